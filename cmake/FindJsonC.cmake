@@ -3,9 +3,23 @@ include(FindPackageHandleStandardArgs)
 find_library(JsonC_LIBRARY NAMES json-c)
 find_path(JsonC_INCLUDE_DIR NAMES json-c/json.h)
 
+if(JsonC_INCLUDE_DIR AND EXISTS "${JsonC_INCLUDE_DIR}/json-c/json_c_version.h")
+    file(
+        STRINGS "${JsonC_INCLUDE_DIR}/json-c/json_c_version.h"
+        JsonC_VERSION_LINE
+        REGEX "^#define[ \t]+JSON_C_VERSION[ \t]+\"[^\"]*\""
+    )
+    string(
+        REGEX REPLACE "^#define[ \t]+JSON_C_VERSION[ \t]+\"([^\"]*)\".*$" "\\1"
+        JsonC_VERSION "${JsonC_VERSION_LINE}"
+    )
+    unset(JsonC_VERSION_LINE)
+endif()
+
 find_package_handle_standard_args(
     JsonC
     REQUIRED_VARS JsonC_LIBRARY JsonC_INCLUDE_DIR
+    VERSION_VAR JsonC_VERSION
 )
 
 if(JsonC_FOUND)
@@ -89,6 +89,20 @@ const AnkiProfile *AnkiClient::profile() const noexcept
     return m_context->ankiConfig()->profile();
 }
 
+AnkiClient::Stats AnkiClient::stats() const noexcept
+{
+    return Stats{
+        .noteBuilds = m_noteBuildLatency.snapshot(),
+        .requests = m_requestLatency.snapshot(),
+    };
+}
+
+void AnkiClient::resetStats()
+{
+    m_noteBuildLatency.reset();
+    m_requestLatency.reset();
+}
+
 /* End Getters */
 /* Begin Slots */
 
@@ -257,15 +271,13 @@ QCoro::Task<QVariantMap> AnkiClient::noteAddableAsync(const Term *term)
             QJsonArray notes;
 
             term.setReadingAsExpression(false);
-            Anki::Note::Context ctx = Anki::Note::build(
-                *m_context, profile, term, false
-            );
+            Anki::Note::Context ctx = buildNote(profile, term, false);
             notes.append(std::move(ctx.ankiObject));
 
             if (!term.reading().isEmpty())
             {
                 term.setReadingAsExpression(true);
-                ctx = Anki::Note::build(*m_context, profile, term, false);
+                ctx = buildNote(profile, term, false);
                 notes.append(std::move(ctx.ankiObject));
             }
 
@@ -319,8 +331,7 @@ QCoro::Task<QVariantMap> AnkiClient::noteAddableAsync(const Kanji *kanji)
         {
             QJsonArray notes;
 
-            Anki::Note::Context ctx =
-                Anki::Note::build(*m_context, profile, kanji, false);
+            Anki::Note::Context ctx = buildNote(profile, kanji, false);
             notes.append(std::move(ctx.ankiObject));
 
             QJsonObject params;
@@ -369,7 +380,7 @@ QCoro::Task<QVariantMap> AnkiClient::addNoteAsync(const Term *term)
         [this, &profile = *profileCopy, &term = *termCopy]
         () -> Anki::Note::Context
         {
-            return Anki::Note::build(*m_context, profile, term, true);
+            return buildNote(profile, term, true);
         }
     );
     co_return co_await addNoteHelper(profileCopy.get(), std::move(ctx));
@@ -397,7 +408,7 @@ QCoro::Task<QVariantMap> AnkiClient::addNoteAsync(const Kanji *kanji)
         [this, &profile = *profileCopy, &kanji = *kanjiCopy]
         () -> Anki::Note::Context
         {
-            return Anki::Note::build(*m_context, profile, kanji, true);
+            return buildNote(profile, kanji, true);
         }
     );
     co_return co_await addNoteHelper(profileCopy.get(), std::move(ctx));
@@ -442,7 +453,9 @@ QCoro::Task<QVariantMap> AnkiClient::addMedia(
         command[AnkiConnect::Req::ACTION] =
             AnkiConnect::Action::STORE_MEDIA_FILE;
         QJsonObject fileParams;
-        fileParams[AnkiConnect::Note::DATA] = FileUtils::toBase64(info.path);
+        fileParams[AnkiConnect::Note::DATA] = info.data.isNull() ?
+            FileUtils::toBase64(info.path) :
+            QString::fromLatin1(info.data.toBase64());
         fileParams[AnkiConnect::Note::FILENAME] = info.name;
         command[AnkiConnect::Req::PARAMS] = fileParams;
 
@@ -620,7 +633,7 @@ QCoro::Task<QVariantMap> AnkiClient::openDuplicatesAsync(const Term *term)
         [this, &profile = *profileCopy, &term = *termCopy]
         () -> Anki::Note::Context
         {
-            return Anki::Note::build(*m_context, profile, term, false);
+            return buildNote(profile, term, false);
         }
     );
     QString fieldValue =
@@ -637,7 +650,7 @@ QCoro::Task<QVariantMap> AnkiClient::openDuplicatesAsync(const Term *term)
             [this, &profile = *profileCopy, &term = *termCopy]
             () -> Anki::Note::Context
             {
-                return Anki::Note::build(*m_context, profile, term, false);
+                return buildNote(profile, term, false);
             }
         );
         QString fieldValue =
@@ -690,7 +703,7 @@ QCoro::Task<QVariantMap> AnkiClient::openDuplicatesAsync(const Kanji *kanji)
         [this, &profile = *profileCopy, &kanji = *kanjiCopy]
         () -> Anki::Note::Context
         {
-            return Anki::Note::build(*m_context, profile, kanji, false);
+            return buildNote(profile, kanji, false);
         }
     );
     QString fieldValue =
@@ -704,6 +717,23 @@ QCoro::Task<QVariantMap> AnkiClient::openDuplicatesAsync(const Kanji *kanji)
 }
 
 /* End Commands */
+/* Begin Note Helpers */
+
+Anki::Note::Context AnkiClient::buildNote(
+    const AnkiProfile &profile, const Term &term, bool media)
+{
+    const LatencyHistogram::Timer latency{m_noteBuildLatency};
+    return Anki::Note::build(*m_context, profile, term, media);
+}
+
+Anki::Note::Context AnkiClient::buildNote(
+    const AnkiProfile &profile, const Kanji &kanji, bool media)
+{
+    const LatencyHistogram::Timer latency{m_noteBuildLatency};
+    return Anki::Note::build(*m_context, profile, kanji, media);
+}
+
+/* End Note Helpers */
 /* Begin Network Helpers */
 
 QCoro::Task<QVariantMap> AnkiClient::requestStringList(
@@ -874,6 +904,7 @@ QCoro::Task<std::unique_ptr<QNetworkReply>> AnkiClient::makeRequest(
     }
     QJsonDocument jsonDoc(jsonMsg);
 
+    const LatencyHistogram::Timer latency{m_requestLatency};
     co_return std::unique_ptr<QNetworkReply>{
         co_await m_manager.post(request, jsonDoc.toJson())
     };
@@ -38,6 +38,7 @@
 #include "anki/notebuilder.h"
 #include "dict/data/kanji.h"
 #include "dict/data/term.h"
+#include "util/latencyhistogram.h"
 
 class Context;
 
@@ -345,6 +346,32 @@ public:
     [[nodiscard]]
     QCoro::Task<QVariantMap> openDuplicatesAsync(const Kanji *kanji);
 
+    /**
+     * @brief How long building notes and talking to AnkiConnect takes.
+     */
+    struct Stats
+    {
+        /* Building a note from a term or kanji, including media if added */
+        LatencyHistogram::Snapshot noteBuilds;
+
+        /* Round trips to AnkiConnect */
+        LatencyHistogram::Snapshot requests;
+    };
+
+    /**
+     * @brief Get how long notes and requests have taken since the client was
+     * created or resetStats() was called.
+     *
+     * @return The latencies of the client.
+     */
+    [[nodiscard]]
+    Stats stats() const noexcept;
+
+    /**
+     * @brief Clears the note build and request latencies.
+     */
+    void resetStats();
+
 signals:
     /**
      * @brief Emitted when the context is changed.
@@ -369,6 +396,30 @@ private slots:
     void updateSubtitleFilterRegex(const QString &filter);
 
 private:
+    /**
+     * @brief Builds a note for a term and records how long it took.
+     *
+     * @param profile The profile to build the note with.
+     * @param term The term to build the note for.
+     * @param media true if media files should be created, false otherwise.
+     * @return The built note.
+     */
+    [[nodiscard]]
+    Anki::Note::Context buildNote(
+        const AnkiProfile &profile, const Term &term, bool media);
+
+    /**
+     * @brief Builds a note for a kanji and records how long it took.
+     *
+     * @param profile The profile to build the note with.
+     * @param kanji The kanji to build the note for.
+     * @param media true if media files should be created, false otherwise.
+     * @return The built note.
+     */
+    [[nodiscard]]
+    Anki::Note::Context buildNote(
+        const AnkiProfile &profile, const Kanji &kanji, bool media);
+
     /**
      * @brief Add a note to Anki using an Anki::Note::Context
      *
@@ -500,4 +551,10 @@ private:
 
     /* The regular expression to filter subtitles with */
     QRegularExpression m_subtitleFilterRegex;
+
+    /* Time spent in buildNote() */
+    LatencyHistogram m_noteBuildLatency;
+
+    /* Time spent waiting on AnkiConnect */
+    LatencyHistogram m_requestLatency;
 };
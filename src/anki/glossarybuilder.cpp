@@ -20,7 +20,7 @@
 
 #include "anki/glossarybuilder.h"
 
-#include <QDir>
+#include <QCryptographicHash>
 
 #include "util/utils.h"
 
@@ -28,7 +28,7 @@
 
 QStringList GlossaryBuilder::buildGlossary(
     const QJsonArray &definitions,
-    QString basepath,
+    const DictionaryResources &resources,
     QSet<FileInfo> &fileMap)
 {
     constexpr const char *KEY_TYPE = "type";
@@ -37,7 +37,6 @@ QStringList GlossaryBuilder::buildGlossary(
     constexpr const char *VALUE_TYPE_STRUCTURED_CONTENT = "structured-content";
     constexpr const char *VALUE_TYPE_TEXT = "text";
 
-    basepath += QDir::separator();
     QStringList glossaries;
 
     for (const QJsonValue &val : definitions)
@@ -58,12 +57,12 @@ QStringList GlossaryBuilder::buildGlossary(
                 if (obj[KEY_TYPE] == VALUE_TYPE_STRUCTURED_CONTENT)
                 {
                     addStructuredContent(
-                        obj[KEY_CONTENT], basepath, glossary, fileMap
+                        obj[KEY_CONTENT], resources, glossary, fileMap
                     );
                 }
                 else if (obj[KEY_TYPE] == VALUE_TYPE_IMAGE)
                 {
-                    addImage(obj, basepath, glossary, fileMap);
+                    addImage(obj, resources, glossary, fileMap);
                 }
                 else if (obj[KEY_TYPE] == VALUE_TYPE_TEXT)
                 {
@@ -473,19 +472,19 @@ void GlossaryBuilder::addStructuredContentHelper(
 
 void GlossaryBuilder::addStructuredContentHelper(
     const QJsonArray &arr,
-    const QString &basepath,
+    const DictionaryResources &resources,
     QString &out,
     QSet<FileInfo> &fileMap)
 {
     for (const QJsonValue &val : arr)
     {
-        addStructuredContent(val, basepath, out, fileMap);
+        addStructuredContent(val, resources, out, fileMap);
     }
 }
 
 void GlossaryBuilder::addStructuredContentHelper(
     const QJsonObject &obj,
-    const QString &basepath,
+    const DictionaryResources &resources,
     QString &out,
     QSet<FileInfo> &fileMap)
 {
@@ -547,7 +546,7 @@ void GlossaryBuilder::addStructuredContentHelper(
             out += ">";
         }
 
-        QString filename = addFile(basepath, obj[KEY_PATH].toString(), fileMap);
+        QString filename = addFile(resources, obj[KEY_PATH].toString(), fileMap);
         out += "<img src=\"";
         out += escapeHtml(filename);
         out += '"';
@@ -723,7 +722,7 @@ void GlossaryBuilder::addStructuredContentHelper(
 
         out += '>';
 
-        addStructuredContent(obj[KEY_CONTENT], basepath, out, fileMap);
+        addStructuredContent(obj[KEY_CONTENT], resources, out, fileMap);
 
         out += "</";
         out += tag;
@@ -733,7 +732,7 @@ void GlossaryBuilder::addStructuredContentHelper(
 
 void GlossaryBuilder::addStructuredContent(
     const QJsonValue &val,
-    const QString &basepath,
+    const DictionaryResources &resources,
     QString &out,
     QSet<FileInfo> &fileMap)
 {
@@ -744,11 +743,11 @@ void GlossaryBuilder::addStructuredContent(
         break;
 
     case QJsonValue::Type::Array:
-        addStructuredContentHelper(val.toArray(), basepath, out, fileMap);
+        addStructuredContentHelper(val.toArray(), resources, out, fileMap);
         break;
 
     case QJsonValue::Type::Object:
-        addStructuredContentHelper(val.toObject(), basepath, out, fileMap);
+        addStructuredContentHelper(val.toObject(), resources, out, fileMap);
         break;
 
     default:
@@ -761,7 +760,7 @@ void GlossaryBuilder::addStructuredContent(
 
 void GlossaryBuilder::addImage(
     const QJsonObject &obj,
-    const QString &basepath,
+    const DictionaryResources &resources,
     QString &out,
     QSet<FileInfo> &fileMap)
 {
@@ -792,7 +791,7 @@ void GlossaryBuilder::addImage(
     }
 
     out += "<img src=\"";
-    out += escapeHtml(addFile(basepath, obj[KEY_PATH].toString(), fileMap));
+    out += escapeHtml(addFile(resources, obj[KEY_PATH].toString(), fileMap));
     out += '"';
 
     if (obj[KEY_WIDTH].isDouble())
@@ -848,20 +847,17 @@ void GlossaryBuilder::addText(const QJsonObject &obj, QString &out)
 /* Begin Helpers */
 
 QString GlossaryBuilder::addFile(
-    QString basepath,
+    const DictionaryResources &resources,
     const QString &path,
     QSet<FileInfo> &fileMap)
 {
-#if defined(Q_OS_WIN)
-    basepath += QDir::toNativeSeparators(path);
-#else
-    basepath += path;
-#endif
-    QString hash = FileUtils::calculateMd5(basepath);
-    if (hash.isEmpty())
+    QByteArray data = resources.read(path);
+    if (data.isNull())
     {
-        return QString("File not found at: %1").arg(basepath);
+        return QString("File not found at: %1").arg(resources.location(path));
     }
+    QString hash =
+        QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
     int lastSlashIndex = path.lastIndexOf('/');
     if (lastSlashIndex == -1)
     {
@@ -872,7 +868,7 @@ QString GlossaryBuilder::addFile(
     {
         hash += path.right(path.length() - dotIndex);
     }
-    fileMap.insert(FileInfo{basepath, hash});
+    fileMap.insert(FileInfo{resources.location(path), hash, std::move(data)});
     return hash;
 }
 
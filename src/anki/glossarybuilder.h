@@ -27,6 +27,8 @@
 #include <QSet>
 #include <QString>
 
+#include "dict/data/dictionaryresources.h"
+
 /**
  * @brief Builds Anki-compatible glossaries.
  */
@@ -43,20 +45,24 @@ public:
 
         /* The new name of the file */
         QString name;
+
+        /* The contents of the file if it isn't stored at path */
+        QByteArray data;
     };
 
     /**
      * @brief Generate an Anki glossary HTML.
      *
      * @param definitions The definitions to add to this glossary.
-     * @param basepath The path where all external resources begin.
+     * @param resources The resources of the dictionary the definitions are
+     * from.
      * @param[out] fileMap A mapping of files to file names.
      * @return A list of HTML formatted glossary entries.
      */
     [[nodiscard]]
     static QStringList buildGlossary(
         const QJsonArray &definitions,
-        QString basepath,
+        const DictionaryResources &resources,
         QSet<FileInfo> &fileMap);
 
 private:
@@ -117,13 +123,13 @@ private:
      * @brief Add an array of structured content.
      *
      * @param arr The array of structured content.
-     * @param basepath The base of the image path.
+     * @param resources The resources images are found in.
      * @param[out] out The string this content will be appended to.
      * @param[out] fileMap A mapping of files to filenames.
      */
     static void addStructuredContentHelper(
         const QJsonArray &arr,
-        const QString &basepath,
+        const DictionaryResources &resources,
         QString &out,
         QSet<FileInfo> &fileMap);
 
@@ -131,13 +137,13 @@ private:
      * @brief Add an object of structured content.
      *
      * @param obj The object of structured content.
-     * @param basepath The base of the image path.
+     * @param resources The resources images are found in.
      * @param[out] out The string this content will be appended to.
      * @param[out] fileMap A mapping of files to filenames.
      */
     static void addStructuredContentHelper(
         const QJsonObject &obj,
-        const QString &basepath,
+        const DictionaryResources &resources,
         QString &out,
         QSet<FileInfo> &fileMap);
 
@@ -145,13 +151,13 @@ private:
      * @brief Parses and outputs structured content to HTML.
      *
      * @param val The JSON value of the structured content.
-     * @param basepath The base of the image path.
+     * @param resources The resources images are found in.
      * @param[out] out The string this content will be appended to.
      * @param[out] fileMap A mapping of files to filenames.
      */
     static void addStructuredContent(
         const QJsonValue &val,
-        const QString &basepath,
+        const DictionaryResources &resources,
         QString &out,
         QSet<FileInfo> &fileMap);
 
@@ -159,13 +165,13 @@ private:
      * @brief Add an image type object.
      *
      * @param obj The image object.
-     * @param basepath The base of the image path.
+     * @param resources The resources images are found in.
      * @param[out] out The string this image will be appended to.
      * @param[out] fileMap A mapping of files to filenames.
      */
     static void addImage(
         const QJsonObject &obj,
-        const QString &basepath,
+        const DictionaryResources &resources,
         QString &out,
         QSet<FileInfo> &fileMap);
 
@@ -180,12 +186,12 @@ private:
     /**
      * @brief Add a file to the file map and returns its mapped filename.
      *
-     * @param basepath The base path all files will be found at.
-     * @param path The relative path of the file to add.
+     * @param resources The resources all files will be found in.
+     * @param path The path of the file to add in the dictionary archive.
      * @param[out] fileMap The map to add the file to.
      */
     static QString addFile(
-        QString basepath,
+        const DictionaryResources &resources,
         const QString &path,
         QSet<FileInfo> &fileMap);
 };
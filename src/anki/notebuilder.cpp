@@ -30,6 +30,7 @@
 #include "anki/marker.h"
 #include "anki/markertokenizer.h"
 #include "state/context.h"
+#include "util/tracing.h"
 #include "util/utils.h"
 
 /**
@@ -1189,10 +1190,19 @@ static GlossaryData getGlossary(const QList<TermDefinition *> &definitions)
         data.glossary += "<span>";
         data.glossaryCompact += "<span>";
 
+        std::shared_ptr<const DictionaryResources> resources =
+            def->dictionaryInfo()->resources();
+        if (resources == nullptr)
+        {
+            resources = std::make_shared<const DictionaryResources>(
+                def->dictionaryInfo()->id(),
+                QString(),
+                QHash<QString, DictionaryResources::Range>(),
+                basepath + def->dictionaryInfo()->name()
+            );
+        }
         QStringList items = GlossaryBuilder::buildGlossary(
-            def->glossary(),
-            basepath + def->dictionaryInfo()->name(),
-            data.files
+            def->glossary(), *resources, data.files
         );
         for (const QString &item : items)
         {
@@ -2420,6 +2430,8 @@ Anki::Note::Context Anki::Note::build(
     const Term &term,
     bool media)
 {
+    MEMENTO_TRACE_SCOPE("Anki::Note::build(Term)");
+
     Anki::Note::Context ctx;
     ctx.setDeck(profile.termDeck());
     ctx.setModel(profile.termModel());
@@ -2500,6 +2512,8 @@ Anki::Note::Context Anki::Note::build(
     const Kanji &kanji,
     bool media)
 {
+    MEMENTO_TRACE_SCOPE("Anki::Note::build(Kanji)");
+
     Anki::Note::Context ctx;
     ctx.setDeck(profile.kanjiDeck());
     ctx.setModel(profile.kanjiModel());
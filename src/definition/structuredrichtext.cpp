@@ -32,6 +32,7 @@
 #include <QStringList>
 #include <QUrl>
 
+#include "util/tracing.h"
 #include "util/utils.h"
 
 /* Begin Local Functions */
@@ -372,6 +373,8 @@ QString StructuredRichText::parse(
     const QColor &color,
     const QColor &backgroundColor) const
 {
+    MEMENTO_TRACE_SCOPE("StructuredRichText::parse");
+
     if (info == nullptr)
     {
         return "";
@@ -425,15 +428,22 @@ QString StructuredRichText::parse(
     ctx.siblings.reserve(SIBLING_STACK_RESERVE);
     ctx.lists.reserve(LIST_STACK_RESERVE);
     ctx.resolvedCssValues.reserve(CSS_VALUE_CACHE_RESERVE);
-    ctx.basepath = DirectoryUtils::getDictionaryResourceDir();
+    if (info->resources() != nullptr)
+    {
+        ctx.basepath = info->resources()->baseUrl();
+    }
+    else
+    {
+        ctx.basepath = DirectoryUtils::getDictionaryResourceDir();
 #if defined(Q_OS_WIN)
-    ctx.basepath.prepend('/');
-    ctx.basepath.replace('\\', '/');
+        ctx.basepath.prepend('/');
+        ctx.basepath.replace('\\', '/');
 #endif
-    ctx.basepath.prepend("file://");
-    ctx.basepath += '/';
-    ctx.basepath += info->name();
-    ctx.basepath += '/';
+        ctx.basepath.prepend("file://");
+        ctx.basepath += '/';
+        ctx.basepath += info->name();
+        ctx.basepath += '/';
+    }
 
     const bool containsSc = containsStructuredContent(content);
     const bool shouldUseBullets =
@@ -795,7 +805,10 @@ void StructuredRichText::addStructuredContentHelper(
         flushPendingVerticalMargin(ctx, out);
         ctx.elements.emplaceBack(structuredElement(obj, ctx));
 
-        QString filename = escapeHtml(ctx.basepath + obj[KEY_PATH].toString());
+        QString filename = escapeHtml(
+            ctx.basepath +
+            QUrl::toPercentEncoding(obj[KEY_PATH].toString(), "/")
+        );
 
         const QString imageTitle = obj[KEY_TITLE].isString() ?
             obj[KEY_TITLE].toString() :
@@ -2337,7 +2350,9 @@ void StructuredRichText::addImage(
     constexpr const char *KEY_RENDERING = "imageRendering";
     constexpr const char *KEY_DESCRIPTION = "description";
 
-    QString filename = escapeHtml(ctx.basepath + obj[KEY_PATH].toString());
+    QString filename = escapeHtml(
+        ctx.basepath + QUrl::toPercentEncoding(obj[KEY_PATH].toString(), "/")
+    );
 
     if (obj[KEY_TITLE].isString())
     {
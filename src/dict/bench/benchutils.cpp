@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dict/bench/benchutils.h"
+
+#include <QCommandLineParser>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+qsizetype BenchUtils::intOption(
+    const QCommandLineParser &parser, const char *name)
+{
+    bool ok = false;
+    const qsizetype value = parser.value(name).toLongLong(&ok);
+    if (!ok || value < 0)
+    {
+        fprintf(stderr, "Invalid value for --%s\n", name);
+        exit(EXIT_FAILURE);
+    }
+    return value;
+}
+
+qsizetype BenchUtils::nearestRank(qsizetype size, double percentile) noexcept
+{
+    const qsizetype rank = std::ceil(percentile / 100.0 * size);
+    return std::clamp<qsizetype>(rank, 1, size) - 1;
+}
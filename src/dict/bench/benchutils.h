@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QtGlobal>
+
+class QCommandLineParser;
+
+/**
+ * @brief Helpers shared by the benchmark executables.
+ */
+namespace BenchUtils
+{
+
+/**
+ * @brief Reads a non-negative integer option and exits on malformed values.
+ *
+ * @param parser The parser holding the option.
+ * @param name The name of the option.
+ * @return The value of the option.
+ */
+[[nodiscard]]
+qsizetype intOption(const QCommandLineParser &parser, const char *name);
+
+/**
+ * @brief Get the index of a percentile in sorted samples by nearest rank.
+ *
+ * @param size The number of samples. Must be greater than 0.
+ * @param percentile The percentile in the range [0, 100].
+ * @return The index of the sample at the percentile.
+ */
+[[nodiscard]]
+qsizetype nearestRank(qsizetype size, double percentile) noexcept;
+
+}
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dict/bench/corpus.h"
+
+#include <QFile>
+#include <QTextStream>
+
+namespace Corpus
+{
+
+/* Lines searched when no corpus is given */
+static constexpr const char16_t *DEFAULT_CORPUS[] = {
+    u"今日は学校に行かなかったの？",
+    u"大丈夫だよ、心配しないで。",
+    u"お前のことは絶対に忘れない！",
+    u"明日の約束、覚えてる？",
+    u"先生が待っていますよ。早く来てください。",
+    u"本当に分からないんだ。",
+    u"俺たちは世界を守るために戦ってきた。",
+    u"電車が遅れて、仕事に間に合わなかった。",
+    u"一緒に帰ろうか。",
+    u"誰がそんなことを言ったんですか？",
+    u"友達と話していたら時間を忘れてしまった。",
+    u"何を食べたいか聞いてもいい？",
+    u"この気持ちは信じてもらえないかもしれない。",
+    u"勉強しなければならないのに、テレビを見てしまう。",
+    u"可愛いって言われても嬉しくないし。",
+    u"始まったばかりなのに、もう終わりそうだ。",
+    u"家に着いたら連絡してね。",
+    u"私は何も知らされていなかった。",
+    u"高すぎて買えませんでした。",
+    u"そういうことは先に言ってくれよ。",
+};
+
+QStringList defaultLines()
+{
+    QStringList lines;
+    for (const char16_t *line : DEFAULT_CORPUS)
+    {
+        lines.emplaceBack(QString::fromUtf16(line));
+    }
+    return lines;
+}
+
+bool read(const QString &path, QStringList &lines)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return false;
+    }
+    QTextStream stream(&file);
+    while (!stream.atEnd())
+    {
+        QString line = stream.readLine().trimmed();
+        if (!line.isEmpty())
+        {
+            lines.emplaceBack(std::move(line));
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Lines of text that benchmarks search.
+ */
+namespace Corpus
+{
+
+/**
+ * @brief Get the lines searched when no corpus is given.
+ *
+ * @return Short lines of Japanese dialogue.
+ */
+[[nodiscard]]
+QStringList defaultLines();
+
+/**
+ * @brief Reads the non-empty lines of a file.
+ *
+ * @param path The path to the file.
+ * @param[out] lines The lines of the file.
+ * @return true on success, false otherwise.
+ */
+bool read(const QString &path, QStringList &lines);
+
+}
@@ -0,0 +1,281 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include "constant/version.h"
+#include "dict/bench/benchutils.h"
+#include "dict/bench/corpus.h"
+#include "dict/bench/memorystats.h"
+#include "dict/deconjugationquerygenerator.h"
+#include "dict/deconjugator.h"
+
+using BenchUtils::intOption;
+
+/**
+ * @brief Times a function once per line of the corpus.
+ *
+ * @param corpus The lines to pass to func.
+ * @param passes Number of times to go over the corpus.
+ * @param func Deconjugates a line and returns the number of results.
+ * @return Summary of the time taken per line.
+ */
+static QJsonObject measure(
+    const QStringList &corpus,
+    qsizetype passes,
+    const std::function<qsizetype(const QString &)> &func)
+{
+    QList<int64_t> samples;
+    qsizetype results = 0;
+    const MemoryStats::Allocations before = MemoryStats::allocations();
+    QElapsedTimer timer;
+    for (qsizetype pass = 0; pass < passes; ++pass)
+    {
+        for (const QString &line : corpus)
+        {
+            timer.start();
+            results += func(line);
+            samples.emplaceBack(timer.nsecsElapsed());
+        }
+    }
+    const MemoryStats::Allocations after = MemoryStats::allocations();
+    if (samples.isEmpty())
+    {
+        return QJsonObject{{"lines", 0}};
+    }
+
+    std::sort(std::begin(samples), std::end(samples));
+    auto percentileUs =
+        [&samples] (double percentile) -> double
+        {
+            const qsizetype i =
+                BenchUtils::nearestRank(samples.size(), percentile);
+            return samples[i] / 1000.0;
+        };
+    double totalNsecs = 0;
+    for (const int64_t nsecs : samples)
+    {
+        totalNsecs += nsecs;
+    }
+    const double count = samples.size();
+
+    return QJsonObject{
+        {"lines", samples.size()},
+        {"p50Us", percentileUs(50)},
+        {"p95Us", percentileUs(95)},
+        {"p99Us", percentileUs(99)},
+        {"maxUs", samples.last() / 1000.0},
+        {"meanUs", totalNsecs / count / 1000.0},
+        {"allocationsPerLine", (after.count - before.count) / count},
+        {"resultsPerLine", results / count},
+    };
+}
+
+/**
+ * @brief Checks that deconjugate() and the reference implementation return
+ * the same results in the same order.
+ *
+ * @param line The line to deconjugate.
+ * @return true if the results match, false otherwise.
+ */
+static bool matchesReference(const QString &line)
+{
+    const QList<ConjugationInfo> results = deconjugate(line);
+    const QList<ConjugationInfo> expected = deconjugateReference(line);
+    return std::equal(
+        std::cbegin(results), std::cend(results),
+        std::cbegin(expected), std::cend(expected),
+        [] (const ConjugationInfo &lhs, const ConjugationInfo &rhs) -> bool
+        {
+            return lhs.base == rhs.base &&
+                lhs.conjugated == rhs.conjugated &&
+                lhs.derivations == rhs.derivations &&
+                lhs.derivationDisplay == rhs.derivationDisplay;
+        }
+    );
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("memento_deconj_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Measures deconjugation per line of text and prints the results as "
+        "JSON. The suffix trie is checked and timed against the linear scan "
+        "it replaced. Pass the output of another build as the baseline to "
+        "compare them."
+    );
+    parser.addHelpOption();
+    parser.addOptions({
+        {"passes", "Number of times to deconjugate the corpus.", "n", "20"},
+        {"corpus", "File with one line of text per line.", "file"},
+        {"baseline", "Results of another build to compare against.", "file"},
+        {"output", "File to write the results to instead of stdout.", "file"},
+    });
+    parser.process(app);
+
+    QStringList corpus;
+    if (parser.isSet("corpus"))
+    {
+        if (!Corpus::read(parser.value("corpus"), corpus))
+        {
+            fprintf(
+                stderr, "Could not read %s\n",
+                qPrintable(parser.value("corpus"))
+            );
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        corpus = Corpus::defaultLines();
+    }
+
+    QJsonObject baseline;
+    if (parser.isSet("baseline"))
+    {
+        QFile file(parser.value("baseline"));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            fprintf(
+                stderr, "Could not read %s\n",
+                qPrintable(parser.value("baseline"))
+            );
+            return EXIT_FAILURE;
+        }
+        baseline = QJsonDocument::fromJson(file.readAll()).object();
+    }
+
+    /* Timing a wrong answer is meaningless */
+    qsizetype mismatches = 0;
+    for (const QString &line : corpus)
+    {
+        if (!matchesReference(line))
+        {
+            fprintf(
+                stderr, "Results differ from the reference for %s\n",
+                qPrintable(line)
+            );
+            ++mismatches;
+        }
+    }
+    if (mismatches > 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    const qsizetype passes = intOption(parser, "passes");
+    QJsonObject results;
+
+    /* A single search of a line in sentence mode */
+    results["sentence"] = measure(
+        corpus, passes,
+        [] (const QString &line) -> qsizetype
+        {
+            return deconjugate(line).size();
+        }
+    );
+
+    /* The same search using the linear scan over every rule */
+    results["reference"] = measure(
+        corpus, passes,
+        [] (const QString &line) -> qsizetype
+        {
+            return deconjugateReference(line).size();
+        }
+    );
+
+    /* Mean time of the reference divided by the trie's */
+    const double referenceUs = results["reference"]["meanUs"].toDouble();
+    const double sentenceUs = results["sentence"]["meanUs"].toDouble();
+    results["referenceSpeedup"] =
+        sentenceUs > 0 ? referenceUs / sentenceUs : 0;
+
+    /* Hovering over every character of a line, which searches the text from
+     * the cursor to the end of the line */
+    results["hover"] = measure(
+        corpus, passes,
+        [] (const QString &line) -> qsizetype
+        {
+            DeconjugationQueryGenerator generator;
+            qsizetype count = 0;
+            for (qsizetype i = 0; i < line.size(); ++i)
+            {
+                count += generator.generateQueries(line.mid(i)).size();
+            }
+            return count;
+        }
+    );
+
+    /* Mean time of the baseline divided by this build's. Result counts
+     * should match if the builds deconjugate the same way. */
+    if (!baseline.isEmpty())
+    {
+        QJsonObject speedup;
+        for (const QString &mode : {QString("sentence"), QString("hover")})
+        {
+            const double before = baseline[mode]["meanUs"].toDouble();
+            const double after = results[mode]["meanUs"].toDouble();
+            speedup[mode] = after > 0 ? before / after : 0;
+        }
+        results["speedup"] = speedup;
+        results["baselineVersionHash"] = baseline["versionHash"];
+    }
+
+    results["version"] = Memento::VERSION;
+    results["versionHash"] = Memento::VERSION_HASH;
+    results["config"] = QJsonObject{
+        {"passes", passes},
+        {"corpusLines", corpus.size()},
+    };
+
+    const QByteArray json = QJsonDocument(results).toJson();
+    if (parser.isSet("output"))
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+            file.write(json) != json.size())
+        {
+            fprintf(
+                stderr, "Could not write %s\n",
+                qPrintable(parser.value("output"))
+            );
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    }
+
+    return EXIT_SUCCESS;
+}
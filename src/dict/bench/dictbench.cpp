@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "constant/version.h"
+#include "dict/bench/benchutils.h"
+#include "dict/bench/corpus.h"
+#include "dict/bench/dictionarybenchmark.h"
+#include "dict/bench/memorystats.h"
+#include "dict/bench/syntheticdictionary.h"
+#include "dict/dictionarysearchcontroller.h"
+#include "dict/yomidbbuilder.h"
+#include "setting/settings.h"
+
+using BenchUtils::intOption;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("memento");
+    QCoreApplication::setApplicationName("memento_dict_bench");
+
+    /* Keep the user's settings out of the measurements */
+    QStandardPaths::setTestModeEnabled(true);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Measures dictionary lookups against generated Yomichan dictionaries "
+        "and prints the results as JSON."
+    );
+    parser.addHelpOption();
+    parser.addOptions({
+        {"dictionaries", "Number of dictionaries to install.", "n", "2"},
+        {"terms", "Number of terms in each dictionary.", "n", "50000"},
+        {"glossaries", "Number of glossaries per term.", "n", "2"},
+        {
+            "structured",
+            "Percent of glossaries that are structured content.",
+            "percent",
+            "50"
+        },
+        {
+            "meta",
+            "Percent of terms and kanji with frequencies and pitches.",
+            "percent",
+            "50"
+        },
+        {"tags", "Number of tags in each dictionary.", "n", "200"},
+        {"kanji", "Number of kanji in each dictionary.", "n", "3000"},
+        {"passes", "Number of times to search the corpus.", "n", "2"},
+        {"seed", "Seed for generating dictionaries.", "n", "1"},
+        {"corpus", "File with one line of text to search per line.", "file"},
+        {"output", "File to write the results to instead of stdout.", "file"},
+    });
+    parser.process(app);
+
+    QStringList corpus;
+    if (parser.isSet("corpus"))
+    {
+        if (!Corpus::read(parser.value("corpus"), corpus))
+        {
+            fprintf(
+                stderr, "Could not read %s\n",
+                qPrintable(parser.value("corpus"))
+            );
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        corpus = Corpus::defaultLines();
+    }
+
+    QTemporaryDir dir;
+    if (!dir.isValid() || !QDir(dir.path()).mkpath("res"))
+    {
+        fprintf(stderr, "Could not create a temporary directory\n");
+        return EXIT_FAILURE;
+    }
+    const QString dbPath = dir.filePath("dictionaries.sqlite");
+    const QString resPath = dir.filePath("res") + QDir::separator();
+
+    /* Generate and import the dictionaries */
+    QElapsedTimer timer;
+    int64_t generateNsecs = 0;
+    int64_t importNsecs = 0;
+    for (qsizetype i = 0; i < intOption(parser, "dictionaries"); ++i)
+    {
+        const SyntheticDictionary::Options options{
+            .title = QString("Synthetic Dictionary %1").arg(i + 1),
+            .seed = static_cast<uint32_t>(intOption(parser, "seed") + i),
+            .terms = intOption(parser, "terms"),
+            .glossaries = intOption(parser, "glossaries"),
+            .structuredPercent =
+                static_cast<int>(intOption(parser, "structured")),
+            .metaPercent = static_cast<int>(intOption(parser, "meta")),
+            .tags = intOption(parser, "tags"),
+            .kanji = intOption(parser, "kanji"),
+            .vocabulary = corpus,
+        };
+        const QString zipPath = dir.filePath(QString("dict_%1.zip").arg(i));
+
+        timer.start();
+        QString err;
+        if (!SyntheticDictionary::write(zipPath, options, &err))
+        {
+            fprintf(
+                stderr, "Could not write %s: %s\n",
+                qPrintable(zipPath), qPrintable(err)
+            );
+            return EXIT_FAILURE;
+        }
+        generateNsecs += timer.nsecsElapsed();
+
+        timer.start();
+        const int ret = yomi_process_dictionary(
+            zipPath.toUtf8(), dbPath.toUtf8(), resPath.toUtf8()
+        );
+        if (ret)
+        {
+            fprintf(
+                stderr, "Could not import %s: error %d\n",
+                qPrintable(zipPath), ret
+            );
+            return EXIT_FAILURE;
+        }
+        importNsecs += timer.nsecsElapsed();
+        QFile::remove(zipPath);
+    }
+
+    timer.start();
+    Dictionary::createDatabaseInstance(dbPath, resPath);
+    Dictionary::waitForDatabaseInstance();
+    const int64_t startupNsecs = timer.nsecsElapsed();
+
+    QJsonObject results;
+    {
+        Settings settings;
+        DictionarySearchController controller(&settings);
+        results = DictionaryBenchmark(&controller)
+            .run(corpus, intOption(parser, "passes"));
+    }
+    Dictionary::destroyDatabaseInstance();
+
+    const MemoryStats::Allocations allocations = MemoryStats::allocations();
+    results["version"] = Memento::VERSION;
+    results["versionHash"] = Memento::VERSION_HASH;
+    results["config"] = QJsonObject{
+        {"dictionaries", intOption(parser, "dictionaries")},
+        {"terms", intOption(parser, "terms")},
+        {"glossaries", intOption(parser, "glossaries")},
+        {"structuredPercent", intOption(parser, "structured")},
+        {"metaPercent", intOption(parser, "meta")},
+        {"tags", intOption(parser, "tags")},
+        {"kanji", intOption(parser, "kanji")},
+        {"passes", intOption(parser, "passes")},
+        {"seed", intOption(parser, "seed")},
+        {"corpusLines", corpus.size()},
+    };
+    results["setup"] = QJsonObject{
+        {"generateMs", generateNsecs / 1e6},
+        {"importMs", importNsecs / 1e6},
+        {"startupMs", startupNsecs / 1e6},
+    };
+    results["memory"] = QJsonObject{
+        {"peakRssKiB", static_cast<qint64>(MemoryStats::peakResidentKiB())},
+        {"allocations", static_cast<qint64>(allocations.count)},
+        {"allocatedBytes", static_cast<qint64>(allocations.bytes)},
+    };
+
+    const QByteArray json = QJsonDocument(results).toJson();
+    if (parser.isSet("output"))
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+            file.write(json) != json.size())
+        {
+            fprintf(
+                stderr, "Could not write %s\n",
+                qPrintable(parser.value("output"))
+            );
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dict/bench/dictionarybenchmark.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+
+#ifdef MEMENTO_SYSTEM_QCORO
+#include <QCoroTask>
+#else
+#include <qcoro/qcorotask.h>
+#endif // MEMENTO_SYSTEM_QCORO
+
+#include <algorithm>
+
+#include "dict/bench/benchutils.h"
+#include "dict/bench/memorystats.h"
+#include "dict/dictionarysearchcontroller.h"
+
+/* Begin Constructor */
+
+DictionaryBenchmark::DictionaryBenchmark(
+    DictionarySearchController *controller) :
+    m_controller(controller)
+{
+}
+
+/* End Constructor */
+/* Begin Benchmark */
+
+QJsonObject DictionaryBenchmark::run(
+    const QStringList &corpus, qsizetype passes)
+{
+    QJsonArray passResults;
+    for (qsizetype pass = 0; pass < passes; ++pass)
+    {
+        QList<Sample> termSamples;
+        QList<Sample> kanjiSamples;
+        for (const QString &text : corpus)
+        {
+            for (qsizetype i = 0; i < text.size(); ++i)
+            {
+                termSamples.emplaceBack(searchTerms(text, i));
+                kanjiSamples.emplaceBack(searchKanji(text, i));
+            }
+        }
+        passResults.append(QJsonObject{
+            {"terms", summarize(termSamples)},
+            {"kanji", summarize(kanjiSamples)},
+        });
+    }
+
+    const DictionarySearchController::SearchCacheStats searchCache =
+        m_controller->searchCacheStats();
+    const DatabaseManager::StatementCacheStats statementCache =
+        m_controller->statementCacheStats();
+    return QJsonObject{
+        {"passes", passResults},
+        {"searchCache", QJsonObject{
+            {"hits", static_cast<qint64>(searchCache.hits)},
+            {"misses", static_cast<qint64>(searchCache.misses)},
+        }},
+        {"statementCache", QJsonObject{
+            {"hits", static_cast<qint64>(statementCache.hits)},
+            {"misses", static_cast<qint64>(statementCache.misses)},
+        }},
+    };
+}
+
+DictionaryBenchmark::Sample DictionaryBenchmark::searchTerms(
+    const QString &text, qsizetype index)
+{
+    const QString query = text.mid(index);
+
+    const MemoryStats::Allocations before = MemoryStats::allocations();
+    QElapsedTimer timer;
+    timer.start();
+
+    /* Only the first page is completed, like the results that are shown */
+    QList<Term *> terms = QCoro::waitFor(
+        m_controller->searchTermsAsync(query, text, index)
+    );
+
+    const int64_t nsecs = timer.nsecsElapsed();
+    const MemoryStats::Allocations after = MemoryStats::allocations();
+
+    /* Count the queries after timing so the generators are not warmed */
+    const DictionarySearchController::QueryCounts queries =
+        m_controller->countTermQueries(query);
+
+    const qsizetype results = terms.size();
+    qDeleteAll(terms);
+
+    return {
+        .nsecs = nsecs,
+        .allocations = after.count - before.count,
+        .bytes = after.bytes - before.bytes,
+        .queries = queries.generated,
+        .dbQueries = queries.lookedUp,
+        .results = results,
+    };
+}
+
+DictionaryBenchmark::Sample DictionaryBenchmark::searchKanji(
+    const QString &text, qsizetype index)
+{
+    const MemoryStats::Allocations before = MemoryStats::allocations();
+    QElapsedTimer timer;
+    timer.start();
+
+    Kanji *kanji = QCoro::waitFor(
+        m_controller->searchKanjiAsync(text.mid(index, 1), text, index)
+    );
+
+    const int64_t nsecs = timer.nsecsElapsed();
+    const MemoryStats::Allocations after = MemoryStats::allocations();
+
+    const qsizetype results = kanji ? kanji->definitions().size() : 0;
+    delete kanji;
+
+    return {
+        .nsecs = nsecs,
+        .allocations = after.count - before.count,
+        .bytes = after.bytes - before.bytes,
+        .queries = 1,
+        .dbQueries = 1,
+        .results = results,
+    };
+}
+
+QJsonObject DictionaryBenchmark::summarize(QList<Sample> &samples)
+{
+    if (samples.isEmpty())
+    {
+        return QJsonObject{{"searches", 0}};
+    }
+
+    std::sort(
+        std::begin(samples), std::end(samples),
+        [] (const Sample &lhs, const Sample &rhs) -> bool
+        {
+            return lhs.nsecs < rhs.nsecs;
+        }
+    );
+    auto percentileUs =
+        [&samples] (double percentile) -> double
+        {
+            const qsizetype i =
+                BenchUtils::nearestRank(samples.size(), percentile);
+            return samples[i].nsecs / 1000.0;
+        };
+
+    double totalNsecs = 0;
+    double allocations = 0;
+    double bytes = 0;
+    double queries = 0;
+    double dbQueries = 0;
+    double results = 0;
+    for (const Sample &sample : samples)
+    {
+        totalNsecs += sample.nsecs;
+        allocations += sample.allocations;
+        bytes += sample.bytes;
+        queries += sample.queries;
+        dbQueries += sample.dbQueries;
+        results += sample.results;
+    }
+    const double count = samples.size();
+
+    return QJsonObject{
+        {"searches", samples.size()},
+        {"p50Us", percentileUs(50)},
+        {"p95Us", percentileUs(95)},
+        {"p99Us", percentileUs(99)},
+        {"maxUs", samples.last().nsecs / 1000.0},
+        {"meanUs", totalNsecs / count / 1000.0},
+        {"allocationsPerSearch", allocations / count},
+        {"bytesPerSearch", bytes / count},
+        {"queriesPerSearch", queries / count},
+        {"dbQueriesPerSearch", dbQueries / count},
+        {"resultsPerSearch", results / count},
+    };
+}
+
+/* End Benchmark */
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+
+#include <cstdint>
+
+class DictionarySearchController;
+
+/**
+ * @brief Replays hover lookups over lines of text against a search controller
+ * and measures them.
+ */
+class DictionaryBenchmark
+{
+public:
+    /**
+     * @brief Creates a benchmark for a controller.
+     *
+     * @param controller The controller to search with. Must outlive the
+     * benchmark.
+     */
+    explicit DictionaryBenchmark(DictionarySearchController *controller);
+
+    /**
+     * @brief Hovers over every character of every line, searching for terms
+     * and kanji the same way the subtitle text does.
+     *
+     * @param corpus The lines to search.
+     * @param passes The number of times to go over the corpus. Passes after
+     * the first are answered from the warm caches.
+     * @return Latency and cost summaries of every pass.
+     */
+    [[nodiscard]]
+    QJsonObject run(const QStringList &corpus, qsizetype passes);
+
+private:
+    /**
+     * @brief The cost of a single search.
+     */
+    struct Sample
+    {
+        /* Wall time of the search */
+        int64_t nsecs;
+
+        /* Number of heap allocations made by the search */
+        uint64_t allocations;
+
+        /* Number of bytes allocated by the search */
+        uint64_t bytes;
+
+        /* Number of distinct queries generated from the text */
+        qsizetype queries;
+
+        /* Number of queries that were looked up in the database */
+        qsizetype dbQueries;
+
+        /* Number of results returned */
+        qsizetype results;
+    };
+
+    /**
+     * @brief Searches for terms through the same asynchronous path as the
+     * definition list, which completes the first page of results.
+     *
+     * @param text The line being hovered over.
+     * @param index The hovered index.
+     * @return The cost of the search.
+     */
+    [[nodiscard]]
+    Sample searchTerms(const QString &text, qsizetype index);
+
+    /**
+     * @brief Searches for the kanji at index through the asynchronous path.
+     *
+     * @param text The line being hovered over.
+     * @param index The hovered index.
+     * @return The cost of the search.
+     */
+    [[nodiscard]]
+    Sample searchKanji(const QString &text, qsizetype index);
+
+    /**
+     * @brief Summarizes samples into percentiles and averages.
+     *
+     * @param samples The samples to summarize. Sorted by this call.
+     * @return The summary.
+     */
+    [[nodiscard]]
+    static QJsonObject summarize(QList<Sample> &samples);
+
+    /* The controller being benchmarked */
+    DictionarySearchController *m_controller;
+};
@@ -0,0 +1,435 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <sqlite3.h>
+
+#include "constant/version.h"
+#include "dict/bench/benchutils.h"
+#include "dict/bench/memorystats.h"
+#include "dict/bench/syntheticdictionary.h"
+#include "dict/yomidbbuilder.h"
+
+using BenchUtils::intOption;
+
+/* Names of the phases in the output, indexed by yomi_import_phase */
+static constexpr const char *PHASE_NAMES[YOMI_PHASE_COUNT] = {
+    "indexFile",
+    "tagBanks",
+    "termBanks",
+    "termMetaBanks",
+    "kanjiBanks",
+    "kanjiMetaBanks",
+    "buildIndexes",
+    "resources",
+    "commit",
+};
+
+/* Text expressions are drawn from so the generated terms look real */
+static constexpr const char16_t *VOCABULARY[] = {
+    u"今日は学校に行かなかったの？",
+    u"大丈夫だよ、心配しないで。",
+    u"お前のことは絶対に忘れない！",
+    u"先生が待っていますよ。早く来てください。",
+    u"俺たちは世界を守るために戦ってきた。",
+    u"電車が遅れて、仕事に間に合わなかった。",
+    u"友達と話していたら時間を忘れてしまった。",
+    u"勉強しなければならないのに、テレビを見てしまう。",
+};
+
+/**
+ * @brief Get the total size of the files in a directory.
+ *
+ * @param path The path to the directory.
+ * @return The size of every file under path in bytes.
+ */
+static qint64 directorySize(const QString &path)
+{
+    qint64 size = 0;
+    QDirIterator it(
+        path, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories
+    );
+    while (it.hasNext())
+    {
+        size += it.nextFileInfo().size();
+    }
+    return size;
+}
+
+/**
+ * @brief Get the ID of the only dictionary in a database.
+ *
+ * @param dbPath The path to the database.
+ * @return The ID of the dictionary, 0 on error.
+ */
+static int64_t dictionaryId(const QString &dbPath)
+{
+    constexpr const char *QUERY = "SELECT dic_id FROM directory LIMIT 1;";
+
+    int64_t id = 0;
+    sqlite3 *db = nullptr;
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_open_v2(
+            dbPath.toUtf8(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK &&
+        sqlite3_prepare_v2(db, QUERY, -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        id = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close_v2(db);
+    return id;
+}
+
+/**
+ * @brief Times a call to a yomidbbuilder function.
+ *
+ * @param func The function to call.
+ * @param[out] ret The error code returned by func.
+ * @return The wall time of the call in milliseconds.
+ */
+template <typename Func>
+static double timeMs(Func func, int &ret)
+{
+    QElapsedTimer timer;
+    timer.start();
+    ret = func();
+    return timer.nsecsElapsed() / 1e6;
+}
+
+/**
+ * @brief Imports, disables, enables and deletes a single dictionary. Runs in
+ * its own process so the peak RSS belongs to this dictionary alone.
+ *
+ * @param zipPath The path to the dictionary archive.
+ * @param workPath An empty directory to put the database in.
+ * @return The measurements, or an empty object on error.
+ */
+static QJsonObject measureImport(
+    const QString &zipPath, const QString &workPath)
+{
+    const QString dbPath = QDir(workPath).filePath("dictionaries.sqlite");
+    const QString resPath =
+        QDir(workPath).filePath("res") + QDir::separator();
+    if (!QDir(workPath).mkpath("res"))
+    {
+        fprintf(stderr, "Could not create %s\n", qPrintable(resPath));
+        return {};
+    }
+    const QByteArray zip = zipPath.toUtf8();
+    const QByteArray db = dbPath.toUtf8();
+    const QByteArray res = resPath.toUtf8();
+
+    int ret = yomi_prepare_db(db, nullptr);
+    if (ret)
+    {
+        fprintf(stderr, "Could not create the database: error %d\n", ret);
+        return {};
+    }
+    const qint64 emptySize = directorySize(workPath);
+
+    yomi_import_stats stats{};
+    const uint64_t startRss = MemoryStats::peakResidentKiB();
+    const MemoryStats::Allocations before = MemoryStats::allocations();
+    const double importMs = timeMs(
+        [&] { return yomi_process_dictionary_stats(zip, db, res, &stats); },
+        ret
+    );
+    const MemoryStats::Allocations after = MemoryStats::allocations();
+    const uint64_t peakRss = MemoryStats::peakResidentKiB();
+    if (ret)
+    {
+        fprintf(stderr, "Could not import %s: error %d\n", zip.data(), ret);
+        return {};
+    }
+    const qint64 importedSize = directorySize(workPath);
+
+    QJsonObject phases;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+    uint64_t compressedBytes = 0;
+    for (int i = 0; i < YOMI_PHASE_COUNT; ++i)
+    {
+        const yomi_phase_stats &phase = stats.phases[i];
+        const double secs = phase.nsecs / 1e9;
+        phases[PHASE_NAMES[i]] = QJsonObject{
+            {"ms", phase.nsecs / 1e6},
+            {"rows", static_cast<qint64>(phase.rows)},
+            {"rowsPerSec", secs > 0 ? phase.rows / secs : 0.0},
+            {"bytes", static_cast<qint64>(phase.bytes)},
+            {"compressedBytes", static_cast<qint64>(phase.compressed_bytes)},
+        };
+        rows += phase.rows;
+        bytes += phase.bytes;
+        compressedBytes += phase.compressed_bytes;
+    }
+
+    const int64_t id = dictionaryId(dbPath);
+    int disableRet = 0;
+    int enableRet = 0;
+    int deleteRet = 0;
+    const double disableMs = timeMs(
+        [&] { return yomi_disable_dictionary(id, db); }, disableRet
+    );
+    const double enableMs = timeMs(
+        [&] { return yomi_enable_dictionary(id, db); }, enableRet
+    );
+    const double deleteMs = timeMs(
+        [&] { return yomi_delete_dictionary(id, db, res); }, deleteRet
+    );
+    if (disableRet || enableRet || deleteRet)
+    {
+        fprintf(
+            stderr, "Could not disable, enable or delete %s: %d %d %d\n",
+            zip.data(), disableRet, enableRet, deleteRet
+        );
+        return {};
+    }
+
+    return QJsonObject{
+        {"zipBytes", QFileInfo(zipPath).size()},
+        {"importMs", importMs},
+        {"rows", static_cast<qint64>(rows)},
+        {"rowsPerSec", importMs > 0 ? rows / (importMs / 1e3) : 0.0},
+        {"bytesRead", static_cast<qint64>(bytes)},
+        {"compressedBytesRead", static_cast<qint64>(compressedBytes)},
+        {"dbGrowthBytes", importedSize - emptySize},
+        {"peakRssKiB", static_cast<qint64>(peakRss)},
+        {"rssGrowthKiB", static_cast<qint64>(peakRss - startRss)},
+        {"importAllocations", static_cast<qint64>(after.count - before.count)},
+        {"phases", phases},
+        {"disableMs", disableMs},
+        {"enableMs", enableMs},
+        {"deleteMs", deleteMs},
+        {"dbBytesAfterDelete", directorySize(workPath) - emptySize},
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("memento");
+    QCoreApplication::setApplicationName("memento_import_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Measures importing, disabling and deleting generated Yomichan "
+        "dictionaries and prints the results as JSON."
+    );
+    parser.addHelpOption();
+    parser.addOptions({
+        {
+            "sizes",
+            "Comma separated number of terms in each dictionary.",
+            "n,...",
+            "10000,100000,500000,2000000"
+        },
+        {"glossaries", "Number of glossaries per term.", "n", "2"},
+        {
+            "structured",
+            "Percent of glossaries that are structured content.",
+            "percent",
+            "50"
+        },
+        {
+            "meta",
+            "Percent of terms and kanji with frequencies and pitches.",
+            "percent",
+            "50"
+        },
+        {"tags", "Number of tags in each dictionary.", "n", "200"},
+        {"kanji", "Number of kanji in each dictionary.", "n", "3000"},
+        {
+            "bank-size",
+            "Maximum number of entries in each bank file.",
+            "n",
+            "10000"
+        },
+        {
+            "max-rss-growth",
+            "Fail if importing grows the peak RSS by more than this. Streaming "
+            "imports should stay under it regardless of the bank size.",
+            "MiB"
+        },
+        {"seed", "Seed for generating dictionaries.", "n", "1"},
+        {"output", "File to write the results to instead of stdout.", "file"},
+        {"import", "Internal: measure a single archive.", "zip"},
+        {"work", "Internal: directory for --import.", "dir"},
+    });
+    parser.process(app);
+
+    QJsonObject results;
+    bool rssExceeded = false;
+    if (parser.isSet("import"))
+    {
+        results = measureImport(parser.value("import"), parser.value("work"));
+        if (results.isEmpty())
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        QTemporaryDir dir;
+        if (!dir.isValid())
+        {
+            fprintf(stderr, "Could not create a temporary directory\n");
+            return EXIT_FAILURE;
+        }
+
+        QStringList vocabulary;
+        for (const char16_t *line : VOCABULARY)
+        {
+            vocabulary.emplaceBack(QString::fromUtf16(line));
+        }
+
+        QJsonArray runs;
+        for (const QString &size : parser.value("sizes").split(','))
+        {
+            bool ok = false;
+            const qsizetype terms = size.trimmed().toLongLong(&ok);
+            if (!ok || terms < 0)
+            {
+                fprintf(stderr, "Invalid size %s\n", qPrintable(size));
+                return EXIT_FAILURE;
+            }
+
+            const SyntheticDictionary::Options options{
+                .title = QString("Synthetic Dictionary %1").arg(terms),
+                .seed = static_cast<uint32_t>(intOption(parser, "seed")),
+                .terms = terms,
+                .glossaries = intOption(parser, "glossaries"),
+                .structuredPercent =
+                    static_cast<int>(intOption(parser, "structured")),
+                .metaPercent = static_cast<int>(intOption(parser, "meta")),
+                .tags = intOption(parser, "tags"),
+                .kanji = intOption(parser, "kanji"),
+                .bankSize = intOption(parser, "bank-size"),
+                .vocabulary = vocabulary,
+            };
+            const QString zipPath = dir.filePath(QString("%1.zip").arg(terms));
+            const QString workPath = dir.filePath(QString("db-%1").arg(terms));
+
+            QElapsedTimer timer;
+            timer.start();
+            QString err;
+            if (!SyntheticDictionary::write(zipPath, options, &err))
+            {
+                fprintf(
+                    stderr, "Could not write %s: %s\n",
+                    qPrintable(zipPath), qPrintable(err)
+                );
+                return EXIT_FAILURE;
+            }
+            const double generateMs = timer.nsecsElapsed() / 1e6;
+
+            /* Measure in a fresh process so earlier runs don't inflate the
+             * peak RSS */
+            QProcess child;
+            child.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            child.start(
+                QCoreApplication::applicationFilePath(),
+                {"--import", zipPath, "--work", workPath}
+            );
+            if (!child.waitForFinished(-1) ||
+                child.exitStatus() != QProcess::NormalExit ||
+                child.exitCode() != EXIT_SUCCESS)
+            {
+                fprintf(stderr, "Could not measure %s\n", qPrintable(zipPath));
+                return EXIT_FAILURE;
+            }
+            QJsonObject run =
+                QJsonDocument::fromJson(child.readAllStandardOutput()).object();
+            run["terms"] = terms;
+            run["generateMs"] = generateMs;
+            runs.append(run);
+
+            QFile::remove(zipPath);
+            QDir(workPath).removeRecursively();
+
+            const qint64 rssGrowth = run["rssGrowthKiB"].toInteger();
+            if (parser.isSet("max-rss-growth") &&
+                rssGrowth > intOption(parser, "max-rss-growth") * 1024)
+            {
+                fprintf(
+                    stderr,
+                    "Importing %lld terms grew the peak RSS by %lld KiB, "
+                    "more than the allowed %lld MiB\n",
+                    static_cast<long long>(terms),
+                    static_cast<long long>(rssGrowth),
+                    static_cast<long long>(intOption(parser, "max-rss-growth"))
+                );
+                rssExceeded = true;
+            }
+        }
+
+        results = QJsonObject{
+            {"version", Memento::VERSION},
+            {"versionHash", Memento::VERSION_HASH},
+            {"config", QJsonObject{
+                {"sizes", parser.value("sizes")},
+                {"glossaries", intOption(parser, "glossaries")},
+                {"structuredPercent", intOption(parser, "structured")},
+                {"metaPercent", intOption(parser, "meta")},
+                {"tags", intOption(parser, "tags")},
+                {"kanji", intOption(parser, "kanji")},
+                {"bankSize", intOption(parser, "bank-size")},
+                {"seed", intOption(parser, "seed")},
+            }},
+            {"runs", runs},
+        };
+    }
+
+    const QByteArray json = QJsonDocument(results).toJson();
+    if (parser.isSet("output"))
+    {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+            file.write(json) != json.size())
+        {
+            fprintf(
+                stderr, "Could not write %s\n",
+                qPrintable(parser.value("output"))
+            );
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    }
+
+    return rssExceeded ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Process wide memory counters for benchmarking.
+ */
+namespace MemoryStats
+{
+
+/**
+ * @brief Counters for heap allocations made since the process started.
+ */
+struct Allocations
+{
+    /* Number of allocations */
+    uint64_t count;
+
+    /* Total number of bytes requested */
+    uint64_t bytes;
+};
+
+/**
+ * @brief Get the heap allocations made so far. On glibc every malloc() is
+ * counted, elsewhere only allocations made through operator new.
+ *
+ * @return The allocation counters.
+ */
+[[nodiscard]]
+Allocations allocations() noexcept;
+
+/**
+ * @brief Get the peak resident set size of the process.
+ *
+ * @return The peak resident set size in KiB. 0 if unsupported.
+ */
+[[nodiscard]]
+uint64_t peakResidentKiB() noexcept;
+
+}
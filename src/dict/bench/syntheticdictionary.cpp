@@ -0,0 +1,749 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dict/bench/syntheticdictionary.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QSet>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+
+#include <zip.h>
+
+/* Begin Constants */
+
+/**
+ * @brief A real word so deconjugated lookups find something.
+ */
+struct SeedTerm
+{
+    const char16_t *expression;
+    const char16_t *reading;
+    const char *rules;
+};
+
+static constexpr SeedTerm SEED_TERMS[] = {
+    {u"食べる", u"たべる", "v1"},
+    {u"見る", u"みる", "v1"},
+    {u"出来る", u"できる", "v1"},
+    {u"忘れる", u"わすれる", "v1"},
+    {u"信じる", u"しんじる", "v1"},
+    {u"行く", u"いく", "v5"},
+    {u"言う", u"いう", "v5"},
+    {u"思う", u"おもう", "v5"},
+    {u"分かる", u"わかる", "v5"},
+    {u"待つ", u"まつ", "v5"},
+    {u"帰る", u"かえる", "v5"},
+    {u"聞く", u"きく", "v5"},
+    {u"話す", u"はなす", "v5"},
+    {u"知る", u"しる", "v5"},
+    {u"戦う", u"たたかう", "v5"},
+    {u"守る", u"まもる", "v5"},
+    {u"終わる", u"おわる", "v5"},
+    {u"始まる", u"はじまる", "v5"},
+    {u"来る", u"くる", "vk"},
+    {u"する", u"する", "vs"},
+    {u"約束", u"やくそく", "vs"},
+    {u"勉強", u"べんきょう", "vs"},
+    {u"心配", u"しんぱい", "vs"},
+    {u"早い", u"はやい", "adj-i"},
+    {u"高い", u"たかい", "adj-i"},
+    {u"可愛い", u"かわいい", "adj-i"},
+    {u"大丈夫", u"だいじょうぶ", ""},
+    {u"本当", u"ほんとう", ""},
+    {u"今日", u"きょう", ""},
+    {u"明日", u"あした", ""},
+    {u"先生", u"せんせい", ""},
+    {u"友達", u"ともだち", ""},
+    {u"学校", u"がっこう", ""},
+    {u"時間", u"じかん", ""},
+    {u"何", u"なに", ""},
+    {u"私", u"わたし", ""},
+    {u"俺", u"おれ", ""},
+    {u"お前", u"おまえ", ""},
+    {u"世界", u"せかい", ""},
+    {u"気持ち", u"きもち", ""},
+    {u"一緒", u"いっしょ", ""},
+    {u"絶対", u"ぜったい", ""},
+    {u"誰", u"だれ", ""},
+    {u"家", u"いえ", ""},
+    {u"電車", u"でんしゃ", ""},
+    {u"仕事", u"しごと", ""},
+};
+
+/* Tag names that show up in real dictionaries */
+static constexpr const char *SEED_TAGS[] = {
+    "n", "v1", "v5", "vk", "vs", "adj-i", "P", "uk", "exp", "news",
+};
+
+/* Categories assigned to tags */
+static constexpr const char *TAG_CATEGORIES[] = {
+    "partOfSpeech", "popular", "frequent", "archaism", "",
+};
+
+/* End Constants */
+/* Begin Helpers */
+
+/**
+ * @brief Get if a character is a CJK unified ideograph.
+ *
+ * @param c The character.
+ * @return true if c is a kanji, false otherwise.
+ */
+static bool isKanji(QChar c)
+{
+    return c.unicode() >= 0x4E00 && c.unicode() <= 0x9FFF;
+}
+
+/**
+ * @brief Generates a random string of hiragana.
+ *
+ * @param rng The random number generator.
+ * @param length The number of characters.
+ * @return The string.
+ */
+static QString randomKana(std::mt19937 &rng, qsizetype length)
+{
+    std::uniform_int_distribution<int> kana(u'ぁ', u'ゖ');
+    QString str;
+    str.reserve(length);
+    for (qsizetype i = 0; i < length; ++i)
+    {
+        str += QChar(static_cast<char16_t>(kana(rng)));
+    }
+    return str;
+}
+
+/**
+ * @brief Picks an expression for a made up term. Half are drawn from the
+ * vocabulary so hover lookups hit, the rest are random strings of the same
+ * characters so the prefix checks have realistic near misses.
+ *
+ * @param rng The random number generator.
+ * @param vocabulary The text to draw from.
+ * @param characters The distinct characters of the vocabulary.
+ * @return The expression.
+ */
+static QString randomExpression(
+    std::mt19937 &rng,
+    const QStringList &vocabulary,
+    const QList<QChar> &characters)
+{
+    std::uniform_int_distribution<qsizetype> length(1, 4);
+    if (!vocabulary.isEmpty() && rng() % 2)
+    {
+        std::uniform_int_distribution<qsizetype> line(0, vocabulary.size() - 1);
+        const QString &text = vocabulary[line(rng)];
+        if (!text.isEmpty())
+        {
+            std::uniform_int_distribution<qsizetype> start(0, text.size() - 1);
+            return text.mid(start(rng), length(rng)).trimmed();
+        }
+    }
+    if (characters.isEmpty())
+    {
+        return randomKana(rng, length(rng));
+    }
+
+    std::uniform_int_distribution<qsizetype> pick(0, characters.size() - 1);
+    QString str;
+    for (qsizetype i = length(rng); i > 0; --i)
+    {
+        str += characters[pick(rng)];
+    }
+    return str;
+}
+
+/**
+ * @brief Creates a structured content glossary with a list and a table like
+ * the ones in popular dictionaries.
+ *
+ * @param expression The expression the glossary belongs to.
+ * @param index The index of the glossary.
+ * @return The structured content object.
+ */
+static QJsonObject structuredGlossary(
+    const QString &expression, qsizetype index)
+{
+    QJsonArray items;
+    for (int i = 0; i < 3; ++i)
+    {
+        items.append(QJsonObject{
+            {"tag", "li"},
+            {"content", QString("sense %1.%2 of %3")
+                .arg(index).arg(i).arg(expression)},
+        });
+    }
+    QJsonArray rows;
+    for (int i = 0; i < 2; ++i)
+    {
+        rows.append(QJsonObject{
+            {"tag", "tr"},
+            {"content", QJsonArray{
+                QJsonObject{{"tag", "th"}, {"content", "example"}},
+                QJsonObject{
+                    {"tag", "td"},
+                    {"lang", "ja"},
+                    {"content", expression + QString::number(i)},
+                },
+            }},
+        });
+    }
+    return QJsonObject{
+        {"type", "structured-content"},
+        {"content", QJsonArray{
+            QJsonObject{
+                {"tag", "ul"},
+                {"style", QJsonObject{{"listStyleType", "circle"}}},
+                {"content", items},
+            },
+            QJsonObject{{"tag", "table"}, {"content", rows}},
+        }},
+    };
+}
+
+/**
+ * @brief Writes entries to numbered bank files in a directory. Entries are
+ * written as they are added and a new file is started every bankSize entries,
+ * so banks of any size never have to fit in memory.
+ */
+class BankWriter
+{
+public:
+    /**
+     * @brief Creates a writer for a type of bank.
+     *
+     * @param dir The directory to write the bank files to.
+     * @param format The printf style name of the bank files.
+     * @param bankSize The maximum number of entries in a bank file.
+     * @param[out] files The names of the written files are appended to this.
+     */
+    BankWriter(
+        const QDir &dir,
+        const char *format,
+        qsizetype bankSize,
+        QStringList &files) :
+        m_dir(dir),
+        m_format(format),
+        m_bankSize(std::max<qsizetype>(bankSize, 1)),
+        m_files(files)
+    {
+    }
+
+    /**
+     * @brief Adds an entry to the bank, finishing the bank if it is full.
+     *
+     * @param entry The entry. Must be an array.
+     * @return true on success, false if a bank could not be written.
+     */
+    [[nodiscard]]
+    bool append(const QJsonValue &entry)
+    {
+        if (!m_file.isOpen())
+        {
+            const QString name = QString::asprintf(m_format, ++m_count);
+            m_file.setFileName(m_dir.filePath(name));
+            if (!m_file.open(QIODevice::WriteOnly) || !m_file.putChar('['))
+            {
+                return false;
+            }
+            m_files.emplaceBack(name);
+        }
+        else if (!m_file.putChar(','))
+        {
+            return false;
+        }
+
+        const QByteArray json =
+            QJsonDocument(entry.toArray()).toJson(QJsonDocument::Compact);
+        if (m_file.write(json) != json.size())
+        {
+            return false;
+        }
+        return ++m_entries < m_bankSize || flush();
+    }
+
+    /**
+     * @brief Finishes the partially filled bank if there is one.
+     *
+     * @return true on success, false if the bank could not be written.
+     */
+    [[nodiscard]]
+    bool flush()
+    {
+        if (!m_file.isOpen())
+        {
+            return true;
+        }
+        const bool written = m_file.putChar(']') && m_file.flush();
+        m_file.close();
+        m_entries = 0;
+        return written;
+    }
+
+private:
+    /* The directory bank files are written to */
+    QDir m_dir;
+
+    /* The printf style name of the bank files */
+    const char *m_format;
+
+    /* The maximum number of entries in a bank file */
+    qsizetype m_bankSize;
+
+    /* The names of the written files */
+    QStringList &m_files;
+
+    /* The bank being filled. Closed between banks. */
+    QFile m_file;
+
+    /* The number of entries in the bank being filled */
+    qsizetype m_entries{0};
+
+    /* The number of bank files started */
+    int m_count{0};
+};
+
+/**
+ * @brief Zips files into an archive.
+ *
+ * @param path The path of the archive. Overwritten if it exists.
+ * @param dir The directory containing the files.
+ * @param files The names of the files. Kept as is in the archive.
+ * @param[out] err Set to a description of the error on failure. Can be
+ * nullptr.
+ * @return true on success, false otherwise.
+ */
+static bool writeArchive(
+    const QString &path,
+    const QDir &dir,
+    const QStringList &files,
+    QString *err)
+{
+    int zipErr = 0;
+    zip_t *archive = zip_open(
+        path.toUtf8().constData(), ZIP_CREATE | ZIP_TRUNCATE, &zipErr
+    );
+    if (archive == nullptr)
+    {
+        if (err)
+        {
+            zip_error_t error;
+            zip_error_init_with_code(&error, zipErr);
+            *err = zip_error_strerror(&error);
+            zip_error_fini(&error);
+        }
+        return false;
+    }
+    bool added = true;
+    for (const QString &name : files)
+    {
+        /* Files are only read once the archive is closed */
+        zip_source_t *source = zip_source_file(
+            archive, dir.filePath(name).toUtf8().constData(), 0, 0
+        );
+        if (source == nullptr ||
+            zip_file_add(
+                archive, name.toUtf8().constData(), source,
+                ZIP_FL_ENC_UTF_8) < 0)
+        {
+            zip_source_free(source);
+            added = false;
+            break;
+        }
+    }
+    if (added && zip_close(archive) == 0)
+    {
+        return true;
+    }
+
+    if (err)
+    {
+        *err = zip_strerror(archive);
+    }
+    zip_discard(archive);
+    return false;
+}
+
+/* End Helpers */
+/* Begin Generator */
+
+/**
+ * @brief Writes the banks of a dictionary into a directory.
+ */
+class Generator
+{
+public:
+    /**
+     * @brief Creates a generator.
+     *
+     * @param dir The directory to write the banks to.
+     * @param options The shape of the dictionary.
+     */
+    Generator(const QDir &dir, const SyntheticDictionary::Options &options) :
+        m_dir(dir),
+        m_options(options),
+        m_rng(options.seed)
+    {
+        QSet<QChar> characters;
+        for (const QString &text : options.vocabulary)
+        {
+            for (QChar c : text)
+            {
+                if (!c.isSpace() && !c.isPunct())
+                {
+                    characters.insert(c);
+                }
+            }
+        }
+        m_characters = characters.values();
+    }
+
+    /**
+     * @brief Writes every file of the dictionary.
+     *
+     * @return true on success, false otherwise.
+     */
+    [[nodiscard]]
+    bool write()
+    {
+        return writeIndex() && writeTags() && writeTerms() && writeKanji();
+    }
+
+    /**
+     * @brief Get the names of the written files.
+     *
+     * @return The names of the written files relative to the directory.
+     */
+    [[nodiscard]]
+    const QStringList &files() const
+    {
+        return m_files;
+    }
+
+private:
+    /**
+     * @brief Writes index.json.
+     *
+     * @return true on success, false otherwise.
+     */
+    bool writeIndex()
+    {
+        QFile index(m_dir.filePath("index.json"));
+        const QByteArray json = QJsonDocument(QJsonObject{
+            {"title", m_options.title},
+            {"format", 3},
+            {"revision", QString("synthetic-%1").arg(m_options.seed)},
+            {"sequenced", true},
+            {"author", "memento_dict_bench"},
+        }).toJson(QJsonDocument::Compact);
+        if (!index.open(QIODevice::WriteOnly) ||
+            index.write(json) != json.size())
+        {
+            return false;
+        }
+        m_files.emplaceBack("index.json");
+        return true;
+    }
+
+    /**
+     * @brief Writes the tag banks.
+     *
+     * @return true on success, false otherwise.
+     */
+    bool writeTags()
+    {
+        BankWriter banks(
+            m_dir, "tag_bank_%d.json", m_options.bankSize, m_files
+        );
+        for (qsizetype i = 0; i < m_options.tags; ++i)
+        {
+            QString name = i < std::ssize(SEED_TAGS) ?
+                QString(SEED_TAGS[i]) : QString("tag%1").arg(i);
+            const bool written = banks.append(QJsonArray{
+                name,
+                TAG_CATEGORIES[m_rng() % std::size(TAG_CATEGORIES)],
+                static_cast<int>(m_rng() % 10) - 5,
+                QString("notes for %1").arg(name),
+                static_cast<int>(m_rng() % 10) - 5,
+            });
+            if (!written)
+            {
+                return false;
+            }
+            m_tagNames.emplaceBack(std::move(name));
+        }
+        return banks.flush();
+    }
+
+    /**
+     * @brief Writes the term and term meta banks.
+     *
+     * @return true on success, false otherwise.
+     */
+    bool writeTerms()
+    {
+        BankWriter banks(
+            m_dir, "term_bank_%d.json", m_options.bankSize, m_files
+        );
+        BankWriter metaBanks(
+            m_dir, "term_meta_bank_%d.json", m_options.bankSize, m_files
+        );
+        for (qsizetype i = 0; i < m_options.terms; ++i)
+        {
+            QString expression;
+            QString reading;
+            QString rules;
+            if (i < std::ssize(SEED_TERMS))
+            {
+                expression = QString::fromUtf16(SEED_TERMS[i].expression);
+                reading = QString::fromUtf16(SEED_TERMS[i].reading);
+                rules = SEED_TERMS[i].rules;
+            }
+            else
+            {
+                expression = randomExpression(
+                    m_rng, m_options.vocabulary, m_characters
+                );
+                if (expression.isEmpty())
+                {
+                    expression = randomKana(m_rng, 2);
+                }
+                reading = randomKana(m_rng, expression.size() + m_rng() % 3);
+            }
+            for (QChar c : expression)
+            {
+                if (isKanji(c))
+                {
+                    m_termKanji.insert(c);
+                }
+            }
+
+            QJsonArray glossary;
+            for (qsizetype j = 0; j < m_options.glossaries; ++j)
+            {
+                if (m_percent(m_rng) < m_options.structuredPercent)
+                {
+                    glossary.append(structuredGlossary(expression, j));
+                }
+                else
+                {
+                    glossary.append(
+                        QString("definition %1 of %2").arg(j).arg(expression)
+                    );
+                }
+            }
+
+            const bool written = banks.append(QJsonArray{
+                expression,
+                reading,
+                randomTags(1 + m_rng() % 2),
+                rules,
+                static_cast<int>(m_rng() % 200) - 100,
+                glossary,
+                static_cast<qint64>(i),
+                randomTags(m_rng() % 2),
+            });
+            if (!written)
+            {
+                return false;
+            }
+
+            if (m_percent(m_rng) >= m_options.metaPercent)
+            {
+                continue;
+            }
+            const bool metaWritten =
+                metaBanks.append(QJsonArray{
+                    expression,
+                    "freq",
+                    QJsonObject{
+                        {"reading", reading},
+                        {"frequency", static_cast<qint64>(m_rng() % 100000)},
+                    },
+                }) &&
+                metaBanks.append(QJsonArray{
+                    expression,
+                    "pitch",
+                    QJsonObject{
+                        {"reading", reading},
+                        {"pitches", QJsonArray{
+                            QJsonObject{
+                                {"position", static_cast<int>(
+                                    m_rng() % (reading.size() + 1)
+                                )},
+                            },
+                        }},
+                    },
+                });
+            if (!metaWritten)
+            {
+                return false;
+            }
+        }
+        return banks.flush() && metaBanks.flush();
+    }
+
+    /**
+     * @brief Writes the kanji and kanji meta banks. Kanji used by the terms
+     * come first.
+     *
+     * @return true on success, false otherwise.
+     */
+    bool writeKanji()
+    {
+        QSet<QChar> kanjiSet = m_termKanji;
+        QList<QChar> kanjiList = kanjiSet.values();
+        std::uniform_int_distribution<int> ideograph(0x4E00, 0x9FFF);
+        for (qsizetype attempts = 0;
+             kanjiList.size() < m_options.kanji &&
+                attempts < m_options.kanji * 4;
+             ++attempts)
+        {
+            QChar c(static_cast<char16_t>(ideograph(m_rng)));
+            if (!kanjiSet.contains(c))
+            {
+                kanjiSet.insert(c);
+                kanjiList.emplaceBack(c);
+            }
+        }
+        kanjiList.resize(std::min(kanjiList.size(), m_options.kanji));
+
+        BankWriter banks(
+            m_dir, "kanji_bank_%d.json", m_options.bankSize, m_files
+        );
+        BankWriter metaBanks(
+            m_dir, "kanji_meta_bank_%d.json", m_options.bankSize, m_files
+        );
+        for (QChar c : kanjiList)
+        {
+            const bool written = banks.append(QJsonArray{
+                QString(c),
+                "カン コウ",
+                "あ.げる",
+                randomTags(1),
+                QJsonArray{
+                    QString("meaning of %1").arg(c),
+                    QString("another meaning of %1").arg(c),
+                },
+                QJsonObject{
+                    {"strokes", QString::number(1 + m_rng() % 24)},
+                    {"freq", QString::number(m_rng() % 2500)},
+                },
+            });
+            if (!written)
+            {
+                return false;
+            }
+            if (m_percent(m_rng) < m_options.metaPercent &&
+                !metaBanks.append(QJsonArray{
+                    QString(c), "freq", static_cast<qint64>(m_rng() % 2500)
+                }))
+            {
+                return false;
+            }
+        }
+        return banks.flush() && metaBanks.flush();
+    }
+
+    /**
+     * @brief Picks random tags from the tag bank.
+     *
+     * @param count The number of tags to pick.
+     * @return The space separated tag names.
+     */
+    QString randomTags(qsizetype count)
+    {
+        if (m_tagNames.isEmpty())
+        {
+            return {};
+        }
+        QStringList tags;
+        for (qsizetype i = 0; i < count; ++i)
+        {
+            tags.emplaceBack(m_tagNames[m_rng() % m_tagNames.size()]);
+        }
+        return tags.join(' ');
+    }
+
+    /* The directory the banks are written to */
+    QDir m_dir;
+
+    /* The shape of the dictionary */
+    const SyntheticDictionary::Options &m_options;
+
+    /* The random number generator */
+    std::mt19937 m_rng;
+
+    /* Distribution for rolling against the percentages in the options */
+    std::uniform_int_distribution<int> m_percent{0, 99};
+
+    /* The distinct characters of the vocabulary */
+    QList<QChar> m_characters;
+
+    /* The names of the tags in the tag bank */
+    QStringList m_tagNames;
+
+    /* The kanji used by the terms */
+    QSet<QChar> m_termKanji;
+
+    /* The names of the written files */
+    QStringList m_files;
+};
+
+bool SyntheticDictionary::write(
+    const QString &path, const Options &options, QString *err)
+{
+    /* Banks are staged next to the archive rather than in memory */
+    QTemporaryDir staging(
+        QFileInfo(path).absoluteDir().filePath("banks-XXXXXX")
+    );
+    if (!staging.isValid())
+    {
+        if (err)
+        {
+            *err = staging.errorString();
+        }
+        return false;
+    }
+
+    const QDir dir(staging.path());
+    Generator generator(dir, options);
+    if (!generator.write())
+    {
+        if (err)
+        {
+            *err = QString("Could not write banks to %1").arg(dir.path());
+        }
+        return false;
+    }
+    return writeArchive(path, dir, generator.files(), err);
+}
+
+/* End Generator */
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include <cstdint>
+
+/**
+ * @brief Generates Yomichan dictionaries filled with made up entries for
+ * benchmarking.
+ */
+namespace SyntheticDictionary
+{
+
+/**
+ * @brief The shape of a generated dictionary.
+ */
+struct Options
+{
+    /* The title of the dictionary. Must be unique per database. */
+    QString title;
+
+    /* Seed of the random number generator. Equal seeds give equal files. */
+    uint32_t seed{0};
+
+    /* Number of entries in the term banks */
+    qsizetype terms{0};
+
+    /* Number of glossaries every term has */
+    qsizetype glossaries{1};
+
+    /* Percent of glossaries that are structured content instead of text */
+    int structuredPercent{0};
+
+    /* Percent of terms that get a frequency and a pitch entry */
+    int metaPercent{0};
+
+    /* Number of entries in the tag bank */
+    qsizetype tags{0};
+
+    /* Number of entries in the kanji banks */
+    qsizetype kanji{0};
+
+    /* Maximum number of entries in a single bank file */
+    qsizetype bankSize{10000};
+
+    /* Text that expressions and kanji are drawn from so lookups in it find
+     * entries at a realistic rate */
+    QStringList vocabulary;
+};
+
+/**
+ * @brief Writes a dictionary archive in the format yomi_process_dictionary()
+ * accepts.
+ *
+ * @param path The path of the zip file to create. Overwritten if it exists.
+ * @param options The shape of the dictionary.
+ * @param[out] err Set to a description of the error on failure. Can be
+ * nullptr.
+ * @return true on success, false otherwise.
+ */
+[[nodiscard]]
+bool write(const QString &path, const Options &options, QString *err);
+
+}
@@ -37,6 +37,7 @@ DictionaryInfo *DictionaryInfo::clone(QObject *parent) const
     copy->setName(name());
     copy->setEnabled(enabled());
     copy->m_dictionaryStyles = m_dictionaryStyles;
+    copy->m_resources = m_resources;
     return copy;
 }
 
@@ -100,3 +101,15 @@ void DictionaryInfo::setStyles(const QString &value)
     }
     m_dictionaryStyles = std::make_shared<DictionaryStyles>(value);
 }
+
+const std::shared_ptr<const DictionaryResources>
+DictionaryInfo::resources() const noexcept
+{
+    return m_resources;
+}
+
+void DictionaryInfo::setResources(
+    std::shared_ptr<const DictionaryResources> value)
+{
+    m_resources = std::move(value);
+}
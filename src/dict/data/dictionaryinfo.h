@@ -24,6 +24,7 @@
 
 #include <memory>
 
+#include "dict/data/dictionaryresources.h"
 #include "dict/data/dictionarystyles.h"
 
 class DictionarySearch;
@@ -131,6 +132,21 @@ public:
      */
     void setStyles(const QString &value);
 
+    /**
+     * @brief Get the resolver for media belonging to this dictionary.
+     *
+     * @return The resource resolver of this dictionary. nullptr if not set.
+     */
+    [[nodiscard]]
+    const std::shared_ptr<const DictionaryResources> resources() const noexcept;
+
+    /**
+     * @brief Set the resolver for media belonging to this dictionary.
+     *
+     * @param value The resource resolver of this dictionary.
+     */
+    void setResources(std::shared_ptr<const DictionaryResources> value);
+
 signals:
     /**
      * @brief Emitted when the ID of the dictionary changes.
@@ -165,4 +181,7 @@ protected:
 
     /* The CSS stylesheet of this dictionary */
     std::shared_ptr<DictionaryStyles> m_dictionaryStyles{nullptr};
+
+    /* Resolves media belonging to this dictionary */
+    std::shared_ptr<const DictionaryResources> m_resources{nullptr};
 };
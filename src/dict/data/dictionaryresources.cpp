@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dict/data/dictionaryresources.h"
+
+#include <QFile>
+#include <QUrl>
+
+DictionaryResources::DictionaryResources(
+    int64_t id,
+    const QString &packPath,
+    QHash<QString, Range> index,
+    const QString &legacyDir) :
+    m_id(id),
+    m_packPath(packPath),
+    m_index(std::move(index)),
+    m_legacyDir(legacyDir)
+{
+
+}
+
+QString DictionaryResources::baseUrl() const
+{
+    return QString("image://%1/%2/").arg(PROVIDER_ID).arg(m_id);
+}
+
+QString DictionaryResources::location(const QString &path) const
+{
+    if (m_index.contains(path))
+    {
+        return m_packPath + '/' + path;
+    }
+    return m_legacyDir + '/' + path;
+}
+
+QByteArray DictionaryResources::read(const QString &path) const
+{
+    auto it = m_index.constFind(path);
+    if (it == m_index.constEnd())
+    {
+        QFile file(m_legacyDir + '/' + path);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return {};
+        }
+        return file.readAll();
+    }
+
+    QFile pack(m_packPath);
+    if (!pack.open(QIODevice::ReadOnly) || !pack.seek(it->offset))
+    {
+        return {};
+    }
+    QByteArray data = pack.read(it->size);
+    if (data.size() != it->size)
+    {
+        return {};
+    }
+    return data;
+}
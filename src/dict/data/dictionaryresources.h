@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+/**
+ * @brief Resolves media belonging to a dictionary. Media is stored in a single
+ * pack file and located through an index of byte ranges. Media extracted by
+ * older versions of Memento is read from the old resource directory instead.
+ */
+class DictionaryResources
+{
+public:
+    /**
+     * @brief The range of bytes a resource occupies in the pack.
+     */
+    struct Range
+    {
+        /* Offset of the first byte in the pack */
+        qint64 offset{0};
+
+        /* Number of bytes in the resource */
+        qint64 size{0};
+    };
+
+    /**
+     * @brief Create a resolver for the resources of a dictionary.
+     *
+     * @param id The ID of the dictionary.
+     * @param packPath The path to the resource pack.
+     * @param index Maps paths in the dictionary archive to ranges in the pack.
+     * @param legacyDir The directory older versions extracted resources to.
+     */
+    DictionaryResources(
+        int64_t id,
+        const QString &packPath,
+        QHash<QString, Range> index,
+        const QString &legacyDir);
+
+    /**
+     * @brief Get the URL the resources of the dictionary can be loaded from
+     * in rich text. Paths to resources are appended to this URL.
+     *
+     * @return The base URL of the resources.
+     */
+    [[nodiscard]]
+    QString baseUrl() const;
+
+    /**
+     * @brief Get the path a resource can be identified by. Only guaranteed to
+     * exist on disk for resources that are not packed.
+     *
+     * @param path The path of the resource in the dictionary archive.
+     * @return The path identifying the resource.
+     */
+    [[nodiscard]]
+    QString location(const QString &path) const;
+
+    /**
+     * @brief Read the contents of a resource.
+     *
+     * @param path The path of the resource in the dictionary archive.
+     * @return The contents of the resource. A null QByteArray if the resource
+     * does not exist or could not be read.
+     */
+    [[nodiscard]]
+    QByteArray read(const QString &path) const;
+
+    /* The host of the image provider that serves dictionary resources */
+    static constexpr const char *PROVIDER_ID = "dictionary";
+
+private:
+    /* The ID of the dictionary */
+    const int64_t m_id;
+
+    /* Path to the resource pack */
+    const QString m_packPath;
+
+    /* Maps paths in the dictionary archive to ranges in the pack */
+    const QHash<QString, Range> m_index;
+
+    /* The directory resources were extracted to by older versions */
+    const QString m_legacyDir;
+};
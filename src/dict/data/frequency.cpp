@@ -20,6 +20,8 @@
 
 #include "dict/data/frequency.h"
 
+#include "dict/data/sharedobject.h"
+
 Frequency::Frequency(QObject *parent) : QObject(parent)
 {
 
@@ -33,32 +35,37 @@ Frequency::~Frequency()
 Frequency *Frequency::clone(QObject *parent) const
 {
     Frequency *copy = new Frequency(parent);
-    copy->setDictionaryInfo(dictionaryInfo()->clone(copy));
+    copy->setDictionaryInfo(m_dictionaryInfo);
     copy->setFrequency(frequency());
     return copy;
 }
 
 DictionaryInfo *Frequency::dictionaryInfo() const noexcept
 {
-    return m_dictionaryInfo;
+    return m_dictionaryInfo.get();
 }
 
 void Frequency::setDictionaryInfo(DictionaryInfo *value)
 {
-    if (m_dictionaryInfo == value)
+    if (m_dictionaryInfo.get() == value)
     {
         return;
     }
     if (value)
     {
-        value->setParent(this);
+        value->setParent(nullptr);
     }
-    std::swap(m_dictionaryInfo, value);
-    emit dictionaryInfoChanged(m_dictionaryInfo);
-    if (value)
+    setDictionaryInfo(shareObject(value));
+}
+
+void Frequency::setDictionaryInfo(std::shared_ptr<DictionaryInfo> value)
+{
+    if (m_dictionaryInfo == value)
     {
-        value->deleteLater();
+        return;
     }
+    m_dictionaryInfo = std::move(value);
+    emit dictionaryInfoChanged(m_dictionaryInfo.get());
 }
 
 const QString &Frequency::frequency() const noexcept
@@ -76,6 +76,14 @@ public:
      */
     void setDictionaryInfo(DictionaryInfo *value);
 
+    /**
+     * @brief Sets the dictionary info for this Frequency. Shares ownership so
+     * results from the same dictionary don't each need a copy.
+     *
+     * @param value The dictionary info to set. Must not be modified.
+     */
+    void setDictionaryInfo(std::shared_ptr<DictionaryInfo> value);
+
     /**
      * @brief Gets the frequency of the expression/kanji/etc.
      *
@@ -108,7 +116,7 @@ signals:
 
 protected:
     /* The dictionary this belongs to */
-    DictionaryInfo *m_dictionaryInfo{nullptr};
+    std::shared_ptr<DictionaryInfo> m_dictionaryInfo{nullptr};
 
     /* The frequency of the expression/kanji/etc. */
     QString m_frequency;
@@ -20,6 +20,8 @@
 
 #include "dict/data/kanjidefinition.h"
 
+#include "dict/data/sharedobject.h"
+
 KanjiDefinition::KanjiDefinition(QObject *parent) : QObject(parent)
 {
 
@@ -33,7 +35,7 @@ KanjiDefinition::~KanjiDefinition()
 KanjiDefinition *KanjiDefinition::clone(QObject *parent) const
 {
 	KanjiDefinition *copy = new KanjiDefinition(parent);
-	copy->setDictionaryInfo(dictionaryInfo()->clone(copy));
+	copy->setDictionaryInfo(m_dictionaryInfo);
 	copy->setOnyomi(onyomi());
 	copy->setKunyomi(kunyomi());
 	copy->setGlossary(glossary());
@@ -62,25 +64,30 @@ KanjiDefinition *KanjiDefinition::clone(QObject *parent) const
 
 DictionaryInfo *KanjiDefinition::dictionaryInfo() const noexcept
 {
-	return m_dictionaryInfo;
+	return m_dictionaryInfo.get();
 }
 
 void KanjiDefinition::setDictionaryInfo(DictionaryInfo *value)
 {
-	if (m_dictionaryInfo == value)
+	if (m_dictionaryInfo.get() == value)
 	{
 		return;
 	}
 	if (value)
 	{
-		value->setParent(this);
+		value->setParent(nullptr);
 	}
-	std::swap(m_dictionaryInfo, value);
-	emit dictionaryInfoChanged(m_dictionaryInfo);
-	if (value)
+	setDictionaryInfo(shareObject(value));
+}
+
+void KanjiDefinition::setDictionaryInfo(std::shared_ptr<DictionaryInfo> value)
+{
+	if (m_dictionaryInfo == value)
 	{
-		value->deleteLater();
+		return;
 	}
+	m_dictionaryInfo = std::move(value);
+	emit dictionaryInfoChanged(m_dictionaryInfo.get());
 }
 
 const QStringList &KanjiDefinition::onyomi() const noexcept
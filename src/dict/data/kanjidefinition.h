@@ -123,6 +123,14 @@ public:
      */
     void setDictionaryInfo(DictionaryInfo *value);
 
+    /**
+     * @brief Sets the dictionary info for this KanjiDefinition. Shares ownership so
+     * results from the same dictionary don't each need a copy.
+     *
+     * @param value The dictionary info to set. Must not be modified.
+     */
+    void setDictionaryInfo(std::shared_ptr<DictionaryInfo> value);
+
     /**
      * @brief Get the onyomi of the kanji.
      *
@@ -368,7 +376,7 @@ signals:
 
 protected:
     /* The dictionary this belongs to */
-    DictionaryInfo *m_dictionaryInfo{nullptr};
+    std::shared_ptr<DictionaryInfo> m_dictionaryInfo{nullptr};
 
     /* The onyomi (Chinese) readings of the kanji. */
     QStringList m_onyomi;
@@ -20,6 +20,8 @@
 
 #include "dict/data/pitch.h"
 
+#include "dict/data/sharedobject.h"
+
 Pitch::Pitch(QObject *parent) : QObject(parent)
 {
 
@@ -33,7 +35,7 @@ Pitch::~Pitch()
 Pitch *Pitch::clone(QObject *parent) const
 {
     Pitch *copy = new Pitch(parent);
-    copy->setDictionaryInfo(dictionaryInfo()->clone(copy));
+    copy->setDictionaryInfo(m_dictionaryInfo);
     copy->setMora(mora());
     copy->setPositions(positions());
     return copy;
@@ -41,25 +43,30 @@ Pitch *Pitch::clone(QObject *parent) const
 
 DictionaryInfo *Pitch::dictionaryInfo() const noexcept
 {
-    return m_dictionaryInfo;
+    return m_dictionaryInfo.get();
 }
 
 void Pitch::setDictionaryInfo(DictionaryInfo *value)
 {
-    if (m_dictionaryInfo == value)
+    if (m_dictionaryInfo.get() == value)
     {
         return;
     }
     if (value)
     {
-        value->setParent(this);
+        value->setParent(nullptr);
     }
-    std::swap(m_dictionaryInfo, value);
-    emit dictionaryInfoChanged(m_dictionaryInfo);
-    if (value)
+    setDictionaryInfo(shareObject(value));
+}
+
+void Pitch::setDictionaryInfo(std::shared_ptr<DictionaryInfo> value)
+{
+    if (m_dictionaryInfo == value)
     {
-        value->deleteLater();
+        return;
     }
+    m_dictionaryInfo = std::move(value);
+    emit dictionaryInfoChanged(m_dictionaryInfo.get());
 }
 
 const QStringList &Pitch::mora() const noexcept
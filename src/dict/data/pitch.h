@@ -83,6 +83,14 @@ public:
      */
     void setDictionaryInfo(DictionaryInfo *value);
 
+    /**
+     * @brief Sets the dictionary info for this Pitch. Shares ownership so
+     * results from the same dictionary don't each need a copy.
+     *
+     * @param value The dictionary info to set. Must not be modified.
+     */
+    void setDictionaryInfo(std::shared_ptr<DictionaryInfo> value);
+
     /**
      * @brief Get the mora for this pitch.
      *
@@ -133,7 +141,7 @@ signals:
 
 protected:
     /* The dictionary this belongs to */
-    DictionaryInfo *m_dictionaryInfo{nullptr};
+    std::shared_ptr<DictionaryInfo> m_dictionaryInfo{nullptr};
 
     /* A list of all the mora that appear in the expression. */
     QStringList m_mora;
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QObject>
+#include <QThread>
+
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Deletes a shared QObject on the thread it lives in. Results sharing
+ * an object can be dropped on worker threads, such as when they are evicted
+ * from the search cache, while QML may still be using the object.
+ *
+ * @param object The object to delete.
+ */
+inline void deleteSharedObject(QObject *object)
+{
+    if (object->thread() == QThread::currentThread())
+    {
+        delete object;
+    }
+    else
+    {
+        object->deleteLater();
+    }
+}
+
+/**
+ * @brief Takes shared ownership of a QObject. The object is deleted by
+ * deleteSharedObject() once the last reference is dropped.
+ *
+ * @param object The object to own. Must not have a parent.
+ * @return The shared object.
+ */
+template <typename T>
+[[nodiscard]]
+std::shared_ptr<T> shareObject(T *object)
+{
+    return std::shared_ptr<T>(object, &deleteSharedObject);
+}
+
+/**
+ * @brief Creates a QObject owned by shared pointers. The object is deleted by
+ * deleteSharedObject() once the last reference is dropped.
+ *
+ * @param args The arguments to construct the object with.
+ * @return The shared object.
+ */
+template <typename T, typename... Args>
+[[nodiscard]]
+std::shared_ptr<T> makeSharedObject(Args &&...args)
+{
+    return shareObject(new T(std::forward<Args>(args)...));
+}
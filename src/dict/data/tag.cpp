@@ -20,6 +20,8 @@
 
 #include "dict/data/tag.h"
 
+#include "dict/data/sharedobject.h"
+
 Tag::Tag(QObject *parent) : QObject(parent)
 {
 
@@ -33,7 +35,7 @@ Tag::~Tag()
 Tag *Tag::clone(QObject *parent) const
 {
     Tag *copy = new Tag(parent);
-    copy->setDictionaryInfo(dictionaryInfo()->clone(copy));
+    copy->setDictionaryInfo(m_dictionaryInfo);
     copy->setName(name());
     copy->setCategory(category());
     copy->setNotes(notes());
@@ -45,25 +47,30 @@ Tag *Tag::clone(QObject *parent) const
 
 DictionaryInfo *Tag::dictionaryInfo() const noexcept
 {
-    return m_dictionaryInfo;
+    return m_dictionaryInfo.get();
 }
 
 void Tag::setDictionaryInfo(DictionaryInfo *value)
 {
-    if (m_dictionaryInfo == value)
+    if (m_dictionaryInfo.get() == value)
     {
         return;
     }
     if (value)
     {
-        value->setParent(this);
+        value->setParent(nullptr);
     }
-    std::swap(m_dictionaryInfo, value);
-    emit dictionaryInfoChanged(m_dictionaryInfo);
-    if (value)
+    setDictionaryInfo(shareObject(value));
+}
+
+void Tag::setDictionaryInfo(std::shared_ptr<DictionaryInfo> value)
+{
+    if (m_dictionaryInfo == value)
     {
-        value->deleteLater();
+        return;
     }
+    m_dictionaryInfo = std::move(value);
+    emit dictionaryInfoChanged(m_dictionaryInfo.get());
 }
 
 const QString &Tag::name() const noexcept
@@ -111,6 +111,14 @@ public:
      */
     void setDictionaryInfo(DictionaryInfo *value);
 
+    /**
+     * @brief Sets the dictionary info for this Tag. Shares ownership so
+     * results from the same dictionary don't each need a copy.
+     *
+     * @param value The dictionary info to set. Must not be modified.
+     */
+    void setDictionaryInfo(std::shared_ptr<DictionaryInfo> value);
+
     /**
      * @brief Get the name of the tag.
      *
@@ -253,7 +261,7 @@ signals:
 
 protected:
     /* The dictionary this belongs to */
-    DictionaryInfo *m_dictionaryInfo{nullptr};
+    std::shared_ptr<DictionaryInfo> m_dictionaryInfo{nullptr};
 
     /* The name of tag */
     QString m_name;
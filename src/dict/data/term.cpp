@@ -20,6 +20,8 @@
 
 #include "dict/data/term.h"
 
+#include "dict/data/sharedobject.h"
+
 Term::Term(QObject *parent) : Expression(parent)
 {
 
@@ -60,10 +62,7 @@ Term *Term::clone(QObject *parent) const
 	copy->setReading(reading());
 	copy->setConjugationExplanation(conjugationExplanation());
 	copy->setReadingAsExpression(readingAsExpression());
-	for (Tag *t : tags())
-	{
-		copy->appendTags(t->clone(copy));
-	}
+	copy->setTags(m_tagRefs);
 	for (Pitch *p : pitches())
 	{
 		copy->appendPitches(p->clone(copy));
@@ -157,20 +156,38 @@ const QList<Tag *> &Term::tags() const noexcept
 
 void Term::setTags(const QList<Tag *> &value)
 {
-	qDeleteAll(m_tags);
-	m_tags.clear();
+	QList<std::shared_ptr<Tag>> tags;
+	tags.reserve(value.size());
 	for (Tag *t : value)
 	{
-		t->setParent(this);
-		m_tags.emplaceBack(t);
+		t->setParent(nullptr);
+		tags.emplaceBack(shareObject(t));
+	}
+	setTags(tags);
+}
+
+void Term::setTags(const QList<std::shared_ptr<Tag>> &value)
+{
+	m_tagRefs = value;
+	m_tags.clear();
+	m_tags.reserve(m_tagRefs.size());
+	for (const std::shared_ptr<Tag> &t : m_tagRefs)
+	{
+		m_tags.emplaceBack(t.get());
 	}
 	emit tagsChanged();
 }
 
 void Term::appendTags(Tag *value)
 {
-    value->setParent(this);
-    m_tags.emplaceBack(value);
+    value->setParent(nullptr);
+    appendTags(shareObject(value));
+}
+
+void Term::appendTags(std::shared_ptr<Tag> value)
+{
+    m_tags.emplaceBack(value.get());
+    m_tagRefs.emplaceBack(std::move(value));
     emit tagsChanged();
 }
 
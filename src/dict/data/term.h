@@ -246,6 +246,14 @@ public:
      */
     void setTags(const QList<Tag *> &value);
 
+    /**
+     * @brief Set the tags of this term. Shares ownership so tags can be
+     * shared with the tag cache and other results.
+     *
+     * @param value The new tags. Must not be modified.
+     */
+    void setTags(const QList<std::shared_ptr<Tag>> &value);
+
     /**
      * @brief Append a tag to the tags. Takes ownership.
      *
@@ -253,6 +261,13 @@ public:
      */
     void appendTags(Tag *value);
 
+    /**
+     * @brief Append a tag to the tags. Shares ownership.
+     *
+     * @param value The tag to append. Must not be modified.
+     */
+    void appendTags(std::shared_ptr<Tag> value);
+
     /**
      * @brief Get the QML accessible pitches.
      *
@@ -575,6 +590,9 @@ protected:
     /* The list of tags applicable to this term. */
     QList<Tag *> m_tags;
 
+    /* Owns the tags in m_tags */
+    QList<std::shared_ptr<Tag>> m_tagRefs;
+
     /* The list of pitches for this term. */
     QList<Pitch *> m_pitches;
 
@@ -20,6 +20,11 @@
 
 #include "dict/data/termdefinition.h"
 
+#include <QCborArray>
+#include <QCborValue>
+
+#include "dict/data/sharedobject.h"
+
 TermDefinition::TermDefinition(QObject *parent) : QObject(parent)
 {
 
@@ -33,13 +38,17 @@ TermDefinition::~TermDefinition()
 TermDefinition *TermDefinition::clone(QObject *parent) const
 {
     TermDefinition *copy = new TermDefinition(parent);
-    copy->setDictionaryInfo(dictionaryInfo()->clone(copy));
-    for (Tag *tag : tags())
+    copy->setDictionaryInfo(m_dictionaryInfo);
+    copy->setTags(m_tagRefs);
+    copy->setRules(rules());
+    if (m_glossaryCbor.isNull())
     {
-        copy->appendTags(tag->clone(copy));
+        copy->setGlossary(m_glossary);
+    }
+    else
+    {
+        copy->setGlossaryCbor(m_glossaryCbor);
     }
-    copy->setRules(rules());
-    copy->setGlossary(glossary());
     copy->setScore(score());
     copy->setSelected(selected());
     return copy;
@@ -47,25 +56,30 @@ TermDefinition *TermDefinition::clone(QObject *parent) const
 
 DictionaryInfo *TermDefinition::dictionaryInfo() const noexcept
 {
-    return m_dictionaryInfo;
+    return m_dictionaryInfo.get();
 }
 
 void TermDefinition::setDictionaryInfo(DictionaryInfo *value)
 {
-    if (m_dictionaryInfo == value)
+    if (m_dictionaryInfo.get() == value)
     {
         return;
     }
     if (value)
     {
-        value->setParent(this);
+        value->setParent(nullptr);
     }
-    std::swap(m_dictionaryInfo, value);
-    emit dictionaryInfoChanged(m_dictionaryInfo);
-    if (value)
+    setDictionaryInfo(shareObject(value));
+}
+
+void TermDefinition::setDictionaryInfo(std::shared_ptr<DictionaryInfo> value)
+{
+    if (m_dictionaryInfo == value)
     {
-        value->deleteLater();
+        return;
     }
+    m_dictionaryInfo = std::move(value);
+    emit dictionaryInfoChanged(m_dictionaryInfo.get());
 }
 
 QQmlListProperty<Tag> TermDefinition::tagsQml()
@@ -80,20 +94,38 @@ const QList<Tag *> &TermDefinition::tags() const noexcept
 
 void TermDefinition::setTags(const QList<Tag *> &value)
 {
-    qDeleteAll(m_tags);
-    m_tags.clear();
+    QList<std::shared_ptr<Tag>> tags;
+    tags.reserve(value.size());
     for (Tag *tag : value)
     {
-        tag->setParent(this);
-        m_tags.emplaceBack(tag);
+        tag->setParent(nullptr);
+        tags.emplaceBack(shareObject(tag));
+    }
+    setTags(tags);
+}
+
+void TermDefinition::setTags(const QList<std::shared_ptr<Tag>> &value)
+{
+    m_tagRefs = value;
+    m_tags.clear();
+    m_tags.reserve(m_tagRefs.size());
+    for (const std::shared_ptr<Tag> &tag : m_tagRefs)
+    {
+        m_tags.emplaceBack(tag.get());
     }
     emit tagsChanged();
 }
 
 void TermDefinition::appendTags(Tag *value)
 {
-    value->setParent(this);
-    m_tags.emplaceBack(value);
+    value->setParent(nullptr);
+    appendTags(shareObject(value));
+}
+
+void TermDefinition::appendTags(std::shared_ptr<Tag> value)
+{
+    m_tags.emplaceBack(value.get());
+    m_tagRefs.emplaceBack(std::move(value));
     emit tagsChanged();
 }
 
@@ -112,21 +144,35 @@ void TermDefinition::setRules(const QStringList &value)
     emit rulesChanged();
 }
 
-const QJsonArray &TermDefinition::glossary() const noexcept
+const QJsonArray &TermDefinition::glossary() const
 {
+    if (!m_glossaryCbor.isNull())
+    {
+        m_glossary =
+            QCborValue::fromCbor(m_glossaryCbor).toArray().toJsonArray();
+        m_glossaryCbor.clear();
+    }
     return m_glossary;
 }
 
 void TermDefinition::setGlossary(const QJsonArray &value)
 {
-    if (m_glossary == value)
+    if (m_glossaryCbor.isNull() && m_glossary == value)
     {
         return;
     }
+    m_glossaryCbor.clear();
     m_glossary = value;
     emit glossaryChanged();
 }
 
+void TermDefinition::setGlossaryCbor(const QByteArray &value)
+{
+    m_glossary = QJsonArray();
+    m_glossaryCbor = value;
+    emit glossaryChanged();
+}
+
 int TermDefinition::score() const noexcept
 {
     return m_score;
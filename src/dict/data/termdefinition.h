@@ -107,6 +107,14 @@ public:
      */
     void setDictionaryInfo(DictionaryInfo *value);
 
+    /**
+     * @brief Sets the dictionary info for this TermDefinition. Shares ownership so
+     * results from the same dictionary don't each need a copy.
+     *
+     * @param value The dictionary info to set. Must not be modified.
+     */
+    void setDictionaryInfo(std::shared_ptr<DictionaryInfo> value);
+
     /**
      * @brief Gets the QML property for the tags.
      *
@@ -130,6 +138,14 @@ public:
      */
     void setTags(const QList<Tag *> &value);
 
+    /**
+     * @brief Set the tags of this definition. Shares ownership so tags can be
+     * shared with the tag cache and other results.
+     *
+     * @param value The new tags. Must not be modified.
+     */
+    void setTags(const QList<std::shared_ptr<Tag>> &value);
+
     /**
      * @brief Append a tag to the tags. Takes ownership.
      *
@@ -137,6 +153,13 @@ public:
      */
     void appendTags(Tag *value);
 
+    /**
+     * @brief Append a tag to the tags. Shares ownership.
+     *
+     * @param value The tag to append. Must not be modified.
+     */
+    void appendTags(std::shared_ptr<Tag> value);
+
     /**
      * @brief Get the rules of this definition.
      *
@@ -153,12 +176,13 @@ public:
     void setRules(const QStringList &value);
 
     /**
-     * @brief Get the glossary of this definition.
+     * @brief Get the glossary of this definition. Decodes the glossary if it
+     * was set with setGlossaryCbor().
      *
      * @return The glossary of this definition.
      */
     [[nodiscard]]
-    const QJsonArray &glossary() const noexcept;
+    const QJsonArray &glossary() const;
 
     /**
      * @brief Set the glossary of this definition.
@@ -167,6 +191,14 @@ public:
      */
     void setGlossary(const QJsonArray &value);
 
+    /**
+     * @brief Set the glossary of this definition from its encoded form. The
+     * glossary is only decoded once it is read.
+     *
+     * @param value A CBOR array of glossary entries.
+     */
+    void setGlossaryCbor(const QByteArray &value);
+
     /**
      * @brief Get the score of this definition.
      *
@@ -237,16 +269,23 @@ signals:
 
 protected:
     /* The dictionary this belongs to */
-    DictionaryInfo *m_dictionaryInfo{nullptr};
+    std::shared_ptr<DictionaryInfo> m_dictionaryInfo{nullptr};
 
     /* A list of the tags associated with this entry. */
     QList<Tag *> m_tags;
 
+    /* Owns the tags in m_tags */
+    QList<std::shared_ptr<Tag>> m_tagRefs;
+
     /* A list of the rules associated with this entry. */
     QStringList m_rules;
 
-    /* A list of glossary entries for this definition. */
-    QJsonArray m_glossary;
+    /* A list of glossary entries for this definition. Empty until decoded
+     * if m_glossaryCbor is set. */
+    mutable QJsonArray m_glossary;
+
+    /* The glossary as a CBOR array if it has not been decoded yet */
+    mutable QByteArray m_glossaryCbor;
 
     /* Score of this definition.
      * Used for ordering. More common entries have a larger score. */
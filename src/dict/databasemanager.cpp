@@ -25,8 +25,14 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
 
+#include "dict/data/sharedobject.h"
+#include "dict/termindex.h"
 #include "dict/yomidbbuilder.h"
+#include "util/tracing.h"
 #include "util/utils.h"
 
 /* Begin Constructor/Destructor */
@@ -39,29 +45,6 @@ DatabaseManager::DatabaseManager(
     m_dbPath(dbPath.toUtf8()),
     m_resourcePath(resourcePath)
 {
-    if (!sqlite3_threadsafe())
-    {
-        qCritical(
-            "The version of SQLite on this system is not threadsafe.\n "
-            "Because of this, Memento will not work.\n Please install a "
-            "version SQLite compiled with SQLITE_THREADSAFE=1 or 2."
-        );
-        return;
-    }
-
-    if (yomi_prepare_db(m_dbPath, nullptr) ||
-        sqlite3_open_v2(
-            m_dbPath,
-            &m_db,
-            SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX,
-            nullptr
-        ) != SQLITE_OK)
-    {
-        m_db = nullptr;
-        qCritical("Could not open dictionary database");
-        return;
-    }
-
     m_moraSkipChar = {
         "ぁ",
         "ぃ",
@@ -81,86 +64,424 @@ DatabaseManager::DatabaseManager(
         "ョ",
     };
 
-    initCache();
+    if (!sqlite3_threadsafe())
+    {
+        qCritical(
+            "The version of SQLite on this system is not threadsafe.\n "
+            "Because of this, Memento will not work.\n Please install a "
+            "version SQLite compiled with SQLITE_THREADSAFE=1 or 2."
+        );
+        setReady();
+        return;
+    }
+
+    /* RETURNING needs 3.35 and window functions need 3.25 */
+    if (sqlite3_libversion_number() < 3035000)
+    {
+        qCritical(
+            "The version of SQLite on this system is %s.\n "
+            "Memento requires SQLite 3.35 or newer.",
+            sqlite3_libversion()
+        );
+        setReady();
+        return;
+    }
+
+    /* Opening the database can migrate it and reads every dictionary's
+     * assets, so it is kept off the thread that creates the manager */
+    m_startupThread = QThread::create(&DatabaseManager::initialize, this);
+    m_startupThread->setObjectName("Database Startup");
+    m_startupThread->start();
 }
 
 DatabaseManager::~DatabaseManager()
 {
+    if (m_startupThread)
+    {
+        m_startupThread->wait();
+        delete m_startupThread;
+        m_startupThread = nullptr;
+    }
+
     QWriteLocker lock{&m_dbLock};
     clearTagCache();
     clearDictionaryCache();
-    sqlite3_close_v2(m_db);
+    closeConnections();
 }
 
 /* End Constructor/Destructor */
+/* Begin Startup */
+
+void DatabaseManager::initialize()
+{
+    MEMENTO_TRACE_SCOPE("DatabaseManager::initialize");
+
+    QElapsedTimer timer;
+    timer.start();
+    {
+        QMutexLocker writeLock{&m_writeLock};
+
+        if (yomi_prepare_db(m_dbPath, nullptr))
+        {
+            qCritical("Could not open dictionary database");
+        }
+        else
+        {
+            const qint64 prepareMsecs = timer.elapsed();
+            reloadCache();
+            qInfo(
+                "Opened dictionary database in %lld ms "
+                "(prepare %lld ms, %lld dictionaries %lld ms)",
+                static_cast<long long>(timer.elapsed()),
+                static_cast<long long>(prepareMsecs),
+                static_cast<long long>(m_dictionaryCache.size()),
+                static_cast<long long>(timer.elapsed() - prepareMsecs)
+            );
+        }
+    }
+    setReady();
+}
+
+void DatabaseManager::setReady()
+{
+    {
+        std::lock_guard lock{m_readyMutex};
+        m_ready = true;
+    }
+    m_readyCondition.notify_all();
+
+    /* Queued so it reaches receivers connected after construction */
+    QMetaObject::invokeMethod(
+        this, &DatabaseManager::ready, Qt::QueuedConnection
+    );
+}
+
+bool DatabaseManager::isReady() const noexcept
+{
+    return m_ready;
+}
+
+bool DatabaseManager::waitUntilReady(std::stop_token cancel) const
+{
+    if (m_ready)
+    {
+        return true;
+    }
+
+    std::unique_lock lock{m_readyMutex};
+    return m_readyCondition.wait(
+        lock, cancel, [this] () { return m_ready.load(); }
+    );
+}
+
+/* End Startup */
+/* Begin Connection Pool */
+
+DatabaseManager::Connection::Connection(
+    const DatabaseManager *manager, bool fresh) :
+    m_manager(manager),
+    m_connection(
+        fresh ? manager->openConnection() : manager->acquireConnection()
+    )
+{
+
+}
+
+DatabaseManager::Connection::~Connection()
+{
+    clearCancellation();
+    m_manager->releaseConnection(m_connection);
+}
+
+sqlite3 *DatabaseManager::Connection::get() const noexcept
+{
+    return m_connection == nullptr ? nullptr : m_connection->db;
+}
+
+void DatabaseManager::Connection::setCancellation(std::stop_token cancel)
+{
+    /* Number of virtual machine instructions between checks */
+    constexpr int PROGRESS_INTERVAL = 1000;
+
+    if (m_connection == nullptr || !cancel.stop_possible())
+    {
+        return;
+    }
+
+    m_cancel = std::move(cancel);
+    sqlite3_progress_handler(
+        m_connection->db, PROGRESS_INTERVAL, progressHandler, &m_cancel
+    );
+}
+
+void DatabaseManager::Connection::clearCancellation()
+{
+    if (m_connection == nullptr || !m_cancel.stop_possible())
+    {
+        return;
+    }
+
+    sqlite3_progress_handler(m_connection->db, 0, nullptr, nullptr);
+    m_cancel = {};
+}
+
+int DatabaseManager::Connection::progressHandler(void *cancel)
+{
+    return static_cast<std::stop_token *>(cancel)->stop_requested() ? 1 : 0;
+}
+
+sqlite3_stmt *DatabaseManager::Connection::prepare(const char *query)
+{
+    if (m_connection == nullptr)
+    {
+        return nullptr;
+    }
+
+    sqlite3_stmt *stmt = m_connection->statements.value(query, nullptr);
+    if (stmt != nullptr)
+    {
+        ++m_manager->m_statementHits;
+        return stmt;
+    }
+
+    ++m_manager->m_statementMisses;
+    if (sqlite3_prepare_v3(
+            m_connection->db,
+            query,
+            -1,
+            SQLITE_PREPARE_PERSISTENT,
+            &stmt,
+            nullptr) != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+    m_connection->statements.insert(query, stmt);
+
+    return stmt;
+}
+
+void DatabaseManager::Connection::finish(sqlite3_stmt *stmt)
+{
+    if (stmt == nullptr)
+    {
+        return;
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+DatabaseManager::PooledConnection *DatabaseManager::acquireConnection() const
+{
+    {
+        QMutexLocker lock{&m_poolLock};
+        if (!m_pool.isEmpty())
+        {
+            return m_pool.takeLast();
+        }
+    }
+    return openConnection();
+}
+
+DatabaseManager::PooledConnection *DatabaseManager::openConnection() const
+{
+    constexpr int BUSY_TIMEOUT_MS = 1000;
+
+    /* Each connection is only used by one thread at a time */
+    sqlite3 *db = nullptr;
+    if (sqlite3_open_v2(
+            m_dbPath,
+            &db,
+            SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+            nullptr) != SQLITE_OK)
+    {
+        sqlite3_close_v2(db);
+        qWarning("Could not open a connection to the dictionary database");
+        return nullptr;
+    }
+    sqlite3_busy_timeout(db, BUSY_TIMEOUT_MS);
+
+    /* Scratch table for batched term lookups. Temporary tables can be
+     * written on read-only connections. */
+    if (sqlite3_exec(
+            db,
+            "CREATE TEMP TABLE term_lookup "
+                "(idx INTEGER NOT NULL, term TEXT NOT NULL);",
+            nullptr,
+            nullptr,
+            nullptr) != SQLITE_OK)
+    {
+        sqlite3_close_v2(db);
+        qWarning("Could not create the term lookup table");
+        return nullptr;
+    }
+
+    /* Make dictionaries stored in their own files visible */
+    if (yomi_attach_dictionaries(db, m_dbPath))
+    {
+        qWarning("Could not attach dictionary files");
+    }
+
+    PooledConnection *connection = new PooledConnection;
+    connection->db = db;
+    return connection;
+}
+
+void DatabaseManager::releaseConnection(PooledConnection *connection) const
+{
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    {
+        QMutexLocker lock{&m_poolLock};
+        if (m_pool.size() < QThread::idealThreadCount())
+        {
+            m_pool.emplaceBack(connection);
+            return;
+        }
+    }
+    closeConnection(connection);
+}
+
+void DatabaseManager::closeConnection(PooledConnection *connection)
+{
+    for (sqlite3_stmt *stmt : connection->statements)
+    {
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_close_v2(connection->db);
+    delete connection;
+}
+
+void DatabaseManager::closeConnections()
+{
+    QMutexLocker lock{&m_poolLock};
+    for (PooledConnection *connection : m_pool)
+    {
+        closeConnection(connection);
+    }
+    m_pool.clear();
+}
+
+void DatabaseManager::reloadCache()
+{
+    /* Lookups keep using the previous caches while the new ones are built */
+    Caches caches;
+    buildCaches(caches);
+    applyCaches(std::move(caches));
+}
+
+/* End Connection Pool */
 /* Begin Initializers */
 
-void DatabaseManager::loadDictionaryAssets(DictionaryInfo *info) const
+void DatabaseManager::loadDictionaryAssets(
+    Connection &db, DictionaryInfo *info) const
 {
     constexpr const char *STYLE_FILENAME = "styles.css";
 
-    QString stylePath = m_resourcePath;
-    stylePath += QDir::separator();
-    stylePath += info->name();
-    stylePath += QDir::separator();
-    stylePath += STYLE_FILENAME;
+    constexpr const char *QUERY =
+        "SELECT path, offset, size FROM resource WHERE dic_id = ?;";
+
+    constexpr int COLUMN_PATH = 0;
+    constexpr int COLUMN_OFFSET = 1;
+    constexpr int COLUMN_SIZE = 2;
 
-    if (!QFile::exists(stylePath))
+    /* Load the index of the resource pack */
+    QHash<QString, DictionaryResources::Range> index;
+    sqlite3_stmt *stmt = nullptr;
+    int step = 0;
+    if ((stmt = db.prepare(QUERY)) == nullptr ||
+        sqlite3_bind_int64(stmt, 1, info->id()) != SQLITE_OK)
     {
-        return;
+        qWarning("Could not load the resource index");
     }
-    QFile styleFile(stylePath);
-    if (!styleFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    else
+    {
+        while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
+        {
+            index.insert(
+                QString::fromUtf8(reinterpret_cast<const char *>(
+                    sqlite3_column_text(stmt, COLUMN_PATH)
+                )),
+                DictionaryResources::Range{
+                    sqlite3_column_int64(stmt, COLUMN_OFFSET),
+                    sqlite3_column_int64(stmt, COLUMN_SIZE),
+                }
+            );
+        }
+        if (isStepError(step))
+        {
+            qWarning("Could not load the resource index");
+        }
+    }
+    Connection::finish(stmt);
+
+    QString packPath = m_resourcePath;
+    packPath += QDir::separator();
+    packPath += QString::asprintf(
+        YOMI_RESOURCE_PACK_FORMAT, static_cast<long long>(info->id())
+    );
+
+    QString legacyDir = m_resourcePath;
+    legacyDir += QDir::separator();
+    legacyDir += info->name();
+
+    std::shared_ptr<const DictionaryResources> resources =
+        std::make_shared<const DictionaryResources>(
+            info->id(), packPath, std::move(index), legacyDir
+        );
+    info->setResources(resources);
+
+    QByteArray styles = resources->read(STYLE_FILENAME);
+    if (styles.isNull())
     {
         return;
     }
-    info->setStyles(styleFile.readAll());
-    styleFile.close();
+    info->setStyles(QString::fromUtf8(styles));
 }
 
-int DatabaseManager::initCache()
+int DatabaseManager::buildCaches(Caches &caches) const
 {
+    MEMENTO_TRACE_SCOPE("DatabaseManager::buildCaches");
+
     constexpr const char *QUERY_DICTIONARY =
-        "SELECT dic_id, title, "
+        "SELECT dic_id, title, revision, "
             "EXISTS ("
                 "SELECT 1 "
                 "FROM dict_disabled "
                 "WHERE dict_disabled.dic_id == directory.dic_id"
-            ") AS disabled "
+            ") AS disabled, "
+            "file IS NOT NULL AS has_file "
         "FROM directory;";
 
     constexpr int COLUMN_DICTIONARY_DIC_ID = 0;
     constexpr int COLUMN_DICTIONARY_TITLE = 1;
-    constexpr int COLUMN_DICTIONARY_DISABLED = 2;
-
-    constexpr const char *QUERY_TAGS =
-        "SELECT dic_id, category, name, ord, notes, score "
-            "FROM tag_bank;";
-
-    constexpr int COLUMN_TAG_DIC_ID = 0;
-    constexpr int COLUMN_TAG_CATEGORY = 1;
-    constexpr int COLUMN_TAG_NAME = 2;
-    constexpr int COLUMN_TAG_ORDER = 3;
-    constexpr int COLUMN_TAG_NOTES = 4;
-    constexpr int COLUMN_TAG_SCORE = 5;
+    constexpr int COLUMN_DICTIONARY_REVISION = 2;
+    constexpr int COLUMN_DICTIONARY_DISABLED = 3;
+    constexpr int COLUMN_DICTIONARY_HAS_FILE = 4;
 
+    /* Pooled connections may not have new dictionary files attached */
     int ret = 0;
+    Connection db{this, true};
     sqlite3_stmt *stmt = nullptr;
     int step = 0;
-
-    /* Empty the cache */
-    clearTagCache();
-    clearDictionaryCache();
+    if (db.get() == nullptr)
+    {
+        return -1;
+    }
 
     /* Build dictionary cache */
-    if (sqlite3_prepare_v2(m_db, QUERY_DICTIONARY, -1, &stmt, nullptr) != SQLITE_OK)
+    if ((stmt = db.prepare(QUERY_DICTIONARY)) == nullptr)
     {
         ret = -1;
         goto cleanup;
     }
     while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
     {
-        DictionaryInfo *info = new DictionaryInfo;
+        std::shared_ptr<DictionaryInfo> info =
+            makeSharedObject<DictionaryInfo>();
         info->setId(sqlite3_column_int64(stmt, COLUMN_DICTIONARY_DIC_ID));
         info->setName(reinterpret_cast<const char *>(
             sqlite3_column_text(stmt, COLUMN_DICTIONARY_TITLE)
@@ -168,74 +489,199 @@ int DatabaseManager::initCache()
         info->setEnabled(
             !sqlite3_column_int64(stmt, COLUMN_DICTIONARY_DISABLED)
         );
-        loadDictionaryAssets(info);
+        loadDictionaryAssets(db, info.get());
+        loadTermIndex(
+            db,
+            info->id(),
+            termIndexFingerprint(
+                db,
+                info->id(),
+                reinterpret_cast<const char *>(
+                    sqlite3_column_text(stmt, COLUMN_DICTIONARY_REVISION)
+                ),
+                sqlite3_column_int(stmt, COLUMN_DICTIONARY_HAS_FILE)
+            ),
+            caches
+        );
 
-        m_dictionaryCache.insert(info->id(), info);
+        /* Shared with results, which are used from the thread of the
+         * manager */
+        info->moveToThread(thread());
+        caches.dictionaries.insert(info->id(), info);
     }
     if (isStepError(step))
     {
         ret = -1;
         goto cleanup;
     }
-    sqlite3_finalize(stmt);
-    stmt = nullptr;
 
-    /* Build tag cache */
-    if (sqlite3_prepare_v2(m_db, QUERY_TAGS, -1, &stmt, nullptr) != SQLITE_OK)
+cleanup:
+    Connection::finish(stmt);
+
+    return ret;
+}
+
+void DatabaseManager::applyCaches(Caches caches)
+{
+    MEMENTO_TRACE_SCOPE("DatabaseManager::applyCaches");
+
+    QWriteLocker lock{&m_dbLock};
+
+    /* Connections are reopened so they see added and removed dictionary
+     * files */
+    closeConnections();
+    ++m_generation;
+    clearTagCache();
+    m_dictionaryCache = std::move(caches.dictionaries);
+
+    /* Rebuilt indices replace the files of mapped ones, which can only be
+     * unmapped now that no lookup is using them */
+    for (auto it = caches.pendingIndices.cbegin();
+         it != caches.pendingIndices.cend();
+         ++it)
     {
-        ret = -1;
-        goto cleanup;
+        m_termIndices.remove(it.key());
+        const QString path = termIndexPath(it.key());
+        QFile::remove(path);
+        std::unique_ptr<TermIndex> index;
+        if (QFile::rename(termIndexPath(it.key(), true), path))
+        {
+            index = TermIndex::open(path, it.value());
+        }
+        if (index == nullptr)
+        {
+            qWarning("Could not open the term index of dictionary %lld",
+                static_cast<long long>(it.key()));
+            continue;
+        }
+        caches.termIndices.insert(it.key(), std::move(index));
     }
-    while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
+    m_termIndices = std::move(caches.termIndices);
+
+    m_dictionaryCounters.removeIf(
+        [this] (const auto &it) -> bool
+        {
+            return !m_dictionaryCache.contains(it.key());
+        }
+    );
+    for (const int64_t id : m_dictionaryCache.keys())
     {
-        uint64_t id = sqlite3_column_int64(stmt, COLUMN_TAG_DIC_ID);
+        if (!m_dictionaryCounters.contains(id))
+        {
+            m_dictionaryCounters.insert(
+                id, std::make_shared<DictionaryCounters>()
+            );
+        }
+    }
+}
 
-        Tag *tag = new Tag;
-        tag->setDictionaryInfo(getDictionary(id)->clone(tag));
-        tag->setName(reinterpret_cast<const char *>(
-            sqlite3_column_text(stmt, COLUMN_TAG_NAME)
-        ));
-        tag->setCategory(reinterpret_cast<const char *>(
-            sqlite3_column_text(stmt, COLUMN_TAG_CATEGORY)
-        ));
-        tag->setNotes(reinterpret_cast<const char *>(
-            sqlite3_column_text(stmt, COLUMN_TAG_NOTES)
-        ));
-        tag->setOrder(sqlite3_column_int(stmt, COLUMN_TAG_ORDER));
-        tag->setScore(sqlite3_column_int(stmt, COLUMN_TAG_SCORE));
+QByteArray DatabaseManager::termIndexFingerprint(
+    Connection &db,
+    int64_t id,
+    const QByteArray &revision,
+    bool hasFile) const
+{
+    constexpr const char *QUERY_FILE =
+        "SELECT count(*), max(rowid) FROM \"dict_%lld\".term_bank;";
+    constexpr const char *QUERY_MAIN =
+        "SELECT count(*), max(rowid) FROM main.term_bank;";
+
+    constexpr int COLUMN_COUNT = 0;
+    constexpr int COLUMN_MAX_ROWID = 1;
+
+    /* Dictionaries in the main database share its table, so changes to any
+     * of them rebuild the index. The schema differs per dictionary, so the
+     * statement isn't cached by the connection. */
+    QByteArray fingerprint = revision;
+    const QByteArray query = hasFile ?
+        QByteArray::asprintf(QUERY_FILE, static_cast<long long>(id)) :
+        QByteArray(QUERY_MAIN);
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v2(
+            db.get(), query.constData(), -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        fingerprint += QByteArray::asprintf(
+            "\n%lld\n%lld",
+            static_cast<long long>(sqlite3_column_int64(stmt, COLUMN_COUNT)),
+            static_cast<long long>(
+                sqlite3_column_int64(stmt, COLUMN_MAX_ROWID)
+            )
+        );
+    }
+    sqlite3_finalize(stmt);
+
+    return fingerprint;
+}
 
-        m_tagCache[id].insert(tag->name(), tag);
+void DatabaseManager::loadTermIndex(
+    Connection &db,
+    int64_t id,
+    const QByteArray &fingerprint,
+    Caches &caches) const
+{
+    std::shared_ptr<const TermIndex> index = m_termIndices.value(id, nullptr);
+    if (index != nullptr && index->fingerprint() == fingerprint)
+    {
+        caches.termIndices.insert(id, std::move(index));
+        return;
     }
-    if (isStepError(step))
+
+    /* A mapped index can't be replaced until the caches are applied, so the
+     * new one is built next to it */
+    const bool mapped = index != nullptr;
+    index.reset();
+    const QString path = termIndexPath(id);
+    if (!mapped && (index = TermIndex::open(path, fingerprint)) != nullptr)
     {
-        ret = -1;
-        goto cleanup;
+        caches.termIndices.insert(id, std::move(index));
+        return;
+    }
+    const QString buildPath = termIndexPath(id, mapped);
+    if (!TermIndex::build(db.get(), id, fingerprint, buildPath))
+    {
+        qWarning("Could not build the term index of dictionary %lld",
+            static_cast<long long>(id));
+        return;
+    }
+    if (mapped)
+    {
+        caches.pendingIndices.insert(id, fingerprint);
+        return;
     }
 
-cleanup:
-    sqlite3_finalize(stmt);
+    index = TermIndex::open(path, fingerprint);
+    if (index == nullptr)
+    {
+        qWarning("Could not open the term index of dictionary %lld",
+            static_cast<long long>(id));
+        return;
+    }
+    caches.termIndices.insert(id, std::move(index));
+}
 
-    return ret;
+QString DatabaseManager::termIndexPath(int64_t id, bool pending) const
+{
+    /* yomi_delete_dictionary_files() removes indices by the same name */
+    constexpr const char *TERM_INDEX_FORMAT = "dict_%lld.keys";
+    constexpr const char *PENDING_TERM_INDEX_FORMAT = "dict_%lld.keys.new";
+
+    return QFileInfo(QString::fromUtf8(m_dbPath)).dir().filePath(
+        QString::asprintf(
+            pending ? PENDING_TERM_INDEX_FORMAT : TERM_INDEX_FORMAT,
+            static_cast<long long>(id)
+        )
+    );
 }
 
 void DatabaseManager::clearDictionaryCache()
 {
-    for (DictionaryInfo *info : m_dictionaryCache)
-    {
-        info->deleteLater();
-    }
     m_dictionaryCache.clear();
 }
 
 void DatabaseManager::clearTagCache()
 {
-    for (QHash<QString, Tag *> &tagDict : m_tagCache)
-    {
-        for (Tag *tag : tagDict)
-        {
-            tag->deleteLater();
-        }
-    }
+    QMutexLocker lock{&m_tagCacheMutex};
     m_tagCache.clear();
 }
 
@@ -257,18 +703,102 @@ void DatabaseManager::setModifyingDatabase(bool value)
     emit modifyingDatabaseChanged(value);
 }
 
+uint64_t DatabaseManager::generation() const noexcept
+{
+    return m_generation;
+}
+
+DatabaseManager::StatementCacheStats
+DatabaseManager::statementCacheStats() const noexcept
+{
+    return StatementCacheStats{
+        .hits = m_statementHits,
+        .misses = m_statementMisses,
+    };
+}
+
+DatabaseManager::QueryStats DatabaseManager::queryStats() const noexcept
+{
+    return QueryStats{
+        .terms = m_termLatency.snapshot(),
+        .termMeta = m_termMetaLatency.snapshot(),
+        .kanji = m_kanjiLatency.snapshot(),
+    };
+}
+
+QList<DatabaseManager::DictionaryCost> DatabaseManager::dictionaryCosts() const
+{
+    /* Called from the UI, which shouldn't wait on startup */
+    if (!isReady())
+    {
+        return {};
+    }
+    QReadLocker lock{&m_dbLock};
+
+    QList<DictionaryCost> costs;
+    costs.reserve(m_dictionaryCache.size());
+    for (const std::shared_ptr<DictionaryInfo> &info : m_dictionaryCache)
+    {
+        const DictionaryCounters *counters = dictionaryCounters(info->id());
+        if (counters == nullptr)
+        {
+            continue;
+        }
+        costs.emplaceBack(DictionaryCost{
+            .id = info->id(),
+            .name = info->name(),
+            .enabled = info->enabled(),
+            .definitions = counters->definitions,
+            .glossaryBytes = counters->glossaryBytes,
+            .frequencies = counters->frequencies,
+            .pitches = counters->pitches,
+            .kanji = counters->kanji,
+        });
+    }
+    return costs;
+}
+
+void DatabaseManager::resetStats()
+{
+    m_termLatency.reset();
+    m_termMetaLatency.reset();
+    m_kanjiLatency.reset();
+
+    if (!isReady())
+    {
+        return;
+    }
+    QReadLocker lock{&m_dbLock};
+    for (const std::shared_ptr<DictionaryCounters> &counters :
+            m_dictionaryCounters)
+    {
+        counters->definitions = 0;
+        counters->glossaryBytes = 0;
+        counters->frequencies = 0;
+        counters->pitches = 0;
+        counters->kanji = 0;
+    }
+}
+
 /* End Properties */
 /* Begin Dictionary Database Modifiers */
 
 int DatabaseManager::addDictionary(QString path)
 {
-    QWriteLocker lock{&m_dbLock};
+    waitUntilReady();
+    QMutexLocker writeLock{&m_writeLock};
 
     setModifyingDatabase(true);
     QByteArray cpath = path.toUtf8();
     QByteArray resPath = m_resourcePath.toUtf8();
-    int ret = yomi_process_dictionary(cpath, m_dbPath, resPath);
-    initCache();
+    /* Only write the changes if an older revision is already installed.
+     * Lookups keep reading the last committed state while this runs. */
+    int ret = yomi_update_dictionary(cpath, m_dbPath, resPath);
+    if (ret == YOMI_ERR_NOT_INSTALLED)
+    {
+        ret = yomi_process_dictionary(cpath, m_dbPath, resPath);
+    }
+    reloadCache();
     setModifyingDatabase(false);
 
     return ret;
@@ -276,12 +806,29 @@ int DatabaseManager::addDictionary(QString path)
 
 int DatabaseManager::deleteDictionary(int64_t id)
 {
-    QWriteLocker lock{&m_dbLock};
+    waitUntilReady();
+    QMutexLocker writeLock{&m_writeLock};
 
     setModifyingDatabase(true);
     QByteArray resPath = m_resourcePath.toUtf8();
-    int ret = yomi_delete_dictionary(id, m_dbPath, resPath);
-    initCache();
+
+    /* Lookups keep reading the last committed state while the dictionary is
+     * removed, which deletes its rows if it is stored in the main database */
+    yomi_removed_dictionary removed;
+    int ret = yomi_remove_dictionary(id, m_dbPath, &removed);
+    if (ret == 0)
+    {
+        {
+            /* Dictionary files can't be deleted while attached or mapped on
+             * some platforms. New connections no longer attach the file. */
+            QWriteLocker lock{&m_dbLock};
+            closeConnections();
+            m_termIndices.remove(id);
+        }
+        ret = yomi_delete_dictionary_files(&removed, resPath);
+        yomi_free_removed_dictionary(&removed);
+    }
+    reloadCache();
     setModifyingDatabase(false);
 
     return ret;
@@ -289,11 +836,12 @@ int DatabaseManager::deleteDictionary(int64_t id)
 
 int DatabaseManager::enableDictionary(int64_t id)
 {
-    QWriteLocker lock{&m_dbLock};
+    waitUntilReady();
+    QMutexLocker writeLock{&m_writeLock};
 
     setModifyingDatabase(true);
     int ret = yomi_enable_dictionary(id, m_dbPath);
-    initCache();
+    reloadCache();
     setModifyingDatabase(false);
 
     return ret;
@@ -302,11 +850,12 @@ int DatabaseManager::enableDictionary(int64_t id)
 
 int DatabaseManager::disableDictionary(int64_t id)
 {
-    QWriteLocker lock{&m_dbLock};
+    waitUntilReady();
+    QMutexLocker writeLock{&m_writeLock};
 
     setModifyingDatabase(true);
     int ret = yomi_disable_dictionary(id, m_dbPath);
-    initCache();
+    reloadCache();
     setModifyingDatabase(false);
 
     return ret;
@@ -317,123 +866,252 @@ int DatabaseManager::disableDictionary(int64_t id)
 
 QList<DictionaryInfo *> DatabaseManager::getDictionaries(QObject *parent) const
 {
+    /* Called from the UI, which is refreshed again on ready() */
+    if (!isReady())
+    {
+        return {};
+    }
     QReadLocker lock{&m_dbLock};
 
     QList<DictionaryInfo *> infos;
     infos.reserve(m_dictionaryCache.size());
-    for (DictionaryInfo *info : m_dictionaryCache)
+    for (const std::shared_ptr<DictionaryInfo> &info : m_dictionaryCache)
     {
         infos.emplaceBack(info->clone(parent));
     }
     return infos;
 }
 
-QList<Term *> DatabaseManager::queryTerms(
-    QString query, QObject *parent, QString *error) const
+bool DatabaseManager::hasTerm(const QString &query) const
 {
-    constexpr const char *QUERY =
-        "SELECT DISTINCT expression, reading "
-            "FROM term_bank "
-            "WHERE dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND "
-            "(expression = ? OR reading = ?);";
+    /* Searches wait for startup themselves so they can be cancelled */
+    if (!isReady())
+    {
+        return false;
+    }
+    const QSet<QByteArray> variants = termVariants(query);
 
-    constexpr const char *QUERY_WITH_KATAKANA =
-        "SELECT DISTINCT expression, reading "
-            "FROM term_bank "
-            "WHERE dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND "
-                "(expression = ? OR reading = ? OR "
-                "expression = ? OR reading = ?);";
+    QReadLocker lock{&m_dbLock};
+    for (const std::shared_ptr<DictionaryInfo> &info : m_dictionaryCache)
+    {
+        if (!info->enabled())
+        {
+            continue;
+        }
 
-    constexpr const char *QUERY_WITH_HALFWIDTH =
-        "SELECT DISTINCT expression, reading "
-            "FROM term_bank "
-            "WHERE dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND "
-                "(expression = ? OR reading = ? OR "
-                "expression = ? OR reading = ? OR "
-                "expression = ? OR reading = ?);";
-
-    constexpr int QUERY_RAW_EXPRESSION_IDX = 1;
-    constexpr int QUERY_RAW_READING_IDX = 2;
-    constexpr int QUERY_KATA_EXPRESSION_IDX = 3;
-    constexpr int QUERY_KATA_READING_IDX = 4;
-    constexpr int QUERY_HALF_EXPRESSION_IDX = 5;
-    constexpr int QUERY_HALF_READING_IDX = 6;
-
-    constexpr int COLUMN_EXPRESSION = 0;
-    constexpr int COLUMN_READING = 1;
+        std::shared_ptr<const TermIndex> index =
+            m_termIndices.value(info->id(), nullptr);
+        if (index == nullptr)
+        {
+            /* Nothing can be ruled out without an index */
+            return true;
+        }
+        for (const QByteArray &variant : variants)
+        {
+            if (index->contains({variant.constData(), size_t(variant.size())}))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
 
+std::shared_ptr<const DictionaryResources>
+DatabaseManager::getResources(int64_t id) const
+{
+    /* Called from image providers, which shouldn't wait on startup */
+    if (!isReady())
+    {
+        return nullptr;
+    }
     QReadLocker lock{&m_dbLock};
 
-    QByteArray exp = query.toUtf8();
-    QByteArray katakana =
-        query.normalized(QString::NormalizationForm_KC).toUtf8();
-    bool containsHalf = katakana != exp;
-    QByteArray hiragana = kataToHira(katakana).toUtf8();
-    bool containsKata = hiragana != katakana;
-    sqlite3_stmt *stmt = nullptr;
-    const char *sql_query = nullptr;
-    int step = 0;
-    QList<Term *> terms;
+    std::shared_ptr<DictionaryInfo> info = m_dictionaryCache.value(id, nullptr);
+    return info == nullptr ? nullptr : info->resources();
+}
 
-    if (containsHalf)
+QList<Term *> DatabaseManager::queryTerms(
+    QString query, QObject *parent, QString *error) const
+{
+    QList<QList<Term *>> results =
+        queryTerms(QStringList{std::move(query)}, parent, error);
+    if (results.isEmpty())
     {
-        sql_query = QUERY_WITH_HALFWIDTH;
+        return {};
     }
-    else if (containsKata)
+    QList<Term *> terms = results.takeFirst();
+    addTermMeta(terms);
+    return terms;
+}
+
+QList<QList<Term *>> DatabaseManager::queryTerms(
+    const QStringList &queries,
+    QObject *parent,
+    QString *error,
+    std::stop_token cancel) const
+{
+    QList<QList<TermCandidate>> candidates =
+        queryTermCandidates(queries, parent, error, cancel);
+
+    QList<QList<Term *>> results;
+    QList<Term *> terms;
+    results.reserve(candidates.size());
+    for (const QList<TermCandidate> &group : candidates)
     {
-        sql_query = QUERY_WITH_KATAKANA;
+        QList<Term *> &result = results.emplaceBack();
+        for (const TermCandidate &candidate : group)
+        {
+            result.emplaceBack(candidate.term);
+            terms.emplaceBack(candidate.term);
+        }
     }
-    else
+    if (addTermDefinitions(terms, cancel))
     {
-        sql_query = QUERY;
+        if (error)
+        {
+            *error = cancel.stop_requested() ?
+                tr("Search was cancelled") :
+                tr("Error getting term information");
+        }
+        qDeleteAll(terms);
+        return {};
     }
 
-    /* Query for all the different terms in the database */
-    if (sqlite3_prepare_v2(m_db, sql_query, -1, &stmt, nullptr) != SQLITE_OK)
+    /* Dictionaries may have been removed since the candidates were found */
+    for (QList<Term *> &group : results)
+    {
+        for (qsizetype i = 0; i < group.size(); ++i)
+        {
+            if (group[i]->definitions().isEmpty())
+            {
+                delete std::exchange(group[i], nullptr);
+            }
+        }
+        group.removeAll(nullptr);
+    }
+
+    return results;
+}
+
+QList<QList<DatabaseManager::TermCandidate>>
+DatabaseManager::queryTermCandidates(
+    const QStringList &queries,
+    QObject *parent,
+    QString *error,
+    std::stop_token cancel) const
+{
+    MEMENTO_TRACE_SCOPE("DatabaseManager::queryTermCandidates");
+    const LatencyHistogram::Timer latency{m_termLatency};
+
+    constexpr const char *QUERY_INSERT =
+        "INSERT INTO temp.term_lookup (idx, term) VALUES (?, ?);";
+
+    constexpr const char *QUERY =
+        "SELECT DISTINCT l.idx, t.expression, t.reading "
+            "FROM temp.term_lookup AS l, term_bank AS t "
+            "WHERE t.dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND "
+                "(t.expression = l.term OR t.reading = l.term) "
+            "ORDER BY l.idx, t.expression, t.reading;";
+
+    constexpr int QUERY_INSERT_INDEX_IDX = 1;
+    constexpr int QUERY_INSERT_TERM_IDX = 2;
+
+    constexpr int COLUMN_INDEX = 0;
+    constexpr int COLUMN_EXPRESSION = 1;
+    constexpr int COLUMN_READING = 2;
+
+    if (!waitUntilReady(cancel))
     {
         if (error)
         {
-            *error = tr("Could not prepare database query");
+            *error = tr("Search was cancelled");
         }
-        goto error;
+        return {};
     }
-    if (sqlite3_bind_text(stmt, QUERY_RAW_EXPRESSION_IDX, exp, -1, nullptr) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_RAW_READING_IDX,    exp, -1, nullptr) != SQLITE_OK)
+    QReadLocker lock{&m_dbLock};
+    Connection db{this};
+    if (db.get() == nullptr)
     {
         if (error)
         {
-            *error = tr("Could not bind values to statement");
+            *error = tr("Could not connect to the database");
         }
-        goto error;
+        return {};
     }
-    if (containsKata &&
-        (
-            sqlite3_bind_text(stmt, QUERY_KATA_EXPRESSION_IDX, hiragana, -1, nullptr) != SQLITE_OK ||
-            sqlite3_bind_text(stmt, QUERY_KATA_READING_IDX,    hiragana, -1, nullptr) != SQLITE_OK
-        ))
+    db.setCancellation(cancel);
+
+    sqlite3_stmt *stmt = nullptr;
+    int step = 0;
+    QList<QList<TermCandidate>> results(queries.size());
+    QList<TermCandidate> candidates;
+    QList<qsizetype> candidateQueries;
+
+    /* Lookup rows are discarded when the transaction is rolled back */
+    if (sqlite3_exec(db.get(), "BEGIN;", nullptr, nullptr, nullptr) != SQLITE_OK)
     {
         if (error)
         {
-            *error = tr("Could not bind values to statement");
+            *error = tr("Could not begin transaction");
         }
-        goto error;
+        return {};
     }
-    if (containsHalf &&
-        (
-            sqlite3_bind_text(stmt, QUERY_HALF_EXPRESSION_IDX, katakana, -1, nullptr) != SQLITE_OK ||
-            sqlite3_bind_text(stmt, QUERY_HALF_READING_IDX,    katakana, -1, nullptr) != SQLITE_OK
-        ))
+
+    /* Add the raw, katakana and halfwidth forms of every query */
+    if ((stmt = db.prepare(QUERY_INSERT)) == nullptr)
     {
         if (error)
         {
-            *error = tr("Could not bind values to statement");
+            *error = tr("Could not prepare database query");
         }
         goto error;
     }
+    for (qsizetype i = 0; i < queries.size(); ++i)
+    {
+        for (const QByteArray &term : termVariants(queries[i]))
+        {
+            if (sqlite3_bind_int64(stmt, QUERY_INSERT_INDEX_IDX, i) != SQLITE_OK ||
+                sqlite3_bind_text(stmt, QUERY_INSERT_TERM_IDX, term, -1, nullptr) != SQLITE_OK)
+            {
+                if (error)
+                {
+                    *error = tr("Could not bind values to statement");
+                }
+                goto error;
+            }
+            if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+            {
+                if (error)
+                {
+                    *error =
+                        tr("Error when executing sqlite query. Code %1")
+                            .arg(step);
+                }
+                goto error;
+            }
+            sqlite3_reset(stmt);
+        }
+    }
+    Connection::finish(stmt);
 
-    /* Create a term for each entry */
+    /* Create a term for each entry grouped by the query it matched */
+    if ((stmt = db.prepare(QUERY)) == nullptr)
+    {
+        if (error)
+        {
+            *error = tr("Could not prepare database query");
+        }
+        goto error;
+    }
     while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
     {
+        /* Don't spend queries on the keys of a dead search */
+        if (cancel.stop_requested())
+        {
+            step = SQLITE_INTERRUPT;
+            break;
+        }
+
         Term *term = new Term(parent);
         term->setExpression(reinterpret_cast<const char *>(
             sqlite3_column_text(stmt, COLUMN_EXPRESSION)
@@ -441,68 +1119,127 @@ QList<Term *> DatabaseManager::queryTerms(
         term->setReading(reinterpret_cast<const char *>(
             sqlite3_column_text(stmt, COLUMN_READING)
         ));
-        if (addFrequencies(term))
-        {
-            qDebug(
-                "Could not add frequencies for %s",
-                qUtf8Printable(term->expression())
-            );
-        }
-        if (addPitches(term))
-        {
-            qDebug(
-                "Could not add pitches for %s",
-                qUtf8Printable(term->expression())
-            );
-        }
-        terms.emplaceBack(term);
+        candidates.emplaceBack(TermCandidate{.term = term});
+        candidateQueries.emplaceBack(
+            sqlite3_column_int64(stmt, COLUMN_INDEX)
+        );
     }
     if (isStepError(step))
     {
         if (error)
         {
-            *error = tr("Error when executing sqlite query. Code %1").arg(step);
+            *error = step == SQLITE_INTERRUPT ?
+                tr("Search was cancelled") :
+                tr("Error when executing sqlite query. Code %1").arg(step);
         }
         goto error;
     }
+    Connection::finish(stmt);
+    stmt = nullptr;
 
-    /* Add data to each term */
-    if (populateTerms(terms))
+    /* Only read what ranking needs. Definitions are added later. */
+    if (addRankingKeys(db, candidates))
     {
         if (error)
         {
-            *error = tr("Error getting term information");
+            *error = cancel.stop_requested() ?
+                tr("Search was cancelled") :
+                tr("Error getting term information");
         }
         goto error;
     }
+    db.clearCancellation();
+    sqlite3_exec(db.get(), "ROLLBACK;", nullptr, nullptr, nullptr);
 
-    /* Filter terms with no definitions */
-    for (qsizetype i = 0; i < terms.size(); ++i)
+    /* Group terms by query, filtering out terms with no definitions */
+    for (qsizetype i = 0; i < candidates.size(); ++i)
     {
-        if (terms[i]->definitions().isEmpty())
+        if (candidates[i].definitions == 0)
         {
-            delete std::exchange(terms[i], nullptr);
+            delete candidates[i].term;
+            continue;
         }
+        results[candidateQueries[i]].emplaceBack(std::move(candidates[i]));
     }
-    terms.removeAll(nullptr);
-
-    /* Return results on success */
-    sqlite3_finalize(stmt);
 
-    return terms;
+    return results;
 
 error:
     /* Free up memory on failure */
-    sqlite3_finalize(stmt);
-    qDeleteAll(terms);
-    terms.clear();
+    Connection::finish(stmt);
+    db.clearCancellation();
+    sqlite3_exec(db.get(), "ROLLBACK;", nullptr, nullptr, nullptr);
+    for (const TermCandidate &candidate : candidates)
+    {
+        delete candidate.term;
+    }
+    candidates.clear();
 
     return {};
 }
 
+int DatabaseManager::addTermDefinitions(
+    const QList<Term *> &terms, std::stop_token cancel) const
+{
+    MEMENTO_TRACE_SCOPE("DatabaseManager::addTermDefinitions");
+
+    if (!waitUntilReady(cancel))
+    {
+        return -1;
+    }
+    QReadLocker lock{&m_dbLock};
+    Connection db{this};
+    if (db.get() == nullptr)
+    {
+        return -1;
+    }
+    db.setCancellation(std::move(cancel));
+
+    return populateTerms(db, terms);
+}
+
+int DatabaseManager::addTermMeta(const QList<Term *> &terms) const
+{
+    MEMENTO_TRACE_SCOPE("DatabaseManager::addTermMeta");
+    const LatencyHistogram::Timer latency{m_termMetaLatency};
+
+    waitUntilReady();
+    QReadLocker lock{&m_dbLock};
+    Connection db{this};
+    if (db.get() == nullptr)
+    {
+        return -1;
+    }
+
+    int ret = 0;
+    for (Term *term : terms)
+    {
+        if (addFrequencies(db, term))
+        {
+            qDebug(
+                "Could not add frequencies for %s",
+                qUtf8Printable(term->expression())
+            );
+            ret = -1;
+        }
+        if (addPitches(db, term))
+        {
+            qDebug(
+                "Could not add pitches for %s",
+                qUtf8Printable(term->expression())
+            );
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
 Kanji *DatabaseManager::queryKanji(
     QString query, QObject *parent, QString *error) const
 {
+    MEMENTO_TRACE_SCOPE("DatabaseManager::queryKanji");
+    const LatencyHistogram::Timer latency{m_kanjiLatency};
+
     constexpr const char *QUERY =
         "SELECT dic_id, onyomi, kunyomi, tags, meanings, stats FROM kanji_bank "
             "WHERE dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND (char = ?);";
@@ -519,18 +1256,29 @@ Kanji *DatabaseManager::queryKanji(
     constexpr const char *TAG_NAME_CODE = "code";
     constexpr const char *TAG_NAME_INDEX = "index";
 
+    waitUntilReady();
     QReadLocker lock{&m_dbLock};
+    Connection db{this};
+    if (db.get() == nullptr)
+    {
+        if (error)
+        {
+            *error = tr("Could not connect to the database");
+        }
+        return nullptr;
+    }
 
     Kanji *kanji = new Kanji(parent);
     kanji->setCharacter(query);
-    addFrequencies(kanji);
+    addFrequencies(db, kanji);
 
     QByteArray ch = query.toUtf8();
+    TagLookup tagLookup;
     sqlite3_stmt *stmt = nullptr;
     int step = 0;
 
     /* Query for the database for the definitions */
-    if (sqlite3_prepare_v2(m_db, QUERY, -1, &stmt, nullptr) != SQLITE_OK)
+    if ((stmt = db.prepare(QUERY)) == nullptr)
     {
         if (error)
         {
@@ -549,10 +1297,20 @@ Kanji *DatabaseManager::queryKanji(
     while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
     {
         int64_t id = sqlite3_column_int64(stmt, COLUMN_DIC_ID);
+        std::shared_ptr<DictionaryInfo> info = getDictionary(id);
+        if (info == nullptr)
+        {
+            continue;
+        }
+
+        if (DictionaryCounters *counters = dictionaryCounters(id))
+        {
+            counters->kanji.fetch_add(1, std::memory_order_relaxed);
+        }
 
         KanjiDefinition *def = new KanjiDefinition(kanji);
 
-        def->setDictionaryInfo(getDictionary(id)->clone(def));
+        def->setDictionaryInfo(std::move(info));
         def->setOnyomi(QString(
             reinterpret_cast<const char *>(
                 sqlite3_column_text(stmt, COLUMN_ONYOMI)
@@ -568,24 +1326,36 @@ Kanji *DatabaseManager::queryKanji(
                 sqlite3_column_text(stmt, COLUMN_MEANINGS)
             )
         ));
-        def->setTags(
-            getTags(
-                id,
-                reinterpret_cast<const char *>(
-                    sqlite3_column_text(stmt, COLUMN_TAGS)
-                ),
-                kanji
+        const QList<std::shared_ptr<Tag>> tags = getTags(
+            tagLookup,
+            id,
+            reinterpret_cast<const char *>(
+                sqlite3_column_text(stmt, COLUMN_TAGS)
             )
         );
+        for (const std::shared_ptr<Tag> &tag : tags)
+        {
+            def->appendTags(tag->clone(def));
+        }
 
         QVariantMap map = QJsonDocument::fromJson(
             reinterpret_cast<const char *>(
                 sqlite3_column_text(stmt, COLUMN_STATS)
             )
         ).toVariant().toMap();
+        std::shared_ptr<const TagMap> dictTags;
+        if (!map.isEmpty())
+        {
+            dictTags = loadTags(tagLookup, id);
+        }
         for (const auto &[key, value] : map.asKeyValueRange())
         {
-            Tag *tag = m_tagCache[id][key]->clone(def);
+            const std::shared_ptr<Tag> cached = dictTags->value(key);
+            if (cached == nullptr)
+            {
+                continue;
+            }
+            Tag *tag = cached->clone(def);
             tag->setValue(value.toString());
             if (tag->category() == TAG_NAME_INDEX)
             {
@@ -621,12 +1391,12 @@ Kanji *DatabaseManager::queryKanji(
         goto error;
     }
 
-    sqlite3_finalize(stmt);
+    Connection::finish(stmt);
 
     return kanji;
 
 error:
-    sqlite3_finalize(stmt);
+    Connection::finish(stmt);
     delete kanji;
 
     return nullptr;
@@ -635,8 +1405,11 @@ error:
 /* End Database Getters */
 /* Begin Query Helpers */
 
-int DatabaseManager::populateTerms(const QList<Term *> &terms) const
+int DatabaseManager::populateTerms(
+    Connection &db, const QList<Term *> &terms) const
 {
+    MEMENTO_TRACE_SCOPE("DatabaseManager::populateTerms");
+
     constexpr const char *QUERY =
         "SELECT dic_id, score, def_tags, glossary, rules, term_tags "
             "FROM term_bank "
@@ -658,17 +1431,19 @@ int DatabaseManager::populateTerms(const QList<Term *> &terms) const
     int step = 0;
     QByteArray exp;
     QByteArray reading;
+    TagLookup tagLookup;
+
+    if ((stmt = db.prepare(QUERY)) == nullptr)
+    {
+        ret = -1;
+        goto cleanup;
+    }
 
     for (Term *term : terms)
     {
         exp = term->expression().toUtf8();
         reading = term->reading().toUtf8();
 
-        if (sqlite3_prepare_v2(m_db, QUERY, -1, &stmt, nullptr) != SQLITE_OK)
-        {
-            ret = -1;
-            goto cleanup;
-        }
         if (sqlite3_bind_text(stmt, QUERY_EXP_IDX,     exp,     -1, nullptr) != SQLITE_OK ||
             sqlite3_bind_text(stmt, QUERY_READING_IDX, reading, -1, nullptr) != SQLITE_OK)
         {
@@ -676,53 +1451,94 @@ int DatabaseManager::populateTerms(const QList<Term *> &terms) const
             goto cleanup;
         }
 
-        QList<Tag *> tags;
+        QList<std::shared_ptr<Tag>> tags;
+        int score = 0;
         while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
         {
-            /* Filter out all deinflection glossaries since they aren't used */
-            QJsonArray glossary = QJsonDocument::fromJson(
-                reinterpret_cast<const char *>(
-                    sqlite3_column_text(stmt, COLUMN_GLOSSARY)
-                )
-            ).array();
-            for (qsizetype i = glossary.size() - 1; i >= 0; --i)
+            /* Glossaries are stored as CBOR with deinflections stripped and
+             * only decoded once they are displayed */
+            QByteArray glossaryCbor;
+            QJsonArray glossary;
+            if (sqlite3_column_type(stmt, COLUMN_GLOSSARY) == SQLITE_BLOB)
             {
-                if (glossary[i].isArray())
+                glossaryCbor = QByteArray(
+                    static_cast<const char *>(
+                        sqlite3_column_blob(stmt, COLUMN_GLOSSARY)
+                    ),
+                    sqlite3_column_bytes(stmt, COLUMN_GLOSSARY)
+                );
+                if (glossaryCbor.isEmpty())
                 {
-                    glossary.removeAt(i);
+                    continue;
                 }
             }
-            if (glossary.isEmpty())
+            else
             {
-                continue;
+                /* Filter out all deinflection glossaries since they aren't
+                 * used */
+                glossary = QJsonDocument::fromJson(
+                    reinterpret_cast<const char *>(
+                        sqlite3_column_text(stmt, COLUMN_GLOSSARY)
+                    )
+                ).array();
+                for (qsizetype i = glossary.size() - 1; i >= 0; --i)
+                {
+                    if (glossary[i].isArray())
+                    {
+                        glossary.removeAt(i);
+                    }
+                }
+                if (glossary.isEmpty())
+                {
+                    continue;
+                }
             }
 
             const int64_t id = sqlite3_column_int64(stmt, COLUMN_DIC_ID);
+            std::shared_ptr<DictionaryInfo> info = getDictionary(id);
+            if (info == nullptr)
+            {
+                continue;
+            }
+
+            if (DictionaryCounters *counters = dictionaryCounters(id))
+            {
+                counters->definitions.fetch_add(1, std::memory_order_relaxed);
+                counters->glossaryBytes.fetch_add(
+                    sqlite3_column_bytes(stmt, COLUMN_GLOSSARY),
+                    std::memory_order_relaxed
+                );
+            }
 
             /* These fields are accumulated */
-            term->setScore(
-                term->score() + sqlite3_column_int(stmt, COLUMN_SCORE)
-            );
+            score += sqlite3_column_int(stmt, COLUMN_SCORE);
             accumulateTags(
+                tagLookup,
                 id,
                 reinterpret_cast<const char *>(
                     sqlite3_column_text(stmt, COLUMN_TERM_TAGS)
                 ),
-                tags,
-                term
+                tags
             );
 
             TermDefinition *def = new TermDefinition(term);
-            def->setDictionaryInfo(getDictionary(id)->clone(def));
-            def->setGlossary(std::move(glossary));
+            def->setDictionaryInfo(std::move(info));
+            if (glossaryCbor.isNull())
+            {
+                def->setGlossary(std::move(glossary));
+            }
+            else
+            {
+                def->setGlossaryCbor(glossaryCbor);
+            }
             def->setScore(sqlite3_column_int(stmt, COLUMN_SCORE));
             def->setTags(
                 getTags(
+                    tagLookup,
                     id,
                     reinterpret_cast<const char *>(
                         sqlite3_column_text(stmt, COLUMN_DEF_TAGS)
-                    ),
-                    term
+                    )
                 )
             );
             def->setRules(QString(
@@ -733,7 +1549,9 @@ int DatabaseManager::populateTerms(const QList<Term *> &terms) const
 
             term->appendDefinitions(def);
         }
+        sortTags(tags);
         term->setTags(tags);
+        term->setScore(score);
 
         if (isStepError(step))
         {
@@ -741,65 +1559,274 @@ int DatabaseManager::populateTerms(const QList<Term *> &terms) const
             goto cleanup;
         }
 
-        sqlite3_finalize(stmt);
-        stmt = nullptr;
+        sqlite3_reset(stmt);
     }
 
 cleanup:
-    sqlite3_finalize(stmt);
+    Connection::finish(stmt);
 
     return ret;
 }
 
-DictionaryInfo *DatabaseManager::getDictionary(const int64_t id) const
+int DatabaseManager::addRankingKeys(
+    Connection &db, QList<TermCandidate> &candidates) const
 {
-    return m_dictionaryCache[id];
-}
+    MEMENTO_TRACE_SCOPE("DatabaseManager::addRankingKeys");
 
-QList<Tag *> DatabaseManager::getTags(
-    const int64_t id,
-    const QString &tagStr,
-    QObject *parent) const
-{
-    QStringList tagList = tagStr.split(" ");
+    /* The size of a blob is read without loading it. Text glossaries are
+     * only read for dictionaries imported before they were stored as CBOR. */
+    constexpr const char *QUERY =
+        "SELECT dic_id, score, rules, length(glossary), "
+                "CASE WHEN typeof(glossary) = 'blob' THEN NULL "
+                    "ELSE glossary END "
+            "FROM term_bank "
+            "WHERE dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND "
+                "(expression = ? AND reading = ?);";
 
-    QList<Tag *> tags;
-    tags.reserve(tagList.size());
-    for (const QString &tagName : tagList)
+    constexpr int QUERY_EXP_IDX = 1;
+    constexpr int QUERY_READING_IDX = 2;
+
+    constexpr int COLUMN_DIC_ID = 0;
+    constexpr int COLUMN_SCORE = 1;
+    constexpr int COLUMN_RULES = 2;
+    constexpr int COLUMN_GLOSSARY_SIZE = 3;
+    constexpr int COLUMN_GLOSSARY_TEXT = 4;
+
+    int ret = 0;
+    sqlite3_stmt *stmt = nullptr;
+    int step = 0;
+    QByteArray exp;
+    QByteArray reading;
+
+    if ((stmt = db.prepare(QUERY)) == nullptr)
     {
-        if (tagName.isEmpty())
+        ret = -1;
+        goto cleanup;
+    }
+
+    for (TermCandidate &candidate : candidates)
+    {
+        exp = candidate.term->expression().toUtf8();
+        reading = candidate.term->reading().toUtf8();
+
+        if (sqlite3_bind_text(stmt, QUERY_EXP_IDX,     exp,     -1, nullptr) != SQLITE_OK ||
+            sqlite3_bind_text(stmt, QUERY_READING_IDX, reading, -1, nullptr) != SQLITE_OK)
         {
-            continue;
+            ret = -1;
+            goto cleanup;
         }
-        const Tag *tag = m_tagCache[id][tagName];
-        if (tag == nullptr)
+
+        /* Counts the same definitions as populateTerms() */
+        int score = 0;
+        while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
         {
-            continue;
+            if (sqlite3_column_type(stmt, COLUMN_GLOSSARY_TEXT) == SQLITE_NULL)
+            {
+                if (sqlite3_column_int64(stmt, COLUMN_GLOSSARY_SIZE) == 0)
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                const QJsonArray glossary = QJsonDocument::fromJson(
+                    reinterpret_cast<const char *>(
+                        sqlite3_column_text(stmt, COLUMN_GLOSSARY_TEXT)
+                    )
+                ).array();
+                const bool hasGlossary = std::any_of(
+                    std::begin(glossary), std::end(glossary),
+                    [] (const QJsonValue &value) -> bool
+                    {
+                        return !value.isArray();
+                    }
+                );
+                if (!hasGlossary)
+                {
+                    continue;
+                }
+            }
+            if (getDictionary(
+                    sqlite3_column_int64(stmt, COLUMN_DIC_ID)) == nullptr)
+            {
+                continue;
+            }
+
+            score += sqlite3_column_int(stmt, COLUMN_SCORE);
+            ++candidate.definitions;
+            const QStringList rules = QString(
+                reinterpret_cast<const char *>(
+                    sqlite3_column_text(stmt, COLUMN_RULES)
+                )
+            ).split(' ');
+            for (const QString &rule : rules)
+            {
+                candidate.rules.insert(rule);
+            }
         }
-        else if (tag->name().isEmpty())
+        candidate.term->setScore(score);
+
+        if (isStepError(step))
         {
-            continue;
+            ret = -1;
+            goto cleanup;
         }
-        tags.emplaceBack(tag->clone(parent));
+
+        sqlite3_reset(stmt);
     }
-    return tags;
+
+cleanup:
+    Connection::finish(stmt);
+
+    return ret;
 }
 
-void DatabaseManager::accumulateTags(
+std::shared_ptr<DictionaryInfo> DatabaseManager::getDictionary(
+    const int64_t id) const
+{
+    return m_dictionaryCache.value(id, nullptr);
+}
+
+DatabaseManager::DictionaryCounters *DatabaseManager::dictionaryCounters(
+    const int64_t id) const
+{
+    const auto it = m_dictionaryCounters.constFind(id);
+    return it == m_dictionaryCounters.constEnd() ? nullptr : it->get();
+}
+
+std::shared_ptr<const DatabaseManager::TagMap> DatabaseManager::loadTags(
+    TagLookup &lookup, const int64_t id) const
+{
+    constexpr const char *QUERY =
+        "SELECT category, name, ord, notes, score "
+            "FROM tag_bank "
+            "WHERE dic_id = ?;";
+
+    constexpr int QUERY_DIC_ID_IDX = 1;
+
+    constexpr int COLUMN_CATEGORY = 0;
+    constexpr int COLUMN_NAME = 1;
+    constexpr int COLUMN_ORDER = 2;
+    constexpr int COLUMN_NOTES = 3;
+    constexpr int COLUMN_SCORE = 4;
+
+    auto it = lookup.maps.constFind(id);
+    if (it != lookup.maps.constEnd())
+    {
+        return *it;
+    }
+    {
+        QMutexLocker lock{&m_tagCacheMutex};
+        std::shared_ptr<const TagMap> cached = m_tagCache.value(id);
+        if (cached != nullptr)
+        {
+            lookup.maps.insert(id, cached);
+            return cached;
+        }
+    }
+
+    MEMENTO_TRACE_SCOPE("DatabaseManager::loadTags");
+
+    /* Failures are remembered for the rest of the query only, so a broken
+     * dictionary isn't queried every row but is retried by the next query */
+    std::shared_ptr<TagMap> tags = std::make_shared<TagMap>();
+    lookup.maps.insert(id, tags);
+    std::shared_ptr<DictionaryInfo> info = getDictionary(id);
+    if (info == nullptr)
+    {
+        return tags;
+    }
+
+    /* The connection of the query may be interrupted by its cancellation,
+     * which must not leave the dictionary without tags for later queries */
+    Connection db{this};
+    sqlite3_stmt *stmt = nullptr;
+    int step = 0;
+    if ((stmt = db.prepare(QUERY)) == nullptr ||
+        sqlite3_bind_int64(stmt, QUERY_DIC_ID_IDX, id) != SQLITE_OK)
+    {
+        qWarning(
+            "Could not load tags of dictionary %lld",
+            static_cast<long long>(id)
+        );
+        Connection::finish(stmt);
+        return tags;
+    }
+    while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        std::shared_ptr<Tag> tag = makeSharedObject<Tag>();
+        tag->setDictionaryInfo(info);
+        tag->setName(reinterpret_cast<const char *>(
+            sqlite3_column_text(stmt, COLUMN_NAME)
+        ));
+        tag->setCategory(reinterpret_cast<const char *>(
+            sqlite3_column_text(stmt, COLUMN_CATEGORY)
+        ));
+        tag->setNotes(reinterpret_cast<const char *>(
+            sqlite3_column_text(stmt, COLUMN_NOTES)
+        ));
+        tag->setOrder(sqlite3_column_int(stmt, COLUMN_ORDER));
+        tag->setScore(sqlite3_column_int(stmt, COLUMN_SCORE));
+
+        /* Shared with results, which are used from the thread of the
+         * manager */
+        tag->moveToThread(thread());
+        tags->insert(tag->name(), tag);
+    }
+    Connection::finish(stmt);
+    if (isStepError(step))
+    {
+        qWarning(
+            "Could not load tags of dictionary %lld",
+            static_cast<long long>(id)
+        );
+        tags->clear();
+        return tags;
+    }
+
+    /* Built without the lock, so another query may have published the tags
+     * first. Everyone uses the published map so tags stay interned. */
+    QMutexLocker lock{&m_tagCacheMutex};
+    std::shared_ptr<const TagMap> &published = m_tagCache[id];
+    if (published == nullptr)
+    {
+        published = std::move(tags);
+    }
+    lookup.maps.insert(id, published);
+
+    return published;
+}
+
+QList<std::shared_ptr<Tag>> DatabaseManager::getTags(
+    TagLookup &lookup,
     const int64_t id,
-    const QString &tagStr,
-    QList<Tag *> &tags,
-    QObject *parent) const
+    const char *tagStr) const
 {
-    QStringList tagList = tagStr.split(" ");
+    if (tagStr == nullptr || tagStr[0] == '\0')
+    {
+        return {};
+    }
+
+    const QByteArray key = QByteArray::fromRawData(tagStr, qstrlen(tagStr));
+    QHash<QByteArray, QList<std::shared_ptr<Tag>>> &lists = lookup.lists[id];
+    auto it = lists.constFind(key);
+    if (it != lists.constEnd())
+    {
+        return *it;
+    }
+
+    const std::shared_ptr<const TagMap> dictTags = loadTags(lookup, id);
+    const QStringList tagList = QString::fromUtf8(key).split(' ');
 
+    QList<std::shared_ptr<Tag>> tags;
+    tags.reserve(tagList.size());
     for (const QString &tagName : tagList)
     {
         if (tagName.isEmpty())
         {
             continue;
         }
-        const Tag *tag = m_tagCache[id][tagName];
+        std::shared_ptr<Tag> tag = dictTags->value(tagName, nullptr);
         if (tag == nullptr)
         {
             continue;
@@ -808,206 +1835,142 @@ void DatabaseManager::accumulateTags(
         {
             continue;
         }
+        tags.emplaceBack(std::move(tag));
+    }
+    sortTags(tags);
 
-        bool exists = std::any_of(
-            std::begin(tags), std::end(tags),
-            [tag] (const Tag *other) -> bool
-            {
-                return tag->dictionaryInfo()->id() == other->dictionaryInfo()->id() &&
-                    tag->name() == other->name() &&
-                    tag->category() == other->category() &&
-                    tag->notes() == other->notes() &&
-                    tag->order() == other->order() &&
-                    tag->score() == other->score();
-            }
-        );
-        if (exists)
+    /* The key has to own its data once it is stored */
+    lists.insert(QByteArray(tagStr), tags);
+
+    return tags;
+}
+
+void DatabaseManager::accumulateTags(
+    TagLookup &lookup,
+    const int64_t id,
+    const char *tagStr,
+    QList<std::shared_ptr<Tag>> &tags) const
+{
+    const QList<std::shared_ptr<Tag>> newTags = getTags(lookup, id, tagStr);
+    for (const std::shared_ptr<Tag> &tag : newTags)
+    {
+        /* Tags are interned, so equal tags are the same object */
+        if (!tags.contains(tag))
         {
-            continue;
+            tags.emplaceBack(tag);
         }
-
-        tags.emplaceBack(tag->clone(parent));
     }
 }
 
-int DatabaseManager::addFrequencies(Term *term) const
+void DatabaseManager::sortTags(QList<std::shared_ptr<Tag>> &tags)
+{
+    std::stable_sort(
+        std::begin(tags), std::end(tags),
+        [] (const std::shared_ptr<Tag> &lhs, const std::shared_ptr<Tag> &rhs)
+        {
+            return lhs->order() < rhs->order() ||
+                (lhs->order() == rhs->order() && lhs->score() > rhs->score());
+        }
+    );
+}
+
+int DatabaseManager::addFrequencies(Connection &db, Term *term) const
 {
+    MEMENTO_TRACE_SCOPE("DatabaseManager::addFrequencies");
+
     constexpr const char *QUERY =
-        "SELECT dic_id, data, type "
+        "SELECT dic_id, display "
             "FROM term_meta_bank "
             "WHERE dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND "
-                "(expression = ? AND mode = 'freq');";
+                "expression = ?1 AND mode = 'freq' AND "
+                "(reading IS NULL OR reading = ?2);";
 
     int error{0};
     term->setFrequencies(
-        getFrequencies(QUERY, term->expression(), term->reading(), term, &error)
+        getFrequencies(
+            db, QUERY, term->expression(), term->reading(), term, &error
+        )
     );
     return error;
 }
 
-int DatabaseManager::addFrequencies(Kanji *kanji) const
+int DatabaseManager::addFrequencies(Connection &db, Kanji *kanji) const
 {
+    MEMENTO_TRACE_SCOPE("DatabaseManager::addFrequencies");
+
     constexpr const char *QUERY =
-        "SELECT dic_id, data, type "
+        "SELECT dic_id, display "
             "FROM kanji_meta_bank "
             "WHERE dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND "
-                "(expression = ? AND mode = 'freq');";
+                "expression = ?1 AND mode = 'freq' AND "
+                "(reading IS NULL OR reading = ?2);";
 
     int error{0};
     kanji->setFrequencies(
-        getFrequencies(QUERY, kanji->character(), "", kanji, &error)
+        getFrequencies(db, QUERY, kanji->character(), "", kanji, &error)
     );
     return error;
 }
 
 QList<Frequency *> DatabaseManager::getFrequencies(
+    Connection &db,
     const char *query,
     const QString &expression,
     const QString &reading,
     QObject *parent,
     int *error) const
 {
-    constexpr const char *OBJ_READING_KEY = "reading";
-    constexpr const char *OBJ_FREQ_KEY = "frequency";
-    constexpr const char *OBJ_VALUE_KEY = "value";
-    constexpr const char *OBJ_DISPLAY_KEY = "displayValue";
+    constexpr int QUERY_EXPRESSION_IDX = 1;
+    constexpr int QUERY_READING_IDX = 2;
+
+    constexpr int COLUMN_DIC_ID = 0;
+    constexpr int COLUMN_DISPLAY = 1;
 
     int ret = 0;
     sqlite3_stmt *stmt = nullptr;
     int step = 0;
     QByteArray exp = expression.toUtf8();
+    QByteArray read = reading.toUtf8();
     QList<Frequency *> frequencies;
 
-    if (sqlite3_prepare_v2(m_db, query, -1, &stmt, nullptr) != SQLITE_OK)
+    if ((stmt = db.prepare(query)) == nullptr)
     {
         qDebug("Could not prepare frequency query");
         ret = -1;
         goto cleanup;
     }
-    if (sqlite3_bind_text(stmt, 1, exp, -1, nullptr) != SQLITE_OK)
+    if (sqlite3_bind_text(stmt, QUERY_EXPRESSION_IDX, exp,  -1, nullptr) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_READING_IDX,    read, -1, nullptr) != SQLITE_OK)
     {
-        qDebug("Error binding expression to frequency query");
+        qDebug("Error binding values to frequency query");
         ret = -1;
         goto cleanup;
     }
     while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
     {
-        QString freqStr;
-        switch (static_cast<yomi_blob_t>(sqlite3_column_int(stmt, 2)))
+        /* Frequencies without anything to display are skipped */
+        if (sqlite3_column_type(stmt, COLUMN_DISPLAY) == SQLITE_NULL)
         {
-        case YOMI_BLOB_TYPE_STRING:
-            freqStr = reinterpret_cast<const char *>(
-                sqlite3_column_blob(stmt, 1)
-            );
-            break;
-
-        case YOMI_BLOB_TYPE_INT:
-            freqStr = QString::number(
-                *reinterpret_cast<const uint64_t *>(
-                    sqlite3_column_blob(stmt, 1)
-                )
-            );
-            break;
-
-        case YOMI_BLOB_TYPE_OBJECT:
-        {
-            QJsonObject obj = QJsonDocument::fromJson(
-                reinterpret_cast<const char *>(sqlite3_column_blob(stmt, 1))
-            ).object();
-
-            /* Check if this frequency is dependant on reading */
-            if (obj[OBJ_READING_KEY].isString())
-            {
-                if (obj[OBJ_READING_KEY].toString() != reading)
-                {
-                    continue;
-                }
-            }
-
-            /* First scenario:
-             * [
-             *     "<term>","freq",{"reading":"<reading>","frequency":<number>}
-             * ]
-             */
-            if (obj[OBJ_FREQ_KEY].isDouble())
-            {
-                freqStr = QString::number(obj[OBJ_FREQ_KEY].toDouble());
-            }
-
-            /* Second scenario:
-             * [
-             *     "<term>","freq",{"reading":"<reading>","frequency": "<frequency string>">}
-             * ]
-             */
-            else if (obj[OBJ_FREQ_KEY].isString())
-            {
-                freqStr = obj[OBJ_FREQ_KEY].toString();
-            }
-
-            /* Third scenario:
-             * [
-             *     "<term>","freq",
-             *     {"reading":"<reading>",
-             *        "frequency": {"value": <number>, "displayValue": "<stylized frequency string>"}
-             *     }
-             * ]
-             */
-            else if (obj[OBJ_FREQ_KEY].isObject())
-            {
-                obj = obj[OBJ_FREQ_KEY].toObject();
-                /* Check for the type that should be shown */
-                if (obj[OBJ_DISPLAY_KEY].isString())
-                {
-                    freqStr = obj[OBJ_DISPLAY_KEY].toString();
-                }
-                else if (obj[OBJ_VALUE_KEY].isDouble())
-                {
-                    freqStr = QString::number(obj[OBJ_VALUE_KEY].toDouble());
-                }
-                else
-                {
-                    continue;
-                }
-            }
-
-            /* Fourth scenario:
-             * [
-             *      "<term>","freq",
-             *      {
-             *          "value": <number>,
-             *          "displayValue": "<stylized frequency string>"
-             *      }
-             * ]
-             */
-            else if (obj[OBJ_DISPLAY_KEY].isString() ||
-                obj[OBJ_VALUE_KEY].isDouble())
-            {
-                /* Check for the type that should be shown */
-                if (obj[OBJ_DISPLAY_KEY].isString())
-                {
-                    freqStr = obj[OBJ_DISPLAY_KEY].toString();
-                }
-                else if (obj[OBJ_VALUE_KEY].isDouble())
-                {
-                    freqStr = QString::number(obj[OBJ_VALUE_KEY].toDouble());
-                }
-                else
-                {
-                    continue;
-                }
-            }
-            break;
+            continue;
         }
 
-        default:
+        int64_t id = sqlite3_column_int64(stmt, COLUMN_DIC_ID);
+        std::shared_ptr<DictionaryInfo> info = getDictionary(id);
+        if (info == nullptr)
+        {
             continue;
         }
 
-        int64_t id = sqlite3_column_int64(stmt, 0);
+        if (DictionaryCounters *counters = dictionaryCounters(id))
+        {
+            counters->frequencies.fetch_add(1, std::memory_order_relaxed);
+        }
 
         Frequency *f = new Frequency(parent);
-        f->setDictionaryInfo(getDictionary(id)->clone(f));
-        f->setFrequency(freqStr);
+        f->setDictionaryInfo(std::move(info));
+        f->setFrequency(reinterpret_cast<const char *>(
+            sqlite3_column_text(stmt, COLUMN_DISPLAY)
+        ));
         frequencies.emplaceBack(f);
     }
     if (isStepError(step))
@@ -1018,7 +1981,7 @@ QList<Frequency *> DatabaseManager::getFrequencies(
     }
 
 cleanup:
-    sqlite3_finalize(stmt);
+    Connection::finish(stmt);
     if (ret)
     {
         qDeleteAll(frequencies);
@@ -1032,50 +1995,63 @@ cleanup:
     return frequencies;
 }
 
-int DatabaseManager::addPitches(Term *term) const
+int DatabaseManager::addPitches(Connection &db, Term *term) const
 {
+    MEMENTO_TRACE_SCOPE("DatabaseManager::addPitches");
+
     constexpr const char *QUERY =
-        "SELECT dic_id, data "
+        "SELECT dic_id, reading, pitches "
             "FROM term_meta_bank "
             "WHERE dic_id NOT IN (SELECT dic_id FROM dict_disabled) AND "
-                "(expression = ? AND mode = 'pitch');";
+                "expression = ?1 AND mode = 'pitch' AND "
+                "(reading = ?1 OR reading = ?2);";
+
+    constexpr int QUERY_EXPRESSION_IDX = 1;
+    constexpr int QUERY_READING_IDX = 2;
 
-    constexpr const char *OBJ_READING_KEY = "reading";
-    constexpr const char *OBJ_PITCHES_KEY = "pitches";
-    constexpr const char *OBJ_POSITION_KEY = "position";
+    constexpr int COLUMN_DIC_ID = 0;
+    constexpr int COLUMN_READING = 1;
+    constexpr int COLUMN_PITCHES = 2;
 
     int ret = 0;
     sqlite3_stmt *stmt = nullptr;
     int step = 0;
     QByteArray exp = term->expression().toUtf8();
+    QByteArray read = term->reading().toUtf8();
 
-    if (sqlite3_prepare_v2(m_db, QUERY, -1, &stmt, nullptr) != SQLITE_OK)
+    if ((stmt = db.prepare(QUERY)) == nullptr)
     {
         qDebug("Could not prepare pitch query");
         ret = -1;
         goto cleanup;
     }
-    if (sqlite3_bind_text(stmt, 1, exp, -1, nullptr) != SQLITE_OK)
+    if (sqlite3_bind_text(stmt, QUERY_EXPRESSION_IDX, exp,  -1, nullptr) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_READING_IDX,    read, -1, nullptr) != SQLITE_OK)
     {
-        qDebug("Error binding expression to pitch query");
+        qDebug("Error binding values to pitch query");
         ret = -1;
         goto cleanup;
     }
     while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
     {
-        QJsonObject obj = QJsonDocument::fromJson(
-            reinterpret_cast<const char *>(sqlite3_column_blob(stmt, 1))
-        ).object();
-        const QString reading = obj[OBJ_READING_KEY].toString();
-        if (reading != term->reading() && reading != term->expression())
+        const QString reading = reinterpret_cast<const char *>(
+            sqlite3_column_text(stmt, COLUMN_READING)
+        );
+
+        int64_t id = sqlite3_column_int64(stmt, COLUMN_DIC_ID);
+        std::shared_ptr<DictionaryInfo> info = getDictionary(id);
+        if (info == nullptr)
         {
             continue;
         }
 
-        int64_t id = sqlite3_column_int64(stmt, 0);
+        if (DictionaryCounters *counters = dictionaryCounters(id))
+        {
+            counters->pitches.fetch_add(1, std::memory_order_relaxed);
+        }
 
         Pitch *pitch = new Pitch(term);
-        pitch->setDictionaryInfo(getDictionary(id)->clone(pitch));
+        pitch->setDictionaryInfo(std::move(info));
 
         /* Add mora */
         QStringList mora;
@@ -1097,10 +2073,12 @@ int DatabaseManager::addPitches(Term *term) const
 
         /* Add pitch positions */
         QList<int> positions;
-        QJsonArray arr = obj[OBJ_PITCHES_KEY].toArray();
-        for (const QJsonValue &val : arr)
+        const QString pitches = reinterpret_cast<const char *>(
+            sqlite3_column_text(stmt, COLUMN_PITCHES)
+        );
+        for (const QString &position : pitches.split(' ', Qt::SkipEmptyParts))
         {
-            positions.emplaceBack(val.toObject()[OBJ_POSITION_KEY].toInt());
+            positions.emplaceBack(position.toInt());
         }
         pitch->setPositions(positions);
 
@@ -1114,7 +2092,7 @@ int DatabaseManager::addPitches(Term *term) const
     }
 
 cleanup:
-    sqlite3_finalize(stmt);
+    Connection::finish(stmt);
 
     return ret;
 }
@@ -1150,11 +2128,27 @@ QString DatabaseManager::errorCodeToString(const int code) const
         return tr("Could not extract dictionary resources");
     case YOMI_ERR_REMOVING_RESOURCES:
         return tr("Could not remove dictionary resources");
+    case YOMI_ERR_CREATING_DICT_FILE:
+        return tr("Could not create dictionary file");
+    case YOMI_ERR_ATTACHING_DICTIONARIES:
+        return tr("Could not attach dictionary files");
+    case YOMI_ERR_ALREADY_INSTALLED:
+        return tr("Dictionary is already installed");
+    case YOMI_ERR_NOT_INSTALLED:
+        return tr("Dictionary is not installed");
+    case YOMI_ERR_UPDATING_DICTIONARY:
+        return tr("Could not update dictionary");
     default:
         return tr("Unknown error");
     }
 }
 
+QSet<QByteArray> DatabaseManager::termVariants(const QString &query)
+{
+    const QString katakana = query.normalized(QString::NormalizationForm_KC);
+    return {query.toUtf8(), katakana.toUtf8(), kataToHira(katakana).toUtf8()};
+}
+
 QString DatabaseManager::kataToHira(QString query)
 {
     static const QChar KATAKANA_LOW(0x30A1);
@@ -22,13 +22,23 @@
 
 #include <QObject>
 
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QSet>
 #include <QString>
 
 #include <sqlite3.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+
 #include "dict/data/data.h"
+#include "util/latencyhistogram.h"
+
+class QThread;
+class TermIndex;
 
 /**
  * @brief Manages all interaction with the dictionary database on the backend.
@@ -39,8 +49,9 @@ class DatabaseManager : public QObject
 
 public:
     /**
-     * @brief Constructs a database manager with the specified database. Creates
-     * the database if it doesn't already exist.
+     * @brief Constructs a database manager with the specified database. The
+     * database is created or migrated and its caches are built on a
+     * background thread. Queries wait until it is ready.
      *
      * @param dbPath The path to the dictionary database.
      * @param resourcePath Path to the resource directory.
@@ -52,6 +63,24 @@ public:
         QObject *parent = nullptr);
     virtual ~DatabaseManager();
 
+    /**
+     * @brief Get if the database has been opened and its caches built.
+     *
+     * @return true if queries can run without waiting, false otherwise.
+     */
+    [[nodiscard]]
+    bool isReady() const noexcept;
+
+    /**
+     * @brief Blocks until the database has been opened and its caches built.
+     * Returns immediately once the manager is ready. Must not be called from
+     * the UI thread.
+     *
+     * @param cancel Stops waiting when stop is requested.
+     * @return true if the manager is ready, false if waiting was cancelled.
+     */
+    bool waitUntilReady(std::stop_token cancel = {}) const;
+
     /**
      * @brief Get if the database is being modified.
      *
@@ -61,6 +90,105 @@ public:
     [[nodiscard]]
     bool modifyingDatabase() const noexcept;
 
+    /**
+     * @brief Get a counter that changes every time the installed or enabled
+     * dictionaries change. Used to invalidate cached search results.
+     *
+     * @return The current generation of the dictionaries.
+     */
+    [[nodiscard]]
+    uint64_t generation() const noexcept;
+
+    /**
+     * @brief Counters for the prepared statement cache.
+     */
+    struct StatementCacheStats
+    {
+        /* Number of lookups that reused a prepared statement */
+        uint64_t hits;
+
+        /* Number of lookups that had to prepare a statement */
+        uint64_t misses;
+    };
+
+    /**
+     * @brief Get how often queries reused a cached prepared statement since
+     * the manager was created.
+     *
+     * @return The statement cache counters.
+     */
+    [[nodiscard]]
+    StatementCacheStats statementCacheStats() const noexcept;
+
+    /**
+     * @brief How long each kind of query takes.
+     */
+    struct QueryStats
+    {
+        /* Term lookups with the keys they are ranked by, but not their
+         * definitions, frequencies or pitches */
+        LatencyHistogram::Snapshot terms;
+
+        /* Adding frequencies and pitches to a page of terms */
+        LatencyHistogram::Snapshot termMeta;
+
+        /* Kanji lookups */
+        LatencyHistogram::Snapshot kanji;
+    };
+
+    /**
+     * @brief Get how long queries have taken since the manager was created or
+     * resetStats() was called.
+     *
+     * @return The query latencies.
+     */
+    [[nodiscard]]
+    QueryStats queryStats() const noexcept;
+
+    /**
+     * @brief What an installed dictionary contributed to search results.
+     */
+    struct DictionaryCost
+    {
+        /* The ID of the dictionary */
+        int64_t id;
+
+        /* The name of the dictionary */
+        QString name;
+
+        /* true if the dictionary is enabled, false otherwise */
+        bool enabled;
+
+        /* Number of term definitions loaded */
+        uint64_t definitions;
+
+        /* Size of the glossaries of the loaded definitions */
+        uint64_t glossaryBytes;
+
+        /* Number of frequencies loaded */
+        uint64_t frequencies;
+
+        /* Number of pitch accents loaded */
+        uint64_t pitches;
+
+        /* Number of kanji definitions loaded */
+        uint64_t kanji;
+    };
+
+    /**
+     * @brief Get how many rows each installed dictionary added to search
+     * results since the manager was created or resetStats() was called.
+     *
+     * @return The costs of the installed dictionaries.
+     */
+    [[nodiscard]]
+    QList<DictionaryCost> dictionaryCosts() const;
+
+    /**
+     * @brief Clears the query latencies and dictionary costs.
+     */
+    void resetStats();
+
     /**
      * @brief Adds a dictionary to the database.
      *
@@ -102,11 +230,34 @@ public:
      * caller.
      *
      * @param parent The parent of the DictionaryInfos.
-     * @return A list of dictionary metadata.
+     * @return A list of dictionary metadata. Empty until the manager is
+     * ready.
      */
     [[nodiscard]]
     QList<DictionaryInfo *> getDictionaries(QObject *parent = nullptr) const;
 
+    /**
+     * @brief Checks the term indices of enabled dictionaries for a string.
+     * Used to skip queries that cannot match anything without touching the
+     * database. Does automatic conversion from katakana to hiragana.
+     *
+     * @param query The term to look for.
+     * @return true if an enabled dictionary may contain the term, false if
+     * none do or the manager is not ready.
+     */
+    [[nodiscard]]
+    bool hasTerm(const QString &query) const;
+
+    /**
+     * @brief Get the resolver for media belonging to a dictionary.
+     *
+     * @param id The id of the dictionary.
+     * @return The resource resolver of the dictionary. nullptr if the
+     * dictionary does not exist or the manager is not ready.
+     */
+    [[nodiscard]]
+    std::shared_ptr<const DictionaryResources> getResources(int64_t id) const;
+
     /**
      * @brief Searches for terms that exactly match the query. Does automatic
      * conversion from katakana to hiragana.
@@ -122,6 +273,88 @@ public:
         QObject *parent = nullptr,
         QString *error = nullptr) const;
 
+    /**
+     * @brief A term found by queryTermCandidates() before its definitions are
+     * loaded, along with the keys it is filtered and ranked by.
+     */
+    struct TermCandidate
+    {
+        /* The term with its expression, reading and score set. Has no
+         * definitions. */
+        Term *term{nullptr};
+
+        /* The rules of every definition of the term */
+        QSet<QString> rules;
+
+        /* Number of definitions the term has */
+        qsizetype definitions{0};
+    };
+
+    /**
+     * @brief Searches for terms that exactly match any of the queries in a
+     * single pass over the database. Does automatic conversion from katakana
+     * to hiragana.
+     *
+     * Only the keys terms are ranked by are read. Use addTermDefinitions()
+     * and addTermMeta() on the terms that are shown.
+     *
+     * @param queries The terms to query for.
+     * @param parent The parent of the terms.
+     * @param[out] error The reason for failure on error. Empty on success.
+     * @param cancel Aborts the search in the middle of a query when stop is
+     * requested. Cancelled searches report an error.
+     * @return The terms found for each query, in the same order as queries.
+     * Terms belong to the caller. An empty list on error.
+     */
+    [[nodiscard]]
+    QList<QList<TermCandidate>> queryTermCandidates(
+        const QStringList &queries,
+        QObject *parent = nullptr,
+        QString *error = nullptr,
+        std::stop_token cancel = {}) const;
+
+    /**
+     * @brief Adds definitions and term tags to terms returned by
+     * queryTermCandidates().
+     *
+     * @param[out] terms The terms to add definitions to. Must not have any.
+     * @param cancel Aborts the query when stop is requested.
+     * @return 0 on success, nonzero on error or cancellation.
+     */
+    int addTermDefinitions(
+        const QList<Term *> &terms, std::stop_token cancel = {}) const;
+
+    /**
+     * @brief Searches for terms that exactly match any of the queries in a
+     * single pass over the database. Does automatic conversion from katakana
+     * to hiragana.
+     *
+     * Frequencies and pitches are not added. Use addTermMeta() on the terms
+     * that need them.
+     *
+     * @param queries The terms to query for.
+     * @param parent The parent of the terms.
+     * @param[out] error The reason for failure on error. Empty on success.
+     * @param cancel Aborts the search in the middle of a query when stop is
+     * requested. Cancelled searches report an error.
+     * @return A list of the terms found for each query, in the same order as
+     * queries. An empty list on error.
+     */
+    [[nodiscard]]
+    QList<QList<Term *>> queryTerms(
+        const QStringList &queries,
+        QObject *parent = nullptr,
+        QString *error = nullptr,
+        std::stop_token cancel = {}) const;
+
+    /**
+     * @brief Adds frequencies and pitches to terms returned by queryTerms().
+     *
+     * @param[out] terms The terms to add frequencies and pitches to.
+     * @return 0 on success, nonzero if any term could not be completed.
+     */
+    int addTermMeta(const QList<Term *> &terms) const;
+
     /**
      * @brief Searches for kanji that exactly match the query.
      *
@@ -153,19 +386,270 @@ signals:
      */
     void modifyingDatabaseChanged(bool value);
 
+    /**
+     * @brief Emitted once the database has been opened and its caches built.
+     * Emitted on the thread the manager belongs to, so it is never emitted
+     * before the constructor returns.
+     */
+    void ready();
+
 private:
+    /**
+     * @brief An open connection and the statements prepared on it. Statements
+     * are keyed by the address of their query literal.
+     */
+    struct PooledConnection
+    {
+        /* The SQLite connection */
+        sqlite3 *db;
+
+        /* Prepared statements that are reset and reused between queries */
+        QHash<const char *, sqlite3_stmt *> statements;
+    };
+
+    /**
+     * @brief A read-only connection checked out of the connection pool. The
+     * connection goes back to the pool when this is destroyed.
+     */
+    class Connection
+    {
+    public:
+        /**
+         * @brief Check out a connection from the pool, opening a new one if
+         * none are idle.
+         *
+         * @param manager The manager that owns the pool.
+         * @param fresh true to always open a new connection, which sees every
+         * committed dictionary file. It joins the pool once returned.
+         */
+        Connection(const DatabaseManager *manager, bool fresh = false);
+        ~Connection();
+
+        Connection(const Connection &) = delete;
+        Connection &operator=(const Connection &) = delete;
+
+        /**
+         * @brief Get the underlying SQLite connection.
+         *
+         * @return The connection. nullptr if one could not be opened.
+         */
+        [[nodiscard]]
+        sqlite3 *get() const noexcept;
+
+        /**
+         * @brief Get a prepared statement for a query, preparing it on the
+         * first use. The statement stays owned by the connection and must be
+         * passed to finish() instead of sqlite3_finalize().
+         *
+         * @param query The query to prepare. Must be a string literal since
+         * statements are cached by address.
+         * @return The prepared statement. nullptr on error.
+         */
+        [[nodiscard]]
+        sqlite3_stmt *prepare(const char *query);
+
+        /**
+         * @brief Resets a statement returned by prepare() and clears its
+         * bindings so it can be reused.
+         *
+         * @param stmt The statement to reset. Safe if nullptr.
+         */
+        static void finish(sqlite3_stmt *stmt);
+
+        /**
+         * @brief Interrupt statements on this connection once stop is
+         * requested on a token. Removed when the connection is returned.
+         *
+         * @param cancel The token to watch.
+         */
+        void setCancellation(std::stop_token cancel);
+
+        /**
+         * @brief Stop interrupting statements on this connection. Must be
+         * called before statements that have to complete, such as ROLLBACK.
+         */
+        void clearCancellation();
+
+    private:
+        /**
+         * @brief SQLite progress handler that interrupts the running statement
+         * if stop was requested.
+         *
+         * @param cancel A pointer to the std::stop_token to check.
+         * @return Nonzero to interrupt the statement, 0 otherwise.
+         */
+        static int progressHandler(void *cancel);
+
+        /* The manager the connection is returned to */
+        const DatabaseManager *m_manager;
+
+        /* The checked out connection */
+        PooledConnection *m_connection;
+
+        /* The token checked by the progress handler */
+        std::stop_token m_cancel;
+    };
+
+    /**
+     * @brief Take an idle connection from the pool or open a new one with all
+     * dictionary files attached. Use Connection instead of calling directly.
+     *
+     * @return A read-only connection. nullptr on error.
+     */
+    [[nodiscard]]
+    PooledConnection *acquireConnection() const;
+
+    /**
+     * @brief Open a new read-only connection with all dictionary files
+     * attached. Use Connection instead of calling directly.
+     *
+     * @return A read-only connection. nullptr on error.
+     */
+    [[nodiscard]]
+    PooledConnection *openConnection() const;
+
+    /**
+     * @brief Return a connection to the pool. Closes it if the pool is full.
+     *
+     * @param connection The connection to return. Safe if nullptr.
+     */
+    void releaseConnection(PooledConnection *connection) const;
+
+    /**
+     * @brief Finalizes the cached statements of a connection and closes it.
+     *
+     * @param connection The connection to close. Deleted by this call.
+     */
+    static void closeConnection(PooledConnection *connection);
+
+    /**
+     * @brief Closes every idle connection in the pool. Must be called with the
+     * database write lock held so no connections are checked out.
+     */
+    void closeConnections();
+
+    /* Maps tag names to the tags of a dictionary. Shared with search
+     * results. */
+    using TagMap = QHash<QString, std::shared_ptr<Tag>>;
+
+    /**
+     * @brief Tags used by a single query. Lets a query resolve tags without
+     * taking m_tagCacheMutex for every row.
+     */
+    struct TagLookup
+    {
+        /* Maps dictionary IDs to their tags */
+        QHash<int64_t, std::shared_ptr<const TagMap>> maps;
+
+        /* Maps dictionary IDs to the sorted tags of every tag string seen so
+         * far. Tag strings repeat across many terms. */
+        QHash<int64_t, QHash<QByteArray, QList<std::shared_ptr<Tag>>>> lists;
+    };
+
+    /**
+     * @brief Caches built by buildCaches() before they replace the current
+     * ones.
+     */
+    struct Caches
+    {
+        /* Maps dictionary IDs to dictionary information */
+        QHash<int64_t, std::shared_ptr<DictionaryInfo>> dictionaries;
+
+        /* Maps dictionary IDs to their mapped term indices */
+        QHash<int64_t, std::shared_ptr<const TermIndex>> termIndices;
+
+        /* Maps the IDs of dictionaries whose indices were rebuilt next to a
+         * mapped index to the fingerprint they were built from */
+        QHash<int64_t, QByteArray> pendingIndices;
+    };
+
+    /**
+     * @brief Rebuilds the caches after the database was modified, then
+     * reopens connections. Only takes the database write lock to swap in the
+     * new caches. m_writeLock must be held.
+     */
+    void reloadCache();
+
+    /**
+     * @brief Creates or migrates the database and builds the caches, then
+     * marks the manager as ready. Runs on the startup thread.
+     */
+    void initialize();
+
+    /**
+     * @brief Marks the manager as ready and wakes every waiting query.
+     */
+    void setReady();
+
     /**
      * @brief Load dictionary assets into the dictionary info.
      *
+     * @param db The connection to load assets with.
      * @param info The info to load assets into.
      */
-    void loadDictionaryAssets(DictionaryInfo *info) const;
+    void loadDictionaryAssets(Connection &db, DictionaryInfo *info) const;
 
     /**
-     * @brief Initializes the dictionary cache so IDs can be quickly mapped to
-     * DictionaryInfo.
+     * @brief Maps the term index of a dictionary, building it if it is missing
+     * or was built from other contents. m_writeLock must be held.
+     *
+     * @param db The connection to build the index with.
+     * @param id The id of the dictionary.
+     * @param fingerprint The fingerprint from termIndexFingerprint().
+     * @param[out] caches The caches to add the index to.
      */
-    int initCache();
+    void loadTermIndex(
+        Connection &db,
+        int64_t id,
+        const QByteArray &fingerprint,
+        Caches &caches) const;
+
+    /**
+     * @brief Identifies the contents of a dictionary by its revision and the
+     * number of rows and largest rowid of the table holding its terms, so an
+     * index is rebuilt if the terms change without a new revision.
+     *
+     * @param db The connection with every dictionary file attached.
+     * @param id The id of the dictionary.
+     * @param revision The installed revision of the dictionary.
+     * @param hasFile true if the dictionary is stored in its own file.
+     * @return The fingerprint.
+     */
+    [[nodiscard]]
+    QByteArray termIndexFingerprint(
+        Connection &db,
+        int64_t id,
+        const QByteArray &revision,
+        bool hasFile) const;
+
+    /**
+     * @brief Get the path of the term index of a dictionary.
+     *
+     * @param id The id of the dictionary.
+     * @param pending true to get the path an index is rebuilt at while the
+     * previous one is still mapped.
+     * @return The path to the index file. Stored next to the database.
+     */
+    [[nodiscard]]
+    QString termIndexPath(int64_t id, bool pending = false) const;
+
+    /**
+     * @brief Builds the dictionary cache so IDs can be quickly mapped to
+     * DictionaryInfo. Tags are loaded later by loadTags(). Runs without the
+     * database lock. m_writeLock must be held.
+     *
+     * @param[out] caches The caches to fill in.
+     * @return 0 on success, nonzero on error.
+     */
+    int buildCaches(Caches &caches) const;
+
+    /**
+     * @brief Replaces the current caches and closes idle connections. Takes
+     * the database write lock.
+     *
+     * @param caches The caches built by buildCaches().
+     */
+    void applyCaches(Caches caches);
 
     /**
      * @brief Clears the dictionary cache.
@@ -185,74 +669,114 @@ private:
     void setModifyingDatabase(bool value);
 
     /**
-     * @brief Get the dictionary that corresponds to the ID.
+     * @brief Get the dictionary that corresponds to the ID. Dictionaries that
+     * were committed after the cache was built are not found.
      *
      * @param id The id of the dictionary to look for.
      * @return The DictionaryInfo if found, nullptr if not.
      */
     [[nodiscard]]
-    DictionaryInfo *getDictionary(int64_t id) const;
+    std::shared_ptr<DictionaryInfo> getDictionary(int64_t id) const;
+
+    /**
+     * @brief Reads the keys of terms found by queryTermCandidates() without
+     * loading their definitions.
+     *
+     * @param db The connection to query.
+     * @param[out] candidates The terms to add scores, rules and definition
+     * counts to.
+     * @return An SQLite error code on failure.
+     */
+    int addRankingKeys(
+        Connection &db, QList<TermCandidate> &candidates) const;
 
     /**
      * @brief Populates term information for queryTerms.
      *
+     * @param db The connection to query.
      * @param[out] terms A list of Term objects with the expression and reading
      * fields populated.
      * @return An SQLite error code on failure.
      */
-    int populateTerms(const QList<Term *> &terms) const;
+    int populateTerms(Connection &db, const QList<Term *> &terms) const;
+
+    /**
+     * @brief Get the tags of a dictionary, loading them the first time the
+     * dictionary is used. Tags are loaded on their own connection without
+     * holding any lock.
+     *
+     * @param lookup The tags already used by the query.
+     * @param id The id of the dictionary.
+     * @return A map of tag names to tags. Never nullptr. Empty on error.
+     */
+    [[nodiscard]]
+    std::shared_ptr<const TagMap> loadTags(
+        TagLookup &lookup, const int64_t id) const;
 
     /**
-     * @brief Helper method for retrieving tag information.
+     * @brief Helper method for retrieving tag information. Each distinct tag
+     * string of a dictionary is only split and looked up once per query.
      *
+     * @param lookup The tags already used by the query.
      * @param id The id of the dictionary the tag comes from.
-     * @param tagStr The name of the tag.
-     * @param parent The parent of the Tag objects.
-     * @return The list of tags. Belongs to the caller.
+     * @param tagStr A space separated list of tag names. Safe if nullptr.
+     * @return The sorted list of tags. Shared with the lookup and must not be
+     * modified.
      */
     [[nodiscard]]
-    QList<Tag *> getTags(
+    QList<std::shared_ptr<Tag>> getTags(
+        TagLookup &lookup,
         const int64_t id,
-        const QString &tagStr,
-        QObject *parent = nullptr) const;
+        const char *tagStr) const;
 
     /**
      * @brief Helper method for retrieving tag information. Accumulates tags in
-     * an array without duplicates.
+     * an array without duplicates. The array must be sorted with sortTags()
+     * once all tags are accumulated.
      *
+     * @param lookup The tags already used by the query.
      * @param id The ID of the tag dictionary.
-     * @param tagStr The tag string.
+     * @param tagStr A space separated list of tag names. Safe if nullptr.
      * @param[out] tags The list to accumulate to.
-     * @param parent The parent of the Tag objects.
      */
     void accumulateTags(
+        TagLookup &lookup,
         const int64_t id,
-        const QString &tagStr,
-        QList<Tag *> &tags,
-        QObject *parent = nullptr) const;
+        const char *tagStr,
+        QList<std::shared_ptr<Tag>> &tags) const;
+
+    /**
+     * @brief Sorts tags by ascending order, breaking ties on descending score.
+     *
+     * @param[out] tags The tags to sort.
+     */
+    static void sortTags(QList<std::shared_ptr<Tag>> &tags);
 
     /**
      * @brief Adds term frequencies to a Term struct.
      *
+     * @param db The connection to query.
      * @param[out] term The term struct to add frequencies to.
      * @return An SQLite error code on failure.
      */
-    int addFrequencies(Term *term) const;
+    int addFrequencies(Connection &db, Term *term) const;
 
     /**
      * @brief Adds kanji frequencies to a Kanji struct.
      *
+     * @param db The connection to query.
      * @param[out] kanji The kanji struct to add frequencies to.
      * @return An SQLite error code on failure.
      */
-    int addFrequencies(Kanji *kanji) const;
+    int addFrequencies(Connection &db, Kanji *kanji) const;
 
     /**
      * @brief Adds frequencies to a frequency list. Should probably not be
      * called directly.
      *
+     * @param db The connection to query.
      * @param query The sql query to use on the database. Must take
-     * one bind.
+     * one bind. Must be a string literal.
      * @param expression The first sql bind.
      * @param reading The reading of the term if available.
      * @param parent The parent of the frequencies.
@@ -260,6 +784,7 @@ private:
      * @return The frequencies found. Empty on error. Belongs to the caller.
      */
     QList<Frequency *> getFrequencies(
+        Connection &db,
         const char *query,
         const QString &expression,
         const QString &reading = QString(),
@@ -269,11 +794,22 @@ private:
     /**
      * @brief Helper method for adding pitch accents to a Term.
      *
+     * @param db The connection to query.
      * @param[out] term The term to add pitch accents to. Must have the
      * expression field set.
      * @return An SQLite error code on failure.
      */
-    int addPitches(Term *term) const;
+    int addPitches(Connection &db, Term *term) const;
+
+    /**
+     * @brief Get the forms of a query that are looked up in the database.
+     *
+     * @param query The query.
+     * @return The raw, halfwidth normalized and hiragana forms of query encoded
+     * as UTF-8.
+     */
+    [[nodiscard]]
+    static QSet<QByteArray> termVariants(const QString &query);
 
     /**
      * @brief Converts all the katakana in a string to their equivalent
@@ -304,28 +840,99 @@ private:
     [[nodiscard]]
     static bool isStepError(const int step);
 
+    /**
+     * @brief Counts the rows a dictionary added to search results.
+     */
+    struct DictionaryCounters
+    {
+        std::atomic_uint64_t definitions{0};
+        std::atomic_uint64_t glossaryBytes{0};
+        std::atomic_uint64_t frequencies{0};
+        std::atomic_uint64_t pitches{0};
+        std::atomic_uint64_t kanji{0};
+    };
+
+    /**
+     * @brief Get the counters of a dictionary. m_dbLock must be held.
+     *
+     * @param id The ID of the dictionary.
+     * @return The counters of the dictionary. nullptr if it isn't installed.
+     */
+    [[nodiscard]]
+    DictionaryCounters *dictionaryCounters(int64_t id) const;
+
     /* Saved path to the database */
     const QByteArray m_dbPath;
 
     /* Saved path to the resource directory */
     const QString m_resourcePath;
 
-    /* A readonly connection to the dictionary database. */
-    sqlite3 *m_db{nullptr};
+    /* Idle read-only connections to the dictionary database. Searches on
+     * different threads each check out their own connection. */
+    mutable QList<PooledConnection *> m_pool;
+
+    /* Protects m_pool. */
+    mutable QMutex m_poolLock;
 
-    /* Locks the database for reading and writing. */
+    /* Held by readers while they use the caches or a connection. Only taken
+     * for writing while the caches are rebuilt. */
     mutable QReadWriteLock m_dbLock;
 
+    /* Serializes modifications of the database and cache rebuilds. */
+    QMutex m_writeLock;
+
+    /* Number of queries that reused a cached prepared statement */
+    mutable std::atomic_uint64_t m_statementHits{0};
+
+    /* Number of queries that had to prepare a statement */
+    mutable std::atomic_uint64_t m_statementMisses{0};
+
+    /* Time spent in queryTermCandidates() */
+    mutable LatencyHistogram m_termLatency;
+
+    /* Time spent in addTermMeta() */
+    mutable LatencyHistogram m_termMetaLatency;
+
+    /* Time spent in queryKanji() */
+    mutable LatencyHistogram m_kanjiLatency;
+
+    /* Maps dictionary IDs to their counters. Entries outlive cache rebuilds
+     * so enabling and disabling a dictionary keeps its counts. */
+    QHash<int64_t, std::shared_ptr<DictionaryCounters>> m_dictionaryCounters;
+
     /* A set containing special characters that cannot be independent mora. */
     QSet<QString> m_moraSkipChar;
 
-    /* Maps dictionary IDs to dictionary names. Must be deleted manually. */
-    QHash<int64_t, DictionaryInfo *> m_dictionaryCache;
+    /* Maps dictionary IDs to dictionary names. Shared with search results. */
+    QHash<int64_t, std::shared_ptr<DictionaryInfo>> m_dictionaryCache;
+
+    /* Maps dictionary IDs to their mapped term indices */
+    QHash<int64_t, std::shared_ptr<const TermIndex>> m_termIndices;
 
-    /* Maps dictionary IDs to a mapping between tag names and Tag structs.
-     * Must be deleted manually. */
-    QHash<int64_t, QHash<QString, Tag *>> m_tagCache;
+    /* Maps dictionary IDs to their tags. Filled in by loadTags() the first
+     * time a dictionary is used. Maps are never modified once published. */
+    mutable QHash<int64_t, std::shared_ptr<const TagMap>> m_tagCache;
+
+    /* Guards m_tagCache, which is filled in by concurrent queries. Only held
+     * to find or publish a map. */
+    mutable QMutex m_tagCacheMutex;
+
+    /* Incremented every time the caches are rebuilt */
+    std::atomic_uint64_t m_generation{0};
 
     /* true if the database is being modified, false otherwise */
     std::atomic_bool m_modifyingDatabase{false};
+
+    /* Opens the database without blocking the thread that created the
+     * manager. nullptr once finished and joined. */
+    QThread *m_startupThread{nullptr};
+
+    /* true once the database is open and the caches are built */
+    std::atomic_bool m_ready{false};
+
+    /* Guards waiting on m_ready */
+    mutable std::mutex m_readyMutex;
+
+    /* Signaled when m_ready is set. Waits also wake on stop requests. */
+    mutable std::condition_variable_any m_readyCondition;
 };
@@ -20,9 +20,7 @@
 
 #include "dict/deconjugationquerygenerator.h"
 
-#include <QList>
-
-#include "dict/deconjugator.h"
+#include "util/tracing.h"
 #include "util/utils.h"
 
 /* Begin Query Generator */
@@ -49,12 +47,61 @@ static QString convertWordformToRule(WordForm wordform)
 std::vector<SearchQuery> DeconjugationQueryGenerator::generateQueries(
     const QString &text) const
 {
+    MEMENTO_TRACE_SCOPE("DeconjugationQueryGenerator::generateQueries");
+
     if (text.isEmpty())
     {
         return {};
     }
 
-    QList<ConjugationInfo> deconjQueries = deconjugate(text);
+    /* Same spans as deconjugate() in sentence mode, each looked up once per
+     * line */
+    const QStringList spans = deconjugationSpans(text);
+    QList<QList<ConjugationInfo>> spanQueries(spans.size());
+    QList<qsizetype> misses;
+    {
+        QMutexLocker lock{&m_memoMutex};
+        updateMemoLine(text);
+        for (qsizetype i = 0; i < spans.size(); ++i)
+        {
+            auto it = m_memo.constFind(spans[i]);
+            if (it == m_memo.constEnd())
+            {
+                misses.append(i);
+            }
+            else
+            {
+                spanQueries[i] = *it;
+            }
+        }
+    }
+
+    /* Misses are computed without the lock so other searches aren't held up
+     * by them */
+    for (const qsizetype i : misses)
+    {
+        spanQueries[i] = deconjugate(spans[i], false);
+    }
+    if (!misses.isEmpty())
+    {
+        QMutexLocker lock{&m_memoMutex};
+
+        /* The memo may have moved on to another line in the meantime */
+        if (m_memoLine.contains(text))
+        {
+            for (const qsizetype i : misses)
+            {
+                m_memo.insert(spans[i], spanQueries[i]);
+            }
+        }
+    }
+
+    QList<ConjugationInfo> deconjQueries;
+    for (const QList<ConjugationInfo> &queries : spanQueries)
+    {
+        deconjQueries.append(queries);
+    }
+
     std::vector<SearchQuery> result;
     for (ConjugationInfo &info : deconjQueries)
     {
@@ -92,3 +139,20 @@ std::vector<SearchQuery> DeconjugationQueryGenerator::generateQueries(
 }
 
 /* End Query Generator */
+/* Begin Memo Helpers */
+
+void DeconjugationQueryGenerator::updateMemoLine(const QString &text) const
+{
+    /* Hovering along a line gives texts that are part of each other */
+    if (m_memoLine.contains(text))
+    {
+        return;
+    }
+    else if (!text.contains(m_memoLine))
+    {
+        m_memo.clear();
+    }
+    m_memoLine = text;
+}
+
+/* End Memo Helpers */
@@ -22,6 +22,13 @@
 
 #include "dict/querygenerator.h"
 
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+#include "dict/deconjugator.h"
+
 /**
  * @brief Query generator that uses look up tables to deconjugate phrases.
  */
@@ -51,4 +58,22 @@ public:
     [[nodiscard]]
     std::vector<SearchQuery> generateQueries(
         const QString &text) const override;
+
+private:
+    /**
+     * @brief Clears the memo if text is not part of the line it was built
+     * for. Must be called with m_memoMutex held.
+     *
+     * @param text The text queries are being generated for.
+     */
+    void updateMemoLine(const QString &text) const;
+
+    /* Guards the memo since generators are shared between searches */
+    mutable QMutex m_memoMutex;
+
+    /* The longest text seen from the current line */
+    mutable QString m_memoLine;
+
+    /* Maps spans of the current line to their deconjugations */
+    mutable QHash<QString, QList<ConjugationInfo>> m_memo;
 };
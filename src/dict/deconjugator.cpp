@@ -21,12 +21,16 @@
 #include "dict/deconjugator.h"
 
 #include <QCoreApplication>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QPair>
 #include <QRegularExpression>
 #include <QStack>
 #include <QString>
+#include <QVarLengthArray>
+
+#include <algorithm>
 
 struct Rule
 {
@@ -563,7 +567,170 @@ static bool isTerminalForm(WordForm wordForm)
         wordForm == WordForm::adjective;
 }
 
-static ConjugationInfo createDerivation(
+/**
+ * @brief A node in a trie of the conjugated suffixes of rules. Edges are
+ * followed from the last character of a word towards the first.
+ */
+struct SuffixNode
+{
+    /* Maps the next character from the end of a word to a child node */
+    QHash<char16_t, qsizetype> children;
+
+    /* Indices of the rules whose conjugated suffix ends at this node */
+    QList<qsizetype> rules;
+};
+
+/**
+ * @brief Compiles the conjugated suffixes of rules into a trie.
+ *
+ * @return The nodes of the trie. The first node is the root.
+ */
+static QList<SuffixNode> buildSuffixTrie()
+{
+    QList<SuffixNode> nodes(1);
+    for (qsizetype i = 0; i < rules.size(); ++i)
+    {
+        const QString &suffix = rules[i].conjugated;
+        qsizetype node = 0;
+        for (auto it = suffix.crbegin(); it != suffix.crend(); ++it)
+        {
+            auto child = nodes[node].children.constFind(it->unicode());
+            if (child == nodes[node].children.constEnd())
+            {
+                nodes[node].children.insert(it->unicode(), nodes.size());
+                node = nodes.size();
+                nodes.emplaceBack();
+            }
+            else
+            {
+                node = *child;
+            }
+        }
+        nodes[node].rules.emplaceBack(i);
+    }
+    return nodes;
+}
+
+/**
+ * @brief The state of a deconjugation shared by every level of recursion.
+ * Children modify it in place and restore it before returning, so trying a
+ * rule does not copy the word or its derivations.
+ */
+struct DeconjugationState
+{
+    /* The original conjugated form */
+    QString conjugated;
+
+    /* The current candidate base form */
+    QString word;
+
+    /* Derivations with the most recent last, reversed from
+     * ConjugationInfo::derivations */
+    QVarLengthArray<WordForm, 16> derivations;
+};
+
+/**
+ * @brief Adds the current state of a deconjugation to the results.
+ *
+ * @param state The state to add.
+ * @param[out] results The list to add to.
+ */
+static void addResult(
+    const DeconjugationState &state,
+    QList<ConjugationInfo> &results)
+{
+    QList<WordForm> derivations(
+        state.derivations.crbegin(), state.derivations.crend()
+    );
+    results.emplace_back(ConjugationInfo{
+        state.word, state.conjugated, std::move(derivations), ""
+    });
+}
+
+static void deconjugateRecursive(
+    DeconjugationState &state,
+    QList<ConjugationInfo> &results)
+{
+    static const QList<SuffixNode> trie = buildSuffixTrie();
+
+    /* Find every rule whose conjugated form is a suffix of the word */
+    QVarLengthArray<qsizetype, 64> matches;
+    qsizetype node = 0;
+    for (qsizetype i = state.word.size(); ; --i)
+    {
+        matches.append(
+            trie[node].rules.constData(), trie[node].rules.size()
+        );
+        if (i == 0)
+        {
+            break;
+        }
+        auto child = trie[node].children.constFind(state.word[i - 1].unicode());
+        if (child == trie[node].children.constEnd())
+        {
+            break;
+        }
+        node = *child;
+    }
+    /* Visit rules in the order they are listed */
+    std::sort(matches.begin(), matches.end());
+
+    const WordForm currentWordForm = state.derivations.isEmpty() ?
+        WordForm::any :
+        state.derivations.back();
+    for (qsizetype match : matches)
+    {
+        const Rule &rule = rules[match];
+        if (rule.conjugatedType != currentWordForm &&
+            currentWordForm != WordForm::any)
+        {
+            continue;
+        }
+
+        /* Apply the rule */
+        const qsizetype pushed = state.derivations.isEmpty() ? 2 : 1;
+        if (state.derivations.isEmpty())
+        {
+            state.derivations.append(rule.conjugatedType);
+        }
+        state.derivations.append(rule.baseType);
+        state.word.chop(rule.conjugated.size());
+        state.word.append(rule.base);
+
+        if (isTerminalForm(rule.baseType))
+        {
+            addResult(state, results);
+            for (const Rule &silentRule : silentRules)
+            {
+                if (silentRule.conjugatedType != rule.baseType)
+                {
+                    continue;
+                }
+                if (!state.word.endsWith(silentRule.base))
+                {
+                    continue;
+                }
+                state.derivations.back() = silentRule.baseType;
+                deconjugateRecursive(state, results);
+            }
+            state.derivations.back() = rule.baseType;
+        }
+        else
+        {
+            deconjugateRecursive(state, results);
+        }
+
+        /* Undo the rule */
+        state.word.chop(rule.base.size());
+        state.word.append(rule.conjugated);
+        state.derivations.resize(state.derivations.size() - pushed);
+    }
+}
+
+#ifdef MEMENTO_BENCHMARKS
+/* Begin Reference Implementation */
+
+static ConjugationInfo createReferenceDerivation(
     const ConjugationInfo &parent,
     const Rule &rule)
 {
@@ -585,7 +752,12 @@ static ConjugationInfo createDerivation(
     return childDetails;
 }
 
-static void deconjugateRecursive(
+/**
+ * @brief The original traversal that tests every rule with endsWith() and
+ * copies the ConjugationInfo for every candidate. Kept so the benchmarks can
+ * check the trie against it.
+ */
+static void deconjugateReferenceRecursive(
     const ConjugationInfo &info,
     QList<ConjugationInfo> &results)
 {
@@ -604,7 +776,7 @@ static void deconjugateRecursive(
         {
             continue;
         }
-        ConjugationInfo childDetails = createDerivation(info, rule);
+        ConjugationInfo childDetails = createReferenceDerivation(info, rule);
         if (isTerminalForm(rule.baseType))
         {
             results.emplace_back(childDetails);
@@ -624,20 +796,23 @@ static void deconjugateRecursive(
                     silentRule.baseType,
                     rule.conjugatedType
                 };
-                ConjugationInfo derivedDetails = createDerivation(
+                ConjugationInfo derivedDetails = createReferenceDerivation(
                     info,
                     derivedRule
                 );
-                deconjugateRecursive(derivedDetails, results);
+                deconjugateReferenceRecursive(derivedDetails, results);
             }
         }
         else
         {
-            deconjugateRecursive(childDetails, results);
+            deconjugateReferenceRecursive(childDetails, results);
         }
     }
 }
 
+/* End Reference Implementation */
+#endif // MEMENTO_BENCHMARKS
+
 static QString formatDerivation(QList<WordForm> derivations)
 {
     QString result;
@@ -675,39 +850,69 @@ static QString formatDerivation(QList<WordForm> derivations)
     return result;
 }
 
-QList<ConjugationInfo> deconjugate(const QString query, bool sentenceMode)
+static const QRegularExpression WHITESPACE_REGEX("\\s");
+
+QStringList deconjugationSpans(const QString &query)
 {
-    static const QRegularExpression WHITESPACE_REGEX("\\s");
+    QStringList spans;
+    QString conjugated = query;
+    while (!conjugated.isEmpty())
+    {
+        spans.append(conjugated);
+        do
+        {
+            conjugated.chop(1);
+        }
+        while (
+            !conjugated.isEmpty() &&
+            WHITESPACE_REGEX.match(conjugated.back()).hasMatch()
+        );
+    }
+    return spans;
+}
 
+QList<ConjugationInfo> deconjugate(const QString query, bool sentenceMode)
+{
     QList<ConjugationInfo> results;
     if (sentenceMode)
     {
-        QString conjugated = query;
-        while (!conjugated.isEmpty())
+        for (const QString &conjugated : deconjugationSpans(query))
         {
-            QString word = conjugated;
-            word.remove(WHITESPACE_REGEX);
-            ConjugationInfo detail = {
-                word, conjugated, QList<WordForm>(), ""
-            };
-            deconjugateRecursive(detail, results);
-            do
-            {
-                conjugated.chop(1);
-            }
-            while (
-                !conjugated.isEmpty() &&
-                WHITESPACE_REGEX.match(conjugated.back()).hasMatch()
-            );
-
+            DeconjugationState state{conjugated, conjugated, {}};
+            state.word.remove(WHITESPACE_REGEX);
+            deconjugateRecursive(state, results);
         }
     }
     else
     {
-        QString word = query;
+        DeconjugationState state{query, query, {}};
+        state.word.remove(WHITESPACE_REGEX);
+        deconjugateRecursive(state, results);
+    }
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        results[i].derivationDisplay = formatDerivation(results[i].derivations);
+    }
+
+    return results;
+}
+
+#ifdef MEMENTO_BENCHMARKS
+QList<ConjugationInfo> deconjugateReference(
+    const QString query, bool sentenceMode)
+{
+    QList<ConjugationInfo> results;
+    const QStringList spans =
+        sentenceMode ? deconjugationSpans(query) : QStringList{query};
+    for (const QString &conjugated : spans)
+    {
+        QString word = conjugated;
         word.remove(WHITESPACE_REGEX);
-        ConjugationInfo detail = { word, query, QList<WordForm>(), ""};
-        deconjugateRecursive(detail, results);
+        ConjugationInfo detail = {
+            word, conjugated, QList<WordForm>(), ""
+        };
+        deconjugateReferenceRecursive(detail, results);
     }
 
     for (int i = 0; i < results.size(); i++)
@@ -717,3 +922,4 @@ QList<ConjugationInfo> deconjugate(const QString query, bool sentenceMode)
 
     return results;
 }
+#endif // MEMENTO_BENCHMARKS
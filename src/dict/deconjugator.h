@@ -21,6 +21,7 @@
 #pragma once
 
 #include <QString>
+#include <QStringList>
 #include <QList>
 
 /**
@@ -102,3 +103,29 @@ struct ConjugationInfo
  */
 QList<ConjugationInfo> deconjugate(
     QString query, bool sentenceMode = true);
+
+/**
+ * @brief Get the spans of a query that sentence mode deconjugates. Each span
+ * drops the last character of the one before it along with any whitespace
+ * this leaves at its end.
+ *
+ * @param query The query to trim.
+ * @return The spans from longest to shortest, starting with query.
+ */
+QStringList deconjugationSpans(const QString &query);
+
+#ifdef MEMENTO_BENCHMARKS
+/**
+ * @brief Deconjugates a word by testing every rule against it at each step.
+ * This is the implementation deconjugate() replaced. It is only built for
+ * the benchmarks, which compare its results and speed against deconjugate().
+ *
+ * @param query The query to attempt to deconjugate
+ * @param sentenceMode If enabled, treats the query as a sentence and will find
+ * potential words by trimming the query
+ * @return A list of all the potential deconjugations found, in the same order
+ * as deconjugate()
+ */
+QList<ConjugationInfo> deconjugateReference(
+    QString query, bool sentenceMode = true);
+#endif // MEMENTO_BENCHMARKS
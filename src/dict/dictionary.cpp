@@ -38,13 +38,19 @@ Dictionary::~Dictionary()
 }
 
 void Dictionary::createDatabaseInstance()
+{
+    createDatabaseInstance(
+        DirectoryUtils::getDictionaryDb(),
+        DirectoryUtils::getDictionaryResourceDir()
+    );
+}
+
+void Dictionary::createDatabaseInstance(
+    const QString &dbPath, const QString &resourcePath)
 {
     if (m_db == nullptr)
     {
-        m_db = new DatabaseManager(
-            DirectoryUtils::getDictionaryDb(),
-            DirectoryUtils::getDictionaryResourceDir()
-        );
+        m_db = new DatabaseManager(dbPath, resourcePath);
     }
 }
 
@@ -54,6 +60,25 @@ void Dictionary::destroyDatabaseInstance()
     m_db = nullptr;
 }
 
+#ifdef MEMENTO_BENCHMARKS
+void Dictionary::waitForDatabaseInstance()
+{
+    if (m_db != nullptr)
+    {
+        m_db->waitUntilReady();
+    }
+}
+#endif // MEMENTO_BENCHMARKS
+
+std::shared_ptr<const DictionaryResources> Dictionary::resources(int64_t id)
+{
+    if (m_db == nullptr)
+    {
+        return nullptr;
+    }
+    return m_db->getResources(id);
+}
+
 bool Dictionary::modifyingDatabase() const noexcept
 {
     return m_modifyingDatabase;
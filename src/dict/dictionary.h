@@ -46,11 +46,39 @@ public:
      */
     static void createDatabaseInstance();
 
+    /**
+     * @brief Create the static database instance from a database outside of
+     * the config directory.
+     *
+     * @param dbPath The path to the dictionary database.
+     * @param resourcePath Path to the resource directory.
+     */
+    static void createDatabaseInstance(
+        const QString &dbPath, const QString &resourcePath);
+
     /**
      * @brief Destroy the static database instance.
      */
     static void destroyDatabaseInstance();
 
+#ifdef MEMENTO_BENCHMARKS
+    /**
+     * @brief Blocks until the static database instance has finished opening.
+     * Returns immediately if there is no instance.
+     */
+    static void waitForDatabaseInstance();
+#endif // MEMENTO_BENCHMARKS
+
+    /**
+     * @brief Get the resolver for media belonging to a dictionary.
+     *
+     * @param id The id of the dictionary.
+     * @return The resource resolver of the dictionary. nullptr if the
+     * dictionary or the database instance does not exist.
+     */
+    [[nodiscard]]
+    static std::shared_ptr<const DictionaryResources> resources(int64_t id);
+
     /**
      * @brief Get if the database is being modified.
      *
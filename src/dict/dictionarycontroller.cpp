@@ -45,7 +45,15 @@ DictionaryController::DictionaryController(
         }
     }
 
-    updateDictionaries();
+    connect(
+        m_db, &DatabaseManager::ready,
+        this, &DictionaryController::updateDictionaries,
+        Qt::QueuedConnection
+    );
+    if (m_db->isReady())
+    {
+        updateDictionaries();
+    }
 }
 
 DictionaryController::~DictionaryController()
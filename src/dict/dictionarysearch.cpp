@@ -20,6 +20,8 @@
 
 #include "dict/dictionarysearch.h"
 
+#include <QPointer>
+
 #include "dict/dictionarysearchcontroller.h"
 
 /* Begin Constructor/Destructor */
@@ -48,9 +50,13 @@ QCoro::Task<void> DictionarySearch::searchTermsAsync(
 {
     QPointer<DictionarySearch> dictionarySearch{this};
     const quint64 termsSearchId = ++m_termsSearchId;
+    m_termsStopSource.request_stop();
+    m_termsStopSource = std::stop_source{};
 
     QList<Term *> terms = co_await DictionarySearchController::instance()
-        ->searchTermsAsync(query, text, index);
+        ->searchTermsAsync(
+            query, text, index, m_termsStopSource.get_token()
+        );
 
     /* Make sure this object hasn't been deleted and the search isn't stale */
     if (dictionarySearch == nullptr || termsSearchId != m_termsSearchId)
@@ -66,6 +72,10 @@ QCoro::Task<void> DictionarySearch::searchTermsAsync(
     }
 
     std::swap(m_terms, terms);
+    m_termsLoaded = std::min(
+        m_terms.size(), DictionarySearchController::TERM_PAGE_SIZE
+    );
+    m_termsRequested = 0;
     emit termsChanged();
 
     for (Term *term : terms)
@@ -75,6 +85,61 @@ QCoro::Task<void> DictionarySearch::searchTermsAsync(
     terms.clear();
 }
 
+void DictionarySearch::loadTerms(qsizetype index)
+{
+    if (index < m_termsLoaded || index >= m_terms.size())
+    {
+        return;
+    }
+    m_termsRequested = std::max(m_termsRequested, index);
+    if (!m_loadingTerms)
+    {
+        loadTermsAsync();
+    }
+}
+
+QCoro::Task<void> DictionarySearch::loadTermsAsync()
+{
+    QPointer<DictionarySearch> dictionarySearch{this};
+    m_loadingTerms = true;
+
+    while (m_termsLoaded <= m_termsRequested && m_termsLoaded < m_terms.size())
+    {
+        const quint64 termsSearchId = m_termsSearchId;
+
+        /* Round up to whole pages so scrolling doesn't load a term at a
+         * time */
+        const qsizetype end = std::min(
+            m_terms.size(),
+            m_termsRequested - m_termsRequested %
+                DictionarySearchController::TERM_PAGE_SIZE +
+                DictionarySearchController::TERM_PAGE_SIZE
+        );
+        QList<QPointer<Term>> terms;
+        terms.reserve(end - m_termsLoaded);
+        for (qsizetype i = m_termsLoaded; i < end; ++i)
+        {
+            terms.emplaceBack(m_terms[i]);
+        }
+
+        co_await DictionarySearchController::instance()
+            ->loadTermDetailsAsync(std::move(terms));
+
+        if (dictionarySearch == nullptr)
+        {
+            co_return;
+        }
+        /* Start over on the results of a newer search */
+        if (termsSearchId != m_termsSearchId)
+        {
+            continue;
+        }
+        m_termsLoaded = end;
+    }
+
+    m_loadingTerms = false;
+}
+
 void DictionarySearch::searchKanji(
     const QString &character, const QString &text, qsizetype index)
 {
@@ -126,11 +191,14 @@ void DictionarySearch::clearResults()
 void DictionarySearch::clearTerms()
 {
     ++m_termsSearchId;
+    m_termsStopSource.request_stop();
     clearTermsLater();
 }
 
 void DictionarySearch::clearTermsLater()
 {
+    m_termsLoaded = 0;
+    m_termsRequested = 0;
     if (m_terms.isEmpty())
     {
         return;
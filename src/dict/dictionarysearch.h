@@ -24,6 +24,8 @@
 
 #include <QQmlListProperty>
 
+#include <stop_token>
+
 #ifdef MEMENTO_SYSTEM_QCORO
 #include <QCoroTask>
 #else
@@ -77,6 +79,15 @@ public:
     Q_INVOKABLE void searchKanji(
         const QString &query, const QString &text, qsizetype index);
 
+    /**
+     * @brief Makes sure a term has its definitions, frequencies and pitches.
+     * Terms past the first page of results are completed a page at a time
+     * once they are about to be shown.
+     *
+     * @param index The index of the term in the terms property.
+     */
+    Q_INVOKABLE void loadTerms(qsizetype index);
+
     /**
      * @brief Clears the result of the last search.
      */
@@ -143,6 +154,14 @@ private:
     QCoro::Task<void> searchKanjiAsync(
         const QString &character, const QString &text, qsizetype index);
 
+    /**
+     * @brief Completes the next pages of terms up to and including the term
+     * at m_termsRequested.
+     *
+     * @return An awaitable task.
+     */
+    QCoro::Task<void> loadTermsAsync();
+
     /**
      * @brief Clears term results and schedules existing objects for deletion.
      */
@@ -158,9 +177,21 @@ private:
     quint64 m_termsSearchId{0};
     quint64 m_kanjiSearchId{0};
 
+    /* Cancels the outstanding term search when a new one starts */
+    std::stop_source m_termsStopSource;
+
     /* The terms of the last search */
     QList<Term *> m_terms;
 
+    /* The number of terms at the start of m_terms that are complete */
+    qsizetype m_termsLoaded{0};
+
+    /* The index of the furthest term that has been asked for */
+    qsizetype m_termsRequested{0};
+
+    /* true while a page of terms is being completed */
+    bool m_loadingTerms{false};
+
     /* The kanji of the last search */
     Kanji *m_kanji{nullptr};
 };
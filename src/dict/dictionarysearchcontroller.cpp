@@ -33,6 +33,7 @@
 #ifdef MEMENTO_MECAB_SUPPORT
 #include "dict/mecabquerygenerator.h"
 #endif // MEMENTO_MECAB_SUPPORT
+#include "util/tracing.h"
 
 /* Begin Constructor/Destructor */
 
@@ -108,7 +109,7 @@ void DictionarySearchController::destroyInstance()
 /* Begin Search Methods */
 
 QCoro::Task<QList<Term *>> DictionarySearchController::searchTermsAsync(
-    QString query, QString text, qsizetype index)
+    QString query, QString text, qsizetype index, std::stop_token cancel)
 {
     std::optional<SearchGuard> searchGuard = acquireSearchGuard();
     if (!searchGuard)
@@ -122,10 +123,13 @@ QCoro::Task<QList<Term *>> DictionarySearchController::searchTermsAsync(
             guard = std::move(*searchGuard),
             query = std::move(query),
             text = std::move(text),
-            index
+            index,
+            cancel = std::move(cancel)
         ] () mutable
         {
-            return searchTermsSync(std::move(query), std::move(text), index);
+            return searchTermsSync(
+                std::move(query), std::move(text), index, std::move(cancel)
+            );
         }
     );
     if (!terms.isEmpty() && m_settings != nullptr)
@@ -137,65 +141,167 @@ QCoro::Task<QList<Term *>> DictionarySearchController::searchTermsAsync(
 }
 
 QList<Term *> DictionarySearchController::searchTermsSync(
-    QString query, QString text, qsizetype index)
+    QString query, QString text, qsizetype index, std::stop_token cancel)
 {
+    MEMENTO_TRACE_SCOPE("DictionarySearchController::searchTermsSync");
+
     if (m_shuttingDown)
     {
         return {};
     }
+    /* The search may have been superseded while waiting for a thread */
+    if (cancel.stop_requested())
+    {
+        ++m_cancelledSearches;
+        return {};
+    }
+    const LatencyHistogram::Timer latency{m_termSearchLatency};
+
+    std::optional<QList<Term *>> cached = takeCachedTerms(query, text, index);
+    if (cached)
+    {
+        ++m_searchCacheHits;
+        return std::move(*cached);
+    }
+    ++m_searchCacheMisses;
+
+    /* Read before searching so results that raced a change are stale */
+    const uint64_t dbGeneration = m_db->generation();
+    const uint64_t settingsGeneration = m_settingsGeneration;
+
+    QList<Term *> terms = searchTermsUncached(query, text, index, cancel);
+    if (cancel.stop_requested())
+    {
+        ++m_cancelledSearches;
+        qDeleteAll(terms);
+        return {};
+    }
+    if (!m_shuttingDown)
+    {
+        cacheTerms(query, dbGeneration, settingsGeneration, terms);
+    }
+
+    for (Term *term : terms)
+    {
+        term->moveToThread(thread());
+    }
+
+    return terms;
+}
 
+QList<Term *> DictionarySearchController::searchTermsUncached(
+    const QString &query,
+    const QString &text,
+    qsizetype index,
+    const std::stop_token &cancel)
+{
     std::vector<SearchQuery> queries = generateQueries(query);
 
     sortQueries(queries);
     filterDuplicates(queries);
 
-    /* Query the database */
+    /* hasTerm() doesn't wait for the database to open */
+    if (!m_db->waitUntilReady(cancel))
+    {
+        return {};
+    }
+
+    /* Skip queries no dictionary has an entry for */
+    std::erase_if(
+        queries,
+        [this] (const SearchQuery &query) -> bool
+        {
+            return !m_db->hasTerm(query.deconj);
+        }
+    );
+
+    /* Look up every distinct query string at once */
+    QStringList candidates;
+    QHash<QString, qsizetype> candidateIndex;
+    QList<qsizetype> candidateUses;
+    for (const SearchQuery &query : queries)
+    {
+        auto it = candidateIndex.constFind(query.deconj);
+        if (it == candidateIndex.constEnd())
+        {
+            it = candidateIndex.insert(query.deconj, candidates.size());
+            candidates.emplaceBack(query.deconj);
+            candidateUses.emplaceBack(0);
+        }
+        ++candidateUses[*it];
+    }
+
+    const auto deleteCandidates =
+        [] (QList<QList<DatabaseManager::TermCandidate>> &groups)
+        {
+            for (const auto &group : groups)
+            {
+                for (const DatabaseManager::TermCandidate &candidate : group)
+                {
+                    delete candidate.term;
+                }
+            }
+            groups.clear();
+        };
+
+    QString err;
+    QList<QList<DatabaseManager::TermCandidate>> candidateResults =
+        m_db->queryTermCandidates(candidates, nullptr, &err, cancel);
+    if (cancel.stop_requested())
+    {
+        deleteCandidates(candidateResults);
+        return {};
+    }
+    if (!err.isEmpty())
+    {
+        qWarning("Could not complete query: %s", qUtf8Printable(err));
+        return {};
+    }
+
     QList<Term *> terms;
     for (const SearchQuery &query : queries)
     {
-        if (m_shuttingDown)
+        if (m_shuttingDown || cancel.stop_requested())
         {
             qDeleteAll(terms);
             terms.clear();
+            deleteCandidates(candidateResults);
             return {};
         }
 
-        QString err;
-        QList<Term *> results = m_db->queryTerms(query.deconj, nullptr, &err);
-        if (!err.isEmpty())
+        /* Queries sharing a string get copies until the last one takes the
+         * originals */
+        const qsizetype candidate = candidateIndex.value(query.deconj);
+        QList<DatabaseManager::TermCandidate> matches;
+        if (--candidateUses[candidate] == 0)
         {
-            qDeleteAll(results);
-            results.clear();
-            qWarning("Could not complete query: %s", qUtf8Printable(err));
-            return {};
+            matches = std::exchange(candidateResults[candidate], {});
         }
-        if (query.ruleFilter.size() > 0)
+        else
         {
-            QList<Term *> filtered;
-            for (Term *term : results)
+            for (const DatabaseManager::TermCandidate &match :
+                    candidateResults[candidate])
             {
-                bool keep = false;
-                for (const TermDefinition *def : term->definitions())
-                {
-                    QSet<QString> rules{
-                        std::begin(def->rules()), std::end(def->rules())
-                    };
-                    if (rules.intersects(query.ruleFilter))
-                    {
-                        keep = true;
-                        break;
-                    }
-                }
-                if (keep)
-                {
-                    filtered.emplaceBack(term);
-                }
-                else
-                {
-                    delete term;
-                }
+                matches.emplaceBack(DatabaseManager::TermCandidate{
+                    .term = match.term->clone(),
+                    .rules = match.rules,
+                    .definitions = match.definitions,
+                });
+            }
+        }
+
+        QList<Term *> results;
+        for (const DatabaseManager::TermCandidate &match : matches)
+        {
+            if (query.ruleFilter.isEmpty() ||
+                match.rules.intersects(query.ruleFilter))
+            {
+                results.emplaceBack(match.term);
+            }
+            else
+            {
+                delete match.term;
             }
-            results = std::move(filtered);
         }
 
         QString clozePrefix;
@@ -221,14 +327,153 @@ QList<Term *> DictionarySearchController::searchTermsSync(
         terms.append(std::move(results));
     }
 
+    /* Ranking only needs the keys read with the candidates, so only the
+     * first page is completed before the results are shown */
     sortTerms(terms);
+    loadTermDetails(terms.first(std::min(terms.size(), TERM_PAGE_SIZE)));
 
-    for (Term *term : terms)
+    return terms;
+}
+
+QCoro::Task<void> DictionarySearchController::loadTermDetailsAsync(
+    QList<QPointer<Term>> terms)
+{
+    std::optional<SearchGuard> searchGuard = acquireSearchGuard();
+    if (!searchGuard)
     {
-        term->moveToThread(thread());
+        co_return;
     }
 
-    return terms;
+    /* Terms belong to this thread, so the worker fills in copies */
+    QList<std::pair<QString, QString>> keys;
+    keys.reserve(terms.size());
+    for (const QPointer<Term> &term : terms)
+    {
+        keys.emplaceBack(
+            term.isNull() ? QString() : term->expression(),
+            term.isNull() ? QString() : term->reading()
+        );
+    }
+
+    QList<Term *> loaded = co_await QtConcurrent::run(
+        [this, guard = std::move(*searchGuard), keys = std::move(keys)] ()
+        {
+            QList<Term *> loaded;
+            loaded.reserve(keys.size());
+            for (const auto &[expression, reading] : keys)
+            {
+                Term *term = new Term;
+                term->setExpression(expression);
+                term->setReading(reading);
+                loaded.emplaceBack(term);
+            }
+            if (!m_shuttingDown)
+            {
+                loadTermDetails(loaded);
+            }
+            for (Term *term : loaded)
+            {
+                term->moveToThread(thread());
+            }
+            return loaded;
+        }
+    );
+
+    for (qsizetype i = 0; i < terms.size() && i < loaded.size(); ++i)
+    {
+        if (terms[i].isNull())
+        {
+            continue;
+        }
+        terms[i]->setDefinitions(loaded[i]->definitions());
+        loaded[i]->m_definitions.clear();
+        terms[i]->setTags(loaded[i]->m_tagRefs);
+        terms[i]->setFrequencies(loaded[i]->frequencies());
+        terms[i]->setPitches(loaded[i]->pitches());
+    }
+    qDeleteAll(loaded);
+}
+
+DictionarySearchController::SearchCacheStats
+DictionarySearchController::searchCacheStats() const noexcept
+{
+    return SearchCacheStats{
+        .hits = m_searchCacheHits,
+        .misses = m_searchCacheMisses,
+    };
+}
+
+uint64_t DictionarySearchController::cancelledSearches() const noexcept
+{
+    return m_cancelledSearches;
+}
+
+DictionarySearchController::SearchStats
+DictionarySearchController::searchStats() const noexcept
+{
+    return SearchStats{
+        .terms = m_termSearchLatency.snapshot(),
+        .kanji = m_kanjiSearchLatency.snapshot(),
+    };
+}
+
+DatabaseManager::StatementCacheStats
+DictionarySearchController::statementCacheStats() const noexcept
+{
+    return m_db->statementCacheStats();
+}
+
+DictionarySearchController::QueryCounts
+DictionarySearchController::countTermQueries(const QString &query) const
+{
+    std::vector<SearchQuery> queries = generateQueries(query);
+    sortQueries(queries);
+    filterDuplicates(queries);
+
+    QSet<QString> lookedUp;
+    for (const SearchQuery &q : queries)
+    {
+        if (m_db->hasTerm(q.deconj))
+        {
+            lookedUp.insert(q.deconj);
+        }
+    }
+
+    return QueryCounts{
+        .generated = static_cast<qsizetype>(queries.size()),
+        .lookedUp = lookedUp.size(),
+    };
+}
+
+DatabaseManager::QueryStats
+DictionarySearchController::queryStats() const noexcept
+{
+    return m_db->queryStats();
+}
+
+QCoro::Task<QList<DatabaseManager::DictionaryCost>>
+DictionarySearchController::dictionaryCostsAsync()
+{
+    std::optional<SearchGuard> searchGuard = acquireSearchGuard();
+    if (!searchGuard)
+    {
+        co_return {};
+    }
+
+    QList<DatabaseManager::DictionaryCost> costs = co_await QtConcurrent::run(
+        [this, guard = std::move(*searchGuard)] ()
+        {
+            return m_db->dictionaryCosts();
+        }
+    );
+    co_return costs;
+}
+
+void DictionarySearchController::resetStats()
+{
+    m_termSearchLatency.reset();
+    m_kanjiSearchLatency.reset();
+    m_db->resetStats();
 }
 
 QCoro::Task<Kanji *> DictionarySearchController::searchKanjiAsync(
@@ -260,10 +505,13 @@ QCoro::Task<Kanji *> DictionarySearchController::searchKanjiAsync(
 Kanji *DictionarySearchController::searchKanjiSync(
     QString character, QString text, qsizetype index)
 {
+    MEMENTO_TRACE_SCOPE("DictionarySearchController::searchKanjiSync");
+
     if (m_shuttingDown)
     {
         return nullptr;
     }
+    const LatencyHistogram::Timer latency{m_kanjiSearchLatency};
 
     QString err;
     Kanji *kanji = m_db->queryKanji(character, nullptr, &err);
@@ -317,6 +565,71 @@ Kanji *DictionarySearchController::searchKanjiSync(
 }
 
 /* End Search Methods */
+/* Begin Search Cache */
+
+DictionarySearchController::CachedSearch::~CachedSearch()
+{
+    qDeleteAll(terms);
+}
+
+std::optional<QList<Term *>> DictionarySearchController::takeCachedTerms(
+    const QString &query, const QString &text, qsizetype index)
+{
+    QMutexLocker lock{&m_searchCacheMutex};
+
+    const CachedSearch *cached = m_searchCache.object(query);
+    if (cached == nullptr)
+    {
+        return std::nullopt;
+    }
+    if (cached->dbGeneration != m_db->generation() ||
+        cached->settingsGeneration != m_settingsGeneration)
+    {
+        m_searchCache.remove(query);
+        return std::nullopt;
+    }
+
+    QList<Term *> terms;
+    terms.reserve(cached->terms.size());
+    for (const Term *term : cached->terms)
+    {
+        const qsizetype bodySize = term->clozeBody().size();
+        Term *copy = term->clone();
+        copy->setClozePrefix(text.left(index));
+        copy->setClozeBody(text.mid(index, bodySize));
+        copy->setClozeSuffix(text.right(text.size() - (index + bodySize)));
+        terms.emplaceBack(copy);
+    }
+    for (Term *term : terms)
+    {
+        term->moveToThread(thread());
+    }
+
+    return terms;
+}
+
+void DictionarySearchController::cacheTerms(
+    const QString &query,
+    uint64_t dbGeneration,
+    uint64_t settingsGeneration,
+    const QList<Term *> &terms)
+{
+    CachedSearch *cached = new CachedSearch{
+        .dbGeneration = dbGeneration,
+        .settingsGeneration = settingsGeneration,
+        .terms = {},
+    };
+    cached->terms.reserve(terms.size());
+    for (const Term *term : terms)
+    {
+        cached->terms.emplaceBack(term->clone());
+    }
+
+    QMutexLocker lock{&m_searchCacheMutex};
+    m_searchCache.insert(query, cached);
+}
+
+/* End Search Cache */
 /* Begin Settings Handlers */
 
 void DictionarySearchController::updateGenerators()
@@ -328,6 +641,7 @@ void DictionarySearchController::updateGenerators()
 
     QWriteLocker lock{&m_generatorsMutex};
 
+    ++m_settingsGeneration;
     m_generators.clear();
 
     if (m_settings->searchMatcherExact())
@@ -357,6 +671,7 @@ void DictionarySearchController::updateDictionaryOrder()
 
     QWriteLocker lock{&m_dictionaryOrderMutex};
 
+    ++m_settingsGeneration;
     m_dictionaryOrder.clear();
     const QList<int64_t> &order = m_settings->dictionaryOrder();
     for (qsizetype i{0}; i < order.size(); ++i)
@@ -456,6 +771,8 @@ void DictionarySearchController::filterDuplicates(
 
 void DictionarySearchController::sortTerms(QList<Term *> &terms) const
 {
+    MEMENTO_TRACE_SCOPE("DictionarySearchController::sortTerms");
+
     std::sort(
         std::begin(terms), std::end(terms),
         [] (const Term *lhs, const Term *rhs) -> bool
@@ -483,6 +800,12 @@ void DictionarySearchController::sortTerms(QList<Term *> &terms) const
             return lhs->score() > rhs->score();
         }
     );
+}
+
+void DictionarySearchController::sortDefinitions(
+    const QList<Term *> &terms) const
+{
+    MEMENTO_TRACE_SCOPE("DictionarySearchController::sortDefinitions");
 
     m_dictionaryOrderMutex.lockForRead();
     for (Term *term : terms)
@@ -503,6 +826,32 @@ void DictionarySearchController::sortTerms(QList<Term *> &terms) const
                     );
             }
         );
+    }
+    m_dictionaryOrderMutex.unlock();
+}
+
+void DictionarySearchController::loadTermDetails(
+    const QList<Term *> &terms) const
+{
+    MEMENTO_TRACE_SCOPE("DictionarySearchController::loadTermDetails");
+
+    if (terms.isEmpty())
+    {
+        return;
+    }
+    if (m_db->addTermDefinitions(terms))
+    {
+        qWarning("Could not load definitions of every term");
+    }
+    sortDefinitions(terms);
+    if (m_db->addTermMeta(terms))
+    {
+        qWarning("Could not load frequencies and pitches of every term");
+    }
+
+    QReadLocker lock{&m_dictionaryOrderMutex};
+    for (Term *term : terms)
+    {
         std::sort(
             std::begin(term->m_frequencies), std::end(term->m_frequencies),
             [this] (const Frequency *lhs, const Frequency *rhs) -> bool
@@ -511,13 +860,7 @@ void DictionarySearchController::sortTerms(QList<Term *> &terms) const
                        m_dictionaryOrder[rhs->dictionaryInfo()->id()];
             }
         );
-        sortTags(term->m_tags);
-        for (TermDefinition *def : term->definitions())
-        {
-            sortTags(def->m_tags);
-        }
     }
-    m_dictionaryOrderMutex.unlock();
 }
 
 void DictionarySearchController::sortTags(QList<Tag *> &tags) const
@@ -26,10 +26,13 @@
 #include <cstdint>
 #include <mutex>
 #include <optional>
+#include <stop_token>
 #include <utility>
 #include <vector>
 
+#include <QCache>
 #include <QHash>
+#include <QMutex>
 #include <QPointer>
 #include <QReadWriteLock>
 
@@ -41,6 +44,7 @@
 
 #include "setting/settings.h"
 #include "dict/querygenerator.h"
+#include "util/latencyhistogram.h"
 
 /**
  * @brief Object managing the generation of search results.
@@ -86,12 +90,27 @@ public:
      * the query.
      * @param text The text containing the query.
      * @param index The index into text where query start from.
+     * @param cancel Stops the search early when stop is requested. Cancelled
+     * searches return an empty list.
      * @return An awaitable task that returns a list of terms. Belongs to the
      * caller.
      */
     [[nodiscard]]
     QCoro::Task<QList<Term *>> searchTermsAsync(
-        QString query, QString text, qsizetype index);
+        QString query,
+        QString text,
+        qsizetype index,
+        std::stop_token cancel = {});
+
+    /**
+     * @brief Adds definitions, frequencies and pitches to terms past the first
+     * page of a searchTermsAsync() result.
+     *
+     * @param terms The terms to complete. Deleted terms are skipped.
+     * @return An awaitable task.
+     */
+    [[nodiscard]]
+    QCoro::Task<void> loadTermDetailsAsync(QList<QPointer<Term>> terms);
 
     /**
      * @brief Search for all kanji in a query.
@@ -105,6 +124,118 @@ public:
     QCoro::Task<Kanji *> searchKanjiAsync(
         QString query, QString text, qsizetype index);
 
+    /**
+     * @brief Counters for the term search result cache.
+     */
+    struct SearchCacheStats
+    {
+        /* Number of searches answered from the cache */
+        uint64_t hits;
+
+        /* Number of searches that had to query the database */
+        uint64_t misses;
+    };
+
+    /**
+     * @brief Get how often term searches were answered from the cache.
+     *
+     * @return The search cache counters.
+     */
+    [[nodiscard]]
+    SearchCacheStats searchCacheStats() const noexcept;
+
+    /**
+     * @brief Get the number of term searches that were cancelled before they
+     * completed.
+     *
+     * @return The number of cancelled searches.
+     */
+    [[nodiscard]]
+    uint64_t cancelledSearches() const noexcept;
+
+    /**
+     * @brief How long searches take from the time they start running,
+     * including searches answered from the cache.
+     */
+    struct SearchStats
+    {
+        /* Term searches */
+        LatencyHistogram::Snapshot terms;
+
+        /* Kanji searches */
+        LatencyHistogram::Snapshot kanji;
+    };
+
+    /**
+     * @brief Get how long searches have taken since the controller was
+     * created or resetStats() was called.
+     *
+     * @return The search latencies.
+     */
+    [[nodiscard]]
+    SearchStats searchStats() const noexcept;
+
+    /**
+     * @brief Get how often database queries reused a cached prepared
+     * statement.
+     *
+     * @return The statement cache counters of the database.
+     */
+    [[nodiscard]]
+    DatabaseManager::StatementCacheStats statementCacheStats() const noexcept;
+
+    /**
+     * @brief The number of queries a term search looks up.
+     */
+    struct QueryCounts
+    {
+        /* Distinct queries generated from the text */
+        qsizetype generated;
+
+        /* Distinct query strings a dictionary may have an entry for */
+        qsizetype lookedUp;
+    };
+
+    /**
+     * @brief Counts the queries a term search would make without searching.
+     * Used to measure searches.
+     *
+     * @param query The text to generate queries from.
+     * @return The number of queries generated and looked up.
+     */
+    [[nodiscard]]
+    QueryCounts countTermQueries(const QString &query) const;
+
+    /**
+     * @brief Get how long database queries take.
+     *
+     * @return The query latencies of the database.
+     */
+    [[nodiscard]]
+    DatabaseManager::QueryStats queryStats() const noexcept;
+
+    /**
+     * @brief Get how many rows each installed dictionary added to search
+     * results. The dictionaries are read on another thread since they may be
+     * locked by an import or deletion.
+     *
+     * @return An awaitable task returning the costs of the installed
+     * dictionaries.
+     */
+    [[nodiscard]]
+    QCoro::Task<QList<DatabaseManager::DictionaryCost>> dictionaryCostsAsync();
+
+    /**
+     * @brief Clears the search latencies, query latencies and dictionary
+     * costs.
+     */
+    void resetStats();
+
+    /* The number of terms at the start of a search result that have
+     * definitions, frequencies and pitches. The rest are loaded with
+     * loadTermDetailsAsync(). */
+    static constexpr qsizetype TERM_PAGE_SIZE = 10;
+
 private slots:
     /**
      * @brief Keeps generators up to date with settings.
@@ -124,11 +255,12 @@ private:
      * the query.
      * @param text The text containing the query.
      * @param index The index into text where query start from.
-     * @return The list of terms.
+     * @param cancel Stops the search early when stop is requested.
+     * @return The list of terms. Empty if cancelled.
      */
     [[nodiscard]]
     QList<Term *> searchTermsSync(
-        QString query, QString text, qsizetype index);
+        QString query, QString text, qsizetype index, std::stop_token cancel);
 
     /**
      * @brief Synchronously searches for kanji.
@@ -142,6 +274,69 @@ private:
     Kanji *searchKanjiSync(
         QString query, QString text, qsizetype index);
 
+    /**
+     * @brief Searches for terms without consulting the result cache.
+     *
+     * @param query The query to look up.
+     * @param text The text containing the query.
+     * @param index The index into text where query start from.
+     * @param cancel Stops the search early when stop is requested.
+     * @return The list of terms. Empty if cancelled.
+     */
+    [[nodiscard]]
+    QList<Term *> searchTermsUncached(
+        const QString &query,
+        const QString &text,
+        qsizetype index,
+        const std::stop_token &cancel);
+
+    /**
+     * @brief A snapshot of the results of a term search. Never modified once
+     * it is in the cache.
+     */
+    struct CachedSearch
+    {
+        ~CachedSearch();
+
+        /* The generation of the dictionaries the results came from */
+        uint64_t dbGeneration;
+
+        /* The generation of the search settings the results came from */
+        uint64_t settingsGeneration;
+
+        /* The sorted results. Cloze fields are relative to the query. */
+        QList<Term *> terms;
+    };
+
+    /**
+     * @brief Get copies of cached results for a query.
+     *
+     * @param query The query to look up.
+     * @param text The text containing the query.
+     * @param index The index into text where query start from.
+     * @return Copies of the results with cloze fields relative to text.
+     * std::nullopt if the query is not cached or the results are stale.
+     */
+    [[nodiscard]]
+    std::optional<QList<Term *>> takeCachedTerms(
+        const QString &query, const QString &text, qsizetype index);
+
+    /**
+     * @brief Add a copy of search results to the cache.
+     *
+     * @param query The query the results are for.
+     * @param dbGeneration The generation of the dictionaries at the start of
+     * the search.
+     * @param settingsGeneration The generation of the settings at the start of
+     * the search.
+     * @param terms The results of the search.
+     */
+    void cacheTerms(
+        const QString &query,
+        uint64_t dbGeneration,
+        uint64_t settingsGeneration,
+        const QList<Term *> &terms);
+
     /**
      * Generate queries from text.
      * @param text The text to generate queries from.
@@ -163,11 +358,26 @@ private:
     static void filterDuplicates(std::vector<SearchQuery> &queries);
 
     /**
-     * Sort the term list by priority and length.
+     * Sort the term list by priority and length. Only uses keys read with the
+     * term candidates, so terms don't need their definitions.
      * @param[out] terms The term list to sort.
      */
     void sortTerms(QList<Term *> &terms) const;
 
+    /**
+     * Sorts the definitions of each term by dictionary priority. Term and
+     * definition tags come from the database already sorted.
+     * @param[out] terms The terms to sort the definitions of.
+     */
+    void sortDefinitions(const QList<Term *> &terms) const;
+
+    /**
+     * Adds definitions, frequencies and pitches to terms and sorts them by
+     * dictionary priority.
+     * @param[out] terms The terms to complete.
+     */
+    void loadTermDetails(const QList<Term *> &terms) const;
+
     /**
      * Sorts tag by descending order, breaking ties on ascending score.
      * @param[out] tags The list of tags to sort.
@@ -239,6 +449,33 @@ private:
     /* Maps dictionary IDs to priorities. */
     QHash<int64_t, qsizetype> m_dictionaryOrder;
 
+    /* Incremented when a setting that changes search results changes */
+    std::atomic_uint64_t m_settingsGeneration{0};
+
+    /* The maximum number of queries with cached results */
+    static constexpr qsizetype SEARCH_CACHE_SIZE = 64;
+
+    /* Mutex for the search result cache */
+    QMutex m_searchCacheMutex;
+
+    /* Least recently used search results keyed by query */
+    QCache<QString, CachedSearch> m_searchCache{SEARCH_CACHE_SIZE};
+
+    /* Number of searches answered from the cache */
+    std::atomic_uint64_t m_searchCacheHits{0};
+
+    /* Number of searches that missed the cache */
+    std::atomic_uint64_t m_searchCacheMisses{0};
+
+    /* Number of searches that were superseded before they completed */
+    std::atomic_uint64_t m_cancelledSearches{0};
+
+    /* Time spent in searchTermsSync() */
+    LatencyHistogram m_termSearchLatency;
+
+    /* Time spent in searchKanjiSync() */
+    LatencyHistogram m_kanjiSearchLatency;
+
     /* Mutex for the lifetime of queued and running searches */
     std::mutex m_searchLifetimeMutex;
 
@@ -20,9 +20,13 @@
 
 #include "dict/exactquerygenerator.h"
 
+#include "util/tracing.h"
+
 std::vector<SearchQuery> ExactQueryGenerator::generateQueries(
     const QString &text) const
 {
+    MEMENTO_TRACE_SCOPE("ExactQueryGenerator::generateQueries");
+
     std::vector<SearchQuery> queries;
 
     QString query = text;
@@ -20,10 +20,15 @@
 
 #include "dict/mecabquerygenerator.h"
 
-#include <QDebug>
+#include <QCache>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QtGlobal>
 
+#include <atomic>
+
+#include "util/tracing.h"
 #include "util/utils.h"
 
 /* Begin Static Helpers */
@@ -85,11 +90,50 @@ static QByteArray genMecabArg()
 }
 #endif
 
+/* The maximum number of texts with cached queries */
+static constexpr qsizetype PARSE_CACHE_SIZE = 128;
+
+/* Guards parseCache */
+static QMutex parseCacheMutex;
+
+/* Queries generated for recently parsed texts. Texts on the same line are
+ * searched repeatedly while hovering. */
+static QCache<QString, std::vector<SearchQuery>> parseCache{PARSE_CACHE_SIZE};
+
+/* Guards tagger */
+static QMutex taggerMutex;
+
+/* The tagger shared by every generator. Set once it loads successfully. */
+static std::shared_ptr<MeCab::Tagger> tagger;
+
+/* Counters reported by MeCabQueryGenerator::stats() */
+static std::atomic_int64_t taggerLoadNsecs{0};
+static std::atomic_uint64_t parses{0};
+static std::atomic_uint64_t parseNsecs{0};
+static std::atomic_uint64_t parseCacheHits{0};
+
 /* End Static Helpers */
 /* Begin Constructor */
 
-MeCabQueryGenerator::MeCabQueryGenerator()
+MeCabQueryGenerator::MeCabQueryGenerator() : m_tagger(sharedTagger())
+{
+
+}
+
+/* End Constructor */
+/* Begin Shared Resources */
+
+std::shared_ptr<MeCab::Tagger> MeCabQueryGenerator::sharedTagger()
 {
+    QMutexLocker lock{&taggerMutex};
+    if (tagger != nullptr)
+    {
+        return tagger;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
 #if defined(Q_OS_WIN)
     QByteArray mecabArg = genMecabArg();
 #elif defined(MEMENTO_BUNDLE)
@@ -100,35 +144,103 @@ MeCabQueryGenerator::MeCabQueryGenerator()
 #else
     QByteArray mecabArg = "";
 #endif
-    m_tagger.reset(MeCab::createTagger(mecabArg));
-    if (m_tagger == nullptr)
+
+    /* Failures aren't kept so the next generator tries again, such as after
+     * the dictionary is installed */
+    std::shared_ptr<MeCab::Tagger> result{MeCab::createTagger(mecabArg)};
+    if (result == nullptr)
     {
-        qWarning("Could not create MeCab::Tagger: %s", MeCab::getTaggerError());
+        qWarning(
+            "Could not create MeCab::Tagger: %s", MeCab::getTaggerError()
+        );
+        return nullptr;
     }
+
+    taggerLoadNsecs = timer.nsecsElapsed();
+    qInfo(
+        "Loaded MeCab tagger in %lld ms",
+        static_cast<long long>(taggerLoadNsecs / 1000000)
+    );
+    tagger = std::move(result);
+    return tagger;
 }
 
-/* End Constructor */
+MeCab::Lattice *MeCabQueryGenerator::threadLattice()
+{
+    thread_local std::unique_ptr<MeCab::Lattice> lattice{
+        MeCab::createLattice()
+    };
+    return lattice.get();
+}
+
+MeCabQueryGenerator::Stats MeCabQueryGenerator::stats() noexcept
+{
+    return Stats{
+        .taggerLoadNsecs = taggerLoadNsecs,
+        .parses = parses,
+        .parseNsecs = parseNsecs,
+        .parseCacheHits = parseCacheHits,
+    };
+}
+
+/* End Shared Resources */
 /* Begin Query Generator */
 
 std::vector<SearchQuery> MeCabQueryGenerator::generateQueries(
     const QString &text) const
 {
+    MEMENTO_TRACE_SCOPE("MeCabQueryGenerator::generateQueries");
+
     if (!valid() || text.isEmpty())
     {
         return {};
     }
 
-    std::unique_ptr<MeCab::Lattice> lattice(MeCab::createLattice());
+    {
+        QMutexLocker lock{&parseCacheMutex};
+        const std::vector<SearchQuery> *cached = parseCache.object(text);
+        if (cached != nullptr)
+        {
+            ++parseCacheHits;
+            return *cached;
+        }
+    }
+
+    std::vector<SearchQuery> queries = parseQueries(text);
+
+    {
+        QMutexLocker lock{&parseCacheMutex};
+        parseCache.insert(text, new std::vector<SearchQuery>(queries));
+    }
+
+    return queries;
+}
+
+std::vector<SearchQuery> MeCabQueryGenerator::parseQueries(
+    const QString &text) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    MeCab::Lattice *lattice = threadLattice();
+    if (lattice == nullptr)
+    {
+        qWarning("Could not create MeCab::Lattice: %s", MeCab::getLastError());
+        return {};
+    }
     QByteArray textArr = text.toUtf8();
     lattice->set_sentence(textArr);
-    if (!m_tagger->parse(lattice.get()))
+    if (!m_tagger->parse(lattice))
     {
-        qWarning("Cannot access MeCab: %s", MeCab::getLastError());
+        qWarning("Cannot access MeCab: %s", lattice->what());
         return {};
     }
     std::vector<MeCabQuery> mecabQueries =
         generateQueriesHelper(lattice->bos_node()->next);
 
+    ++parses;
+    parseNsecs += timer.nsecsElapsed();
+
     std::vector<SearchQuery> queries;
     queries.reserve(mecabQueries.size());
     std::copy(
@@ -57,7 +57,62 @@ public:
     std::vector<SearchQuery> generateQueries(
         const QString &text) const override;
 
+    /**
+     * @brief Timings of the shared tagger.
+     */
+    struct Stats
+    {
+        /* Nanoseconds spent loading the tagger. 0 if not loaded yet. */
+        int64_t taggerLoadNsecs;
+
+        /* Number of texts parsed by MeCab */
+        uint64_t parses;
+
+        /* Total nanoseconds spent parsing */
+        uint64_t parseNsecs;
+
+        /* Number of texts answered from the parse cache */
+        uint64_t parseCacheHits;
+    };
+
+    /**
+     * @brief Get the load time of the tagger and how long parses take.
+     *
+     * @return Timings shared by every MeCabQueryGenerator.
+     */
+    [[nodiscard]]
+    static Stats stats() noexcept;
+
 private:
+    /**
+     * @brief Get the tagger shared by every generator, loading IPAdic the
+     * first time it is called. The tagger lives until the application exits
+     * so reconfiguring generators doesn't reload the dictionary. Loading is
+     * tried again on the next call if it fails.
+     *
+     * @return The shared tagger. nullptr if it could not be created.
+     */
+    [[nodiscard]]
+    static std::shared_ptr<MeCab::Tagger> sharedTagger();
+
+    /**
+     * @brief Get a lattice owned by the calling thread. Lattices hold the
+     * state of a parse, so each thread needs its own to share a tagger.
+     *
+     * @return The lattice of the calling thread.
+     */
+    [[nodiscard]]
+    static MeCab::Lattice *threadLattice();
+
+    /**
+     * @brief Parses text with MeCab and generates queries from the result.
+     *
+     * @param text The text to parse.
+     * @return The list of generated queries.
+     */
+    [[nodiscard]]
+    std::vector<SearchQuery> parseQueries(const QString &text) const;
+
     /**
      * @brief A special SearchPair that contains additional information needed
      * by MeCab.
@@ -105,6 +160,7 @@ private:
     [[nodiscard]]
     static inline QString extractCleanSurface(const MeCab::Node *node);
 
-    /* The object used for interacting with MeCab */
-    std::unique_ptr<MeCab::Tagger> m_tagger{nullptr};
+    /* The object used for interacting with MeCab. Shared between
+     * generators. */
+    std::shared_ptr<MeCab::Tagger> m_tagger{nullptr};
 };
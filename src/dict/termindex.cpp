@@ -0,0 +1,235 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "dict/termindex.h"
+
+#include <QSaveFile>
+
+#include <cstring>
+
+/* Begin File Format */
+
+/* Identifies index files and their version */
+static constexpr char MAGIC[8] = {'M', 'E', 'M', 'K', 'E', 'Y', 'S', '2'};
+
+/**
+ * @brief Rounds a size up so the data following it is aligned for quint32.
+ *
+ * @param size The size to round.
+ * @return The rounded size.
+ */
+static constexpr qint64 alignSize(qint64 size)
+{
+    return (size + sizeof(quint32) - 1) & ~qint64(sizeof(quint32) - 1);
+}
+
+/* End File Format */
+/* Begin Constructor */
+
+TermIndex::TermIndex(const QString &path) :
+    m_file(path)
+{
+
+}
+
+/* End Constructor */
+/* Begin Loading */
+
+std::unique_ptr<TermIndex> TermIndex::open(
+    const QString &path, const QByteArray &fingerprint)
+{
+    std::unique_ptr<TermIndex> index{new TermIndex(path)};
+    if (!index->m_file.open(QIODevice::ReadOnly))
+    {
+        return nullptr;
+    }
+
+    const qint64 size = index->m_file.size();
+    qint64 pos = sizeof(MAGIC) + sizeof(quint32);
+    if (size < pos)
+    {
+        return nullptr;
+    }
+    const uchar *data = index->m_file.map(0, size);
+    if (data == nullptr)
+    {
+        return nullptr;
+    }
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+    {
+        return nullptr;
+    }
+
+    /* Header */
+    quint32 fingerprintSize = 0;
+    std::memcpy(
+        &fingerprintSize, data + sizeof(MAGIC), sizeof(fingerprintSize)
+    );
+    if (size < pos + fingerprintSize + qint64(sizeof(quint32)))
+    {
+        return nullptr;
+    }
+    index->m_fingerprint = QByteArray(
+        reinterpret_cast<const char *>(data + pos), fingerprintSize
+    );
+    if (index->m_fingerprint != fingerprint)
+    {
+        return nullptr;
+    }
+    pos = alignSize(pos + fingerprintSize);
+
+    /* Key table */
+    if (size < pos + qint64(sizeof(quint32)))
+    {
+        return nullptr;
+    }
+    std::memcpy(&index->m_count, data + pos, sizeof(index->m_count));
+    pos += sizeof(quint32);
+    const qint64 offsetsSize =
+        (qint64(index->m_count) + 1) * qint64(sizeof(quint32));
+    if (size < pos + offsetsSize)
+    {
+        return nullptr;
+    }
+    index->m_offsets = reinterpret_cast<const quint32 *>(data + pos);
+    pos += offsetsSize;
+    index->m_keys = reinterpret_cast<const char *>(data + pos);
+    if (size - pos < index->m_offsets[index->m_count])
+    {
+        return nullptr;
+    }
+
+    return index;
+}
+
+/* End Loading */
+/* Begin Building */
+
+bool TermIndex::build(
+    sqlite3 *db,
+    int64_t id,
+    const QByteArray &fingerprint,
+    const QString &path)
+{
+    constexpr const char *QUERY =
+        "SELECT expression FROM term_bank WHERE dic_id = ?1 "
+        "UNION "
+        "SELECT reading FROM term_bank WHERE dic_id = ?1 AND reading != '' "
+        "ORDER BY 1;";
+
+    constexpr int QUERY_DIC_ID_IDX = 1;
+
+    constexpr int COLUMN_KEY = 0;
+
+    /* Collect the keys sorted and without duplicates */
+    QList<quint32> offsets{0};
+    QByteArray keys;
+    sqlite3_stmt *stmt = nullptr;
+    int step = 0;
+    if (sqlite3_prepare_v2(db, QUERY, -1, &stmt, nullptr) != SQLITE_OK ||
+        sqlite3_bind_int64(stmt, QUERY_DIC_ID_IDX, id) != SQLITE_OK)
+    {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+    while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        keys.append(
+            reinterpret_cast<const char *>(
+                sqlite3_column_blob(stmt, COLUMN_KEY)
+            ),
+            sqlite3_column_bytes(stmt, COLUMN_KEY)
+        );
+        offsets.emplaceBack(keys.size());
+    }
+    sqlite3_finalize(stmt);
+    if (step != SQLITE_DONE)
+    {
+        return false;
+    }
+
+    /* Write the file */
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+    const quint32 fingerprintSize = fingerprint.size();
+    const quint32 count = offsets.size() - 1;
+    const QByteArray padding(
+        alignSize(fingerprintSize) - fingerprintSize, '\0'
+    );
+    file.write(MAGIC, sizeof(MAGIC));
+    file.write(
+        reinterpret_cast<const char *>(&fingerprintSize),
+        sizeof(fingerprintSize)
+    );
+    file.write(fingerprint);
+    file.write(padding);
+    file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    file.write(
+        reinterpret_cast<const char *>(offsets.constData()),
+        offsets.size() * sizeof(quint32)
+    );
+    file.write(keys);
+
+    return file.commit();
+}
+
+/* End Building */
+/* Begin Lookup */
+
+bool TermIndex::contains(std::string_view key) const
+{
+    quint32 low = 0;
+    quint32 high = m_count;
+    while (low < high)
+    {
+        const quint32 mid = low + (high - low) / 2;
+        const int cmp = this->key(mid).compare(key);
+        if (cmp == 0)
+        {
+            return true;
+        }
+        else if (cmp < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+const QByteArray &TermIndex::fingerprint() const noexcept
+{
+    return m_fingerprint;
+}
+
+std::string_view TermIndex::key(quint32 i) const
+{
+    return std::string_view(
+        m_keys + m_offsets[i], m_offsets[i + 1] - m_offsets[i]
+    );
+}
+
+/* End Lookup */
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include <memory>
+#include <string_view>
+
+#include <sqlite3.h>
+
+/**
+ * @brief A sorted table of every expression and reading in a dictionary. The
+ * table is stored in its own file and memory mapped so checking if a string
+ * can match anything in the dictionary does not touch the database.
+ */
+class TermIndex
+{
+public:
+    /**
+     * @brief Maps an index file into memory.
+     *
+     * @param path The path to the index file.
+     * @param fingerprint Identifies the contents of the dictionary the index
+     * must be built from, such as its revision and number of terms.
+     * @return The index. nullptr if the file does not exist, is malformed, or
+     * was built from different contents.
+     */
+    [[nodiscard]]
+    static std::unique_ptr<TermIndex> open(
+        const QString &path, const QByteArray &fingerprint);
+
+    /**
+     * @brief Builds the index file of a dictionary, replacing any existing
+     * one.
+     *
+     * @param db The connection to read terms from.
+     * @param id The ID of the dictionary.
+     * @param fingerprint Identifies the contents of the dictionary. Stored in
+     * the header.
+     * @param path The path to write the index file to.
+     * @return true on success, false otherwise.
+     */
+    static bool build(
+        sqlite3 *db,
+        int64_t id,
+        const QByteArray &fingerprint,
+        const QString &path);
+
+    /**
+     * @brief Checks if a string is the expression or reading of any term in
+     * the dictionary.
+     *
+     * @param key The UTF-8 string to look for.
+     * @return true if the dictionary contains key, false otherwise.
+     */
+    [[nodiscard]]
+    bool contains(std::string_view key) const;
+
+    /**
+     * @brief Get the fingerprint of the dictionary contents the index was
+     * built from.
+     *
+     * @return The fingerprint.
+     */
+    [[nodiscard]]
+    const QByteArray &fingerprint() const noexcept;
+
+private:
+    TermIndex(const QString &path);
+
+    /**
+     * @brief Get a key in the table.
+     *
+     * @param i The position of the key. Must be less than m_count.
+     * @return The key.
+     */
+    [[nodiscard]]
+    std::string_view key(quint32 i) const;
+
+    /* The mapped index file */
+    QFile m_file;
+
+    /* Identifies the dictionary contents the index was built from */
+    QByteArray m_fingerprint;
+
+    /* Number of keys in the table */
+    quint32 m_count{0};
+
+    /* Offsets of each key into m_keys. Has m_count + 1 entries. */
+    const quint32 *m_offsets{nullptr};
+
+    /* The keys stored back to back in sorted order */
+    const char *m_keys{nullptr};
+};
@@ -22,6 +22,8 @@
 
 #include <errno.h>
 #include <json-c/json.h>
+#include <limits.h>
+#include <pthread.h>
 #include <regex.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -30,6 +32,15 @@
 #include <sys/types.h>
 #include <zip.h>
 
+#if JSON_C_VERSION_NUM < ((0 << 16) | (15 << 8) | 0)
+#error "json-c 0.15 or newer is required"
+#endif
+
+/* RETURNING needs 3.35 and window functions need 3.25 */
+#if SQLITE_VERSION_NUMBER < 3035000
+#error "SQLite 3.35 or newer is required"
+#endif
+
 #ifdef _WIN32
 #include <windows.h>
 
@@ -41,6 +52,8 @@
 #define __USE_XOPEN_EXTENDED 500
 
 #include <ftw.h>
+#include <time.h>
+#include <unistd.h>
 #endif
 
 #define INDEX_FILE              "index.json"
@@ -50,6 +63,26 @@
 #define KANJI_BANK_FORMAT       "kanji_bank_%u.json"
 #define KANJI_META_BANK_FORMAT  "kanji_meta_bank_%u.json"
 
+#define TAG_BANK_QUERY \
+    "INSERT INTO tag_bank (dic_id, name, category, ord, notes, score) "\
+        "VALUES (?, ?, ?, ?, ?, ?);"
+#define TERM_BANK_QUERY \
+    "INSERT INTO term_bank "\
+        "(dic_id, expression, reading, def_tags, rules, score, glossary, sequence, term_tags) "\
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);"
+#define TERM_META_BANK_QUERY \
+    "INSERT INTO term_meta_bank "\
+        "(dic_id, expression, mode, type, data, reading, value, display, pitches) "\
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);"
+#define KANJI_BANK_QUERY \
+    "INSERT INTO kanji_bank "\
+        "(dic_id, char, onyomi, kunyomi, tags, meanings, stats) "\
+        "VALUES (?, ?, ?, ?, ?, ?, ?);"
+#define KANJI_META_BANK_QUERY \
+    "INSERT INTO kanji_meta_bank "\
+        "(dic_id, expression, mode, type, data, reading, value, display, pitches) "\
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);"
+
 #define FILENAME_BUFFER_SIZE  256
 
 #define STAT_ERR                    -1
@@ -77,6 +110,9 @@
 #define TRANSACTION_ERR             -23
 #define DB_ALTER_TABLE_ERR          -24
 #define JSON_PARSE_ERROR            -25
+#define THREAD_CREATE_ERR           -26
+#define IMPORT_CANCELLED_ERR        -27
+#define DICT_INSTALLED_ERR          -28
 
 typedef enum bank_type
 {
@@ -87,6 +123,72 @@ typedef enum bank_type
     kanji_meta_bank
 } bank_type;
 
+/**
+ * Gets a monotonic timestamp for measuring import phases.
+ * @return The current time in nanoseconds.
+ */
+static uint64_t now_nsecs(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)(count.QuadPart / freq.QuadPart) * 1000000000ULL +
+           (uint64_t)(count.QuadPart % freq.QuadPart) * 1000000000ULL / freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * Adds a measurement to a phase of an import.
+ * @param[out] stats            The stats to add to. Safe if NULL.
+ * @param      phase            The phase that was measured.
+ * @param      start            The now_nsecs() timestamp the phase started at.
+ * @param      rows             The number of rows written.
+ * @param      bytes            The number of uncompressed bytes read.
+ * @param      compressed_bytes The number of compressed bytes read.
+ */
+static void add_phase_stats(yomi_import_stats *stats, yomi_import_phase phase,
+                            uint64_t start, uint64_t rows, uint64_t bytes,
+                            uint64_t compressed_bytes)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    stats->phases[phase].nsecs            += now_nsecs() - start;
+    stats->phases[phase].rows             += rows;
+    stats->phases[phase].bytes            += bytes;
+    stats->phases[phase].compressed_bytes += compressed_bytes;
+}
+
+/**
+ * Gets the import phase that writes a type of bank.
+ * @param type The type of bank.
+ * @return The phase writing the bank.
+ */
+static yomi_import_phase bank_type_to_phase(bank_type type)
+{
+    switch (type)
+    {
+    case tag_bank:
+        return YOMI_PHASE_TAG_BANK;
+    case term_bank:
+        return YOMI_PHASE_TERM_BANK;
+    case term_meta_bank:
+        return YOMI_PHASE_TERM_META_BANK;
+    case kanji_bank:
+        return YOMI_PHASE_KANJI_BANK;
+    case kanji_meta_bank:
+        return YOMI_PHASE_KANJI_META_BANK;
+    }
+    return YOMI_PHASE_TERM_BANK;
+}
+
 /**
  * Begins an database transaction
  * @param db The database to begin a transaction on
@@ -141,6 +243,236 @@ static int rollback_transaction(sqlite3 *db)
     return 0;
 }
 
+/* Begin import pragma defines */
+
+#define IMPORT_PRAGMAS  "PRAGMA synchronous = NORMAL;"\
+                        "PRAGMA cache_size = -65536;"\
+                        "PRAGMA temp_store = MEMORY;"
+
+#define QUERY_BUFFER_SIZE   128
+
+/**
+ * Connection settings that are changed for the duration of an import.
+ */
+typedef struct import_pragmas
+{
+    int synchronous;
+    int cache_size;
+    int temp_store;
+} import_pragmas;
+
+/**
+ * Reads an integer PRAGMA value.
+ * @param      db    The database.
+ * @param      query The PRAGMA query to read.
+ * @param[out] value The value of the PRAGMA.
+ * @return Error code
+ */
+static int get_pragma_int(sqlite3 *db, const char *query, int *value)
+{
+    int           ret  = 0;
+    sqlite3_stmt *stmt = NULL;
+
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not prepare sqlite statement\n");
+        fprintf(stderr, "Query: %s\n", query);
+        ret = STATEMENT_PREPARE_ERR;
+        goto cleanup;
+    }
+    if (sqlite3_step(stmt) != SQLITE_ROW)
+    {
+        fprintf(stderr, "Could not execute %s\n", query);
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+    *value = sqlite3_column_int(stmt, 0);
+
+cleanup:
+    sqlite3_finalize(stmt);
+
+    return ret;
+}
+
+/**
+ * Switches the connection to settings suited to a large import. Must be called
+ * outside of a transaction. journal_mode is left alone so an interrupted import
+ * can always be rolled back.
+ * @param      db    The database.
+ * @param[out] saved The settings before they were changed.
+ * @return Error code
+ */
+static int begin_import_pragmas(sqlite3 *db, import_pragmas *saved)
+{
+    int   ret    = 0;
+    char *errmsg = NULL;
+
+    if ((ret = get_pragma_int(db, "PRAGMA synchronous;", &saved->synchronous)) ||
+        (ret = get_pragma_int(db, "PRAGMA cache_size;", &saved->cache_size)) ||
+        (ret = get_pragma_int(db, "PRAGMA temp_store;", &saved->temp_store)))
+    {
+        return ret;
+    }
+
+    sqlite3_exec(db, IMPORT_PRAGMAS, NULL, NULL, &errmsg);
+    if (errmsg)
+    {
+        fprintf(stderr, "Could not set PRAGMA values\nError: %s\n", errmsg);
+        sqlite3_free(errmsg);
+        return PRAGMA_SET_ERR;
+    }
+
+    return 0;
+}
+
+/**
+ * Restores the settings changed by begin_import_pragmas().
+ * @param db    The database.
+ * @param saved The settings to restore.
+ * @return Error code
+ */
+static int end_import_pragmas(sqlite3 *db, const import_pragmas *saved)
+{
+    char  query[QUERY_BUFFER_SIZE];
+    char *errmsg = NULL;
+
+    snprintf(
+        query, QUERY_BUFFER_SIZE,
+        "PRAGMA synchronous = %d;"
+        "PRAGMA cache_size = %d;"
+        "PRAGMA temp_store = %d;",
+        saved->synchronous, saved->cache_size, saved->temp_store
+    );
+    sqlite3_exec(db, query, NULL, NULL, &errmsg);
+    if (errmsg)
+    {
+        fprintf(stderr, "Could not restore PRAGMA values\nError: %s\n", errmsg);
+        sqlite3_free(errmsg);
+        return PRAGMA_SET_ERR;
+    }
+
+    return 0;
+}
+
+#undef IMPORT_PRAGMAS
+
+#undef QUERY_BUFFER_SIZE
+
+/* End import pragma defines */
+
+/**
+ * Indexes on the bank tables. Also dropped and rebuilt around large imports.
+ */
+#define TERM_BANK_EXP_INDEX \
+    "CREATE INDEX idx_term_bank_exp     ON term_bank(expression);"
+#define TERM_BANK_READING_INDEX \
+    "CREATE INDEX idx_term_bank_reading ON term_bank(reading);"
+#define TERM_BANK_COMBO_INDEX \
+    "CREATE INDEX idx_term_bank_combo   ON term_bank(expression, reading);"
+#define TERM_META_EXP_INDEX \
+    "CREATE INDEX idx_term_meta_exp ON term_meta_bank(expression, reading, mode);"
+
+/**
+ * The tables holding the contents of dictionaries. Shared by the main database
+ * and dictionaries stored in their own files.
+ */
+#define BANK_TABLES_SCHEMA \
+    "CREATE TABLE tag_bank (" \
+        "dic_id     INTEGER     NOT NULL," \
+        "name       TEXT        NOT NULL," \
+        "category   TEXT        NOT NULL," \
+        "ord        INTEGER     NOT NULL," \
+        "notes      TEXT        NOT NULL," \
+        "score      INTEGER     NOT NULL," \
+        "PRIMARY KEY(dic_id, name)" \
+    ");" \
+    "CREATE INDEX idx_tag_bank_name ON tag_bank(dic_id, name);" \
+\
+    "CREATE TABLE term_bank (" \
+        "dic_id     INTEGER     NOT NULL," \
+        "expression TEXT        NOT NULL," \
+        "reading    TEXT        NOT NULL," \
+        "def_tags   TEXT        NOT NULL,"  /* Space separated list */ \
+        "rules      TEXT        NOT NULL,"  /* Space separated list */ \
+        "score      INTEGER     NOT NULL," \
+        "glossary   BLOB        NOT NULL,"  /* CBOR array */ \
+        "sequence   INTEGER     NOT NULL," \
+        "term_tags  TEXT        NOT NULL"   /* Space separated list */ \
+    ");" \
+    TERM_BANK_EXP_INDEX \
+    TERM_BANK_READING_INDEX \
+    TERM_BANK_COMBO_INDEX \
+\
+    "CREATE TABLE term_meta_bank (" \
+        "dic_id     INTEGER     NOT NULL," \
+        "expression TEXT        NOT NULL," \
+        "mode       TEXT        NOT NULL," \
+        "type       INTEGER     NOT NULL,"  /* Type of data in the blob */ \
+        "data       BLOB,"                  /* Data defined by mode */ \
+        "reading    TEXT,"                  /* NULL if for every reading */ \
+        "value      NUMERIC,"               /* Frequency value */ \
+        "display    TEXT,"                  /* Frequency to display */ \
+        "pitches    TEXT"                   /* Space separated list */ \
+    ");" \
+    TERM_META_EXP_INDEX \
+\
+    "CREATE TABLE kanji_bank (" \
+        "dic_id     INTEGER     NOT NULL," \
+        "char       TEXT        NOT NULL," \
+        "onyomi     TEXT        NOT NULL,"  /* Space separated list */ \
+        "kunyomi    TEXT        NOT NULL,"  /* Space separated list */ \
+        "tags       TEXT        NOT NULL,"  /* Space separated list */ \
+        "meanings   TEXT        NOT NULL,"  /* Json array */ \
+        "stats      TEXT        NOT NULL"   /* Json object */ \
+    ");" \
+    "CREATE INDEX idx_kanji_bank_char ON kanji_bank(char);" \
+\
+    "CREATE TABLE kanji_meta_bank (" \
+        "dic_id     INTEGER     NOT NULL," \
+        "expression TEXT        NOT NULL," \
+        "mode       TEXT        NOT NULL," \
+        "type       INTEGER     NOT NULL," /* Type of data in the blob */ \
+        "data       BLOB,"                 /* Data defined by mode */ \
+        "reading    TEXT,"                 /* NULL if for every reading */ \
+        "value      NUMERIC,"              /* Frequency value */ \
+        "display    TEXT,"                 /* Frequency to display */ \
+        "pitches    TEXT"                  /* Space separated list */ \
+    ");" \
+    "CREATE INDEX idx_kanji_meta_exp ON kanji_meta_bank(expression, mode);"
+
+/**
+ * Maps the path of every resource in a dictionary archive to the range of bytes
+ * it occupies in the dictionary's resource pack.
+ */
+#define RESOURCE_SCHEMA \
+    "CREATE TABLE resource (" \
+        "dic_id     INTEGER     NOT NULL," \
+        "path       TEXT        NOT NULL,"  /* Path inside the archive */ \
+        "offset     INTEGER     NOT NULL,"  /* Byte offset in the pack */ \
+        "size       INTEGER     NOT NULL," \
+        "PRIMARY KEY(dic_id, path)" \
+    ") WITHOUT ROWID;"
+
+/**
+ * Triggers that clean up after a dictionary is removed from the directory.
+ * Dictionaries stored in their own file are removed by deleting the file.
+ */
+#define DIRECTORY_TRIGGERS \
+    "CREATE TRIGGER directory_remove AFTER DELETE ON directory " \
+    "BEGIN " \
+        "DELETE FROM dict_disabled   WHERE dic_id = old.dic_id;" \
+        "DELETE FROM resource        WHERE dic_id = old.dic_id;" \
+    "END;" \
+    "CREATE TRIGGER directory_remove_banks AFTER DELETE ON directory " \
+    "WHEN old.file IS NULL " \
+    "BEGIN " \
+        "DELETE FROM tag_bank        WHERE dic_id = old.dic_id;" \
+        "DELETE FROM term_bank       WHERE dic_id = old.dic_id;" \
+        "DELETE FROM term_meta_bank  WHERE dic_id = old.dic_id;" \
+        "DELETE FROM kanji_bank      WHERE dic_id = old.dic_id;" \
+        "DELETE FROM kanji_meta_bank WHERE dic_id = old.dic_id;" \
+    "END;"
+
 /**
  * Drops all the tables provided in argv
  * @param   db   The database to drop tables from
@@ -208,76 +540,18 @@ static int create_db(sqlite3 *db)
             "title      TEXT        NOT NULL UNIQUE,"
             "format     INTEGER     NOT NULL,"
             "revision   TEXT        NOT NULL,"
-            "sequenced  INTEGER     NOT NULL"   // Boolean
+            "sequenced  INTEGER     NOT NULL,"  // Boolean
+            "file       TEXT"                   // NULL if stored in this file
         ");"
-        "CREATE TRIGGER directory_remove AFTER DELETE ON directory "
-        "BEGIN "
-            "DELETE FROM dict_disabled   WHERE dic_id = old.dic_id;"
-            "DELETE FROM tag_bank        WHERE dic_id = old.dic_id;"
-            "DELETE FROM term_bank       WHERE dic_id = old.dic_id;"
-            "DELETE FROM term_meta_bank  WHERE dic_id = old.dic_id;"
-            "DELETE FROM kanji_bank      WHERE dic_id = old.dic_id;"
-            "DELETE FROM kanji_meta_bank WHERE dic_id = old.dic_id;"
-        "END;"
+        DIRECTORY_TRIGGERS
 
         "CREATE TABLE dict_disabled ("
             "dic_id     INTEGER     PRIMARY KEY"
         ");"
 
-        "CREATE TABLE tag_bank ("
-            "dic_id     INTEGER     NOT NULL,"
-            "name       TEXT        NOT NULL,"
-            "category   TEXT        NOT NULL,"
-            "ord        INTEGER     NOT NULL,"
-            "notes      TEXT        NOT NULL,"
-            "score      INTEGER     NOT NULL,"
-            "PRIMARY KEY(dic_id, name)"
-        ");"
-        "CREATE INDEX idx_tag_bank_name ON tag_bank(dic_id, name);"
-
-        "CREATE TABLE term_bank ("
-            "dic_id     INTEGER     NOT NULL,"
-            "expression TEXT        NOT NULL,"
-            "reading    TEXT        NOT NULL,"
-            "def_tags   TEXT        NOT NULL,"  // Space separated list
-            "rules      TEXT        NOT NULL,"  // Space separated list
-            "score      INTEGER     NOT NULL,"
-            "glossary   TEXT        NOT NULL,"  // Json array
-            "sequence   INTEGER     NOT NULL,"
-            "term_tags  TEXT        NOT NULL"   // Space separated list
-        ");"
-        "CREATE INDEX idx_term_bank_exp     ON term_bank(expression);"
-        "CREATE INDEX idx_term_bank_reading ON term_bank(reading);"
-        "CREATE INDEX idx_term_bank_combo   ON term_bank(expression, reading);"
-
-        "CREATE TABLE term_meta_bank ("
-            "dic_id     INTEGER     NOT NULL,"
-            "expression TEXT        NOT NULL,"
-            "mode       TEXT        NOT NULL,"
-            "type       INTEGER     NOT NULL,"  // Type of data in the blob
-            "data       BLOB"                   // Data defined by mode
-        ");"
-        "CREATE INDEX idx_term_meta_exp ON term_meta_bank(expression, mode);"
-
-        "CREATE TABLE kanji_bank ("
-            "dic_id     INTEGER     NOT NULL,"
-            "char       TEXT        NOT NULL,"
-            "onyomi     TEXT        NOT NULL,"  // Space separated list
-            "kunyomi    TEXT        NOT NULL,"  // Space separated list
-            "tags       TEXT        NOT NULL,"  // Space separated list
-            "meanings   TEXT        NOT NULL,"  // Json array
-            "stats      TEXT        NOT NULL"   // Json object
-        ");"
-        "CREATE INDEX idx_kanji_bank_char ON kanji_bank(char);"
-
-        "CREATE TABLE kanji_meta_bank ("
-            "dic_id     INTEGER     NOT NULL,"
-            "expression TEXT        NOT NULL,"
-            "mode       TEXT        NOT NULL,"
-            "type       INTEGER     NOT NULL," // Type of data in the blob
-            "data       BLOB"                  // Data defined by mode
-        ");"
-        "CREATE INDEX idx_kanji_meta_exp ON kanji_meta_bank(expression, mode);",
+        RESOURCE_SCHEMA
+
+        BANK_TABLES_SCHEMA,
         NULL, NULL, &errmsg
     );
     if (errmsg)
@@ -310,794 +584,4090 @@ cleanup:
     return ret;
 }
 
-static int update_v1_to_v2(sqlite3 *db)
-{
-    int        ret     = 0;
-    const int  version = 2;
-    char      *pragma  = NULL;
-    char      *errmsg  = NULL;
+/* Begin CBOR defines */
 
-    pragma = sqlite3_mprintf(
-        "ALTER TABLE term_meta_bank  ADD type INTEGER NOT NULL DEFAULT 0;"
-        "ALTER TABLE kanji_meta_bank ADD type INTEGER NOT NULL DEFAULT 0;"
+#define CBOR_MAJOR_UINT     0
+#define CBOR_MAJOR_NEGINT   1
+#define CBOR_MAJOR_STRING   3
+#define CBOR_MAJOR_ARRAY    4
+#define CBOR_MAJOR_MAP      5
 
-        "UPDATE term_meta_bank "
-            "SET   type = %u "
-            "WHERE mode = 'pitch';"
-        "UPDATE kanji_meta_bank "
-            "SET   type = %u "
-            "WHERE mode = 'pitch';"
+#define CBOR_FALSE          0xf4
+#define CBOR_TRUE           0xf5
+#define CBOR_NULL           0xf6
+#define CBOR_DOUBLE         0xfb
 
-        "UPDATE term_meta_bank "
-            "SET   type = %u "
-            "WHERE mode = 'freq';"
-        "UPDATE kanji_meta_bank "
-            "SET   type = %u "
-            "WHERE mode = 'freq';"
+#define CBOR_JSON_DEPTH     256
 
-        "PRAGMA user_version = %d;",
-        YOMI_BLOB_TYPE_OBJECT, YOMI_BLOB_TYPE_OBJECT,
-        YOMI_BLOB_TYPE_INT,    YOMI_BLOB_TYPE_INT,
-        version
-    );
-    if (pragma == NULL)
+/**
+ * A growable buffer CBOR is encoded into.
+ */
+typedef struct cbor_buffer
+{
+    unsigned char *data;
+    size_t         size;
+    size_t         capacity;
+} cbor_buffer;
+
+/**
+ * Makes room for more bytes at the end of a CBOR buffer.
+ * @param buf The buffer to grow.
+ * @param len The number of bytes that will be appended.
+ * @return Error code
+ */
+static int cbor_reserve(cbor_buffer *buf, size_t len)
+{
+    unsigned char *data     = NULL;
+    size_t         capacity = buf->capacity ? buf->capacity : 64;
+
+    if (buf->size + len <= buf->capacity)
     {
-        fprintf(stderr, "Could not allocate memory for query\n");
-        ret = MALLOC_FAILURE_ERR;
-        goto cleanup;
+        return 0;
     }
-
-    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
+    while (capacity < buf->size + len)
     {
-        fprintf(stderr,
-            "Failed to update database from version 1 to 2.\n"
-            "Error: %s\n"
-            "Query: %s\n",
-            errmsg, pragma
-        );
-        ret = DB_ALTER_TABLE_ERR;
-        goto cleanup;
+        capacity *= 2;
     }
+    data = realloc(buf->data, capacity);
+    if (data == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for CBOR\n");
+        return MALLOC_FAILURE_ERR;
+    }
+    buf->data = data;
+    buf->capacity = capacity;
 
-cleanup:
-    sqlite3_free(errmsg);
-    sqlite3_free(pragma);
-
-    return ret;
+    return 0;
 }
 
-static int update_v2_to_v3(sqlite3 *db)
+/**
+ * Appends bytes to a CBOR buffer.
+ * @param buf  The buffer to append to.
+ * @param data The bytes to append.
+ * @param len  The number of bytes to append.
+ * @return Error code
+ */
+static int cbor_put_bytes(cbor_buffer *buf, const void *data, size_t len)
 {
-    int        ret     = 0;
-    const int  version = 3;
-    char      *pragma  = NULL;
-    char      *errmsg  = NULL;
+    int ret = 0;
 
-    pragma = sqlite3_mprintf(
-        "CREATE TABLE dict_disabled ("
-            "dic_id     INTEGER     PRIMARY KEY"
-        ");"
+    if ((ret = cbor_reserve(buf, len)))
+    {
+        return ret;
+    }
+    memcpy(buf->data + buf->size, data, len);
+    buf->size += len;
 
-        "DROP TRIGGER directory_remove;"
-        "CREATE TRIGGER directory_remove AFTER DELETE ON directory "
-        "BEGIN "
-            "DELETE FROM tag_bank        WHERE dic_id = old.dic_id;"
-            "DELETE FROM term_bank       WHERE dic_id = old.dic_id;"
-            "DELETE FROM term_meta_bank  WHERE dic_id = old.dic_id;"
-            "DELETE FROM kanji_bank      WHERE dic_id = old.dic_id;"
-            "DELETE FROM kanji_meta_bank WHERE dic_id = old.dic_id;"
-            "DELETE FROM dict_disabled   WHERE dic_id = old.dic_id;"
-        "END;"
+    return 0;
+}
 
-        "PRAGMA user_version = %d;",
-        version
-    );
+/**
+ * Appends the head of a CBOR data item in its shortest form.
+ * @param buf   The buffer to append to.
+ * @param major The major type of the item.
+ * @param value The value or length of the item.
+ * @return Error code
+ */
+static int cbor_put_head(cbor_buffer *buf, unsigned int major, uint64_t value)
+{
+    unsigned char head[9];
+    size_t        len   = 0;
+    int           bytes = 0;
 
-    if (pragma == NULL)
+    major <<= 5;
+    if (value < 24)
     {
-        fprintf(stderr, "Could not allocate memory for query\n");
-        ret = MALLOC_FAILURE_ERR;
-        goto cleanup;
+        head[len++] = major | value;
     }
-
-    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
+    else
     {
-        fprintf(stderr,
-            "Failed to update database from version 2 to 3.\n"
-            "Error: %s\n"
-            "Query: %s\n",
-            errmsg, pragma
-        );
-        ret = DB_ALTER_TABLE_ERR;
-        goto cleanup;
+        if (value <= UINT8_MAX)
+        {
+            head[len++] = major | 24;
+            bytes = 1;
+        }
+        else if (value <= UINT16_MAX)
+        {
+            head[len++] = major | 25;
+            bytes = 2;
+        }
+        else if (value <= UINT32_MAX)
+        {
+            head[len++] = major | 26;
+            bytes = 4;
+        }
+        else
+        {
+            head[len++] = major | 27;
+            bytes = 8;
+        }
+        for (int i = bytes - 1; i >= 0; --i)
+        {
+            head[len++] = (value >> (i * 8)) & 0xff;
+        }
     }
 
-cleanup:
-    sqlite3_free(errmsg);
-    sqlite3_free(pragma);
-
-    return ret;
+    return cbor_put_bytes(buf, head, len);
 }
 
-static int update_v3_to_v4(sqlite3 *db)
+/**
+ * Encodes a JSON value as CBOR.
+ * @param buf The buffer to append to.
+ * @param obj The JSON value to encode.
+ * @return Error code
+ */
+static int cbor_put_json(cbor_buffer *buf, json_object *obj)
 {
-    int        ret     = 0;
-    const int  version = 4;
-    char      *pragma  = NULL;
-    char      *errmsg  = NULL;
+    int           ret   = 0;
+    unsigned char byte  = 0;
+    int64_t       num   = 0;
+    double        dbl   = 0;
+    uint64_t      bits  = 0;
+    unsigned char bytes[9];
+
+    switch (json_object_get_type(obj))
+    {
+    case json_type_null:
+        byte = CBOR_NULL;
+        return cbor_put_bytes(buf, &byte, 1);
 
-    pragma = sqlite3_mprintf(
-        "UPDATE term_bank SET reading = '' WHERE expression = reading;"
-        "PRAGMA user_version = %d;",
-        version
-    );
+    case json_type_boolean:
+        byte = json_object_get_boolean(obj) ? CBOR_TRUE : CBOR_FALSE;
+        return cbor_put_bytes(buf, &byte, 1);
 
-    if (pragma == NULL)
-    {
-        fprintf(stderr, "Could not allocate memory for query\n");
-        ret = MALLOC_FAILURE_ERR;
-        goto cleanup;
-    }
+    case json_type_int:
+        num = json_object_get_int64(obj);
+        if (num < 0)
+        {
+            return cbor_put_head(buf, CBOR_MAJOR_NEGINT, -(num + 1));
+        }
+        return cbor_put_head(buf, CBOR_MAJOR_UINT, num);
 
-    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
-    {
-        fprintf(stderr,
-            "Failed to update database from version 3 to 4.\n"
-            "Error: %s\n"
-            "Query: %s\n",
-            errmsg, pragma
-        );
-        ret = DB_ALTER_TABLE_ERR;
-        goto cleanup;
-    }
+    case json_type_double:
+        dbl = json_object_get_double(obj);
+        memcpy(&bits, &dbl, sizeof(bits));
+        bytes[0] = CBOR_DOUBLE;
+        for (int i = 0; i < 8; ++i)
+        {
+            bytes[i + 1] = (bits >> ((7 - i) * 8)) & 0xff;
+        }
+        return cbor_put_bytes(buf, bytes, sizeof(bytes));
 
-cleanup:
-    sqlite3_free(errmsg);
-    sqlite3_free(pragma);
+    case json_type_string:
+        if ((ret = cbor_put_head(buf, CBOR_MAJOR_STRING, json_object_get_string_len(obj))))
+        {
+            return ret;
+        }
+        return cbor_put_bytes(buf, json_object_get_string(obj), json_object_get_string_len(obj));
 
-    return ret;
+    case json_type_array:
+        if ((ret = cbor_put_head(buf, CBOR_MAJOR_ARRAY, json_object_array_length(obj))))
+        {
+            return ret;
+        }
+        for (size_t i = 0; i < json_object_array_length(obj); ++i)
+        {
+            if ((ret = cbor_put_json(buf, json_object_array_get_idx(obj, i))))
+            {
+                return ret;
+            }
+        }
+        return 0;
+
+    case json_type_object:
+        if ((ret = cbor_put_head(buf, CBOR_MAJOR_MAP, json_object_object_length(obj))))
+        {
+            return ret;
+        }
+        json_object_object_foreach(obj, key, val)
+        {
+            if ((ret = cbor_put_head(buf, CBOR_MAJOR_STRING, strlen(key))) ||
+                (ret = cbor_put_bytes(buf, key, strlen(key))) ||
+                (ret = cbor_put_json(buf, val)))
+            {
+                return ret;
+            }
+        }
+        return 0;
+    }
+
+    return UNKNOWN_DATA_TYPE_ERR;
 }
 
 /**
- * Create the tables in the database if they do not already exist
- * @param   db The database to add tables to
+ * Encodes a glossary as a CBOR array. Deinflection entries, which are stored as
+ * arrays, are left out since they are never displayed.
+ * @param      glossary The JSON glossary array.
+ * @param[out] buf      The buffer to append to.
+ * @param[out] count    The number of entries that were encoded.
  * @return Error code
  */
-static int prepare_db(sqlite3 *db)
+static int glossary_to_cbor(json_object *glossary, cbor_buffer *buf, size_t *count)
 {
-    int           ret          = 0;
-    int           user_version = 0;
-    sqlite3_stmt *stmt         = NULL;
-    char         *errmsg       = NULL;
+    int          ret   = 0;
+    json_object *entry = NULL;
 
-    /* Check if the schema is an empty file */
-    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, NULL) != SQLITE_OK)
-    {
-        ret = STATEMENT_PREPARE_ERR;
-        goto cleanup;
-    }
-    if (sqlite3_step(stmt) != SQLITE_ROW)
+    *count = 0;
+    for (size_t i = 0; i < json_object_array_length(glossary); ++i)
     {
-        fprintf(stderr, "Could not execute user_version check\n");
-        ret = STATEMENT_STEP_ERR;
-        goto cleanup;
+        if (!json_object_is_type(json_object_array_get_idx(glossary, i), json_type_array))
+        {
+            ++*count;
+        }
     }
-    user_version = sqlite3_column_int(stmt, 0);
-    if (user_version > YOMI_DB_VERSION)
+
+    if ((ret = cbor_put_head(buf, CBOR_MAJOR_ARRAY, *count)))
     {
-        fprintf(stderr, "Expected user_version %d, got newer version %d\n",
-                YOMI_DB_VERSION, user_version);
-        ret = DB_NEW_VERSION_ERR;
-        goto cleanup;
+        return ret;
     }
-
-    switch (user_version)
+    for (size_t i = 0; i < json_object_array_length(glossary); ++i)
     {
-    case 0:
-        if ((ret = create_db(db)))
+        entry = json_object_array_get_idx(glossary, i);
+        if (json_object_is_type(entry, json_type_array))
         {
-            fprintf(
-                stderr,
-                "Could not update the database, reported version %d\n",
-                user_version
-            );
-            goto cleanup;
+            continue;
         }
-        break;
-
-    case 1:
-        if ((ret = update_v1_to_v2(db)))
+        if ((ret = cbor_put_json(buf, entry)))
         {
-            goto cleanup;
+            return ret;
         }
-        __attribute__((fallthrough));
+    }
 
-    case 2:
-        if ((ret = update_v2_to_v3(db)))
-        {
-            goto cleanup;
-        }
-        __attribute__((fallthrough));
+    return 0;
+}
 
-    case 3:
-        if ((ret = update_v3_to_v4(db)))
-        {
-            goto cleanup;
-        }
+/**
+ * SQLite function that converts a JSON glossary into the CBOR form stored by
+ * add_term(). Values that are not text are returned unchanged.
+ * @param ctx  The SQLite function context.
+ * @param argc The number of arguments. Always 1.
+ * @param argv The glossary to convert.
+ */
+static void glossary_to_cbor_func(sqlite3_context *ctx, int argc __attribute__((unused)), sqlite3_value **argv)
+{
+    json_tokener *tok      = NULL;
+    json_object  *glossary = NULL;
+    cbor_buffer   buf      = {0};
+    size_t        count    = 0;
+
+    if (sqlite3_value_type(argv[0]) != SQLITE_TEXT)
+    {
+        sqlite3_result_value(ctx, argv[0]);
+        return;
     }
 
-    /* Set all PRAGMA value to their expected values */
-    sqlite3_exec(db, "PRAGMA recursive_triggers = true;", NULL, NULL, &errmsg);
-    if (errmsg)
+    tok = json_tokener_new_ex(CBOR_JSON_DEPTH);
+    if (tok == NULL)
     {
-        fprintf(stderr, "Could not set PRAGMA values\nError: %s\n", errmsg);
-        ret = PRAGMA_SET_ERR;
+        sqlite3_result_error_nomem(ctx);
+        return;
+    }
+    glossary = json_tokener_parse_ex(
+        tok,
+        (const char *)sqlite3_value_text(argv[0]),
+        sqlite3_value_bytes(argv[0])
+    );
+    if (!json_object_is_type(glossary, json_type_array))
+    {
+        sqlite3_result_error(ctx, "Glossary is not a JSON array", -1);
+        goto cleanup;
+    }
+    if (glossary_to_cbor(glossary, &buf, &count))
+    {
+        sqlite3_result_error_nomem(ctx);
         goto cleanup;
     }
+    sqlite3_result_blob(ctx, buf.data, buf.size, SQLITE_TRANSIENT);
 
 cleanup:
-    sqlite3_finalize(stmt);
-    sqlite3_free(errmsg);
-
-    return ret;
+    free(buf.data);
+    json_object_put(glossary);
+    json_tokener_free(tok);
 }
 
-#define YOMI_JSON_BUILDER_DEPTH 256
+#undef CBOR_MAJOR_UINT
+#undef CBOR_MAJOR_NEGINT
+#undef CBOR_MAJOR_STRING
+#undef CBOR_MAJOR_ARRAY
+#undef CBOR_MAJOR_MAP
+
+#undef CBOR_FALSE
+#undef CBOR_TRUE
+#undef CBOR_NULL
+#undef CBOR_DOUBLE
+
+#undef CBOR_JSON_DEPTH
+
+/* End CBOR defines */
+
+/* Begin meta column defines */
+
+#define META_MODE_FREQ      "freq"
+#define META_MODE_PITCH     "pitch"
+
+#define META_READING_KEY    "reading"
+#define META_FREQ_KEY       "frequency"
+#define META_VALUE_KEY      "value"
+#define META_DISPLAY_KEY    "displayValue"
+#define META_PITCHES_KEY    "pitches"
+#define META_POSITION_KEY   "position"
 
 /**
- * Parses a string into a JSON object.
- * @param str The string to parse.
- * @param len The length of the string including the nul terminator.
- * @return The JSON object on success, NULL on failure.
+ * Frequency and pitch metadata decoded into the typed columns of the meta
+ * banks so it can be read without parsing JSON.
  */
-static json_object *tokenize_json(const char *str, size_t len)
+typedef struct meta_columns
 {
-    json_tokener            *tok   = NULL;
-    json_object             *obj   = NULL;
-    enum json_tokener_error  error = json_tokener_success;
+    /* The reading the metadata applies to. NULL if it applies to every
+     * reading. Belongs to the JSON object it was decoded from. */
+    const char *reading;
 
-    tok = json_tokener_new_ex(YOMI_JSON_BUILDER_DEPTH);
-    obj = json_tokener_parse_ex(tok, str, len);
-    error = json_tokener_get_error(tok);
-    if (error != json_tokener_success)
-    {
-        fprintf(stderr, "Could not parse JSON: %s\n", json_tokener_error_desc(error));
-        goto cleanup;
-    }
+    /* Nonzero if the frequency has a numeric value */
+    int has_value;
 
-cleanup:
-    json_tokener_free(tok);
-    tok = NULL;
+    /* Nonzero if value_int holds the value, zero if value_double does */
+    int value_is_int;
 
-    return obj;
-}
+    int64_t value_int;
+    double  value_double;
 
-#undef YOMI_JSON_BUILDER_DEPTH
+    /* The frequency as it should be displayed. NULL if there is nothing to
+     * display. Free with sqlite3_free(). */
+    char *display;
+
+    /* Space separated list of downstep positions. NULL if there are none.
+     * Free with sqlite3_free(). */
+    char *pitches;
+} meta_columns;
 
 /**
- * Parse the file in the archive and returns its object representation
- * @param       archive  Archive containing the file
- * @param       filename Name of the file to get the size of
- * @param[out]  obj      The Json object
+ * Sets the numeric value of a frequency. Also sets the display string if
+ * there isn't one.
+ * @param      num  A JSON number.
+ * @param[out] cols The columns to set.
  * @return Error code
  */
-static int get_json_obj(zip_t *archive, const char *filename, json_object **obj)
+static int set_meta_value(json_object *num, meta_columns *cols)
 {
-    int                      ret        = 0;
-    struct zip_stat          st;
-    char                    *contents   = NULL;
-    struct zip_file         *file       = NULL;
-    zip_int64_t              bytes_read = 0;
-
-    /* Get the size of the file */
-    zip_stat_init(&st);
-    if (zip_stat(archive, filename, 0, &st))
+    cols->has_value = 1;
+    cols->value_is_int = json_object_is_type(num, json_type_int);
+    if (cols->value_is_int)
     {
-        fprintf(stderr, "Failed to stat file %s\n", filename);
-        ret = STAT_ERR;
-        goto cleanup;
+        cols->value_int = json_object_get_int64(num);
     }
-    if (!(st.valid & ZIP_STAT_SIZE))
+    else
     {
-        fprintf(stderr, "%s did not have a valid size\n", filename);
-        ret = INVALID_SIZE_ERR;
-        goto cleanup;
+        cols->value_double = json_object_get_double(num);
     }
 
-    /* Allocate buffer for the contents of the file */
-    contents = (char *)malloc(sizeof(char) * (st.size + 1));
-    if (!contents)
+    if (cols->display == NULL)
     {
-        fprintf(stderr, "Failed to allocate memory to read %s\n", filename);
-        ret = MALLOC_FAILURE_ERR;
-        goto cleanup;
+        cols->display = cols->value_is_int ?
+            sqlite3_mprintf("%lld", (long long)cols->value_int) :
+            sqlite3_mprintf("%g", cols->value_double);
+        if (cols->display == NULL)
+        {
+            return MALLOC_FAILURE_ERR;
+        }
     }
 
-    /* Read filename into the contents buffer */
-    file = zip_fopen(archive, filename, 0);
-    if (!file)
-    {
-        fprintf(stderr, "Could not open %s\n", filename);
-        ret = ZIP_FILE_OPEN_ERR;
-        goto cleanup;
-    }
-    bytes_read = zip_fread(file, contents, st.size);
-    if (bytes_read == -1 || (zip_uint64_t)bytes_read != st.size)
-    {
-        fprintf(stderr, "Did not read expected number of bytes in %s\n", filename);
-#ifdef __APPLE__
-        fprintf(stderr, "Expected bytes: %llu\tActual bytes read %llu\n", st.size, bytes_read);
-#elif defined(_WIN32)
-        fprintf(stderr, "Expected bytes: %lld\tActual bytes read %lld\n", st.size, bytes_read);
-#else
-        fprintf(stderr, "Expected bytes: %ld\tActual bytes read %ld\n", st.size, bytes_read);
-#endif
-        ret = ZIP_FILE_READ_ERR;
-        goto cleanup;
-    }
-    contents[st.size] = '\0';
+    return 0;
+}
 
-    /* Parse the contents into a json object */
-    *obj = tokenize_json(contents, st.size + 1);
-    if (obj == NULL)
+/**
+ * Sets the display string of a frequency.
+ * @param      str  A JSON string.
+ * @param[out] cols The columns to set.
+ * @return Error code
+ */
+static int set_meta_display(json_object *str, meta_columns *cols)
+{
+    sqlite3_free(cols->display);
+    cols->display = sqlite3_mprintf("%s", json_object_get_string(str));
+    return cols->display == NULL ? MALLOC_FAILURE_ERR : 0;
+}
+
+/**
+ * Reads a frequency stored as {"value": <number>, "displayValue": "<string>"}.
+ * The display value is preferred over the numeric value when showing it.
+ * @param      obj  The JSON object.
+ * @param[out] cols The columns to set.
+ * @return Error code
+ */
+static int decode_meta_value_obj(json_object *obj, meta_columns *cols)
+{
+    int          ret = 0;
+    json_object *val = NULL;
+
+    if (json_object_object_get_ex(obj, META_DISPLAY_KEY, &val) &&
+        json_object_is_type(val, json_type_string) &&
+        (ret = set_meta_display(val, cols)))
     {
-        ret = JSON_PARSE_ERROR;
-        goto cleanup;
+        return ret;
     }
-
-cleanup:
-    free(contents);
-    if (file)
+    if (json_object_object_get_ex(obj, META_VALUE_KEY, &val) &&
+        (json_object_is_type(val, json_type_int) || json_object_is_type(val, json_type_double)) &&
+        (ret = set_meta_value(val, cols)))
     {
-        zip_fclose(file);
+        return ret;
     }
 
-    return ret;
+    return 0;
 }
 
 /**
- * Get the json object from the parent object of type and check for correctness
- * @param      parent The object to get the value from
- * @param      key    The key to the value
- * @param      type   The type of the value
- * @param[out] obj    The object to set to the value object
+ * Decodes frequency metadata. Frequencies are stored as one of:
+ *  <number>
+ *  "<string>"
+ *  {"reading": "<reading>", "frequency": <number>}
+ *  {"reading": "<reading>", "frequency": "<string>"}
+ *  {"reading": "<reading>", "frequency": {"value": <number>, "displayValue": "<string>"}}
+ *  {"value": <number>, "displayValue": "<string>"}
+ * @param      data The data of the metadata.
+ * @param[out] cols The columns to set.
  * @return Error code
  */
-static int get_obj_from_obj(json_object *parent, const char *key,
-                            json_type type, json_object **obj)
+static int decode_meta_freq(json_object *data, meta_columns *cols)
 {
-    if (!json_object_object_get_ex(parent, key, obj))
-    {
-        fprintf(stderr, "Could not get \"%s\" key from object\n%s\n", key,
-                json_object_to_json_string_ext(parent, JSON_C_TO_STRING_PRETTY));
-        return JSON_MISSING_KEY_ERR;
-    }
-    if (!json_object_is_type(*obj, type))
+    json_object *val = NULL;
+
+    switch (json_object_get_type(data))
     {
-        fprintf(stderr, "Key \"%s\" is not of type %s\n%s\n", key, json_type_to_name(type),
-                json_object_to_json_string_ext(parent, JSON_C_TO_STRING_PRETTY));
-        return JSON_WRONG_TYPE_ERR;
-    }
+    case json_type_int:
+    case json_type_double:
+        return set_meta_value(data, cols);
 
-    return 0;
-}
+    case json_type_string:
+        return set_meta_display(data, cols);
 
-/* Begin add_index defines */
+    case json_type_object:
+        if (json_object_object_get_ex(data, META_READING_KEY, &val) &&
+            json_object_is_type(val, json_type_string))
+        {
+            cols->reading = json_object_get_string(val);
+        }
 
-#define TITLE_KEY     "title"
-#define FORMAT_KEY    "format"
-#define REV_KEY       "revision"
-#define SEQ_KEY       "sequenced"
+        if (!json_object_object_get_ex(data, META_FREQ_KEY, &val))
+        {
+            return decode_meta_value_obj(data, cols);
+        }
+        switch (json_object_get_type(val))
+        {
+        case json_type_int:
+        case json_type_double:
+            return set_meta_value(val, cols);
 
-#define QUERY   "INSERT OR REPLACE INTO directory (title, format, revision, sequenced) VALUES (?, ?, ?, ?);"
-#define TITLE_INDEX     1
-#define FORMAT_INDEX    2
-#define REV_INDEX       3
-#define SEQ_INDEX       4
+        case json_type_string:
+            return set_meta_display(val, cols);
+
+        case json_type_object:
+            return decode_meta_value_obj(val, cols);
+
+        default:
+            return 0;
+        }
+
+    default:
+        return 0;
+    }
+}
 
 /**
- * Adds the yomichan index.json file to the database
- * @param      dict_archive The dictionary archive holding index.json
- * @param      db           The database
- * @param[out] id           The id of the dictionary
+ * Decodes pitch metadata stored as
+ *  {"reading": "<reading>", "pitches": [{"position": <number>}, ...]}
+ * @param      data The data of the metadata.
+ * @param[out] cols The columns to set.
  * @return Error code
  */
-static int add_index(zip_t *dict_archive, sqlite3 *db, sqlite3_int64 *id)
+static int decode_meta_pitch(json_object *data, meta_columns *cols)
 {
-    int           ret       = 0;
-    json_object  *index_obj = NULL;
-    json_object  *ret_obj   = NULL;
-
-    const char   *title     = NULL;
-    int32_t       format    = 0;
-    const char   *revision  = NULL;
-    json_bool     sequenced = 0;
+    json_object *val      = NULL;
+    json_object *position = NULL;
+    sqlite3_str *pitches  = NULL;
 
-    sqlite3_stmt *stmt      = NULL;
-    int           step      = 0;
-
-    /* Get the index object from the index file */
-    if ((ret = get_json_obj(dict_archive, INDEX_FILE, &index_obj)))
+    if (!json_object_is_type(data, json_type_object))
     {
-        goto cleanup;
-    }
-    if (!json_object_is_type(index_obj, json_type_object))
-    {
-        fprintf(stderr, "Returned index json was not an object\n");
-        ret = JSON_WRONG_TYPE_ERR;
-        goto cleanup;
+        return 0;
     }
-
-    /* Get the fields from the json object */
-    if ((ret = get_obj_from_obj(index_obj, TITLE_KEY, json_type_string, &ret_obj)))
-        goto cleanup;
-    title = json_object_get_string(ret_obj);
-
-    if ((ret = get_obj_from_obj(index_obj, FORMAT_KEY, json_type_int, &ret_obj)))
-        goto cleanup;
-    format = json_object_get_int(ret_obj);
-
-    if ((ret = get_obj_from_obj(index_obj, REV_KEY, json_type_string, &ret_obj)))
-        goto cleanup;
-    revision = json_object_get_string(ret_obj);
-
-    if (!json_object_object_get_ex(index_obj, SEQ_KEY, &ret_obj))
+    if (json_object_object_get_ex(data, META_READING_KEY, &val) &&
+        json_object_is_type(val, json_type_string))
     {
-        sequenced = 0;
+        cols->reading = json_object_get_string(val);
     }
-    else
+    if (!json_object_object_get_ex(data, META_PITCHES_KEY, &val) ||
+        !json_object_is_type(val, json_type_array))
     {
-        if ((ret = get_obj_from_obj(index_obj, SEQ_KEY, json_type_boolean, &ret_obj)))
-            goto cleanup;
-        sequenced = json_object_get_boolean(ret_obj);
+        return 0;
     }
 
-    /* Check that the format is valid */
-    if (format != YOMI_DB_FORMAT_VERSION)
+    pitches = sqlite3_str_new(NULL);
+    for (size_t i = 0; i < json_object_array_length(val); ++i)
     {
-        fprintf(stderr, "Unsupported dictionary format %d different from supported %d\n",
-                format, YOMI_DB_FORMAT_VERSION);
-        ret = UNSUPPORTED_FORMAT_ERR;
-        goto cleanup;
+        if (!json_object_object_get_ex(json_object_array_get_idx(val, i), META_POSITION_KEY, &position))
+        {
+            continue;
+        }
+        sqlite3_str_appendf(
+            pitches, i == 0 ? "%d" : " %d", json_object_get_int(position)
+        );
     }
-
-    /* Put dictionary metadata into the index table */
-    if (sqlite3_prepare_v2(db, QUERY, -1, &stmt, NULL) != SQLITE_OK)
+    if (sqlite3_str_errcode(pitches) != SQLITE_OK)
     {
-        fprintf(stderr, "Could not prepare sqlite statement\n");
-        fprintf(stderr, "Query: %s\n", QUERY);
-        ret = STATEMENT_PREPARE_ERR;
-        goto cleanup;
+        sqlite3_free(sqlite3_str_finish(pitches));
+        return MALLOC_FAILURE_ERR;
     }
-    if (sqlite3_bind_text(stmt, TITLE_INDEX,  title,    -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_int (stmt, FORMAT_INDEX, format            ) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, REV_INDEX,    revision, -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_int (stmt, SEQ_INDEX,    sequenced         ) != SQLITE_OK)
+    cols->pitches = sqlite3_str_finish(pitches);
+
+    return 0;
+}
+
+/**
+ * Decodes frequency and pitch metadata into typed columns. Metadata of other
+ * modes leaves every column empty.
+ * @param      mode The mode of the metadata.
+ * @param      data The data of the metadata.
+ * @param[out] cols The decoded columns. Must be released with
+ *                  free_meta_columns() even on error.
+ * @return Error code
+ */
+static int decode_meta(const char *mode, json_object *data, meta_columns *cols)
+{
+    memset(cols, 0, sizeof(*cols));
+
+    if (strcmp(mode, META_MODE_FREQ) == 0)
     {
-        fprintf(stderr, "Could not bind values to sqlite statement\n");
-        ret = STATEMENT_BIND_ERR;
-        goto cleanup;
+        return decode_meta_freq(data, cols);
     }
-    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    else if (strcmp(mode, META_MODE_PITCH) == 0)
     {
-        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
-        ret = STATEMENT_STEP_ERR;
-        goto cleanup;
+        return decode_meta_pitch(data, cols);
     }
 
-    /* Copy the title into name */
-    *id = sqlite3_last_insert_rowid(db);
-
-cleanup:
-    json_object_put(index_obj);
-    sqlite3_finalize(stmt);
-
-    return ret;
+    return 0;
 }
 
-#undef TITLE_KEY
-#undef FORMAT_KEY
-#undef REV_KEY
-#undef SEQ_KEY
-
-#undef QUERY
-#undef TITLE_INDEX
-#undef FORMAT_INDEX
-#undef REV_INDEX
-#undef SEQ_INDEX
-
-/* End add_index defines */
+/**
+ * Frees the memory held by decoded metadata columns.
+ * @param cols The columns to free.
+ */
+static void free_meta_columns(meta_columns *cols)
+{
+    sqlite3_free(cols->display);
+    cols->display = NULL;
+    sqlite3_free(cols->pitches);
+    cols->pitches = NULL;
+}
 
 /**
- * Checks the type and returns an array object
- * @param      arr     The array to obtains values from
- * @param      idx     The index of the element to return
- * @param      type    The type of the element
- * @param[out] ret_obj The json object to return to
- * @return 0 on the correct type, JSON_WRONG_TYPE_ERR otherwise
+ * Binds decoded metadata columns to consecutive parameters of a statement.
+ * @param stmt  The statement to bind to.
+ * @param first The index of the parameter to bind the reading to. The value,
+ *              display and pitches parameters follow it.
+ * @param cols  The columns to bind.
+ * @return Error code
  */
-static int get_obj_from_array(json_object *arr, size_t idx, json_type type, json_object **ret_obj)
+static int bind_meta_columns(sqlite3_stmt *stmt, int first, const meta_columns *cols)
 {
-    *ret_obj = json_object_array_get_idx(arr, idx);
-    if (!json_object_is_type(*ret_obj, type))
+    int ret = 0;
+
+    ret |= cols->reading ?
+        sqlite3_bind_text(stmt, first, cols->reading, -1, NULL) :
+        sqlite3_bind_null(stmt, first);
+    if (!cols->has_value)
     {
-#ifdef _WIN32
-        fprintf(stderr, "Expected index %llu to be of type %s\n%s\n", idx, json_type_to_name(type),
-                        json_object_to_json_string_ext(arr, JSON_C_TO_STRING_PRETTY));
-#else
-        fprintf(stderr, "Expected index %lu to be of type %s\n%s\n", idx, json_type_to_name(type),
-                json_object_to_json_string_ext(arr, JSON_C_TO_STRING_PRETTY));
-#endif
-        *ret_obj = NULL;
-        return JSON_WRONG_TYPE_ERR;
+        ret |= sqlite3_bind_null(stmt, first + 1);
     }
-    return 0;
+    else if (cols->value_is_int)
+    {
+        ret |= sqlite3_bind_int64(stmt, first + 1, cols->value_int);
+    }
+    else
+    {
+        ret |= sqlite3_bind_double(stmt, first + 1, cols->value_double);
+    }
+    ret |= cols->display ?
+        sqlite3_bind_text(stmt, first + 2, cols->display, -1, NULL) :
+        sqlite3_bind_null(stmt, first + 2);
+    ret |= cols->pitches ?
+        sqlite3_bind_text(stmt, first + 3, cols->pitches, -1, NULL) :
+        sqlite3_bind_null(stmt, first + 3);
+
+    return ret == SQLITE_OK ? 0 : STATEMENT_BIND_ERR;
 }
 
-/* Begin add_tag defines */
-
-#define TAG_ARRAY_SIZE  5
-
-#define QUERY   "INSERT INTO tag_bank (dic_id, name, category, ord, notes, score) "\
-                    "VALUES (?, ?, ?, ?, ?, ?);"
+#undef META_MODE_FREQ
+#undef META_MODE_PITCH
 
-#define NAME_INDEX      0
-#define CATEGORY_INDEX  1
-#define ORDER_INDEX     2
-#define NOTES_INDEX     3
-#define SCORE_INDEX     4
+#undef META_READING_KEY
+#undef META_FREQ_KEY
+#undef META_VALUE_KEY
+#undef META_DISPLAY_KEY
+#undef META_PITCHES_KEY
+#undef META_POSITION_KEY
 
-#define QUERY_DIC_ID_INDEX    1
-#define QUERY_NAME_INDEX      2
-#define QUERY_CATEGORY_INDEX  3
-#define QUERY_ORDER_INDEX     4
-#define QUERY_NOTES_INDEX     5
-#define QUERY_SCORE_INDEX     6
+/* End meta column defines */
 
-/**
- * Add the tag stored in the json array
- * @param db  The database to add the tag to
- * @param tag The tag array to add to the database
- * @param id  The id of the dictionary the tag belongs to
- * @return Error code
- */
-static int add_tag(sqlite3 *db, json_object *tag, const sqlite3_int64 id)
+static int update_v1_to_v2(sqlite3 *db)
 {
-    int           ret      = 0;
-    json_object  *ret_obj  = NULL;
+    int        ret     = 0;
+    const int  version = 2;
+    char      *pragma  = NULL;
+    char      *errmsg  = NULL;
 
-    const char   *name     = NULL;
-    const char   *category = NULL;
-    int           order    = 0;
-    const char   *notes    = NULL;
-    int           score    = 0;
+    pragma = sqlite3_mprintf(
+        "ALTER TABLE term_meta_bank  ADD type INTEGER NOT NULL DEFAULT 0;"
+        "ALTER TABLE kanji_meta_bank ADD type INTEGER NOT NULL DEFAULT 0;"
 
-    sqlite3_stmt *stmt     = NULL;
-    int           step     = 0;
+        "UPDATE term_meta_bank "
+            "SET   type = %u "
+            "WHERE mode = 'pitch';"
+        "UPDATE kanji_meta_bank "
+            "SET   type = %u "
+            "WHERE mode = 'pitch';"
 
-    /* Make sure the length of the tag array is correct */
-    if (json_object_array_length(tag) != TAG_ARRAY_SIZE)
+        "UPDATE term_meta_bank "
+            "SET   type = %u "
+            "WHERE mode = 'freq';"
+        "UPDATE kanji_meta_bank "
+            "SET   type = %u "
+            "WHERE mode = 'freq';"
+
+        "PRAGMA user_version = %d;",
+        YOMI_BLOB_TYPE_OBJECT, YOMI_BLOB_TYPE_OBJECT,
+        YOMI_BLOB_TYPE_INT,    YOMI_BLOB_TYPE_INT,
+        version
+    );
+    if (pragma == NULL)
     {
-#ifdef _WIN32
-        fprintf(stderr, "Expected tag array of size %u, got %llu\n",
-                TAG_ARRAY_SIZE, json_object_array_length(tag));
-#else
-        fprintf(stderr, "Expected tag array of size %u, got %lu\n",
-                TAG_ARRAY_SIZE, json_object_array_length(tag));
-#endif
-        ret = TAG_WRONG_SIZE_ERR;
+        fprintf(stderr, "Could not allocate memory for query\n");
+        ret = MALLOC_FAILURE_ERR;
         goto cleanup;
     }
 
-    /* Get the objects to add to the database */
-    if ((ret = get_obj_from_array(tag, NAME_INDEX, json_type_string, &ret_obj)))
+    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
+    {
+        fprintf(stderr,
+            "Failed to update database from version 1 to 2.\n"
+            "Error: %s\n"
+            "Query: %s\n",
+            errmsg, pragma
+        );
+        ret = DB_ALTER_TABLE_ERR;
         goto cleanup;
-    name = json_object_get_string(ret_obj);
+    }
 
-    if ((ret = get_obj_from_array(tag, CATEGORY_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    category = json_object_get_string(ret_obj);
+cleanup:
+    sqlite3_free(errmsg);
+    sqlite3_free(pragma);
 
-    if ((ret = get_obj_from_array(tag, ORDER_INDEX, json_type_int, &ret_obj)))
-        goto cleanup;
-    order = json_object_get_int(ret_obj);
+    return ret;
+}
 
-    if ((ret = get_obj_from_array(tag, NOTES_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    notes = json_object_get_string(ret_obj);
+static int update_v2_to_v3(sqlite3 *db)
+{
+    int        ret     = 0;
+    const int  version = 3;
+    char      *pragma  = NULL;
+    char      *errmsg  = NULL;
 
-    if ((ret = get_obj_from_array(tag, SCORE_INDEX, json_type_int, &ret_obj)))
-        goto cleanup;
-    score = json_object_get_int(ret_obj);
+    pragma = sqlite3_mprintf(
+        "CREATE TABLE dict_disabled ("
+            "dic_id     INTEGER     PRIMARY KEY"
+        ");"
 
-    /* Add tag to the database */
-    if (sqlite3_prepare_v2(db, QUERY, -1, &stmt, NULL) != SQLITE_OK)
+        "DROP TRIGGER directory_remove;"
+        "CREATE TRIGGER directory_remove AFTER DELETE ON directory "
+        "BEGIN "
+            "DELETE FROM tag_bank        WHERE dic_id = old.dic_id;"
+            "DELETE FROM term_bank       WHERE dic_id = old.dic_id;"
+            "DELETE FROM term_meta_bank  WHERE dic_id = old.dic_id;"
+            "DELETE FROM kanji_bank      WHERE dic_id = old.dic_id;"
+            "DELETE FROM kanji_meta_bank WHERE dic_id = old.dic_id;"
+            "DELETE FROM dict_disabled   WHERE dic_id = old.dic_id;"
+        "END;"
+
+        "PRAGMA user_version = %d;",
+        version
+    );
+
+    if (pragma == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for query\n");
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+
+    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
+    {
+        fprintf(stderr,
+            "Failed to update database from version 2 to 3.\n"
+            "Error: %s\n"
+            "Query: %s\n",
+            errmsg, pragma
+        );
+        ret = DB_ALTER_TABLE_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_free(errmsg);
+    sqlite3_free(pragma);
+
+    return ret;
+}
+
+static int update_v3_to_v4(sqlite3 *db)
+{
+    int        ret     = 0;
+    const int  version = 4;
+    char      *pragma  = NULL;
+    char      *errmsg  = NULL;
+
+    pragma = sqlite3_mprintf(
+        "UPDATE term_bank SET reading = '' WHERE expression = reading;"
+        "PRAGMA user_version = %d;",
+        version
+    );
+
+    if (pragma == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for query\n");
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+
+    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
+    {
+        fprintf(stderr,
+            "Failed to update database from version 3 to 4.\n"
+            "Error: %s\n"
+            "Query: %s\n",
+            errmsg, pragma
+        );
+        ret = DB_ALTER_TABLE_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_free(errmsg);
+    sqlite3_free(pragma);
+
+    return ret;
+}
+
+static int update_v4_to_v5(sqlite3 *db)
+{
+    int        ret     = 0;
+    const int  version = 5;
+    char      *pragma  = NULL;
+    char      *errmsg  = NULL;
+
+    pragma = sqlite3_mprintf(
+        "ALTER TABLE directory ADD file TEXT;"
+
+        /* The triggers as of version 5. Later versions replace them. */
+        "DROP TRIGGER directory_remove;"
+        "CREATE TRIGGER directory_remove AFTER DELETE ON directory "
+        "BEGIN "
+            "DELETE FROM dict_disabled   WHERE dic_id = old.dic_id;"
+        "END;"
+        "CREATE TRIGGER directory_remove_banks AFTER DELETE ON directory "
+        "WHEN old.file IS NULL "
+        "BEGIN "
+            "DELETE FROM tag_bank        WHERE dic_id = old.dic_id;"
+            "DELETE FROM term_bank       WHERE dic_id = old.dic_id;"
+            "DELETE FROM term_meta_bank  WHERE dic_id = old.dic_id;"
+            "DELETE FROM kanji_bank      WHERE dic_id = old.dic_id;"
+            "DELETE FROM kanji_meta_bank WHERE dic_id = old.dic_id;"
+        "END;"
+
+        "PRAGMA user_version = %d;",
+        version
+    );
+
+    if (pragma == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for query\n");
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+
+    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
+    {
+        fprintf(stderr,
+            "Failed to update database from version 4 to 5.\n"
+            "Error: %s\n"
+            "Query: %s\n",
+            errmsg, pragma
+        );
+        ret = DB_ALTER_TABLE_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_free(errmsg);
+    sqlite3_free(pragma);
+
+    return ret;
+}
+
+static int update_v5_to_v6(sqlite3 *db)
+{
+    int        ret     = 0;
+    const int  version = 6;
+    char      *pragma  = NULL;
+    char      *errmsg  = NULL;
+
+    pragma = sqlite3_mprintf(
+        RESOURCE_SCHEMA
+
+        "DROP TRIGGER directory_remove;"
+        "DROP TRIGGER directory_remove_banks;"
+        DIRECTORY_TRIGGERS
+
+        "PRAGMA user_version = %d;",
+        version
+    );
+
+    if (pragma == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for query\n");
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+
+    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
+    {
+        fprintf(stderr,
+            "Failed to update database from version 5 to 6.\n"
+            "Error: %s\n"
+            "Query: %s\n",
+            errmsg, pragma
+        );
+        ret = DB_ALTER_TABLE_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_free(errmsg);
+    sqlite3_free(pragma);
+
+    return ret;
+}
+
+static char *get_dict_file_path(const char *db_file, const char *file);
+
+/* A glossary with every entry stripped */
+#define EMPTY_GLOSSARY "x'80'"
+
+/**
+ * Converts the JSON glossaries in a database to CBOR and sets its version.
+ * @param db      The database to convert.
+ * @param version The version to set.
+ * @return Error code
+ */
+static int convert_glossaries(sqlite3 *db, const int version)
+{
+    int   ret    = 0;
+    char *pragma = NULL;
+    char *errmsg = NULL;
+
+    if (sqlite3_create_function_v2(
+            db, "yomi_glossary_to_cbor", 1,
+            SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+            NULL, glossary_to_cbor_func, NULL, NULL, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not register glossary conversion function\n");
+        ret = DB_ALTER_TABLE_ERR;
+        goto cleanup;
+    }
+
+    pragma = sqlite3_mprintf(
+        "BEGIN;"
+        "UPDATE term_bank "
+            "SET   glossary = yomi_glossary_to_cbor(glossary) "
+            "WHERE typeof(glossary) = 'text';"
+        "DELETE FROM term_bank WHERE glossary = " EMPTY_GLOSSARY ";"
+        "PRAGMA user_version = %d;"
+        "COMMIT;",
+        version
+    );
+    if (pragma == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for query\n");
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+
+    if (sqlite3_exec(db, pragma, NULL, NULL, &errmsg) != SQLITE_OK)
+    {
+        fprintf(stderr,
+            "Failed to convert glossaries.\n"
+            "Error: %s\n",
+            errmsg
+        );
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+        ret = DB_ALTER_TABLE_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_create_function_v2(db, "yomi_glossary_to_cbor", 1, SQLITE_UTF8, NULL, NULL, NULL, NULL, NULL);
+    sqlite3_free(errmsg);
+    sqlite3_free(pragma);
+
+    return ret;
+}
+
+#undef EMPTY_GLOSSARY
+
+/**
+ * Applies an update to every dictionary stored in its own file.
+ * @param db      The main database.
+ * @param update  The update to apply to each dictionary file.
+ * @param version The version to pass to update.
+ * @return Error code
+ */
+static int update_dict_files(sqlite3 *db, int (*update)(sqlite3 *, const int), const int version)
+{
+    int           ret     = 0;
+    sqlite3_stmt *stmt    = NULL;
+    sqlite3      *dict_db = NULL;
+    char         *path    = NULL;
+    int           step    = 0;
+
+    if (sqlite3_prepare_v2(db, "SELECT file FROM directory WHERE file IS NOT NULL;", -1, &stmt, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not prepare sqlite statement\n");
+        ret = STATEMENT_PREPARE_ERR;
+        goto cleanup;
+    }
+    while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        path = get_dict_file_path(
+            sqlite3_db_filename(db, "main"),
+            (const char *)sqlite3_column_text(stmt, 0)
+        );
+        if (path == NULL)
+        {
+            fprintf(stderr, "Could not allocate memory for dictionary file path\n");
+            ret = MALLOC_FAILURE_ERR;
+            goto cleanup;
+        }
+        if (sqlite3_open_v2(path, &dict_db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK)
+        {
+            fprintf(stderr, "Could not open dictionary file %s\n", path);
+            ret = CREATE_DB_ERR;
+            goto cleanup;
+        }
+        if ((ret = update(dict_db, version)))
+        {
+            goto cleanup;
+        }
+        sqlite3_close_v2(dict_db);
+        dict_db = NULL;
+        free(path);
+        path = NULL;
+    }
+    if (step != SQLITE_DONE)
+    {
+        fprintf(stderr, "Could not list dictionary files, sqlite3 error code %d\n", step);
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_finalize(stmt);
+    sqlite3_close_v2(dict_db);
+    free(path);
+
+    return ret;
+}
+
+static int update_v6_to_v7(sqlite3 *db)
+{
+    int ret = 0;
+
+    /* Dictionary files are converted first so the main database is only
+     * marked as updated once everything is converted */
+    if ((ret = update_dict_files(db, convert_glossaries, 7)) ||
+        (ret = convert_glossaries(db, 7)))
+    {
+        fprintf(stderr, "Failed to update database from version 6 to 7.\n");
+    }
+
+    return ret;
+}
+
+/* Begin update_v7_to_v8 defines */
+
+#define META_COLUMNS_SCHEMA(table) \
+    "ALTER TABLE " table " ADD reading TEXT;" \
+    "ALTER TABLE " table " ADD value   NUMERIC;" \
+    "ALTER TABLE " table " ADD display TEXT;" \
+    "ALTER TABLE " table " ADD pitches TEXT;"
+
+#define QUERY_SELECT    "SELECT rowid, mode, type, data FROM %s WHERE mode IN ('freq', 'pitch');"
+#define QUERY_UPDATE    "UPDATE %s SET reading = ?, value = ?, display = ?, pitches = ? WHERE rowid = ?;"
+
+#define QUERY_SELECT_ROWID_INDEX    0
+#define QUERY_SELECT_MODE_INDEX     1
+#define QUERY_SELECT_TYPE_INDEX     2
+#define QUERY_SELECT_DATA_INDEX     3
+
+#define QUERY_UPDATE_COLUMNS_INDEX  1
+#define QUERY_UPDATE_ROWID_INDEX    5
+
+#define META_JSON_DEPTH 256
+
+static const char *META_TABLE_NAMES[] = {"term_meta_bank", "kanji_meta_bank"};
+
+#define META_TABLE_COUNT \
+    (sizeof(META_TABLE_NAMES) / sizeof(META_TABLE_NAMES[0]))
+
+/**
+ * Converts metadata stored in a data blob back into JSON.
+ * @param type The type of data in the blob.
+ * @param data The blob.
+ * @param len  The size of the blob in bytes.
+ * @return The JSON value. NULL if the type is not decoded into columns.
+ */
+static json_object *meta_blob_to_json(yomi_blob_t type, const void *data, int len)
+{
+    json_tokener *tok      = NULL;
+    json_object  *obj      = NULL;
+    int64_t       data_int = 0;
+    double        data_dbl = 0;
+
+    if (data == NULL)
+    {
+        return NULL;
+    }
+
+    switch (type)
+    {
+    case YOMI_BLOB_TYPE_INT:
+        memcpy(&data_int, data, sizeof(data_int));
+        return json_object_new_int64(data_int);
+
+    case YOMI_BLOB_TYPE_DOUBLE:
+        memcpy(&data_dbl, data, sizeof(data_dbl));
+        return json_object_new_double(data_dbl);
+
+    case YOMI_BLOB_TYPE_STRING:
+        return json_object_new_string(data);
+
+    case YOMI_BLOB_TYPE_OBJECT:
+    case YOMI_BLOB_TYPE_ARRAY:
+        tok = json_tokener_new_ex(META_JSON_DEPTH);
+        if (tok == NULL)
+        {
+            return NULL;
+        }
+        obj = json_tokener_parse_ex(tok, data, len);
+        json_tokener_free(tok);
+        return obj;
+
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * Adds the typed metadata columns to a database, fills them from the data
+ * blobs and sets its version.
+ * @param db      The database to update.
+ * @param version The version to set.
+ * @return Error code
+ */
+static int add_meta_columns(sqlite3 *db, const int version)
+{
+    int            ret    = 0;
+    char          *query  = NULL;
+    char          *errmsg = NULL;
+    sqlite3_stmt  *select = NULL;
+    sqlite3_stmt  *update = NULL;
+    json_object   *data   = NULL;
+    meta_columns   cols   = {0};
+    int            step   = 0;
+
+    if ((ret = begin_transaction(db)))
+    {
+        return ret;
+    }
+
+    sqlite3_exec(
+        db,
+        META_COLUMNS_SCHEMA("term_meta_bank")
+        META_COLUMNS_SCHEMA("kanji_meta_bank"),
+        NULL, NULL, &errmsg
+    );
+    if (errmsg)
+    {
+        fprintf(stderr, "Failed to add metadata columns\nError: %s\n", errmsg);
+        ret = DB_ALTER_TABLE_ERR;
+        goto cleanup;
+    }
+
+    for (size_t i = 0; i < META_TABLE_COUNT; ++i)
+    {
+        query = sqlite3_mprintf(QUERY_SELECT, META_TABLE_NAMES[i]);
+        if (query == NULL ||
+            sqlite3_prepare_v2(db, query, -1, &select, NULL) != SQLITE_OK)
+        {
+            fprintf(stderr, "Could not prepare sqlite statement\n");
+            ret = STATEMENT_PREPARE_ERR;
+            goto cleanup;
+        }
+        sqlite3_free(query);
+        query = sqlite3_mprintf(QUERY_UPDATE, META_TABLE_NAMES[i]);
+        if (query == NULL ||
+            sqlite3_prepare_v2(db, query, -1, &update, NULL) != SQLITE_OK)
+        {
+            fprintf(stderr, "Could not prepare sqlite statement\n");
+            ret = STATEMENT_PREPARE_ERR;
+            goto cleanup;
+        }
+        sqlite3_free(query);
+        query = NULL;
+
+        while ((step = sqlite3_step(select)) == SQLITE_ROW)
+        {
+            data = meta_blob_to_json(
+                sqlite3_column_int(select, QUERY_SELECT_TYPE_INDEX),
+                sqlite3_column_blob(select, QUERY_SELECT_DATA_INDEX),
+                sqlite3_column_bytes(select, QUERY_SELECT_DATA_INDEX)
+            );
+            if (data == NULL)
+            {
+                continue;
+            }
+            if ((ret = decode_meta(
+                    (const char *)sqlite3_column_text(select, QUERY_SELECT_MODE_INDEX),
+                    data, &cols)))
+            {
+                goto cleanup;
+            }
+            if ((ret = bind_meta_columns(update, QUERY_UPDATE_COLUMNS_INDEX, &cols)) ||
+                sqlite3_bind_int64(update, QUERY_UPDATE_ROWID_INDEX,
+                    sqlite3_column_int64(select, QUERY_SELECT_ROWID_INDEX)) != SQLITE_OK)
+            {
+                fprintf(stderr, "Could not bind values to sqlite statement\n");
+                ret = STATEMENT_BIND_ERR;
+                goto cleanup;
+            }
+            if ((step = sqlite3_step(update)) != SQLITE_DONE)
+            {
+                fprintf(stderr, "Could not update metadata, sqlite3 error code %d\n", step);
+                ret = STATEMENT_STEP_ERR;
+                goto cleanup;
+            }
+            sqlite3_reset(update);
+            sqlite3_clear_bindings(update);
+            free_meta_columns(&cols);
+            json_object_put(data);
+            data = NULL;
+        }
+        if (step != SQLITE_DONE)
+        {
+            fprintf(stderr, "Could not read metadata, sqlite3 error code %d\n", step);
+            ret = STATEMENT_STEP_ERR;
+            goto cleanup;
+        }
+        sqlite3_finalize(select);
+        select = NULL;
+        sqlite3_finalize(update);
+        update = NULL;
+    }
+
+    /* Readings are filtered in SQL, so they are indexed */
+    query = sqlite3_mprintf(
+        "DROP INDEX idx_term_meta_exp;"
+        TERM_META_EXP_INDEX
+        "PRAGMA user_version = %d;",
+        version
+    );
+    if (query == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for query\n");
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+    sqlite3_exec(db, query, NULL, NULL, &errmsg);
+    if (errmsg)
+    {
+        fprintf(stderr, "Failed to index metadata columns\nError: %s\n", errmsg);
+        ret = DB_ALTER_TABLE_ERR;
+        goto cleanup;
+    }
+
+    ret = commit_transaction(db);
+
+cleanup:
+    if (ret)
+    {
+        rollback_transaction(db);
+    }
+    free_meta_columns(&cols);
+    json_object_put(data);
+    sqlite3_finalize(select);
+    sqlite3_finalize(update);
+    sqlite3_free(query);
+    sqlite3_free(errmsg);
+
+    return ret;
+}
+
+static int update_v7_to_v8(sqlite3 *db)
+{
+    int ret = 0;
+
+    if ((ret = update_dict_files(db, add_meta_columns, 8)) ||
+        (ret = add_meta_columns(db, 8)))
+    {
+        fprintf(stderr, "Failed to update database from version 7 to 8.\n");
+    }
+
+    return ret;
+}
+
+#undef META_COLUMNS_SCHEMA
+
+#undef QUERY_SELECT
+#undef QUERY_UPDATE
+
+#undef QUERY_SELECT_ROWID_INDEX
+#undef QUERY_SELECT_MODE_INDEX
+#undef QUERY_SELECT_TYPE_INDEX
+#undef QUERY_SELECT_DATA_INDEX
+
+#undef QUERY_UPDATE_COLUMNS_INDEX
+#undef QUERY_UPDATE_ROWID_INDEX
+
+#undef META_JSON_DEPTH
+
+#undef META_TABLE_COUNT
+
+/* End update_v7_to_v8 defines */
+
+/**
+ * Write-ahead logging lets readers keep querying while a dictionary is being
+ * imported. Persists in the database file once set.
+ */
+#define JOURNAL_MODE_PRAGMA "PRAGMA journal_mode = WAL;"
+
+/**
+ * Create the tables in the database if they do not already exist
+ * @param   db The database to add tables to
+ * @return Error code
+ */
+static int prepare_db(sqlite3 *db)
+{
+    int           ret          = 0;
+    int           user_version = 0;
+    sqlite3_stmt *stmt         = NULL;
+    char         *errmsg       = NULL;
+
+    /* Check if the schema is an empty file */
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, NULL) != SQLITE_OK)
+    {
+        ret = STATEMENT_PREPARE_ERR;
+        goto cleanup;
+    }
+    if (sqlite3_step(stmt) != SQLITE_ROW)
+    {
+        fprintf(stderr, "Could not execute user_version check\n");
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+    user_version = sqlite3_column_int(stmt, 0);
+    if (user_version > YOMI_DB_VERSION)
+    {
+        fprintf(stderr, "Expected user_version %d, got newer version %d\n",
+                YOMI_DB_VERSION, user_version);
+        ret = DB_NEW_VERSION_ERR;
+        goto cleanup;
+    }
+
+    switch (user_version)
+    {
+    case 0:
+        if ((ret = create_db(db)))
+        {
+            fprintf(
+                stderr,
+                "Could not update the database, reported version %d\n",
+                user_version
+            );
+            goto cleanup;
+        }
+        break;
+
+    case 1:
+        if ((ret = update_v1_to_v2(db)))
+        {
+            goto cleanup;
+        }
+        __attribute__((fallthrough));
+
+    case 2:
+        if ((ret = update_v2_to_v3(db)))
+        {
+            goto cleanup;
+        }
+        __attribute__((fallthrough));
+
+    case 3:
+        if ((ret = update_v3_to_v4(db)))
+        {
+            goto cleanup;
+        }
+        __attribute__((fallthrough));
+
+    case 4:
+        if ((ret = update_v4_to_v5(db)))
+        {
+            goto cleanup;
+        }
+        __attribute__((fallthrough));
+
+    case 5:
+        if ((ret = update_v5_to_v6(db)))
+        {
+            goto cleanup;
+        }
+        __attribute__((fallthrough));
+
+    case 6:
+        if ((ret = update_v6_to_v7(db)))
+        {
+            goto cleanup;
+        }
+        __attribute__((fallthrough));
+
+    case 7:
+        if ((ret = update_v7_to_v8(db)))
+        {
+            goto cleanup;
+        }
+    }
+
+    /* Set all PRAGMA value to their expected values */
+    sqlite3_exec(db, "PRAGMA recursive_triggers = true;" JOURNAL_MODE_PRAGMA, NULL, NULL, &errmsg);
+    if (errmsg)
+    {
+        fprintf(stderr, "Could not set PRAGMA values\nError: %s\n", errmsg);
+        ret = PRAGMA_SET_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_finalize(stmt);
+    sqlite3_free(errmsg);
+
+    return ret;
+}
+
+#define YOMI_JSON_BUILDER_DEPTH 256
+
+/**
+ * Parses a string into a JSON object.
+ * @param str The string to parse.
+ * @param len The length of the string including the nul terminator.
+ * @return The JSON object on success, NULL on failure.
+ */
+static json_object *tokenize_json(const char *str, size_t len)
+{
+    json_tokener            *tok   = NULL;
+    json_object             *obj   = NULL;
+    enum json_tokener_error  error = json_tokener_success;
+
+    tok = json_tokener_new_ex(YOMI_JSON_BUILDER_DEPTH);
+    obj = json_tokener_parse_ex(tok, str, len);
+    error = json_tokener_get_error(tok);
+    if (error != json_tokener_success)
+    {
+        fprintf(stderr, "Could not parse JSON: %s\n", json_tokener_error_desc(error));
+        goto cleanup;
+    }
+
+cleanup:
+    json_tokener_free(tok);
+    tok = NULL;
+
+    return obj;
+}
+
+#undef YOMI_JSON_BUILDER_DEPTH
+
+/**
+ * Parse the file in the archive and returns its object representation
+ * @param       archive  Archive containing the file
+ * @param       filename Name of the file to get the size of
+ * @param[out]  obj      The Json object
+ * @return Error code
+ */
+static int get_json_obj(zip_t *archive, const char *filename, json_object **obj)
+{
+    int                      ret        = 0;
+    struct zip_stat          st;
+    char                    *contents   = NULL;
+    struct zip_file         *file       = NULL;
+    zip_int64_t              bytes_read = 0;
+
+    /* Get the size of the file */
+    zip_stat_init(&st);
+    if (zip_stat(archive, filename, 0, &st))
+    {
+        fprintf(stderr, "Failed to stat file %s\n", filename);
+        ret = STAT_ERR;
+        goto cleanup;
+    }
+    if (!(st.valid & ZIP_STAT_SIZE))
+    {
+        fprintf(stderr, "%s did not have a valid size\n", filename);
+        ret = INVALID_SIZE_ERR;
+        goto cleanup;
+    }
+
+    /* Allocate buffer for the contents of the file */
+    contents = (char *)malloc(sizeof(char) * (st.size + 1));
+    if (!contents)
+    {
+        fprintf(stderr, "Failed to allocate memory to read %s\n", filename);
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+
+    /* Read filename into the contents buffer */
+    file = zip_fopen(archive, filename, 0);
+    if (!file)
+    {
+        fprintf(stderr, "Could not open %s\n", filename);
+        ret = ZIP_FILE_OPEN_ERR;
+        goto cleanup;
+    }
+    bytes_read = zip_fread(file, contents, st.size);
+    if (bytes_read == -1 || (zip_uint64_t)bytes_read != st.size)
+    {
+        fprintf(stderr, "Did not read expected number of bytes in %s\n", filename);
+#ifdef __APPLE__
+        fprintf(stderr, "Expected bytes: %llu\tActual bytes read %llu\n", st.size, bytes_read);
+#elif defined(_WIN32)
+        fprintf(stderr, "Expected bytes: %lld\tActual bytes read %lld\n", st.size, bytes_read);
+#else
+        fprintf(stderr, "Expected bytes: %ld\tActual bytes read %ld\n", st.size, bytes_read);
+#endif
+        ret = ZIP_FILE_READ_ERR;
+        goto cleanup;
+    }
+    contents[st.size] = '\0';
+
+    /* Parse the contents into a json object */
+    *obj = tokenize_json(contents, st.size + 1);
+    if (obj == NULL)
+    {
+        ret = JSON_PARSE_ERROR;
+        goto cleanup;
+    }
+
+cleanup:
+    free(contents);
+    if (file)
+    {
+        zip_fclose(file);
+    }
+
+    return ret;
+}
+
+/* Begin stream_json_array defines */
+
+#define STREAM_CHUNK_SIZE       (64 * 1024)
+#define STREAM_BUILDER_DEPTH    256
+
+/**
+ * Positions of the stream reader within the outer array.
+ */
+typedef enum stream_state
+{
+    /* Before the opening bracket of the outer array */
+    stream_outer_start,
+
+    /* Before the first element or the closing bracket */
+    stream_element_start,
+
+    /* After a comma, before an element */
+    stream_element_next,
+
+    /* Inside an element that is being handed to the tokener */
+    stream_element,
+
+    /* After an element, expecting a comma or the closing bracket */
+    stream_separator,
+
+    /* After the closing bracket of the outer array */
+    stream_outer_end
+} stream_state;
+
+/**
+ * Callback for every element of an array read by stream_json_array().
+ * @param elem The element. Belongs to the callback.
+ * @param data The user data passed to stream_json_array().
+ * @return Error code. Nonzero stops the stream.
+ */
+typedef int (*stream_callback)(json_object *elem, void *data);
+
+/**
+ * Checks if a character is JSON whitespace.
+ * @param c The character to check.
+ * @return 1 if whitespace, 0 otherwise.
+ */
+static int is_json_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+ * Reads a file in the archive containing a JSON array one element at a time.
+ * Only STREAM_CHUNK_SIZE bytes of the file and a single element are held in
+ * memory at once, regardless of the size of the file.
+ * @param archive  Archive containing the file.
+ * @param filename Name of the file to read.
+ * @param callback Called for every element of the outer array in order.
+ * @param data     User data passed to the callback.
+ * @return Error code
+ */
+static int stream_json_array(zip_t *archive, const char *filename,
+                             stream_callback callback, void *data)
+{
+    int                      ret        = 0;
+    struct zip_file         *file       = NULL;
+    json_tokener            *tok        = NULL;
+    char                    *chunk      = NULL;
+    zip_int64_t              bytes_read = 0;
+    stream_state             state      = stream_outer_start;
+
+    chunk = malloc(STREAM_CHUNK_SIZE);
+    tok = json_tokener_new_ex(STREAM_BUILDER_DEPTH);
+    if (chunk == NULL || tok == NULL)
+    {
+        fprintf(stderr, "Failed to allocate memory to read %s\n", filename);
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+
+    file = zip_fopen(archive, filename, 0);
+    if (!file)
+    {
+        fprintf(stderr, "Could not open %s\n", filename);
+        ret = ZIP_FILE_OPEN_ERR;
+        goto cleanup;
+    }
+
+    while ((bytes_read = zip_fread(file, chunk, STREAM_CHUNK_SIZE)) > 0)
+    {
+        size_t len = bytes_read;
+        size_t pos = 0;
+
+        while (pos < len)
+        {
+            if (state != stream_element && is_json_space(chunk[pos]))
+            {
+                ++pos;
+                continue;
+            }
+
+            switch (state)
+            {
+            case stream_outer_start:
+                if (chunk[pos] != '[')
+                {
+                    fprintf(stderr, "Expected %s to contain an array\n", filename);
+                    ret = JSON_WRONG_TYPE_ERR;
+                    goto cleanup;
+                }
+                ++pos;
+                state = stream_element_start;
+                break;
+
+            case stream_element_start:
+                if (chunk[pos] == ']')
+                {
+                    ++pos;
+                    state = stream_outer_end;
+                    break;
+                }
+                state = stream_element;
+                break;
+
+            case stream_element_next:
+                if (chunk[pos] == ']')
+                {
+                    fprintf(stderr, "Trailing comma in %s\n", filename);
+                    ret = JSON_PARSE_ERROR;
+                    goto cleanup;
+                }
+                state = stream_element;
+                break;
+
+            case stream_element:
+            {
+                json_object *elem = json_tokener_parse_ex(tok, chunk + pos, len - pos);
+                enum json_tokener_error error = json_tokener_get_error(tok);
+                if (error == json_tokener_continue)
+                {
+                    pos = len;
+                    break;
+                }
+                if (error != json_tokener_success || elem == NULL)
+                {
+                    fprintf(stderr, "Could not parse JSON in %s: %s\n",
+                            filename, json_tokener_error_desc(error));
+                    json_object_put(elem);
+                    ret = JSON_PARSE_ERROR;
+                    goto cleanup;
+                }
+                pos += json_tokener_get_parse_end(tok);
+                json_tokener_reset(tok);
+                state = stream_separator;
+
+                if ((ret = callback(elem, data)))
+                {
+                    goto cleanup;
+                }
+                break;
+            }
+
+            case stream_separator:
+                if (chunk[pos] == ',')
+                {
+                    state = stream_element_next;
+                }
+                else if (chunk[pos] == ']')
+                {
+                    state = stream_outer_end;
+                }
+                else
+                {
+                    fprintf(stderr, "Unexpected character '%c' in %s\n",
+                            chunk[pos], filename);
+                    ret = JSON_PARSE_ERROR;
+                    goto cleanup;
+                }
+                ++pos;
+                break;
+
+            case stream_outer_end:
+                fprintf(stderr, "Unexpected data after the array in %s\n", filename);
+                ret = JSON_PARSE_ERROR;
+                goto cleanup;
+            }
+        }
+    }
+    if (bytes_read < 0)
+    {
+        fprintf(stderr, "Could not read %s\n", filename);
+        ret = ZIP_FILE_READ_ERR;
+        goto cleanup;
+    }
+    if (state != stream_outer_end)
+    {
+        fprintf(stderr, "Unexpected end of file in %s\n", filename);
+        ret = JSON_PARSE_ERROR;
+        goto cleanup;
+    }
+
+cleanup:
+    if (file)
+    {
+        zip_fclose(file);
+    }
+    if (tok)
+    {
+        json_tokener_free(tok);
+    }
+    free(chunk);
+
+    return ret;
+}
+
+#undef STREAM_CHUNK_SIZE
+#undef STREAM_BUILDER_DEPTH
+
+/* End stream_json_array defines */
+
+/**
+ * Get the json object from the parent object of type and check for correctness
+ * @param      parent The object to get the value from
+ * @param      key    The key to the value
+ * @param      type   The type of the value
+ * @param[out] obj    The object to set to the value object
+ * @return Error code
+ */
+static int get_obj_from_obj(json_object *parent, const char *key,
+                            json_type type, json_object **obj)
+{
+    if (!json_object_object_get_ex(parent, key, obj))
+    {
+        fprintf(stderr, "Could not get \"%s\" key from object\n%s\n", key,
+                json_object_to_json_string_ext(parent, JSON_C_TO_STRING_PRETTY));
+        return JSON_MISSING_KEY_ERR;
+    }
+    if (!json_object_is_type(*obj, type))
+    {
+        fprintf(stderr, "Key \"%s\" is not of type %s\n%s\n", key, json_type_to_name(type),
+                json_object_to_json_string_ext(parent, JSON_C_TO_STRING_PRETTY));
+        return JSON_WRONG_TYPE_ERR;
+    }
+
+    return 0;
+}
+
+/* Begin add_index defines */
+
+#define TITLE_KEY     "title"
+#define FORMAT_KEY    "format"
+#define REV_KEY       "revision"
+#define SEQ_KEY       "sequenced"
+
+#define QUERY   "INSERT INTO directory (title, format, revision, sequenced) VALUES (?, ?, ?, ?);"
+#define TITLE_INDEX     1
+#define FORMAT_INDEX    2
+#define REV_INDEX       3
+#define SEQ_INDEX       4
+
+/**
+ * The fields of a yomichan index.json file.
+ */
+typedef struct index_info
+{
+    /* The parsed index.json. Owns all the strings below. */
+    json_object *obj;
+
+    const char *title;
+    int32_t format;
+    const char *revision;
+    json_bool sequenced;
+} index_info;
+
+/**
+ * Reads the yomichan index.json file from the archive
+ * @param      dict_archive The dictionary archive holding index.json
+ * @param[out] info         The fields of index.json. info->obj belongs to the
+ *                          caller and must be freed with json_object_put().
+ * @return Error code
+ */
+static int read_index(zip_t *dict_archive, index_info *info)
+{
+    int           ret       = 0;
+    json_object  *ret_obj   = NULL;
+
+    memset(info, 0, sizeof(*info));
+
+    /* Get the index object from the index file */
+    if ((ret = get_json_obj(dict_archive, INDEX_FILE, &info->obj)))
+    {
+        return ret;
+    }
+    if (!json_object_is_type(info->obj, json_type_object))
+    {
+        fprintf(stderr, "Returned index json was not an object\n");
+        return JSON_WRONG_TYPE_ERR;
+    }
+
+    /* Get the fields from the json object */
+    if ((ret = get_obj_from_obj(info->obj, TITLE_KEY, json_type_string, &ret_obj)))
+        return ret;
+    info->title = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_obj(info->obj, FORMAT_KEY, json_type_int, &ret_obj)))
+        return ret;
+    info->format = json_object_get_int(ret_obj);
+
+    if ((ret = get_obj_from_obj(info->obj, REV_KEY, json_type_string, &ret_obj)))
+        return ret;
+    info->revision = json_object_get_string(ret_obj);
+
+    if (!json_object_object_get_ex(info->obj, SEQ_KEY, &ret_obj))
+    {
+        info->sequenced = 0;
+    }
+    else
+    {
+        if ((ret = get_obj_from_obj(info->obj, SEQ_KEY, json_type_boolean, &ret_obj)))
+            return ret;
+        info->sequenced = json_object_get_boolean(ret_obj);
+    }
+
+    /* Check that the format is valid */
+    if (info->format != YOMI_DB_FORMAT_VERSION)
+    {
+        fprintf(stderr, "Unsupported dictionary format %d different from supported %d\n",
+                info->format, YOMI_DB_FORMAT_VERSION);
+        return UNSUPPORTED_FORMAT_ERR;
+    }
+
+    return 0;
+}
+
+/**
+ * Adds the yomichan index.json file to the database
+ * @param      dict_archive The dictionary archive holding index.json
+ * @param      db           The database
+ * @param[out] id           The id of the dictionary
+ * @return Error code
+ */
+static int add_index(zip_t *dict_archive, sqlite3 *db, sqlite3_int64 *id)
+{
+    int           ret       = 0;
+    index_info    info;
+
+    sqlite3_stmt *stmt      = NULL;
+    int           step      = 0;
+
+    if ((ret = read_index(dict_archive, &info)))
+    {
+        goto cleanup;
+    }
+
+    /* Put dictionary metadata into the index table */
+    if (sqlite3_prepare_v2(db, QUERY, -1, &stmt, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not prepare sqlite statement\n");
+        fprintf(stderr, "Query: %s\n", QUERY);
+        ret = STATEMENT_PREPARE_ERR;
+        goto cleanup;
+    }
+    if (sqlite3_bind_text(stmt, TITLE_INDEX,  info.title,    -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_int (stmt, FORMAT_INDEX, info.format            ) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, REV_INDEX,    info.revision, -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_int (stmt, SEQ_INDEX,    info.sequenced         ) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not bind values to sqlite statement\n");
+        ret = STATEMENT_BIND_ERR;
+        goto cleanup;
+    }
+    /* Titles are unique. Installed dictionaries are replaced through
+     * yomi_update_dictionary() so their files are never orphaned. */
+    if ((step = sqlite3_step(stmt)) == SQLITE_CONSTRAINT)
+    {
+        fprintf(stderr, "Dictionary %s is already installed\n", info.title);
+        ret = DICT_INSTALLED_ERR;
+        goto cleanup;
+    }
+    if (step != SQLITE_DONE)
+    {
+        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+
+    /* Copy the title into name */
+    *id = sqlite3_last_insert_rowid(db);
+
+cleanup:
+    json_object_put(info.obj);
+    sqlite3_finalize(stmt);
+
+    return ret;
+}
+
+#undef TITLE_KEY
+#undef FORMAT_KEY
+#undef REV_KEY
+#undef SEQ_KEY
+
+#undef QUERY
+#undef TITLE_INDEX
+#undef FORMAT_INDEX
+#undef REV_INDEX
+#undef SEQ_INDEX
+
+/* End add_index defines */
+
+/**
+ * Checks the type and returns an array object
+ * @param      arr     The array to obtains values from
+ * @param      idx     The index of the element to return
+ * @param      type    The type of the element
+ * @param[out] ret_obj The json object to return to
+ * @return 0 on the correct type, JSON_WRONG_TYPE_ERR otherwise
+ */
+static int get_obj_from_array(json_object *arr, size_t idx, json_type type, json_object **ret_obj)
+{
+    *ret_obj = json_object_array_get_idx(arr, idx);
+    if (!json_object_is_type(*ret_obj, type))
+    {
+#ifdef _WIN32
+        fprintf(stderr, "Expected index %llu to be of type %s\n%s\n", idx, json_type_to_name(type),
+                        json_object_to_json_string_ext(arr, JSON_C_TO_STRING_PRETTY));
+#else
+        fprintf(stderr, "Expected index %lu to be of type %s\n%s\n", idx, json_type_to_name(type),
+                json_object_to_json_string_ext(arr, JSON_C_TO_STRING_PRETTY));
+#endif
+        *ret_obj = NULL;
+        return JSON_WRONG_TYPE_ERR;
+    }
+    return 0;
+}
+
+/* Begin add_tag defines */
+
+#define TAG_ARRAY_SIZE  5
+
+#define NAME_INDEX      0
+#define CATEGORY_INDEX  1
+#define ORDER_INDEX     2
+#define NOTES_INDEX     3
+#define SCORE_INDEX     4
+
+#define QUERY_DIC_ID_INDEX    1
+#define QUERY_NAME_INDEX      2
+#define QUERY_CATEGORY_INDEX  3
+#define QUERY_ORDER_INDEX     4
+#define QUERY_NOTES_INDEX     5
+#define QUERY_SCORE_INDEX     6
+
+/**
+ * Add the tag stored in the json array
+ * @param stmt The prepared TAG_BANK_QUERY statement to insert with
+ * @param tag  The tag array to add to the database
+ * @param id   The id of the dictionary the tag belongs to
+ * @return Error code
+ */
+static int add_tag(sqlite3_stmt *stmt, json_object *tag, const sqlite3_int64 id)
+{
+    int           ret      = 0;
+    json_object  *ret_obj  = NULL;
+
+    const char   *name     = NULL;
+    const char   *category = NULL;
+    int           order    = 0;
+    const char   *notes    = NULL;
+    int           score    = 0;
+
+    int           step     = 0;
+
+    /* Make sure the length of the tag array is correct */
+    if (json_object_array_length(tag) != TAG_ARRAY_SIZE)
+    {
+#ifdef _WIN32
+        fprintf(stderr, "Expected tag array of size %u, got %llu\n",
+                TAG_ARRAY_SIZE, json_object_array_length(tag));
+#else
+        fprintf(stderr, "Expected tag array of size %u, got %lu\n",
+                TAG_ARRAY_SIZE, json_object_array_length(tag));
+#endif
+        ret = TAG_WRONG_SIZE_ERR;
+        goto cleanup;
+    }
+
+    /* Get the objects to add to the database */
+    if ((ret = get_obj_from_array(tag, NAME_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    name = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(tag, CATEGORY_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    category = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(tag, ORDER_INDEX, json_type_int, &ret_obj)))
+        goto cleanup;
+    order = json_object_get_int(ret_obj);
+
+    if ((ret = get_obj_from_array(tag, NOTES_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    notes = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(tag, SCORE_INDEX, json_type_int, &ret_obj)))
+        goto cleanup;
+    score = json_object_get_int(ret_obj);
+
+    /* Add tag to the database */
+    if (sqlite3_bind_int (stmt, QUERY_DIC_ID_INDEX,   id                ) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_NAME_INDEX,     name,     -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_CATEGORY_INDEX, category, -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_int (stmt, QUERY_ORDER_INDEX,    order             ) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_NOTES_INDEX,    notes,    -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_int (stmt, QUERY_SCORE_INDEX,    score             ) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not bind values to sqlite statement\n");
+        ret = STATEMENT_BIND_ERR;
+        goto cleanup;
+    }
+    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    {
+        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    return ret;
+}
+
+#undef TAG_ARRAY_SIZE
+
+#undef NAME_INDEX
+#undef CATEGORY_INDEX
+#undef ORDER_INDEX
+#undef NOTES_INDEX
+#undef SCORE_INDEX
+
+#undef QUERY_DIC_ID_INDEX
+#undef QUERY_NAME_INDEX
+#undef QUERY_CATEGORY_INDEX
+#undef QUERY_ORDER_INDEX
+#undef QUERY_NOTES_INDEX
+#undef QUERY_SCORE_INDEX
+
+/* End add_tag defines */
+/* Begin add_term defines */
+
+#define TERM_ARRAY_SIZE     8
+
+#define EXPRESSION_INDEX    0
+#define READING_INDEX       1
+#define DEF_TAGS_INDEX      2
+#define RULES_INDEX         3
+#define SCORE_INDEX         4
+#define GLOSSARY_INDEX      5
+#define SEQUENCE_INDEX      6
+#define TERM_TAGS_INDEX     7
+
+#define QUERY_DIC_ID_INDEX          1
+#define QUERY_EXPRESSION_INDEX      2
+#define QUERY_READING_INDEX         3
+#define QUERY_DEF_TAGS_INDEX        4
+#define QUERY_RULES_INDEX           5
+#define QUERY_SCORE_INDEX           6
+#define QUERY_GLOSSARY_INDEX        7
+#define QUERY_SEQUENCE_INDEX        8
+#define QUERY_TERM_TAGS_INDEX       9
+
+/**
+ * Add the term stored in the json array
+ * @param stmt The prepared TERM_BANK_QUERY statement to insert with
+ * @param term The term array to add to the database
+ * @param id   The id of the dictionary the tag belongs to
+ * @return Error code
+ */
+static int add_term(sqlite3_stmt *stmt, json_object *term, const sqlite3_int64 id)
+{
+    int           ret       = 0;
+    json_object  *ret_obj   = NULL;
+
+    const char   *exp       = NULL;
+    const char   *reading   = NULL;
+    const char   *def_tags  = NULL;
+    const char   *rules     = NULL;
+    int           score     = 0;
+    cbor_buffer   glossary  = {0};
+    size_t        entries   = 0;
+    int           sequence  = 0;
+    const char   *term_tags = NULL;
+
+    int           step      = 0;
+
+    /* Make sure the length of the term array is correct */
+    if (json_object_array_length(term) != TERM_ARRAY_SIZE)
+    {
+#ifdef _WIN32
+        fprintf(stderr, "Expected term array of size %u, got %llu\n",
+                TERM_ARRAY_SIZE, json_object_array_length(term));
+#else
+        fprintf(stderr, "Expected term array of size %u, got %lu\n",
+                TERM_ARRAY_SIZE, json_object_array_length(term));
+#endif
+        ret = TERM_WRONG_SIZE_ERR;
+        goto cleanup;
+    }
+
+    /* Get the objects to add to the database */
+    if ((ret = get_obj_from_array(term, EXPRESSION_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    exp = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(term, READING_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    reading = json_object_get_string(ret_obj);
+
+    ret_obj = json_object_array_get_idx(term, DEF_TAGS_INDEX);
+    switch (json_object_get_type(ret_obj))
+    {
+        case json_type_string:
+            def_tags = json_object_get_string(ret_obj);
+            ret = 0;
+            break;
+        case json_type_null:
+            def_tags = "";
+            ret = 0;
+            break;
+        default:
+            fprintf(stderr, "Expected index %u to be of type string or null\n%s\n",
+                    DEF_TAGS_INDEX,
+                    json_object_to_json_string_ext(term, JSON_C_TO_STRING_PRETTY
+            ));
+            ret_obj = NULL;
+            ret = JSON_WRONG_TYPE_ERR;
+            goto cleanup;
+    }
+
+    if ((ret = get_obj_from_array(term, RULES_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    rules = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(term, SCORE_INDEX, json_type_int, &ret_obj)))
+        goto cleanup;
+    score = json_object_get_int(ret_obj);
+
+    if ((ret = get_obj_from_array(term, GLOSSARY_INDEX, json_type_array, &ret_obj)))
+        goto cleanup;
+    if ((ret = glossary_to_cbor(ret_obj, &glossary, &entries)))
+        goto cleanup;
+
+    if ((ret = get_obj_from_array(term, SEQUENCE_INDEX, json_type_int, &ret_obj)))
+        goto cleanup;
+    sequence = json_object_get_int(ret_obj);
+
+    if ((ret = get_obj_from_array(term, TERM_TAGS_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    term_tags = json_object_get_string(ret_obj);
+
+    /* Terms with only deinflection entries are never shown */
+    if (entries == 0)
+    {
+        goto cleanup;
+    }
+
+    /* Make sure that expression and reading aren't the same */
+    if (!strcmp(exp, reading))
+    {
+        reading = "";
+    }
+
+    /* Add term to the database */
+    if (sqlite3_bind_int (stmt, QUERY_DIC_ID_INDEX,     id                 ) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_EXPRESSION_INDEX, exp,       -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_READING_INDEX,    reading,   -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_DEF_TAGS_INDEX,   def_tags,  -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_RULES_INDEX,      rules,     -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_int (stmt, QUERY_SCORE_INDEX,      score              ) != SQLITE_OK ||
+        sqlite3_bind_blob(stmt, QUERY_GLOSSARY_INDEX,   glossary.data, glossary.size, NULL) != SQLITE_OK ||
+        sqlite3_bind_int (stmt, QUERY_SEQUENCE_INDEX,   sequence           ) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_TERM_TAGS_INDEX,  term_tags, -1, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not bind values to sqlite statement\n");
+        ret = STATEMENT_BIND_ERR;
+        goto cleanup;
+    }
+    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    {
+        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    free(glossary.data);
+
+    return ret;
+}
+
+#undef TERM_ARRAY_SIZE
+
+#undef EXPRESSION_INDEX
+#undef READING_INDEX
+#undef DEF_TAGS_INDEX
+#undef RULES_INDEX
+#undef SCORE_INDEX
+#undef GLOSSARY_INDEX
+#undef SEQUENCE_INDEX
+#undef TERM_TAGS_INDEX
+
+#undef QUERY_DIC_ID_INDEX
+#undef QUERY_EXPRESSION_INDEX
+#undef QUERY_READING_INDEX
+#undef QUERY_DEF_TAGS_INDEX
+#undef QUERY_RULES_INDEX
+#undef QUERY_SCORE_INDEX
+#undef QUERY_GLOSSARY_INDEX
+#undef QUERY_SEQUENCE_INDEX
+#undef QUERY_TERM_TAGS_INDEX
+
+/* End add_term defines */
+/* Begin add_kanji defines */
+
+#define KANJI_ARRAY_SIZE     6
+
+#define CHAR_INDEX          0
+#define ONYOMI_INDEX        1
+#define KUNYOMI_INDEX       2
+#define TAGS_INDEX          3
+#define MEANINGS_INDEX      4
+#define STATS_INDEX         5
+
+#define QUERY_DIC_ID_INDEX        1
+#define QUERY_CHAR_INDEX          2
+#define QUERY_ONYOMI_INDEX        3
+#define QUERY_KUNYOMI_INDEX       4
+#define QUERY_TAGS_INDEX          5
+#define QUERY_MEANINGS_INDEX      6
+#define QUERY_STATS_INDEX         7
+
+/**
+ * Add the kanji stored in the json array
+ * @param stmt  The prepared KANJI_BANK_QUERY statement to insert with
+ * @param kanji The kanji array to add to the database
+ * @param id    The id of the dictionary the tag belongs to
+ * @return Error code
+ */
+static int add_kanji(sqlite3_stmt *stmt, json_object *kanji, const sqlite3_int64 id)
+{
+    int           ret       = 0;
+    json_object  *ret_obj   = NULL;
+
+    const char   *character = NULL;
+    const char   *onyomi    = NULL;
+    const char   *kunyomi   = NULL;
+    const char   *tags      = NULL;
+    const char   *meanings  = NULL;
+    const char   *stats     = NULL;
+
+    int           step      = 0;
+
+    /* Make sure the length of the term array is correct */
+    if (json_object_array_length(kanji) != KANJI_ARRAY_SIZE)
+    {
+#ifdef _WIN32
+        fprintf(stderr, "Expected kanji array of size %u, got %llu\n",
+                KANJI_ARRAY_SIZE, json_object_array_length(kanji));
+#else
+        fprintf(stderr, "Expected kanji array of size %u, got %lu\n",
+                KANJI_ARRAY_SIZE, json_object_array_length(kanji));
+#endif
+        ret = KANJI_WRONG_SIZE_ERR;
+        goto cleanup;
+    }
+
+    /* Get the objects to add to the database */
+    if ((ret = get_obj_from_array(kanji, CHAR_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    character = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(kanji, ONYOMI_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    onyomi = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(kanji, KUNYOMI_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    kunyomi = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(kanji, TAGS_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    tags = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(kanji, MEANINGS_INDEX, json_type_array, &ret_obj)))
+        goto cleanup;
+    meanings = json_object_to_json_string(ret_obj);
+
+    if ((ret = get_obj_from_array(kanji, STATS_INDEX, json_type_object, &ret_obj)))
+        goto cleanup;
+    stats = json_object_to_json_string(ret_obj);
+
+    /* Add term to the database */
+    if (sqlite3_bind_int (stmt, QUERY_DIC_ID_INDEX,   id                 ) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_CHAR_INDEX,     character, -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_ONYOMI_INDEX,   onyomi,    -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_KUNYOMI_INDEX,  kunyomi,   -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_TAGS_INDEX,     tags,      -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_MEANINGS_INDEX, meanings,  -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_STATS_INDEX,    stats,     -1, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not bind values to sqlite statement\n");
+        ret = STATEMENT_BIND_ERR;
+        goto cleanup;
+    }
+    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    {
+        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    return ret;
+}
+
+#undef KANJI_ARRAY_SIZE
+
+#undef CHAR_INDEX
+#undef ONYOMI_INDEX
+#undef KUNYOMI_INDEX
+#undef TAGS_INDEX
+#undef MEANINGS_INDEX
+#undef STATS_INDEX
+
+#undef QUERY_DIC_ID_INDEX
+#undef QUERY_CHAR_INDEX
+#undef QUERY_ONYOMI_INDEX
+#undef QUERY_KUNYOMI_INDEX
+#undef QUERY_TAGS_INDEX
+#undef QUERY_MEANINGS_INDEX
+#undef QUERY_STATS_INDEX
+
+/* End add_kanji defines */
+/* Begin add_meta defines */
+
+#define META_ARRAY_SIZE     3
+
+#define EXPRESSION_INDEX    0
+#define MODE_INDEX          1
+#define DATA_INDEX          2
+
+#define QUERY_DIC_ID_INDEX          1
+#define QUERY_EXPRESSION_INDEX      2
+#define QUERY_MODE_INDEX            3
+#define QUERY_TYPE_INDEX            4
+#define QUERY_DATA_INDEX            5
+#define QUERY_COLUMNS_INDEX         6
+
+/**
+ * Add the metadata stored in the json array
+ * @param stmt The prepared TERM_META_BANK_QUERY or KANJI_META_BANK_QUERY
+ *             statement to insert with
+ * @param meta The tag array to add to the database
+ * @param id   The id of the dictionary the tag belongs to
+ * @return Error code
+ */
+static int add_meta(sqlite3_stmt *stmt, json_object *meta, const sqlite3_int64 id)
+{
+    int         ret         = 0;
+    json_object *ret_obj    = NULL;
+
+    const char  *exp        = NULL;
+    const char  *mode       = NULL;
+    const void  *data       = NULL;
+    yomi_blob_t type        = 0;
+    size_t      data_len    = 0;
+    int64_t     data_int    = 0;
+    json_bool   data_bool   = 0;
+    double      data_double = 0.0;
+    int         data_null   = 0;
+    meta_columns cols       = {0};
+
+    int           step      = 0;
+
+    /* Make sure the length of the metadata array is correct */
+    if (json_object_array_length(meta) != META_ARRAY_SIZE)
+    {
+#ifdef _WIN32
+        fprintf(stderr, "Expected metadata array of size %u, got %llu\n",
+                META_ARRAY_SIZE, json_object_array_length(meta));
+#else
+        fprintf(stderr, "Expected metadata array of size %u, got %lu\n",
+                META_ARRAY_SIZE, json_object_array_length(meta));
+#endif
+        ret = META_WRONG_SIZE_ERR;
+        goto cleanup;
+    }
+
+    /* Get the objects to add to the database */
+    if ((ret = get_obj_from_array(meta, EXPRESSION_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    exp = json_object_get_string(ret_obj);
+
+    if ((ret = get_obj_from_array(meta, MODE_INDEX, json_type_string, &ret_obj)))
+        goto cleanup;
+    mode = json_object_get_string(ret_obj);
+
+    /* Get the proper type from the data field of the array */
+    ret_obj = json_object_array_get_idx(meta, DATA_INDEX);
+    if ((ret = decode_meta(mode, ret_obj, &cols)))
+    {
+        fprintf(stderr, "Could not decode metadata\n");
+        goto cleanup;
+    }
+    switch (json_object_get_type(ret_obj))
+    {
+    case json_type_array:
+        data = json_object_to_json_string_length(ret_obj, JSON_C_TO_STRING_SPACED, &data_len);
+        ++data_len;
+        type = YOMI_BLOB_TYPE_ARRAY;
+        break;
+    case json_type_object:
+        data = json_object_to_json_string_length(ret_obj, JSON_C_TO_STRING_SPACED, &data_len);
+        ++data_len;
+        type = YOMI_BLOB_TYPE_OBJECT;
+        break;
+    case json_type_int:
+        data_int = json_object_get_int64(ret_obj);
+        data = &data_int;
+        data_len = sizeof(int64_t);
+        type = YOMI_BLOB_TYPE_INT;
+        break;
+    case json_type_boolean:
+        data_bool = json_object_get_boolean(ret_obj);
+        data = &data_bool;
+        data_len = sizeof(json_bool);
+        type = YOMI_BLOB_TYPE_BOOLEAN;
+        break;
+    case json_type_double:
+        data_double = json_object_get_double(ret_obj);
+        data = &data_double;
+        data_len = sizeof(double);
+        type = YOMI_BLOB_TYPE_DOUBLE;
+        break;
+    case json_type_string:
+        data = json_object_get_string(ret_obj);
+        data_len = json_object_get_string_len(ret_obj) + 1;
+        type = YOMI_BLOB_TYPE_STRING;
+        break;
+    case json_type_null:
+        data_null = 1;
+        type = YOMI_BLOB_TYPE_NULL;
+        break;
+    default:
+        fprintf(stderr, "Unknown json type stored in data\n");
+        ret = UNKNOWN_DATA_TYPE_ERR;
+        goto cleanup;
+    }
+
+    /* Add metadata to the database */
+    if (sqlite3_bind_int (stmt, QUERY_DIC_ID_INDEX,     id            ) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_EXPRESSION_INDEX, exp,  -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, QUERY_MODE_INDEX,       mode, -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_int (stmt, QUERY_TYPE_INDEX,       type)           != SQLITE_OK ||
+        bind_meta_columns(stmt, QUERY_COLUMNS_INDEX, &cols))
+    {
+        fprintf(stderr, "Could not bind values to sqlite statement\n");
+        ret = STATEMENT_BIND_ERR;
+        goto cleanup;
+    }
+    if (data_null)
+    {
+        if (sqlite3_bind_null(stmt, QUERY_DATA_INDEX) != SQLITE_OK)
+        {
+            fprintf(stderr, "Could not bind null data to statement\n");
+            ret = STATEMENT_BIND_ERR;
+            goto cleanup;
+        }
+    }
+    else
+    {
+        if (sqlite3_bind_blob(stmt, QUERY_DATA_INDEX, data, data_len, NULL) != SQLITE_OK)
+        {
+            fprintf(stderr, "Could not bind data blob to statement\n");
+            ret = STATEMENT_BIND_ERR;
+            goto cleanup;
+        }
+    }
+    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    {
+        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+
+cleanup:
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    free_meta_columns(&cols);
+
+    return ret;
+}
+
+#undef META_ARRAY_SIZE
+
+#undef EXPRESSION_INDEX
+#undef MODE_INDEX
+#undef DATA_INDEX
+
+#undef QUERY_DIC_ID_INDEX
+#undef QUERY_EXPRESSION_INDEX
+#undef QUERY_MODE_INDEX
+#undef QUERY_DATA_INDEX
+#undef QUERY_COLUMNS_INDEX
+
+/* End add_meta defines */
+
+/* Begin import pipeline defines */
+
+#define MAX_IMPORT_WORKERS  8
+#define QUEUE_DEPTH_FACTOR  2
+#define BATCH_QUEUE_DEPTH   4
+#define BATCH_ROW_COUNT     256
+
+/**
+ * A single bank file in the dictionary archive waiting to be imported.
+ */
+typedef struct bank_job
+{
+    /* The type of bank stored in the file */
+    bank_type type;
+
+    /* The name of the file in the archive */
+    char filename[FILENAME_BUFFER_SIZE];
+} bank_job;
+
+/**
+ * A slot in the bounded queue between parsing workers and the writer. Holds
+ * the batches of rows of a single bank that have been parsed but not written.
+ */
+typedef struct bank_slot
+{
+    /* Ring buffer of arrays of up to BATCH_ROW_COUNT rows */
+    json_object *batches[BATCH_QUEUE_DEPTH];
+    size_t head;
+    size_t count;
+
+    /* Error code returned while parsing the bank */
+    int ret;
+
+    /* Nonzero once a worker has finished reading the bank */
+    int done;
+} bank_slot;
+
+/**
+ * State shared between the parsing workers and the writer.
+ *
+ * Workers claim jobs in order and may only run QUEUE_DEPTH_FACTOR * workers
+ * jobs ahead of the writer. Each of those jobs may only hold BATCH_QUEUE_DEPTH
+ * batches of rows before its worker waits on the writer, so memory use does
+ * not depend on the size of the banks. The writer consumes jobs in the same
+ * order they were listed so that rows are inserted deterministically.
+ */
+typedef struct import_pipeline
+{
+    /* Path to the dictionary archive. Every worker opens its own handle. */
+    const char *dict_file;
+
+    /* Jobs to complete in the order they should be written */
+    const bank_job *jobs;
+    size_t job_count;
+
+    /* Ring buffer of banks being parsed indexed by job number modulo depth */
+    bank_slot *slots;
+    size_t depth;
+
+    /* The next job a worker should claim */
+    size_t next_job;
+
+    /* The next job the writer will consume */
+    size_t next_write;
+
+    /* Nonzero if the writer has given up and workers should exit */
+    int cancelled;
+
+    pthread_mutex_t lock;
+
+    /* Signaled when a worker adds a batch to a slot or finishes a bank */
+    pthread_cond_t slot_filled;
+
+    /* Signaled when the writer takes a batch from a slot, finishes a bank or
+     * the pipeline is cancelled */
+    pthread_cond_t slot_emptied;
+} import_pipeline;
+
+/**
+ * Gets the number of worker threads that should be used to parse banks.
+ * @param job_count The number of jobs that need to be completed.
+ * @return The number of workers to start. Always at least 1.
+ */
+static size_t get_worker_count(size_t job_count)
+{
+    long cpus = 1;
+#ifdef _WIN32
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    cpus = sysinfo.dwNumberOfProcessors;
+#else
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    /* Leave one core for the writer */
+    size_t workers = cpus > 1 ? (size_t)cpus - 1 : 1;
+    if (workers > MAX_IMPORT_WORKERS)
+    {
+        workers = MAX_IMPORT_WORKERS;
+    }
+    if (workers > job_count)
+    {
+        workers = job_count;
+    }
+    return workers ? workers : 1;
+}
+
+/**
+ * The state of a worker reading a single bank.
+ */
+typedef struct worker_job
+{
+    import_pipeline *pipeline;
+
+    /* The slot batches are written to */
+    bank_slot *slot;
+
+    /* The batch currently being filled. NULL if empty. */
+    json_object *batch;
+} worker_job;
+
+/**
+ * Hands the current batch of a worker to the writer. Waits if the writer has
+ * not caught up with the previous batches.
+ * @param job The job the batch belongs to.
+ * @return Error code
+ */
+static int push_batch(worker_job *job)
+{
+    import_pipeline *pipeline = job->pipeline;
+    bank_slot       *slot     = job->slot;
+
+    if (job->batch == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&pipeline->lock);
+    while (!pipeline->cancelled && slot->count == BATCH_QUEUE_DEPTH)
+    {
+        pthread_cond_wait(&pipeline->slot_emptied, &pipeline->lock);
+    }
+    if (pipeline->cancelled)
+    {
+        pthread_mutex_unlock(&pipeline->lock);
+        return IMPORT_CANCELLED_ERR;
+    }
+    slot->batches[(slot->head + slot->count) % BATCH_QUEUE_DEPTH] = job->batch;
+    ++slot->count;
+    job->batch = NULL;
+    pthread_cond_broadcast(&pipeline->slot_filled);
+    pthread_mutex_unlock(&pipeline->lock);
+
+    return 0;
+}
+
+/**
+ * Adds a row read from a bank to the current batch of a worker.
+ * @param row  The row to add. Belongs to this function.
+ * @param data The worker_job the row belongs to.
+ * @return Error code
+ */
+static int add_row_to_batch(json_object *row, void *data)
+{
+    worker_job *job = data;
+
+    if (!json_object_is_type(row, json_type_array))
+    {
+        fprintf(stderr, "Bank array is of the incorrect type\n");
+        json_object_put(row);
+        return JSON_WRONG_TYPE_ERR;
+    }
+
+    if (job->batch == NULL)
+    {
+        job->batch = json_object_new_array_ext(BATCH_ROW_COUNT);
+        if (job->batch == NULL)
+        {
+            fprintf(stderr, "Could not allocate memory for a batch of rows\n");
+            json_object_put(row);
+            return MALLOC_FAILURE_ERR;
+        }
+    }
+    json_object_array_add(job->batch, row);
+
+    if (json_object_array_length(job->batch) < BATCH_ROW_COUNT)
+    {
+        return 0;
+    }
+    return push_batch(job);
+}
+
+/**
+ * Streams bank files from the archive and hands their rows to the writer.
+ * @param arg The import_pipeline shared with the writer.
+ * @return Always NULL.
+ */
+static void *import_worker(void *arg)
+{
+    import_pipeline *pipeline = arg;
+    int              err      = 0;
+    zip_t           *archive  = NULL;
+
+    /* zip_t handles are not thread safe, so each worker needs its own */
+    archive = zip_open(pipeline->dict_file, ZIP_RDONLY, &err);
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;)
+    {
+        /* Wait until there is a free slot for another bank */
+        while (!pipeline->cancelled &&
+               pipeline->next_job < pipeline->job_count &&
+               pipeline->next_job >= pipeline->next_write + pipeline->depth)
+        {
+            pthread_cond_wait(&pipeline->slot_emptied, &pipeline->lock);
+        }
+        if (pipeline->cancelled || pipeline->next_job >= pipeline->job_count)
+        {
+            break;
+        }
+        size_t job_idx = pipeline->next_job++;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        /* Read the bank without holding the lock */
+        worker_job job = {
+            .pipeline = pipeline,
+            .slot = &pipeline->slots[job_idx % pipeline->depth],
+            .batch = NULL,
+        };
+        int ret = 0;
+        if (archive == NULL)
+        {
+            fprintf(stderr, "Could not open %s\n", pipeline->dict_file);
+            ret = ZIP_FILE_OPEN_ERR;
+        }
+        else if ((ret = stream_json_array(
+                    archive, pipeline->jobs[job_idx].filename,
+                    add_row_to_batch, &job)) == 0)
+        {
+            ret = push_batch(&job);
+        }
+        json_object_put(job.batch);
+
+        pthread_mutex_lock(&pipeline->lock);
+        job.slot->ret  = ret;
+        job.slot->done = 1;
+        pthread_cond_broadcast(&pipeline->slot_filled);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+
+    if (archive)
+    {
+        zip_discard(archive);
+    }
+
+    return NULL;
+}
+
+/**
+ * Lists every bank file of a given type in the archive.
+ * @param      dict_archive The dictionary archive.
+ * @param      type         The type of bank to look for.
+ * @param[out] jobs         The job array to append to. Realloced as needed.
+ * @param[out] job_count    The number of jobs in the array.
+ * @param[out] job_cap      The capacity of the job array.
+ * @return Error code
+ */
+static int list_bank_files(zip_t *dict_archive, bank_type type,
+                           bank_job **jobs, size_t *job_count, size_t *job_cap)
+{
+    const char *file_format = NULL;
+
+    switch (type)
+    {
+    case tag_bank:
+        file_format = TAG_BANK_FORMAT;
+        break;
+    case term_bank:
+        file_format = TERM_BANK_FORMAT;
+        break;
+    case term_meta_bank:
+        file_format = TERM_META_BANK_FORMAT;
+        break;
+    case kanji_bank:
+        file_format = KANJI_BANK_FORMAT;
+        break;
+    case kanji_meta_bank:
+        file_format = KANJI_META_BANK_FORMAT;
+        break;
+    default:
+        fprintf(stderr, "Unknown bank_type value %d\n", type);
+        return UNKNOWN_BANK_TYPE_ERR;
+    }
+
+    for (unsigned int fileno = 1; ; ++fileno)
+    {
+        char filename[FILENAME_BUFFER_SIZE];
+        snprintf(filename, FILENAME_BUFFER_SIZE, file_format, fileno);
+        filename[FILENAME_BUFFER_SIZE - 1] = '\0';
+        if (zip_name_locate(dict_archive, filename, 0) == -1)
+        {
+            break;
+        }
+
+        if (*job_count == *job_cap)
+        {
+            size_t    cap  = *job_cap ? *job_cap * 2 : 16;
+            bank_job *next = realloc(*jobs, sizeof(bank_job) * cap);
+            if (next == NULL)
+            {
+                fprintf(stderr, "Could not allocate memory for bank jobs\n");
+                return MALLOC_FAILURE_ERR;
+            }
+            *jobs    = next;
+            *job_cap = cap;
+        }
+        (*jobs)[*job_count].type = type;
+        memcpy((*jobs)[*job_count].filename, filename, FILENAME_BUFFER_SIZE);
+        ++*job_count;
+    }
+
+    return 0;
+}
+
+/* Begin bulk import defines */
+
+#define BULK_ROW_SIZE_ESTIMATE  128
+#define BULK_MIN_ROWS           10000
+
+#define QUERY_BUFFER_SIZE       256
+
+/**
+ * An index that is dropped and rebuilt around large imports rather than being
+ * updated on every insert.
+ */
+typedef struct deferred_index
+{
+    /* The type of bank that writes to the index */
+    bank_type type;
+
+    /* The table the index belongs to */
+    const char *table;
+
+    /* The name of the index */
+    const char *name;
+
+    /* The statement used to rebuild the index */
+    const char *create;
+} deferred_index;
+
+static const deferred_index DEFERRED_INDEXES[] = {
+    {
+        term_bank, "term_bank", "idx_term_bank_exp",
+        TERM_BANK_EXP_INDEX
+    },
+    {
+        term_bank, "term_bank", "idx_term_bank_reading",
+        TERM_BANK_READING_INDEX
+    },
+    {
+        term_bank, "term_bank", "idx_term_bank_combo",
+        TERM_BANK_COMBO_INDEX
+    },
+    {
+        term_meta_bank, "term_meta_bank", "idx_term_meta_exp",
+        TERM_META_EXP_INDEX
+    },
+};
+
+#define DEFERRED_INDEX_COUNT \
+    (sizeof(DEFERRED_INDEXES) / sizeof(DEFERRED_INDEXES[0]))
+
+/**
+ * Determines if indexes on a table should be rebuilt rather than updated.
+ * This is true when the number of rows being added is large compared to the
+ * number of rows already in the table, since building an index from scratch
+ * is much faster than updating it a row at a time.
+ * @param      dict_archive The dictionary archive.
+ * @param      db           The database.
+ * @param      jobs         The bank files being imported.
+ * @param      job_count    The number of bank files being imported.
+ * @param      idx          The index to check.
+ * @param[out] defer        Set to 1 if the index should be deferred, 0 otherwise.
+ * @return Error code
+ */
+static int should_defer_index(zip_t *dict_archive, sqlite3 *db,
+                              const bank_job *jobs, size_t job_count,
+                              const deferred_index *idx, int *defer)
+{
+    int            ret         = 0;
+    zip_uint64_t   bytes       = 0;
+    sqlite3_int64  new_rows    = 0;
+    sqlite3_int64  rows        = 0;
+    sqlite3_stmt  *stmt        = NULL;
+    char           query[QUERY_BUFFER_SIZE];
+
+    *defer = 0;
+
+    /* Estimate the number of rows being added from the size of the banks */
+    for (size_t i = 0; i < job_count; ++i)
+    {
+        struct zip_stat st;
+
+        if (jobs[i].type != idx->type)
+        {
+            continue;
+        }
+        zip_stat_init(&st);
+        if (zip_stat(dict_archive, jobs[i].filename, 0, &st) == 0 &&
+            (st.valid & ZIP_STAT_SIZE))
+        {
+            bytes += st.size;
+        }
+    }
+    new_rows = bytes / BULK_ROW_SIZE_ESTIMATE;
+    if (new_rows < BULK_MIN_ROWS)
+    {
+        goto cleanup;
+    }
+
+    /* Rows are never updated, so the largest rowid is close to the row count */
+    snprintf(query, QUERY_BUFFER_SIZE, "SELECT max(rowid) FROM %s;", idx->table);
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not prepare sqlite statement\n");
+        fprintf(stderr, "Query: %s\n", query);
+        ret = STATEMENT_PREPARE_ERR;
+        goto cleanup;
+    }
+    if (sqlite3_step(stmt) != SQLITE_ROW)
+    {
+        fprintf(stderr, "Could not get the size of %s\n", idx->table);
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+    rows = sqlite3_column_int64(stmt, 0);
+
+    *defer = new_rows >= rows;
+
+cleanup:
+    sqlite3_finalize(stmt);
+
+    return ret;
+}
+
+/**
+ * Drops every index that would be cheaper to rebuild after the import.
+ * @param      dict_archive The dictionary archive.
+ * @param      db           The database.
+ * @param      jobs         The bank files being imported.
+ * @param      job_count    The number of bank files being imported.
+ * @param[out] deferred     Array of size DEFERRED_INDEX_COUNT. Set to 1 for
+ *                          every index that was dropped.
+ * @param[out] failed_type  The type of bank that failed on error.
+ * @return Error code
+ */
+static int drop_deferred_indexes(zip_t *dict_archive, sqlite3 *db,
+                                 const bank_job *jobs, size_t job_count,
+                                 int *deferred, bank_type *failed_type)
+{
+    int   ret    = 0;
+    char *errmsg = NULL;
+    char  query[QUERY_BUFFER_SIZE];
+
+    for (size_t i = 0; i < DEFERRED_INDEX_COUNT; ++i)
+    {
+        const deferred_index *idx = &DEFERRED_INDEXES[i];
+
+        *failed_type = idx->type;
+        if ((ret = should_defer_index(dict_archive, db, jobs, job_count, idx, &deferred[i])))
+        {
+            return ret;
+        }
+        if (!deferred[i])
+        {
+            continue;
+        }
+
+        snprintf(query, QUERY_BUFFER_SIZE, "DROP INDEX IF EXISTS %s;", idx->name);
+        sqlite3_exec(db, query, NULL, NULL, &errmsg);
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not drop index %s\nError: %s\n", idx->name, errmsg);
+            sqlite3_free(errmsg);
+            deferred[i] = 0;
+            return DB_TABLE_DROP_ERR;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Rebuilds every index dropped by drop_deferred_indexes().
+ * @param      db          The database.
+ * @param      deferred    Array of size DEFERRED_INDEX_COUNT. Indexes set to 1
+ *                         are rebuilt.
+ * @param[out] failed_type The type of bank that failed on error.
+ * @return Error code
+ */
+static int rebuild_deferred_indexes(sqlite3 *db, const int *deferred,
+                                    bank_type *failed_type)
+{
+    char *errmsg = NULL;
+
+    for (size_t i = 0; i < DEFERRED_INDEX_COUNT; ++i)
+    {
+        if (!deferred[i])
+        {
+            continue;
+        }
+
+        *failed_type = DEFERRED_INDEXES[i].type;
+        sqlite3_exec(db, DEFERRED_INDEXES[i].create, NULL, NULL, &errmsg);
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not rebuild index %s\nError: %s\n",
+                    DEFERRED_INDEXES[i].name, errmsg);
+            sqlite3_free(errmsg);
+            return DB_CREATE_TABLE_ERR;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Prepares the insert statement for a bank type.
+ * @param      db       The database.
+ * @param      type     The type of bank being inserted.
+ * @param[out] stmt     The prepared statement. Belongs to the caller.
+ * @param[out] add_item The function that inserts a row with the statement.
+ * @return Error code
+ */
+static int prepare_bank_stmt(sqlite3 *db, bank_type type, sqlite3_stmt **stmt,
+                             int (**add_item)(sqlite3_stmt *, json_object *, const sqlite3_int64))
+{
+    const char *query = NULL;
+
+    switch (type)
+    {
+    case tag_bank:
+        query = TAG_BANK_QUERY;
+        *add_item = add_tag;
+        break;
+    case term_bank:
+        query = TERM_BANK_QUERY;
+        *add_item = add_term;
+        break;
+    case term_meta_bank:
+        query = TERM_META_BANK_QUERY;
+        *add_item = add_meta;
+        break;
+    case kanji_bank:
+        query = KANJI_BANK_QUERY;
+        *add_item = add_kanji;
+        break;
+    case kanji_meta_bank:
+        query = KANJI_META_BANK_QUERY;
+        *add_item = add_meta;
+        break;
+    default:
+        fprintf(stderr, "Unknown bank_type value %d\n", type);
+        return UNKNOWN_BANK_TYPE_ERR;
+    }
+
+    if (sqlite3_prepare_v3(db, query, -1, SQLITE_PREPARE_PERSISTENT, stmt, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not prepare sqlite statement\n");
+        fprintf(stderr, "Query: %s\n", query);
+        return STATEMENT_PREPARE_ERR;
+    }
+
+    return 0;
+}
+
+#undef BULK_ROW_SIZE_ESTIMATE
+#undef BULK_MIN_ROWS
+
+#undef QUERY_BUFFER_SIZE
+
+/* End bulk import defines */
+
+/**
+ * Adds every bank in the dictionary to the database. Banks are decompressed
+ * and parsed on worker threads in batches of rows while the calling thread
+ * inserts them into the database inside the current transaction.
+ * @param      dict_archive The dictionary archive.
+ * @param      dict_file    Path to the dictionary archive.
+ * @param      db           The database
+ * @param      id           The id of the dictionary
+ * @param      allow_defer  Nonzero if indexes may be dropped and rebuilt
+ *                          around large imports.
+ * @param[out] failed_type  The type of bank that failed on error.
+ * @param[out] stats        Measurements of the banks are added to this.
+ *                          Safe if NULL.
+ * @return Error code
+ */
+static int add_dic_files(zip_t *dict_archive, const char *dict_file,
+                         sqlite3 *db, const sqlite3_int64 id,
+                         int allow_defer, bank_type *failed_type,
+                         yomi_import_stats *stats)
+{
+    static const bank_type types[] = {
+        tag_bank, term_bank, term_meta_bank, kanji_bank, kanji_meta_bank
+    };
+
+    int              ret          = 0;
+    bank_job        *jobs         = NULL;
+    size_t           job_count    = 0;
+    size_t           job_cap      = 0;
+    pthread_t       *workers      = NULL;
+    size_t           worker_count = 0;
+    size_t           started      = 0;
+    import_pipeline  pipeline;
+    sqlite3_stmt    *stmt         = NULL;
+    bank_type        stmt_type    = tag_bank;
+    int              deferred[DEFERRED_INDEX_COUNT] = {0};
+    int (*add_item)(sqlite3_stmt *, json_object *, const sqlite3_int64) = NULL;
+
+    memset(&pipeline, 0, sizeof(pipeline));
+
+    /* Collect the bank files in the order they should be written */
+    for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i)
+    {
+        if ((ret = list_bank_files(dict_archive, types[i], &jobs, &job_count, &job_cap)))
+        {
+            *failed_type = types[i];
+            goto cleanup;
+        }
+    }
+    if (job_count == 0)
+    {
+        goto cleanup;
+    }
+
+    /* Drop indexes that are cheaper to rebuild once all rows are inserted */
+    if (allow_defer &&
+        (ret = drop_deferred_indexes(dict_archive, db, jobs, job_count, deferred, failed_type)))
+    {
+        goto cleanup;
+    }
+
+    /* Start the parsing workers */
+    worker_count       = get_worker_count(job_count);
+    pipeline.dict_file = dict_file;
+    pipeline.jobs      = jobs;
+    pipeline.job_count = job_count;
+    pipeline.depth     = worker_count * QUEUE_DEPTH_FACTOR;
+    pipeline.slots     = calloc(pipeline.depth, sizeof(bank_slot));
+    workers            = calloc(worker_count, sizeof(pthread_t));
+    if (pipeline.slots == NULL || workers == NULL)
+    {
+        fprintf(stderr, "Could not allocate memory for import workers\n");
+        *failed_type = jobs[0].type;
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.slot_filled, NULL);
+    pthread_cond_init(&pipeline.slot_emptied, NULL);
+    for (; started < worker_count; ++started)
+    {
+        if (pthread_create(&workers[started], NULL, import_worker, &pipeline))
+        {
+            break;
+        }
+    }
+    if (started == 0)
+    {
+        fprintf(stderr, "Could not start any import workers\n");
+        *failed_type = jobs[0].type;
+        ret = THREAD_CREATE_ERR;
+        goto cleanup_threads;
+    }
+
+    /* Write banks in order as they become available */
+    for (size_t job = 0; job < job_count; ++job)
+    {
+        bank_slot *slot      = &pipeline.slots[job % pipeline.depth];
+        uint64_t   job_start = now_nsecs();
+        uint64_t   job_rows  = 0;
+
+        *failed_type = jobs[job].type;
+
+        /* Only prepare a new statement when the bank type changes */
+        if (stmt == NULL || jobs[job].type != stmt_type)
+        {
+            sqlite3_finalize(stmt);
+            stmt = NULL;
+            if ((ret = prepare_bank_stmt(db, jobs[job].type, &stmt, &add_item)))
+            {
+                goto cleanup_threads;
+            }
+            stmt_type = jobs[job].type;
+        }
+
+        for (;;)
+        {
+            json_object *batch = NULL;
+
+            pthread_mutex_lock(&pipeline.lock);
+            while (slot->count == 0 && !slot->done)
+            {
+                pthread_cond_wait(&pipeline.slot_filled, &pipeline.lock);
+            }
+            if (slot->count)
+            {
+                batch = slot->batches[slot->head];
+                slot->batches[slot->head] = NULL;
+                slot->head = (slot->head + 1) % BATCH_QUEUE_DEPTH;
+                --slot->count;
+            }
+            else
+            {
+                /* The bank has been completely read */
+                ret = slot->ret;
+                memset(slot, 0, sizeof(*slot));
+                ++pipeline.next_write;
+            }
+            pthread_cond_broadcast(&pipeline.slot_emptied);
+            pthread_mutex_unlock(&pipeline.lock);
+
+            if (batch == NULL)
+            {
+                break;
+            }
+
+            /* Add every row in the batch to the database */
+            for (size_t i = 0; i < json_object_array_length(batch); ++i)
+            {
+                json_object *inner_arr = json_object_array_get_idx(batch, i);
+                if ((ret = (*add_item)(stmt, inner_arr, id)))
+                {
+                    fprintf(stderr, "Could not add %s\n", jobs[job].filename);
+                    break;
+                }
+                ++job_rows;
+            }
+            json_object_put(batch);
+            if (ret)
+            {
+                goto cleanup_threads;
+            }
+        }
+        if (ret)
+        {
+            fprintf(stderr, "Could not read %s\n", jobs[job].filename);
+            goto cleanup_threads;
+        }
+
+        /* The wait for parsing workers is included in the bank's time */
+        if (stats)
+        {
+            zip_stat_t st;
+            zip_stat_init(&st);
+            zip_stat(dict_archive, jobs[job].filename, 0, &st);
+            add_phase_stats(stats, bank_type_to_phase(jobs[job].type),
+                            job_start, job_rows,
+                            (st.valid & ZIP_STAT_SIZE) ? st.size : 0,
+                            (st.valid & ZIP_STAT_COMP_SIZE) ? st.comp_size : 0);
+        }
+    }
+
+cleanup_threads:
+    /* Wake up and join any workers that are still waiting on the writer */
+    pthread_mutex_lock(&pipeline.lock);
+    pipeline.cancelled = 1;
+    pthread_cond_broadcast(&pipeline.slot_emptied);
+    pthread_mutex_unlock(&pipeline.lock);
+    for (size_t i = 0; i < started; ++i)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    for (size_t i = 0; i < pipeline.depth; ++i)
+    {
+        for (size_t j = 0; j < BATCH_QUEUE_DEPTH; ++j)
+        {
+            json_object_put(pipeline.slots[i].batches[j]);
+        }
+    }
+    pthread_cond_destroy(&pipeline.slot_emptied);
+    pthread_cond_destroy(&pipeline.slot_filled);
+    pthread_mutex_destroy(&pipeline.lock);
+
+    /* Rebuild the dropped indexes now that every row has been inserted */
+    if (ret == 0)
+    {
+        uint64_t start = now_nsecs();
+        ret = rebuild_deferred_indexes(db, deferred, failed_type);
+        add_phase_stats(stats, YOMI_PHASE_BUILD_INDEXES, start, 0, 0, 0);
+    }
+
+cleanup:
+    sqlite3_finalize(stmt);
+    free(pipeline.slots);
+    free(workers);
+    free(jobs);
+
+    return ret;
+}
+
+#undef MAX_IMPORT_WORKERS
+#undef QUEUE_DEPTH_FACTOR
+#undef BATCH_QUEUE_DEPTH
+#undef BATCH_ROW_COUNT
+
+/* End import pipeline defines */
+
+#ifdef _WIN32
+/**
+ * Converts a UTF-8 string to an LPWSTR.
+ * @param str The UTF-8 string to convert.
+ * @return An LPSTR. Must be freed with free(). NULL on error.
+ */
+static LPWSTR utf8_to_lpwstr(const char *str)
+{
+    int len = MultiByteToWideChar(CP_UTF8, 0, str, -1, NULL, 0);
+    if (len == 0)
+    {
+        return NULL;
+    }
+    LPWSTR lpwstr = malloc(sizeof(WCHAR) * len);
+    if (MultiByteToWideChar(CP_UTF8, 0, str, -1, lpwstr, len) == 0)
+    {
+        free(lpwstr);
+        return NULL;
+    }
+    return lpwstr;
+}
+
+/**
+ * Removes a path on Windows.
+ * @param path The path to remove in UTF-8 encoding.
+ * @return Error code.
+ */
+static int remove_path(const char *path)
+{
+    int    ret     = 0;
+    LPWSTR pszFrom = NULL;
+
+    int len = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
+    if (len == 0)
+    {
+        ret = -1;
+        goto cleanup;
+    }
+    pszFrom = malloc(sizeof(WCHAR) * (len + 2));
+    len = MultiByteToWideChar(CP_UTF8, 0, path, -1, pszFrom, len);
+    if (len == 0)
+    {
+        ret = -2;
+        goto cleanup;
+    }
+    pszFrom[len] = '\0';
+    pszFrom[len + 1] = '\0';
+    if (pszFrom[len - 1] == '\\')
+    {
+        pszFrom[len - 1] = '\0';
+    }
+    for (LPWSTR ptr = pszFrom; *ptr; ++ptr)
+    {
+        if (*ptr == '/')
+        {
+            *ptr = '\\';
+        }
+    }
+
+    /* Delete the directory contents */
+    SHFILEOPSTRUCTW fileop = {
+        .hwnd = NULL, // no status display
+        .wFunc = FO_DELETE, // delete operation
+        .pFrom = pszFrom, // source file name as double null terminated string
+        .pTo = NULL, // no destination needed
+        .fFlags = FOF_NOCONFIRMATION | FOF_SILENT, // do not prompt the user
+        .fAnyOperationsAborted = FALSE,
+        .lpszProgressTitle = NULL,
+        .hNameMappings = NULL,
+    };
+    if ((ret = SHFileOperationW(&fileop)))
+    {
+        goto cleanup;
+    }
+
+cleanup:
+    free(pszFrom);
+
+    return ret;
+}
+
+/**
+ * Creates a path if it doesn't already exist.
+ * @param path The path to create.
+ * @return mkdir error code.
+ */
+static int make_path(const char *path)
+{
+    int    ret       = 0;
+    LPWSTR path_copy = NULL;
+    LPWSTR ptr       = NULL;
+
+    /* Convert to LPSTR */
+    path_copy = utf8_to_lpwstr(path);
+    if (path_copy == NULL)
+    {
+        ret = -1;
+        goto cleanup;
+    }
+
+    /* Seek to the first seperator */
+    ptr = path_copy;
+    while (*ptr && *ptr != '/')
+    {
+        ++ptr;
+    }
+    if (*ptr == '\0')
+    {
+        goto cleanup;
+    }
+
+    /* Create the path */
+    for (ptr += 1; *ptr; ++ptr)
+    {
+        if (*ptr != '/')
+        {
+            continue;
+        }
+
+        *ptr = '\0';
+        if (_wmkdir(path_copy) && errno != EEXIST)
+        {
+            ret = errno;
+            goto cleanup;
+        }
+        *ptr = '/';
+    }
+    if (_wmkdir(path_copy) && errno != EEXIST)
+    {
+        ret = errno;
+        goto cleanup;
+    }
+
+cleanup:
+    free(path_copy);
+
+    return ret;
+}
+
+/**
+ * Removes a file on Windows.
+ * @param path The path of the file to remove in UTF-8 encoding.
+ * @return 0 on success, errno on failure.
+ */
+static int remove_file(const char *path)
+{
+    int    ret   = 0;
+    LPWSTR wpath = utf8_to_lpwstr(path);
+
+    if (wpath == NULL)
+    {
+        return EINVAL;
+    }
+    if (_wremove(wpath))
+    {
+        ret = errno;
+    }
+    free(wpath);
+
+    return ret;
+}
+
+/**
+ * Moves a file to a new path, replacing any file that is already there.
+ * @param from The path of the file to move in UTF-8 encoding.
+ * @param to   The path to move the file to in UTF-8 encoding.
+ * @return 0 on success, a system error code on failure.
+ */
+static int replace_file(const char *from, const char *to)
+{
+    int    ret   = 0;
+    LPWSTR wfrom = utf8_to_lpwstr(from);
+    LPWSTR wto   = utf8_to_lpwstr(to);
+
+    if (wfrom == NULL || wto == NULL)
+    {
+        ret = ERROR_INVALID_PARAMETER;
+        goto cleanup;
+    }
+    if (!MoveFileExW(wfrom, wto, MOVEFILE_REPLACE_EXISTING))
+    {
+        ret = GetLastError();
+        goto cleanup;
+    }
+
+cleanup:
+    free(wfrom);
+    free(wto);
+
+    return ret;
+}
+
+#else
+/**
+ * Deletes the files pass in the path argument.
+ * @param path The path of the file/folder to delete.
+ * @param sbuf Unused.
+ * @param type Unused.
+ * @param ftwb Unused.
+ * @return 0 on success, errno on failure.
+ */
+static int remove_path_callback(
+    const char *path,
+    const struct stat *sbuf __attribute__((unused)),
+    int type __attribute__((unused)),
+    struct FTW *ftwb __attribute__((unused)))
+{
+    if (remove(path))
+    {
+        fprintf(stderr, "Could not remove file:\n%s\n", strerror(errno));
+        return errno;
+    }
+    return 0;
+}
+
+/**
+ * Recursively deletes a path.
+ * @param path The path to recursively delete.
+ * @return 0 on success, errno on failure.
+ */
+static int remove_path(const char *path)
+{
+    if (nftw(path, remove_path_callback, 10, FTW_DEPTH|FTW_MOUNT|FTW_PHYS))
+    {
+        return errno;
+    }
+    return 0;
+}
+
+/**
+ * Creates a path if it doesn't already exist.
+ * @param path The path to create.
+ * @return mkdir error code.
+ */
+static int make_path(const char *path)
+{
+    int   ret       = 0;
+    char *path_copy = strdup(path);
+    char *ptr       = strchr(path_copy, '/');
+
+    if (ptr == NULL)
+    {
+        goto cleanup;
+    }
+
+    for (ptr += 1; *ptr; ++ptr)
+    {
+        if (*ptr != '/')
+        {
+            continue;
+        }
+
+        *ptr = '\0';
+        if (mkdir(path_copy, 0755) && errno != EEXIST)
+        {
+            ret = errno;
+            goto cleanup;
+        }
+        *ptr = '/';
+    }
+    if (mkdir(path_copy, 0755) && errno != EEXIST)
+    {
+        ret = errno;
+        goto cleanup;
+    }
+
+cleanup:
+    free(path_copy);
+
+    return ret;
+}
+
+/**
+ * Removes a file.
+ * @param path The path of the file to remove.
+ * @return 0 on success, errno on failure.
+ */
+static int remove_file(const char *path)
+{
+    return remove(path) ? errno : 0;
+}
+
+/**
+ * Moves a file to a new path, replacing any file that is already there.
+ * @param from The path of the file to move.
+ * @param to   The path to move the file to.
+ * @return 0 on success, errno on failure.
+ */
+static int replace_file(const char *from, const char *to)
+{
+    return rename(from, to) ? errno : 0;
+}
+#endif
+
+/**
+ * Concatenates two paths and normalizes all separators to use /.
+ * @param start The begining of the path.
+ * @param end   The ending of the path.
+ * @return The two paths concatenated. Must be freed with free().
+ */
+static char *concat_paths(const char *start, const char *end)
+{
+    size_t  start_len = strlen(start);
+    size_t  end_len   = strlen(end);
+    char   *path      = malloc(start_len + end_len + 2);
+    strcpy(path, start);
+
+    /* Make sure the start path ends in a separator */
+#ifdef _WIN32
+    if (start[start_len - 1] != '/' || start[start_len - 1] != '\\')
+#else
+    if (start[start_len - 1] != '/')
+#endif
+    {
+        path[start_len++] = '/';
+    }
+
+    /* Copy the ending */
+    strcpy(&path[start_len], end);
+
+#ifdef _WIN32
+    /* Normalize path to use forward slashes on Windows */
+    for (char *ptr = path; *ptr; ++ptr)
+    {
+        if (*ptr == '\\')
+        {
+            *ptr = '/';
+        }
+    }
+#endif
+
+    return path;
+}
+
+#define TITLE_KEY "title"
+
+#define PACK_PART_SUFFIX ".part"
+
+#define REGEX_SKIP_FILE \
+    "^index\\.json$|" \
+    "^tag_bank_[1-9][0-9\\(\\)]*\\.json$|" \
+    "^term_bank_[1-9][0-9\\(\\)]*\\.json$|" \
+    "^term_meta_bank_[1-9][0-9\\(\\)]*\\.json$|" \
+    "^kanji_bank_[1-9][0-9\\(\\)]*\\.json$|" \
+    "^kanji_meta_bank_[1-9][0-9\\(\\)]*\\.json$"
+
+#define QUERY_DELETE "DELETE FROM resource WHERE dic_id = ?;"
+#define QUERY_INSERT "INSERT INTO resource (dic_id, path, offset, size) VALUES (?, ?, ?, ?);"
+
+#define QUERY_DIC_ID_INDEX  1
+#define QUERY_PATH_INDEX    2
+#define QUERY_OFFSET_INDEX  3
+#define QUERY_SIZE_INDEX    4
+
+#ifdef _WIN32
+/* This is returned from SHFileOperationW when folders in the path don't exist */
+#define DE_INVALIDFILES 0x7C
+#endif
+
+/**
+ * Gets the path of the resource pack belonging to a dictionary.
+ * @param res_dir Path to the resource directory.
+ * @param id      The ID of the dictionary.
+ * @param suffix  A suffix to append to the file name. Can be empty.
+ * @return The path to the pack. Must be freed with free(). NULL on error.
+ */
+static char *get_pack_path(const char *res_dir, const sqlite3_int64 id, const char *suffix)
+{
+    char file_name[FILENAME_BUFFER_SIZE];
+
+    sqlite3_snprintf(
+        sizeof(file_name), file_name,
+        YOMI_RESOURCE_PACK_FORMAT "%s", (long long)id, suffix
+    );
+
+    return concat_paths(res_dir, file_name);
+}
+
+/**
+ * Removes the directory resources were extracted to before they were packed.
+ * @param res_dir   Path to the resource directory.
+ * @param dict_name The title of the dictionary.
+ * @return Error code.
+ */
+static int remove_resource_dir(const char *res_dir, const char *dict_name)
+{
+    int   ret       = 0;
+    char *base_path = concat_paths(res_dir, dict_name);
+
+    ret = remove_path(base_path);
+#ifdef _WIN32
+    switch (ret)
+    {
+    case DE_INVALIDFILES:
+    case ERROR_FILE_NOT_FOUND:
+        ret = 0;
+        break;
+    default:
+        break;
+    }
+#else
+    ret = ret && ret != ENOENT ? ret : 0;
+#endif
+    if (ret)
+    {
+        fprintf(stderr, "Could not remove base path: %s\n", base_path);
+#ifdef _WIN32
+        fprintf(stderr, "Error Code: %x\n", ret);
+#else
+        fprintf(stderr, "%s\n", strerror(ret));
+#endif
+    }
+    free(base_path);
+
+    return ret;
+}
+
+/**
+ * Packs resources also in the archive into a single file in the resource
+ * directory and indexes them in the resource table. The pack is written next to
+ * the previous one. The previous pack is left in place until
+ * swap_resource_pack() is called after the transaction commits, since the
+ * index of the previous pack is only replaced at that point.
+ * @param      dict_archive The dictionary archive to pack resources from.
+ * @param      db           The database containing the resource table.
+ * @param      id           The ID of the dictionary.
+ * @param      res_dir      Path to the resource directory.
+ * @param      stats        Measurements of the resources are added to this.
+ *                          Safe if NULL.
+ * @param[out] has_pack     Set to 1 if a new pack was written, 0 if the
+ *                          archive has no resources.
+ * @return Error code.
+ */
+static int pack_resources(zip_t *dict_archive, sqlite3 *db, const sqlite3_int64 id, const char *res_dir,
+                          yomi_import_stats *stats, int *has_pack)
+{
+    int           ret         = 0;
+    uint64_t      start       = now_nsecs();
+    uint64_t      packed      = 0;
+    uint64_t      packed_size = 0;
+    uint64_t      comp_size   = 0;
+    regex_t       rt;
+    regex_t      *file_regex  = NULL;
+    json_object  *obj         = NULL;
+    json_object  *ret_obj     = NULL;
+    sqlite3_stmt *stmt        = NULL;
+    char         *part_path   = NULL;
+    FILE         *pack        = NULL;
+    zip_file_t   *zip_file    = NULL;
+    const char   *file_name   = NULL;
+    sqlite3_int64 offset      = 0;
+
+    *has_pack = 0;
+
+    /* Remove resources extracted by older versions */
+    if ((ret = get_json_obj(dict_archive, INDEX_FILE, &obj)))
+    {
+        fprintf(stderr, "Failed to open index file\n");
+        goto cleanup;
+    }
+    if ((ret = get_obj_from_obj(obj, TITLE_KEY, json_type_string, &ret_obj)))
+    {
+        fprintf(stderr, "Failed to get title from index object\n");
+        goto cleanup;
+    }
+    if ((ret = remove_resource_dir(res_dir, json_object_get_string(ret_obj))))
+    {
+        goto cleanup;
+    }
+
+    /* Clear out the index of the previous pack */
+    if (sqlite3_prepare_v2(db, QUERY_DELETE, -1, &stmt, NULL) != SQLITE_OK)
     {
         fprintf(stderr, "Could not prepare sqlite statement\n");
-        fprintf(stderr, "Query: %s\n", QUERY);
+        fprintf(stderr, "Query: %s\n", QUERY_DELETE);
         ret = STATEMENT_PREPARE_ERR;
         goto cleanup;
     }
-    if (sqlite3_bind_int (stmt, QUERY_DIC_ID_INDEX,   id                ) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_NAME_INDEX,     name,     -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_CATEGORY_INDEX, category, -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_int (stmt, QUERY_ORDER_INDEX,    order             ) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_NOTES_INDEX,    notes,    -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_int (stmt, QUERY_SCORE_INDEX,    score             ) != SQLITE_OK)
+    if (sqlite3_bind_int64(stmt, QUERY_DIC_ID_INDEX, id) != SQLITE_OK)
     {
-        fprintf(stderr, "Could not bind values to sqlite statement\n");
         ret = STATEMENT_BIND_ERR;
         goto cleanup;
     }
-    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    if (sqlite3_step(stmt) != SQLITE_DONE)
+    {
+        fprintf(stderr, "Could not clear resource index\n");
+        ret = STATEMENT_STEP_ERR;
+        goto cleanup;
+    }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+
+    if (sqlite3_prepare_v2(db, QUERY_INSERT, -1, &stmt, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not prepare sqlite statement\n");
+        fprintf(stderr, "Query: %s\n", QUERY_INSERT);
+        ret = STATEMENT_PREPARE_ERR;
+        goto cleanup;
+    }
+
+    part_path = get_pack_path(res_dir, id, PACK_PART_SUFFIX);
+    if (part_path == NULL)
+    {
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+
+    /* Initialize the file regex filter */
+    if ((ret = regcomp(&rt, REGEX_SKIP_FILE, REG_EXTENDED)))
+    {
+        fprintf(stderr, "Could not compile regex\nError: %d\n", ret);
+        goto cleanup;
+    }
+    file_regex = &rt; // if regcomp fails, regfree is UB if passed non-NULL
+
+    /* Iterate over files */
+    for (zip_int64_t i = 0; i < zip_get_num_entries(dict_archive, 0); ++i)
+    {
+        file_name = zip_get_name(dict_archive, i, 0);
+        /* Skip unwanted files */
+        switch (regexec(file_regex, file_name, 0, NULL, 0))
+        {
+        case REG_NOMATCH:
+            break;
+        case 0:
+            continue;
+        default:
+            fprintf(stderr, "Error occurring in matching file regex\n");
+            ret = UNSUPPORTED_FORMAT_ERR;
+            goto cleanup;
+        }
+
+        /* Directories only exist implicitly in the pack */
+        size_t file_name_len = strlen(file_name);
+        if (file_name[file_name_len - 1] == '/')
+        {
+            continue;
+        }
+
+        /* Open the pack on the first resource */
+        if (pack == NULL)
+        {
+#ifdef _WIN32
+            LPWSTR wPartPath = utf8_to_lpwstr(part_path);
+            pack = wPartPath ? _wfopen(wPartPath, L"wb") : NULL;
+            free(wPartPath);
+#else
+            pack = fopen(part_path, "wb");
+#endif
+            if (pack == NULL)
+            {
+                fprintf(stderr, "Could not open file for writing\n%s\n", part_path);
+                ret = ZIP_FILE_OPEN_ERR;
+                goto cleanup;
+            }
+        }
+
+        zip_file = zip_fopen_index(dict_archive, i, 0);
+        if (zip_file == NULL)
+        {
+            fprintf(stderr, "Could not open resource file in archive\n");
+            ret = ZIP_FILE_OPEN_ERR;
+            goto cleanup;
+        }
+
+        /* Buffer and append the file to the pack */
+        char buf[BUFSIZ];
+        zip_int64_t   bytes_read = 0;
+        sqlite3_int64 size       = 0;
+        while ((bytes_read = zip_fread(zip_file, buf, sizeof(buf))) > 0)
+        {
+            if (fwrite(buf, sizeof(char), bytes_read, pack) != (size_t)bytes_read)
+            {
+                fprintf(stderr, "Could not write to resource pack\n%s\n", part_path);
+                ret = ZIP_FILE_READ_ERR;
+                goto cleanup;
+            }
+            size += bytes_read;
+        }
+        if (bytes_read < 0)
+        {
+            fprintf(stderr, "Could not read resource file %s\n", file_name);
+            ret = ZIP_FILE_READ_ERR;
+            goto cleanup;
+        }
+        zip_fclose(zip_file);
+        zip_file = NULL;
+
+        /* Index the range the file occupies */
+        if (sqlite3_bind_int64(stmt, QUERY_DIC_ID_INDEX, id)                   != SQLITE_OK ||
+            sqlite3_bind_text (stmt, QUERY_PATH_INDEX, file_name, -1, NULL)    != SQLITE_OK ||
+            sqlite3_bind_int64(stmt, QUERY_OFFSET_INDEX, offset)               != SQLITE_OK ||
+            sqlite3_bind_int64(stmt, QUERY_SIZE_INDEX, size)                   != SQLITE_OK)
+        {
+            ret = STATEMENT_BIND_ERR;
+            goto cleanup;
+        }
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            fprintf(stderr, "Could not index resource %s\n", file_name);
+            ret = STATEMENT_STEP_ERR;
+            goto cleanup;
+        }
+        sqlite3_reset(stmt);
+        offset += size;
+
+        if (stats)
+        {
+            zip_stat_t st;
+            zip_stat_init(&st);
+            if (zip_stat_index(dict_archive, i, 0, &st) == 0 &&
+                (st.valid & ZIP_STAT_COMP_SIZE))
+            {
+                comp_size += st.comp_size;
+            }
+            ++packed;
+            packed_size += size;
+        }
+    }
+
+    /* Finish the new pack. It replaces the previous one after the commit. */
+    if (pack)
+    {
+        if (fclose(pack))
+        {
+            pack = NULL;
+            fprintf(stderr, "Could not write to resource pack\n%s\n", part_path);
+            ret = ZIP_FILE_READ_ERR;
+            goto cleanup;
+        }
+        pack = NULL;
+        *has_pack = 1;
+    }
+    add_phase_stats(stats, YOMI_PHASE_RESOURCES, start, packed, packed_size, comp_size);
+
+cleanup:
+    if (zip_file)
+    {
+        zip_fclose(zip_file);
+    }
+    if (pack)
+    {
+        fclose(pack);
+    }
+    if (ret && part_path)
+    {
+        remove_file(part_path);
+    }
+    if (file_regex)
+    {
+        regfree(file_regex);
+    }
+    sqlite3_finalize(stmt);
+    json_object_put(obj);
+    free(part_path);
+
+    return ret;
+}
+
+/**
+ * Replaces the resource pack of a dictionary with the one written by
+ * pack_resources(). Must only be called once the resource index is committed.
+ * @param res_dir  Path to the resource directory.
+ * @param id       The ID of the dictionary.
+ * @param has_pack The value pack_resources() set. If 0, the previous pack is
+ *                 removed since the dictionary no longer has resources.
+ * @return Error code.
+ */
+static int swap_resource_pack(const char *res_dir, const sqlite3_int64 id, int has_pack)
+{
+    int   ret       = 0;
+    char *part_path = get_pack_path(res_dir, id, PACK_PART_SUFFIX);
+    char *pack_path = get_pack_path(res_dir, id, "");
+
+    if (part_path == NULL || pack_path == NULL)
+    {
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+    if (has_pack)
     {
-        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
-        ret = STATEMENT_STEP_ERR;
-        goto cleanup;
+        if ((ret = replace_file(part_path, pack_path)))
+        {
+            fprintf(stderr, "Could not move resource pack to %s\n", pack_path);
+        }
+    }
+    else if ((ret = remove_file(pack_path)) == ENOENT)
+    {
+        ret = 0;
     }
 
 cleanup:
-    sqlite3_finalize(stmt);
+    free(part_path);
+    free(pack_path);
 
     return ret;
 }
 
-#undef TAG_ARRAY_SIZE
-
-#undef QUERY
-
-#undef NAME_INDEX
-#undef CATEGORY_INDEX
-#undef ORDER_INDEX
-#undef NOTES_INDEX
-#undef SCORE_INDEX
-
-#undef QUERY_DIC_ID_INDEX
-#undef QUERY_NAME_INDEX
-#undef QUERY_CATEGORY_INDEX
-#undef QUERY_ORDER_INDEX
-#undef QUERY_NOTES_INDEX
-#undef QUERY_SCORE_INDEX
-
-/* End add_tag defines */
-/* Begin add_term defines */
-
-#define TERM_ARRAY_SIZE     8
-
-#define QUERY   "INSERT INTO term_bank "\
-                    "(dic_id, expression, reading, def_tags, rules, score, glossary, sequence, term_tags) "\
-                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);"
-
-#define EXPRESSION_INDEX    0
-#define READING_INDEX       1
-#define DEF_TAGS_INDEX      2
-#define RULES_INDEX         3
-#define SCORE_INDEX         4
-#define GLOSSARY_INDEX      5
-#define SEQUENCE_INDEX      6
-#define TERM_TAGS_INDEX     7
-
-#define QUERY_DIC_ID_INDEX          1
-#define QUERY_EXPRESSION_INDEX      2
-#define QUERY_READING_INDEX         3
-#define QUERY_DEF_TAGS_INDEX        4
-#define QUERY_RULES_INDEX           5
-#define QUERY_SCORE_INDEX           6
-#define QUERY_GLOSSARY_INDEX        7
-#define QUERY_SEQUENCE_INDEX        8
-#define QUERY_TERM_TAGS_INDEX       9
-
 /**
- * Add the term stored in the json array
- * @param db   The database to add the tag to
- * @param term The term array to add to the database
- * @param id   The id of the dictionary the tag belongs to
- * @return Error code
+ * Removes a resource pack written by pack_resources() that will not be used
+ * because the transaction was rolled back.
+ * @param res_dir Path to the resource directory.
+ * @param id      The ID of the dictionary.
  */
-static int add_term(sqlite3 *db, json_object *term, const sqlite3_int64 id)
+static void discard_resource_pack(const char *res_dir, const sqlite3_int64 id)
 {
-    int           ret       = 0;
-    json_object  *ret_obj   = NULL;
-
-    const char   *exp       = NULL;
-    const char   *reading   = NULL;
-    const char   *def_tags  = NULL;
-    const char   *rules     = NULL;
-    int           score     = 0;
-    const char   *glossary  = NULL;
-    int           sequence  = 0;
-    const char   *term_tags = NULL;
-
-    sqlite3_stmt *stmt      = NULL;
-    int           step      = 0;
+    char *part_path = get_pack_path(res_dir, id, PACK_PART_SUFFIX);
 
-    /* Make sure the length of the term array is correct */
-    if (json_object_array_length(term) != TERM_ARRAY_SIZE)
+    if (part_path)
     {
-#ifdef _WIN32
-        fprintf(stderr, "Expected term array of size %u, got %llu\n",
-                TERM_ARRAY_SIZE, json_object_array_length(term));
-#else
-        fprintf(stderr, "Expected term array of size %u, got %lu\n",
-                TERM_ARRAY_SIZE, json_object_array_length(term));
-#endif
-        ret = TERM_WRONG_SIZE_ERR;
-        goto cleanup;
+        remove_file(part_path);
+        free(part_path);
     }
+}
 
-    /* Get the objects to add to the database */
-    if ((ret = get_obj_from_array(term, EXPRESSION_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    exp = json_object_get_string(ret_obj);
-
-    if ((ret = get_obj_from_array(term, READING_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    reading = json_object_get_string(ret_obj);
-
-    ret_obj = json_object_array_get_idx(term, DEF_TAGS_INDEX);
-    switch (json_object_get_type(ret_obj))
-    {
-        case json_type_string:
-            def_tags = json_object_get_string(ret_obj);
-            ret = 0;
-            break;
-        case json_type_null:
-            def_tags = "";
-            ret = 0;
-            break;
-        default:
-            fprintf(stderr, "Expected index %u to be of type string or null\n%s\n",
-                    DEF_TAGS_INDEX,
-                    json_object_to_json_string_ext(term, JSON_C_TO_STRING_PRETTY
-            ));
-            ret_obj = NULL;
-            ret = JSON_WRONG_TYPE_ERR;
-            goto cleanup;
-    }
+#undef TITLE_KEY
 
-    if ((ret = get_obj_from_array(term, RULES_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    rules = json_object_get_string(ret_obj);
+#undef PACK_PART_SUFFIX
 
-    if ((ret = get_obj_from_array(term, SCORE_INDEX, json_type_int, &ret_obj)))
-        goto cleanup;
-    score = json_object_get_int(ret_obj);
+#undef REGEX_SKIP_FILE
 
-    if ((ret = get_obj_from_array(term, GLOSSARY_INDEX, json_type_array, &ret_obj)))
-        goto cleanup;
-    glossary = json_object_to_json_string(ret_obj);
+#undef QUERY_DELETE
+#undef QUERY_INSERT
 
-    if ((ret = get_obj_from_array(term, SEQUENCE_INDEX, json_type_int, &ret_obj)))
-        goto cleanup;
-    sequence = json_object_get_int(ret_obj);
+#undef QUERY_DIC_ID_INDEX
+#undef QUERY_PATH_INDEX
+#undef QUERY_OFFSET_INDEX
+#undef QUERY_SIZE_INDEX
 
-    if ((ret = get_obj_from_array(term, TERM_TAGS_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    term_tags = json_object_get_string(ret_obj);
+/**
+ * Modifies the dict_disabled table with a given query.
+ * @param dic_id  The ID to bind to the query.
+ * @param db_file The path to the database file.
+ * @param query   The query to execute. Must contain an ID bind.
+ * @return Error code
+ */
+static int modify_dict_disabled(int64_t dic_id, const char *db_file, const char *query)
+{
+    int           ret  = 0;
+    sqlite3      *db   = NULL;
+    sqlite3_stmt *stmt = NULL;
+    int           step = 0;
+    char         *path = NULL;
 
-    /* Make sure that expression and reading aren't the same */
-    if (!strcmp(exp, reading))
+    /* Open or create the database */
+    if ((ret = yomi_prepare_db(db_file, &db)))
     {
-        reading = "";
+        goto cleanup;
     }
 
-    /* Add term to the database */
-    if (sqlite3_prepare_v2(db, QUERY, -1, &stmt, NULL) != SQLITE_OK)
+    /* Remove the dictionary from the  */
+    if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK)
     {
         fprintf(stderr, "Could not prepare sqlite statement\n");
-        fprintf(stderr, "Query: %s\n", QUERY);
+        fprintf(stderr, "Query: %s\n", query);
         ret = STATEMENT_PREPARE_ERR;
         goto cleanup;
     }
-    if (sqlite3_bind_int (stmt, QUERY_DIC_ID_INDEX,     id                 ) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_EXPRESSION_INDEX, exp,       -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_READING_INDEX,    reading,   -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_DEF_TAGS_INDEX,   def_tags,  -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_RULES_INDEX,      rules,     -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_int (stmt, QUERY_SCORE_INDEX,      score              ) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_GLOSSARY_INDEX,   glossary,  -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_int (stmt, QUERY_SEQUENCE_INDEX,   sequence           ) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_TERM_TAGS_INDEX,  term_tags, -1, NULL) != SQLITE_OK)
+    if (sqlite3_bind_int(stmt, 1, dic_id) != SQLITE_OK)
     {
         fprintf(stderr, "Could not bind values to sqlite statement\n");
         ret = STATEMENT_BIND_ERR;
@@ -1112,143 +4682,161 @@ static int add_term(sqlite3 *db, json_object *term, const sqlite3_int64 id)
 
 cleanup:
     sqlite3_finalize(stmt);
+    sqlite3_close_v2(db);
+    free(path);
 
     return ret;
 }
 
-#undef TERM_ARRAY_SIZE
-
-#undef QUERY
-
-#undef EXPRESSION_INDEX
-#undef READING_INDEX
-#undef DEF_TAGS_INDEX
-#undef RULES_INDEX
-#undef SCORE_INDEX
-#undef GLOSSARY_INDEX
-#undef SEQUENCE_INDEX
-#undef TERM_TAGS_INDEX
+/* Begin dictionary file defines */
 
-#undef QUERY_DIC_ID_INDEX
-#undef QUERY_EXPRESSION_INDEX
-#undef QUERY_READING_INDEX
-#undef QUERY_DEF_TAGS_INDEX
-#undef QUERY_RULES_INDEX
-#undef QUERY_SCORE_INDEX
-#undef QUERY_GLOSSARY_INDEX
-#undef QUERY_SEQUENCE_INDEX
-#undef QUERY_TERM_TAGS_INDEX
+#define DICT_FILE_FORMAT    "dict_%lld.sqlite"
+#define DICT_SCHEMA_FORMAT  "dict_%lld"
 
-/* End add_term defines */
-/* Begin add_kanji defines */
+static const char *BANK_TABLE_NAMES[] = {
+    "tag_bank", "term_bank", "term_meta_bank", "kanji_bank", "kanji_meta_bank"
+};
 
-#define KANJI_ARRAY_SIZE     6
+#define BANK_TABLE_COUNT \
+    (sizeof(BANK_TABLE_NAMES) / sizeof(BANK_TABLE_NAMES[0]))
 
-#define QUERY   "INSERT INTO kanji_bank "\
-                    "(dic_id, char, onyomi, kunyomi, tags, meanings, stats) "\
-                    "VALUES (?, ?, ?, ?, ?, ?, ?);"
+/* The columns of each table in BANK_TABLE_NAMES. Older databases added some
+ * of them with ALTER TABLE, so their order differs from BANK_TABLES_SCHEMA and
+ * they must be named instead of selected with *. */
+static const char *BANK_TABLE_COLUMNS[] = {
+    "dic_id, name, category, ord, notes, score",
+    "dic_id, expression, reading, def_tags, rules, score, glossary, sequence, "
+        "term_tags",
+    "dic_id, expression, mode, type, data, reading, value, display, pitches",
+    "dic_id, char, onyomi, kunyomi, tags, meanings, stats",
+    "dic_id, expression, mode, type, data, reading, value, display, pitches"
+};
 
-#define CHAR_INDEX          0
-#define ONYOMI_INDEX        1
-#define KUNYOMI_INDEX       2
-#define TAGS_INDEX          3
-#define MEANINGS_INDEX      4
-#define STATS_INDEX         5
+/* The dictionary file and the files SQLite keeps next to it in WAL mode */
+static const char *DICT_FILE_SUFFIXES[] = {"", "-wal", "-shm"};
 
-#define QUERY_DIC_ID_INDEX        1
-#define QUERY_CHAR_INDEX          2
-#define QUERY_ONYOMI_INDEX        3
-#define QUERY_KUNYOMI_INDEX       4
-#define QUERY_TAGS_INDEX          5
-#define QUERY_MEANINGS_INDEX      6
-#define QUERY_STATS_INDEX         7
+#define DICT_FILE_SUFFIX_COUNT \
+    (sizeof(DICT_FILE_SUFFIXES) / sizeof(DICT_FILE_SUFFIXES[0]))
 
 /**
- * Add the kanji stored in the json array
- * @param db    The database to add the tag to
- * @param kanji The kanji array to add to the database
- * @param id    The id of the dictionary the tag belongs to
- * @return Error code
+ * Gets the path of a dictionary file stored next to the main database.
+ * @param db_file Path to the main database.
+ * @param file    The name of the dictionary file.
+ * @return The path to the dictionary file. Belongs to the caller. NULL on
+ *         allocation failure.
  */
-static int add_kanji(sqlite3 *db, json_object *kanji, const sqlite3_int64 id)
+static char *get_dict_file_path(const char *db_file, const char *file)
 {
-    int           ret       = 0;
-    json_object  *ret_obj   = NULL;
-
-    const char   *character = NULL;
-    const char   *onyomi    = NULL;
-    const char   *kunyomi   = NULL;
-    const char   *tags      = NULL;
-    const char   *meanings  = NULL;
-    const char   *stats     = NULL;
-
-    sqlite3_stmt *stmt      = NULL;
-    int           step      = 0;
-
-    /* Make sure the length of the term array is correct */
-    if (json_object_array_length(kanji) != KANJI_ARRAY_SIZE)
-    {
+    const char *sep  = strrchr(db_file, '/');
 #ifdef _WIN32
-        fprintf(stderr, "Expected kanji array of size %u, got %llu\n",
-                KANJI_ARRAY_SIZE, json_object_array_length(kanji));
-#else
-        fprintf(stderr, "Expected kanji array of size %u, got %lu\n",
-                KANJI_ARRAY_SIZE, json_object_array_length(kanji));
+    const char *bsep = strrchr(db_file, '\\');
+    if (bsep > sep)
+    {
+        sep = bsep;
+    }
 #endif
-        ret = KANJI_WRONG_SIZE_ERR;
-        goto cleanup;
+    if (sep == NULL)
+    {
+        return strdup(file);
     }
 
-    /* Get the objects to add to the database */
-    if ((ret = get_obj_from_array(kanji, CHAR_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    character = json_object_get_string(ret_obj);
+    size_t  dir_len  = sep - db_file + 1;
+    size_t  file_len = strlen(file);
+    char   *path     = malloc(dir_len + file_len + 1);
+    if (path == NULL)
+    {
+        return NULL;
+    }
+    memcpy(path, db_file, dir_len);
+    memcpy(path + dir_len, file, file_len + 1);
 
-    if ((ret = get_obj_from_array(kanji, ONYOMI_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    onyomi = json_object_get_string(ret_obj);
+    return path;
+}
+
+/**
+ * Removes a dictionary file along with the files SQLite keeps next to it.
+ * Files that don't exist are ignored.
+ * @param path Path to the dictionary file in UTF-8 encoding.
+ * @return 0 on success, errno on failure.
+ */
+static int remove_dict_file(const char *path)
+{
+    int ret = 0;
+
+    for (size_t i = 0; i < DICT_FILE_SUFFIX_COUNT; ++i)
+    {
+        char *file = sqlite3_mprintf("%s%s", path, DICT_FILE_SUFFIXES[i]);
+        int   err  = 0;
+        if (file == NULL)
+        {
+            return ENOMEM;
+        }
+        err = remove_file(file);
+        if (err && err != ENOENT)
+        {
+            fprintf(stderr, "Could not remove dictionary file %s\n", file);
+            ret = err;
+        }
+        sqlite3_free(file);
+    }
 
-    if ((ret = get_obj_from_array(kanji, KUNYOMI_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    kunyomi = json_object_get_string(ret_obj);
+    return ret;
+}
 
-    if ((ret = get_obj_from_array(kanji, TAGS_INDEX, json_type_string, &ret_obj)))
-        goto cleanup;
-    tags = json_object_get_string(ret_obj);
+/**
+ * Raises the number of databases that can be attached to a connection to the
+ * most SQLite was compiled with. The default is far lower than the maximum.
+ * @param db The connection to raise the limit on.
+ * @return The number of databases that can be attached.
+ */
+static int raise_attach_limit(sqlite3 *db)
+{
+    /* Values above the compile time maximum are lowered to it */
+    sqlite3_limit(db, SQLITE_LIMIT_ATTACHED, INT_MAX);
+    return sqlite3_limit(db, SQLITE_LIMIT_ATTACHED, -1);
+}
 
-    if ((ret = get_obj_from_array(kanji, MEANINGS_INDEX, json_type_array, &ret_obj)))
-        goto cleanup;
-    meanings = json_object_to_json_string(ret_obj);
+/**
+ * Determines if a new dictionary can be stored in its own file. This is
+ * limited by the number of databases SQLite can attach to a connection.
+ * Once the limit is reached, dictionaries are stored in the main database
+ * and a warning is printed.
+ * @param      db  The main database.
+ * @param[out] use 1 if the dictionary should get its own file, 0 otherwise.
+ * @return Error code
+ */
+static int can_use_dict_file(sqlite3 *db, int *use)
+{
+    int           ret   = 0;
+    sqlite3_stmt *stmt  = NULL;
+    int           step  = 0;
+    int           limit = 0;
 
-    if ((ret = get_obj_from_array(kanji, STATS_INDEX, json_type_object, &ret_obj)))
-        goto cleanup;
-    stats = json_object_to_json_string(ret_obj);
+    *use = 0;
 
-    /* Add term to the database */
-    if (sqlite3_prepare_v2(db, QUERY, -1, &stmt, NULL) != SQLITE_OK)
+    if (sqlite3_prepare_v2(
+            db, "SELECT count(*) FROM directory WHERE file IS NOT NULL;",
+            -1, &stmt, NULL) != SQLITE_OK)
     {
         fprintf(stderr, "Could not prepare sqlite statement\n");
-        fprintf(stderr, "Query: %s\n", QUERY);
         ret = STATEMENT_PREPARE_ERR;
         goto cleanup;
     }
-    if (sqlite3_bind_int (stmt, QUERY_DIC_ID_INDEX,   id                 ) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_CHAR_INDEX,     character, -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_ONYOMI_INDEX,   onyomi,    -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_KUNYOMI_INDEX,  kunyomi,   -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_TAGS_INDEX,     tags,      -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_MEANINGS_INDEX, meanings,  -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_STATS_INDEX,    stats,     -1, NULL) != SQLITE_OK)
+    if ((step = sqlite3_step(stmt)) != SQLITE_ROW)
     {
-        fprintf(stderr, "Could not bind values to sqlite statement\n");
-        ret = STATEMENT_BIND_ERR;
+        fprintf(stderr, "Could not count dictionary files, sqlite3 error code %d\n", step);
+        ret = STATEMENT_STEP_ERR;
         goto cleanup;
     }
-    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    limit = raise_attach_limit(db);
+    *use = sqlite3_column_int(stmt, 0) < limit;
+    if (!*use)
     {
-        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
-        ret = STATEMENT_STEP_ERR;
-        goto cleanup;
+        fprintf(stderr,
+            "SQLite can only attach %d databases. The dictionary will be "
+            "stored in the main database, which makes removing it slow.\n",
+            limit
+        );
     }
 
 cleanup:
@@ -1257,171 +4845,84 @@ cleanup:
     return ret;
 }
 
-#undef KANJI_ARRAY_SIZE
-
-#undef QUERY
-
-#undef CHAR_INDEX
-#undef ONYOMI_INDEX
-#undef KUNYOMI_INDEX
-#undef TAGS_INDEX
-#undef MEANINGS_INDEX
-#undef STATS_INDEX
-
-#undef QUERY_DIC_ID_INDEX
-#undef QUERY_CHAR_INDEX
-#undef QUERY_ONYOMI_INDEX
-#undef QUERY_KUNYOMI_INDEX
-#undef QUERY_TAGS_INDEX
-#undef QUERY_MEANINGS_INDEX
-#undef QUERY_STATS_INDEX
-
-/* End add_kanji defines */
-/* Begin add_meta defines */
-
-#define META_ARRAY_SIZE     3
-
-#define EXPRESSION_INDEX    0
-#define MODE_INDEX          1
-#define DATA_INDEX          2
-
-#define QUERY_DIC_ID_INDEX          1
-#define QUERY_EXPRESSION_INDEX      2
-#define QUERY_MODE_INDEX            3
-#define QUERY_TYPE_INDEX            4
-#define QUERY_DATA_INDEX            5
-
 /**
- * Add the metadata stored in the json array
- * @param db    The database to add the tag to
- * @param meta  The tag array to add to the database
- * @param id    The id of the dictionary the tag belongs to
- * @param query The query to execute on the database with (?, ?, ?) bindable fields
+ * Creates a dictionary file for a dictionary and records it in the directory.
+ * Any existing file at the path is replaced.
+ * @param      db      The main database. Must be in a transaction.
+ * @param      db_file Path to the main database.
+ * @param      id      The id of the dictionary.
+ * @param[out] path    The path of the new file. Belongs to the caller.
+ * @param[out] dict_db The opened dictionary database. Belongs to the caller.
  * @return Error code
  */
-static int add_meta(sqlite3 *db, json_object *meta, const sqlite3_int64 id, const char *query)
+static int create_dict_file(sqlite3 *db, const char *db_file,
+                            const sqlite3_int64 id, char **path,
+                            sqlite3 **dict_db)
 {
-    int         ret         = 0;
-    json_object *ret_obj    = NULL;
-
-    const char  *exp        = NULL;
-    const char  *mode       = NULL;
-    const void  *data       = NULL;
-    yomi_blob_t type        = 0;
-    size_t      data_len    = 0;
-    int64_t     data_int    = 0;
-    json_bool   data_bool   = 0;
-    double      data_double = 0.0;
-    int         data_null   = 0;
-
-    sqlite3_stmt *stmt      = NULL;
-    int           step      = 0;
-
-    /* Make sure the length of the metadata array is correct */
-    if (json_object_array_length(meta) != META_ARRAY_SIZE)
+    int           ret    = 0;
+    char         *file   = NULL;
+    char         *pragma = NULL;
+    char         *errmsg = NULL;
+    sqlite3_stmt *stmt   = NULL;
+    int           step   = 0;
+
+    *path = NULL;
+    *dict_db = NULL;
+
+    file = sqlite3_mprintf(DICT_FILE_FORMAT, (long long)id);
+    if (file == NULL || (*path = get_dict_file_path(db_file, file)) == NULL)
     {
-#ifdef _WIN32
-        fprintf(stderr, "Expected metadata array of size %u, got %llu\n",
-                META_ARRAY_SIZE, json_object_array_length(meta));
-#else
-        fprintf(stderr, "Expected metadata array of size %u, got %lu\n",
-                META_ARRAY_SIZE, json_object_array_length(meta));
-#endif
-        ret = META_WRONG_SIZE_ERR;
+        fprintf(stderr, "Could not allocate memory for dictionary file path\n");
+        ret = MALLOC_FAILURE_ERR;
         goto cleanup;
     }
 
-    /* Get the objects to add to the database */
-    if ((ret = get_obj_from_array(meta, EXPRESSION_INDEX, json_type_string, &ret_obj)))
+    /* Start from an empty file in case an old import was interrupted */
+    if (remove_dict_file(*path))
+    {
+        ret = DB_TABLE_DROP_ERR;
         goto cleanup;
-    exp = json_object_get_string(ret_obj);
-
-    if ((ret = get_obj_from_array(meta, MODE_INDEX, json_type_string, &ret_obj)))
+    }
+    if (sqlite3_open_v2(*path, dict_db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not create dictionary file %s\n", *path);
+        ret = CREATE_DB_ERR;
         goto cleanup;
-    mode = json_object_get_string(ret_obj);
-
-    /* Get the proper type from the data field of the array */
-    ret_obj = json_object_array_get_idx(meta, DATA_INDEX);
-    switch (json_object_get_type(ret_obj))
+    }
+    pragma = sqlite3_mprintf(
+        JOURNAL_MODE_PRAGMA
+        BANK_TABLES_SCHEMA
+        "PRAGMA user_version = %d;",
+        YOMI_DB_VERSION
+    );
+    if (pragma == NULL)
     {
-    case json_type_array:
-        data = json_object_to_json_string_length(ret_obj, JSON_C_TO_STRING_SPACED, &data_len);
-        ++data_len;
-        type = YOMI_BLOB_TYPE_ARRAY;
-        break;
-    case json_type_object:
-        data = json_object_to_json_string_length(ret_obj, JSON_C_TO_STRING_SPACED, &data_len);
-        ++data_len;
-        type = YOMI_BLOB_TYPE_OBJECT;
-        break;
-    case json_type_int:
-        data_int = json_object_get_int64(ret_obj);
-        data = &data_int;
-        data_len = sizeof(int64_t);
-        type = YOMI_BLOB_TYPE_INT;
-        break;
-    case json_type_boolean:
-        data_bool = json_object_get_boolean(ret_obj);
-        data = &data_bool;
-        data_len = sizeof(json_bool);
-        type = YOMI_BLOB_TYPE_BOOLEAN;
-        break;
-    case json_type_double:
-        data_double = json_object_get_double(ret_obj);
-        data = &data_double;
-        data_len = sizeof(double);
-        type = YOMI_BLOB_TYPE_DOUBLE;
-        break;
-    case json_type_string:
-        data = json_object_get_string(ret_obj);
-        data_len = json_object_get_string_len(ret_obj) + 1;
-        type = YOMI_BLOB_TYPE_STRING;
-        break;
-    case json_type_null:
-        data_null = 1;
-        type = YOMI_BLOB_TYPE_NULL;
-        break;
-    default:
-        fprintf(stderr, "Unknown json type stored in data\n");
-        ret = UNKNOWN_DATA_TYPE_ERR;
+        fprintf(stderr, "Could not allocate memory for query\n");
+        ret = MALLOC_FAILURE_ERR;
+        goto cleanup;
+    }
+    sqlite3_exec(*dict_db, pragma, NULL, NULL, &errmsg);
+    if (errmsg)
+    {
+        fprintf(stderr, "Failed to create tables\nError: %s\n", errmsg);
+        ret = DB_CREATE_TABLE_ERR;
         goto cleanup;
     }
 
-    /* Add metadata to the database */
-    if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK)
+    /* Record the file in the directory */
+    if (sqlite3_prepare_v2(db, "UPDATE directory SET file = ? WHERE dic_id = ?;", -1, &stmt, NULL) != SQLITE_OK)
     {
         fprintf(stderr, "Could not prepare sqlite statement\n");
-        fprintf(stderr, "Query: %s\n", query);
         ret = STATEMENT_PREPARE_ERR;
         goto cleanup;
     }
-    if (sqlite3_bind_int (stmt, QUERY_DIC_ID_INDEX,     id            ) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_EXPRESSION_INDEX, exp,  -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_text(stmt, QUERY_MODE_INDEX,       mode, -1, NULL) != SQLITE_OK ||
-        sqlite3_bind_int (stmt, QUERY_TYPE_INDEX,       type)           != SQLITE_OK)
+    if (sqlite3_bind_text (stmt, 1, file, -1, NULL) != SQLITE_OK ||
+        sqlite3_bind_int64(stmt, 2, id)             != SQLITE_OK)
     {
         fprintf(stderr, "Could not bind values to sqlite statement\n");
         ret = STATEMENT_BIND_ERR;
         goto cleanup;
     }
-    if (data_null)
-    {
-        if (sqlite3_bind_null(stmt, QUERY_DATA_INDEX) != SQLITE_OK)
-        {
-            fprintf(stderr, "Could not bind null data to statement\n");
-            ret = STATEMENT_BIND_ERR;
-            goto cleanup;
-        }
-    }
-    else
-    {
-        if (sqlite3_bind_blob(stmt, QUERY_DATA_INDEX, data, data_len, NULL) != SQLITE_OK)
-        {
-            fprintf(stderr, "Could not bind data blob to statement\n");
-            ret = STATEMENT_BIND_ERR;
-            goto cleanup;
-        }
-    }
     if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
     {
         fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
@@ -1430,800 +4931,1130 @@ static int add_meta(sqlite3 *db, json_object *meta, const sqlite3_int64 id, cons
     }
 
 cleanup:
+    if (ret)
+    {
+        sqlite3_close_v2(*dict_db);
+        *dict_db = NULL;
+        if (*path)
+        {
+            remove_dict_file(*path);
+        }
+        free(*path);
+        *path = NULL;
+    }
     sqlite3_finalize(stmt);
+    sqlite3_free(errmsg);
+    sqlite3_free(pragma);
+    sqlite3_free(file);
 
     return ret;
 }
 
-#undef META_ARRAY_SIZE
-
-#undef EXPRESSION_INDEX
-#undef MODE_INDEX
-#undef DATA_INDEX
-
-#undef QUERY_DIC_ID_INDEX
-#undef QUERY_EXPRESSION_INDEX
-#undef QUERY_MODE_INDEX
-#undef QUERY_DATA_INDEX
-
-/* End add_meta defines */
-
-/**
- * Add the term meta data stored in the json object
- * @param db        The database to add the metadata to
- * @param term_meta The term metadata json array to add
- * @param id        The id of the dictionary the term metadata belongs to
- * @return Error code
- */
-static int add_term_meta(sqlite3 *db, json_object *term_meta, const sqlite3_int64 id)
-{
-    return add_meta(
-        db,
-        term_meta,
-        id,
-        "INSERT INTO term_meta_bank (dic_id, expression, mode, type, data) "
-            "VALUES (?, ?, ?, ?, ?);"
-    );
-}
-
-/**
- * Add the kanji meta data stored in the json object
- * @param db         The database to add the metadata to
- * @param kanji_meta The kanji metadata json array to add
- * @param id         The id of the dictionary the kanji metadata belongs to
- * @return Error code
- */
-static int add_kanji_meta(sqlite3 *db, json_object *kanji_meta, const sqlite3_int64 id)
-{
-    return add_meta(
-        db,
-        kanji_meta,
-        id,
-        "INSERT INTO kanji_meta_bank (dic_id, expression, mode, type, data) "
-            "VALUES (?, ?, ?, ?, ?);"
-    );
-}
-
-/**
- * Adds a yomichan bank type to the database
- * @param dict_archive The dictionary archive holding index.json
- * @param db           The database
- * @param id           The id of the dictionary
- * @param type         The type of bank to add to the database
- * @return Error code
- */
-static int add_dic_files(zip_t *dict_archive, sqlite3 *db, const sqlite3_int64 id, bank_type type)
-{
-    int           ret         = 0;
-    const char   *file_format = NULL;
-    size_t        fileno      = 1;
-    json_object  *outer_arr   = NULL;
-    json_object  *inner_arr   = NULL;
-    char         *errmsg      = NULL;
-    int (*add_item)(sqlite3 *, json_object *, const sqlite3_int64) = NULL;
-
-    /* Set the type of files to iterate over and the function used to add them */
-    switch (type)
-    {
-    case tag_bank:
-        file_format = TAG_BANK_FORMAT;
-        add_item    = add_tag;
-        break;
-    case term_bank:
-        file_format = TERM_BANK_FORMAT;
-        add_item    = add_term;
-        break;
-    case term_meta_bank:
-        file_format = TERM_META_BANK_FORMAT;
-        add_item    = add_term_meta;
-        break;
-    case kanji_bank:
-        file_format = KANJI_BANK_FORMAT;
-        add_item    = add_kanji;
-        break;
-    case kanji_meta_bank:
-        file_format = KANJI_META_BANK_FORMAT;
-        add_item    = add_kanji_meta;
-        break;
-    default:
-        fprintf(stderr, "Unknown bank_type value %d\n", type);
-        ret = UNKNOWN_BANK_TYPE_ERR;
+/**
+ * Copies the banks of a dictionary in the main database to its dictionary
+ * file.
+ * @param dict_db The dictionary file. Must not be in a transaction.
+ * @param db_file Path to the main database.
+ * @param id      The id of the dictionary.
+ * @return Error code
+ */
+static int copy_dict_banks(sqlite3 *dict_db, const char *db_file,
+                           const sqlite3_int64 id)
+{
+    int           ret      = 0;
+    int           attached = 0;
+    char         *query    = NULL;
+    char         *errmsg   = NULL;
+    sqlite3_stmt *stmt     = NULL;
+    int           step     = 0;
+
+    if (sqlite3_prepare_v2(dict_db, "ATTACH DATABASE ? AS src;", -1, &stmt, NULL) != SQLITE_OK)
+    {
+        fprintf(stderr, "Could not prepare sqlite statement\n");
+        ret = STATEMENT_PREPARE_ERR;
+        goto cleanup;
+    }
+    if (sqlite3_bind_text(stmt, 1, db_file, -1, NULL) != SQLITE_OK ||
+        sqlite3_step(stmt) != SQLITE_DONE)
+    {
+        fprintf(stderr, "Could not attach %s\nError: %s\n", db_file, sqlite3_errmsg(dict_db));
+        ret = CREATE_DB_ERR;
         goto cleanup;
     }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+    attached = 1;
 
-    /* Iterate over all the files  */
-    char filename[FILENAME_BUFFER_SIZE];
-    snprintf(filename, FILENAME_BUFFER_SIZE, file_format, fileno++);
-    filename[FILENAME_BUFFER_SIZE - 1] = '\0';
-    while (zip_name_locate(dict_archive, filename, 0) != -1)
+    /* Deferred, since an exclusive transaction would also lock src */
+    sqlite3_exec(dict_db, "BEGIN;", NULL, NULL, &errmsg);
+    if (errmsg)
+    {
+        fprintf(stderr, "Could not begin transaction\nError: %s\n", errmsg);
+        ret = TRANSACTION_ERR;
+        goto cleanup;
+    }
+    for (size_t i = 0; i < BANK_TABLE_COUNT; ++i)
     {
-        /* Parse the current tag bank into Json */
-        if ((ret = get_json_obj(dict_archive, filename, &outer_arr)))
+        query = sqlite3_mprintf(
+            "INSERT INTO main.%s (%s) SELECT %s FROM src.%s WHERE dic_id = ?;",
+            BANK_TABLE_NAMES[i], BANK_TABLE_COLUMNS[i],
+            BANK_TABLE_COLUMNS[i], BANK_TABLE_NAMES[i]
+        );
+        if (query == NULL)
         {
+            fprintf(stderr, "Could not allocate memory for query\n");
+            ret = MALLOC_FAILURE_ERR;
             goto cleanup;
         }
-        if (!json_object_is_type(outer_arr, json_type_array))
+        if (sqlite3_prepare_v2(dict_db, query, -1, &stmt, NULL) != SQLITE_OK)
         {
-            fprintf(stderr, "Returned object was not of type array\n");
-            ret = JSON_WRONG_TYPE_ERR;
+            fprintf(stderr, "Could not prepare sqlite statement\n");
+            ret = STATEMENT_PREPARE_ERR;
             goto cleanup;
         }
-
-        /* Iterate over all the outer arrays */
-        for (size_t i = 0; i < json_object_array_length(outer_arr); ++i)
+        if (sqlite3_bind_int64(stmt, 1, id) != SQLITE_OK)
         {
-            /* Get the inner array which contains tag info */
-            inner_arr = json_object_array_get_idx(outer_arr, i);
-            if (!json_object_is_type(inner_arr, json_type_array))
-            {
-                fprintf(stderr, "Tag array is of the incorrect type\n");
-                ret = JSON_WRONG_TYPE_ERR;
-                goto cleanup;
-            }
-
-            /* Add the tag to the database */
-            if ((ret = (*add_item)(db, inner_arr, id)))
-            {
-                fprintf(stderr, "Could not add %s\n", filename);
-                goto cleanup;
-            }
+            fprintf(stderr, "Could not bind values to sqlite statement\n");
+            ret = STATEMENT_BIND_ERR;
+            goto cleanup;
         }
-
-        /* Prepare for the next iteration of the loop */
-        snprintf(filename, FILENAME_BUFFER_SIZE, file_format, fileno++);
-        filename[FILENAME_BUFFER_SIZE - 1] = '\0';
-        json_object_put(outer_arr);
-        outer_arr  = NULL;
-        inner_arr = NULL;
+        if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+        {
+            fprintf(stderr, "Could not copy %s, sqlite3 error code %d\n", BANK_TABLE_NAMES[i], step);
+            ret = STATEMENT_STEP_ERR;
+            goto cleanup;
+        }
+        sqlite3_finalize(stmt);
+        stmt = NULL;
+        sqlite3_free(query);
+        query = NULL;
+    }
+    if ((ret = commit_transaction(dict_db)))
+    {
+        goto cleanup;
     }
 
 cleanup:
-    json_object_put(outer_arr);
-    sqlite3_free(errmsg);
-
-    return ret;
-}
-
-#ifdef _WIN32
-/**
- * Converts a UTF-8 string to an LPWSTR.
- * @param str The UTF-8 string to convert.
- * @return An LPSTR. Must be freed with free(). NULL on error.
- */
-static LPWSTR utf8_to_lpwstr(const char *str)
-{
-    int len = MultiByteToWideChar(CP_UTF8, 0, str, -1, NULL, 0);
-    if (len == 0)
+    sqlite3_finalize(stmt);
+    sqlite3_free(query);
+    if (ret && !sqlite3_get_autocommit(dict_db))
     {
-        return NULL;
+        rollback_transaction(dict_db);
     }
-    LPWSTR lpwstr = malloc(sizeof(WCHAR) * len);
-    if (MultiByteToWideChar(CP_UTF8, 0, str, -1, lpwstr, len) == 0)
+    sqlite3_free(errmsg);
+    errmsg = NULL;
+    if (attached)
     {
-        free(lpwstr);
-        return NULL;
+        sqlite3_exec(dict_db, "DETACH DATABASE src;", NULL, NULL, &errmsg);
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not detach %s\nError: %s\n", db_file, errmsg);
+            ret = ret ? ret : CREATE_DB_ERR;
+        }
     }
-    return lpwstr;
+    sqlite3_free(errmsg);
+
+    return ret;
 }
 
 /**
- * Removes a path on Windows.
- * @param path The path to remove in UTF-8 encoding.
- * @return Error code.
+ * Moves the banks of a dictionary stored in the main database to its own file.
+ * @param db      The main database. Must not be in a transaction.
+ * @param db_file Path to the main database.
+ * @param id      The id of the dictionary.
+ * @return Error code
  */
-static int remove_path(const char *path)
+static int move_dict_to_file(sqlite3 *db, const char *db_file,
+                             const sqlite3_int64 id)
 {
-    int    ret     = 0;
-    LPWSTR pszFrom = NULL;
-
-    int len = MultiByteToWideChar(CP_UTF8, 0, path, -1, NULL, 0);
-    if (len == 0)
+    int           ret     = 0;
+    sqlite3      *dict_db = NULL;
+    char         *path    = NULL;
+    char         *query   = NULL;
+    char         *errmsg  = NULL;
+    sqlite3_stmt *stmt    = NULL;
+    int           step    = 0;
+
+    /* The directory only points to the file once the banks are deleted from
+     * the main database, so an interrupted move starts over. The transaction
+     * is not exclusive so the copy can still read the main database. */
+    sqlite3_exec(db, "BEGIN IMMEDIATE;", NULL, NULL, &errmsg);
+    if (errmsg)
     {
-        ret = -1;
+        fprintf(stderr, "Could not begin transaction\nError: %s\n", errmsg);
+        ret = TRANSACTION_ERR;
         goto cleanup;
     }
-    pszFrom = malloc(sizeof(WCHAR) * (len + 2));
-    len = MultiByteToWideChar(CP_UTF8, 0, path, -1, pszFrom, len);
-    if (len == 0)
+    if ((ret = create_dict_file(db, db_file, id, &path, &dict_db)) ||
+        (ret = copy_dict_banks(dict_db, db_file, id)))
     {
-        ret = -2;
         goto cleanup;
     }
-    pszFrom[len] = '\0';
-    pszFrom[len + 1] = '\0';
-    if (pszFrom[len - 1] == '\\')
-    {
-        pszFrom[len - 1] = '\0';
-    }
-    for (LPWSTR ptr = pszFrom; *ptr; ++ptr)
+    for (size_t i = 0; i < BANK_TABLE_COUNT; ++i)
     {
-        if (*ptr == '/')
+        query = sqlite3_mprintf(
+            "DELETE FROM main.%s WHERE dic_id = ?;", BANK_TABLE_NAMES[i]
+        );
+        if (query == NULL)
         {
-            *ptr = '\\';
+            fprintf(stderr, "Could not allocate memory for query\n");
+            ret = MALLOC_FAILURE_ERR;
+            goto cleanup;
+        }
+        if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK)
+        {
+            fprintf(stderr, "Could not prepare sqlite statement\n");
+            ret = STATEMENT_PREPARE_ERR;
+            goto cleanup;
+        }
+        if (sqlite3_bind_int64(stmt, 1, id) != SQLITE_OK)
+        {
+            fprintf(stderr, "Could not bind values to sqlite statement\n");
+            ret = STATEMENT_BIND_ERR;
+            goto cleanup;
+        }
+        if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+        {
+            fprintf(stderr, "Could not delete from %s, sqlite3 error code %d\n", BANK_TABLE_NAMES[i], step);
+            ret = STATEMENT_STEP_ERR;
+            goto cleanup;
         }
+        sqlite3_finalize(stmt);
+        stmt = NULL;
+        sqlite3_free(query);
+        query = NULL;
     }
-
-    /* Delete the directory contents */
-    SHFILEOPSTRUCTW fileop = {
-        .hwnd = NULL, // no status display
-        .wFunc = FO_DELETE, // delete operation
-        .pFrom = pszFrom, // source file name as double null terminated string
-        .pTo = NULL, // no destination needed
-        .fFlags = FOF_NOCONFIRMATION | FOF_SILENT, // do not prompt the user
-        .fAnyOperationsAborted = FALSE,
-        .lpszProgressTitle = NULL,
-        .hNameMappings = NULL,
-    };
-    if ((ret = SHFileOperationW(&fileop)))
+    if ((ret = commit_transaction(db)))
     {
         goto cleanup;
     }
 
 cleanup:
-    free(pszFrom);
+    sqlite3_finalize(stmt);
+    sqlite3_free(query);
+    sqlite3_free(errmsg);
+    sqlite3_close_v2(dict_db);
+    if (ret)
+    {
+        if (!sqlite3_get_autocommit(db))
+        {
+            rollback_transaction(db);
+        }
+        if (path)
+        {
+            remove_dict_file(path);
+        }
+    }
+    free(path);
 
     return ret;
 }
 
 /**
- * Creates a path if it doesn't already exist.
- * @param path The path to create.
- * @return mkdir error code.
+ * Moves dictionaries stored in the main database by older versions to their
+ * own files while there is room to attach them. Stops at the first failure,
+ * leaving the remaining dictionaries in the main database.
+ * @param db      The main database.
+ * @param db_file Path to the main database.
+ * @return Error code
  */
-static int make_path(const char *path)
+static int move_dicts_to_files(sqlite3 *db, const char *db_file)
 {
-    int    ret       = 0;
-    LPWSTR path_copy = NULL;
-    LPWSTR ptr       = NULL;
-
-    /* Convert to LPSTR */
-    path_copy = utf8_to_lpwstr(path);
-    if (path_copy == NULL)
-    {
-        ret = -1;
-        goto cleanup;
-    }
-
-    /* Seek to the first seperator */
-    ptr = path_copy;
-    while (*ptr && *ptr != '/')
-    {
-        ++ptr;
-    }
-    if (*ptr == '\0')
+    int           ret    = 0;
+    sqlite3_stmt *stmt   = NULL;
+    int           step   = 0;
+    int           use    = 0;
+    int           moved  = 0;
+    sqlite3_int64 id     = 0;
+    char         *errmsg = NULL;
+
+    if (sqlite3_prepare_v2(
+            db, "SELECT dic_id FROM directory WHERE file IS NULL LIMIT 1;",
+            -1, &stmt, NULL) != SQLITE_OK)
     {
+        fprintf(stderr, "Could not prepare sqlite statement\n");
+        ret = STATEMENT_PREPARE_ERR;
         goto cleanup;
     }
-
-    /* Create the path */
-    for (ptr += 1; *ptr; ++ptr)
+    for (;;)
     {
-        if (*ptr != '/')
+        if ((step = sqlite3_step(stmt)) == SQLITE_DONE)
         {
-            continue;
+            break;
+        }
+        else if (step != SQLITE_ROW)
+        {
+            fprintf(stderr, "Could not list dictionaries, sqlite3 error code %d\n", step);
+            ret = STATEMENT_STEP_ERR;
+            goto cleanup;
         }
+        id = sqlite3_column_int64(stmt, 0);
+        sqlite3_reset(stmt);
 
-        *ptr = '\0';
-        if (_wmkdir(path_copy) && errno != EEXIST)
+        if ((ret = can_use_dict_file(db, &use)) || !use)
         {
-            ret = errno;
             goto cleanup;
         }
-        *ptr = '/';
-    }
-    if (_wmkdir(path_copy) && errno != EEXIST)
-    {
-        ret = errno;
-        goto cleanup;
+        if ((ret = move_dict_to_file(db, db_file, id)))
+        {
+            fprintf(stderr, "Could not move dictionary %lld to its own file\n", (long long)id);
+            goto cleanup;
+        }
+        moved = 1;
     }
 
 cleanup:
-    free(path_copy);
+    sqlite3_finalize(stmt);
+
+    /* Give the space the banks took back to the file system. This is only
+     * worth the wait once, so a busy database is not an error. */
+    if (moved)
+    {
+        sqlite3_exec(db, "VACUUM;", NULL, NULL, &errmsg);
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not vacuum the database\nError: %s\n", errmsg);
+            sqlite3_free(errmsg);
+        }
+    }
 
     return ret;
 }
 
-#else
-/**
- * Deletes the files pass in the path argument.
- * @param path The path of the file/folder to delete.
- * @param sbuf Unused.
- * @param type Unused.
- * @param ftwb Unused.
- * @return 0 on success, errno on failure.
- */
-static int remove_path_callback(
-    const char *path,
-    const struct stat *sbuf __attribute__((unused)),
-    int type __attribute__((unused)),
-    struct FTW *ftwb __attribute__((unused)))
+int yomi_detach_dictionaries(sqlite3 *db)
 {
-    if (remove(path))
+    int           ret    = 0;
+    sqlite3_stmt *stmt   = NULL;
+    char         *query  = NULL;
+    char         *errmsg = NULL;
+    int           step   = 0;
+
+    /* Drop the views that reference the attached databases */
+    for (size_t i = 0; i < BANK_TABLE_COUNT; ++i)
     {
-        fprintf(stderr, "Could not remove file:\n%s\n", strerror(errno));
-        return errno;
+        query = sqlite3_mprintf("DROP VIEW IF EXISTS temp.%s;", BANK_TABLE_NAMES[i]);
+        if (query == NULL)
+        {
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
+        }
+        sqlite3_exec(db, query, NULL, NULL, &errmsg);
+        sqlite3_free(query);
+        query = NULL;
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not drop view\nError: %s\n", errmsg);
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
+        }
     }
-    return 0;
-}
 
-/**
- * Recursively deletes a path.
- * @param path The path to recursively delete.
- * @return 0 on success, errno on failure.
- */
-static int remove_path(const char *path)
-{
-    if (nftw(path, remove_path_callback, 10, FTW_DEPTH|FTW_MOUNT|FTW_PHYS))
+    /* Detach every dictionary file. Databases can't be detached while the
+     * database list is being read, so read it again after every detach. */
+    for (;;)
     {
-        return errno;
+        if (sqlite3_prepare_v2(
+                db,
+                "SELECT name FROM pragma_database_list "
+                    "WHERE name LIKE 'dict\\_%' ESCAPE '\\';",
+                -1, &stmt, NULL) != SQLITE_OK)
+        {
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
+        }
+        if ((step = sqlite3_step(stmt)) != SQLITE_ROW)
+        {
+            ret = step == SQLITE_DONE ? 0 : YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
+        }
+        query = sqlite3_mprintf(
+            "DETACH DATABASE \"%w\";", (const char *)sqlite3_column_text(stmt, 0)
+        );
+        sqlite3_finalize(stmt);
+        stmt = NULL;
+        if (query == NULL)
+        {
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
+        }
+        sqlite3_exec(db, query, NULL, NULL, &errmsg);
+        sqlite3_free(query);
+        query = NULL;
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not detach dictionary\nError: %s\n", errmsg);
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
+        }
     }
-    return 0;
-}
 
-/**
- * Creates a path if it doesn't already exist.
- * @param path The path to create.
- * @return mkdir error code.
- */
-static int make_path(const char *path)
-{
-    int   ret       = 0;
-    char *path_copy = strdup(path);
-    char *ptr       = strchr(path_copy, '/');
+cleanup:
+    sqlite3_finalize(stmt);
+    sqlite3_free(errmsg);
+
+    return ret;
+}
 
-    if (ptr == NULL)
+int yomi_attach_dictionaries(sqlite3 *db, const char *db_file)
+{
+    int           ret      = 0;
+    sqlite3_stmt *stmt     = NULL;
+    sqlite3_stmt *attach   = NULL;
+    int           step     = 0;
+    char         *path     = NULL;
+    char         *schema   = NULL;
+    char         *errmsg   = NULL;
+    char         *views[BANK_TABLE_COUNT] = {NULL};
+    size_t        attached = 0;
+
+    if ((ret = yomi_detach_dictionaries(db)))
     {
         goto cleanup;
     }
+    raise_attach_limit(db);
 
-    for (ptr += 1; *ptr; ++ptr)
+    for (size_t i = 0; i < BANK_TABLE_COUNT; ++i)
     {
-        if (*ptr != '/')
+        views[i] = sqlite3_mprintf(
+            "CREATE TEMP VIEW %s AS SELECT %s FROM main.%s",
+            BANK_TABLE_NAMES[i], BANK_TABLE_COLUMNS[i], BANK_TABLE_NAMES[i]
+        );
+        if (views[i] == NULL)
         {
-            continue;
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
         }
+    }
 
-        *ptr = '\0';
-        if (mkdir(path_copy, 0755) && errno != EEXIST)
+    /* Attach every dictionary stored in its own file */
+    if (sqlite3_prepare_v2(
+            db,
+            "SELECT dic_id, file FROM main.directory WHERE file IS NOT NULL;",
+            -1, &stmt, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(
+            db, "ATTACH DATABASE ? AS ?;", -1, &attach, NULL) != SQLITE_OK)
+    {
+        ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+        goto cleanup;
+    }
+    while ((step = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        sqlite3_int64 id = sqlite3_column_int64(stmt, 0);
+
+        path = get_dict_file_path(
+            db_file, (const char *)sqlite3_column_text(stmt, 1)
+        );
+        schema = sqlite3_mprintf(DICT_SCHEMA_FORMAT, (long long)id);
+        if (path == NULL || schema == NULL)
         {
-            ret = errno;
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
             goto cleanup;
         }
-        *ptr = '/';
+        if (sqlite3_bind_text(attach, 1, path,   -1, NULL) != SQLITE_OK ||
+            sqlite3_bind_text(attach, 2, schema, -1, NULL) != SQLITE_OK ||
+            sqlite3_step(attach) != SQLITE_DONE)
+        {
+            fprintf(stderr, "Could not attach %s\nError: %s\n", path, sqlite3_errmsg(db));
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
+        }
+        sqlite3_reset(attach);
+        sqlite3_clear_bindings(attach);
+        ++attached;
+
+        for (size_t i = 0; i < BANK_TABLE_COUNT; ++i)
+        {
+            views[i] = sqlite3_mprintf(
+                "%z UNION ALL SELECT %s FROM \"%w\".%s",
+                views[i], BANK_TABLE_COLUMNS[i], schema, BANK_TABLE_NAMES[i]
+            );
+            if (views[i] == NULL)
+            {
+                ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+                goto cleanup;
+            }
+        }
+
+        free(path);
+        path = NULL;
+        sqlite3_free(schema);
+        schema = NULL;
     }
-    if (mkdir(path_copy, 0755) && errno != EEXIST)
+    if (step != SQLITE_DONE)
+    {
+        ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+        goto cleanup;
+    }
+
+    /* Shadow the tables in main with views over every database */
+    if (attached == 0)
     {
-        ret = errno;
         goto cleanup;
     }
+    for (size_t i = 0; i < BANK_TABLE_COUNT; ++i)
+    {
+        sqlite3_exec(db, views[i], NULL, NULL, &errmsg);
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not create view\nError: %s\n", errmsg);
+            ret = YOMI_ERR_ATTACHING_DICTIONARIES;
+            goto cleanup;
+        }
+    }
 
 cleanup:
-    free(path_copy);
+    sqlite3_finalize(stmt);
+    sqlite3_finalize(attach);
+    for (size_t i = 0; i < BANK_TABLE_COUNT; ++i)
+    {
+        sqlite3_free(views[i]);
+    }
+    sqlite3_free(errmsg);
+    sqlite3_free(schema);
+    free(path);
 
     return ret;
 }
-#endif
 
-/**
- * Concatenates two paths and normalizes all separators to use /.
- * @param start The begining of the path.
- * @param end   The ending of the path.
- * @return The two paths concatenated. Must be freed with free().
- */
-static char *concat_paths(const char *start, const char *end)
+#undef DICT_FILE_FORMAT
+#undef DICT_SCHEMA_FORMAT
+
+#undef BANK_TABLE_COUNT
+#undef DICT_FILE_SUFFIX_COUNT
+
+/* End dictionary file defines */
+
+int yomi_prepare_db(const char *db_file, sqlite3 **db)
 {
-    size_t  start_len = strlen(start);
-    size_t  end_len   = strlen(end);
-    char   *path      = malloc(start_len + end_len + 2);
-    strcpy(path, start);
+    int      ret          = 0;
+    sqlite3 *db_loc       = NULL;
+    int      prepare_code = 0;
 
-    /* Make sure the start path ends in a separator */
-#ifdef _WIN32
-    if (start[start_len - 1] != '/' || start[start_len - 1] != '\\')
-#else
-    if (start[start_len - 1] != '/')
-#endif
+    /* Open or create the database */
+    if (sqlite3_open_v2(db_file, &db_loc, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK)
     {
-        path[start_len++] = '/';
+        ret = YOMI_ERR_DB;
+        goto cleanup;
     }
 
-    /* Copy the ending */
-    strcpy(&path[start_len], end);
-
-#ifdef _WIN32
-    /* Normalize path to use forward slashes on Windows */
-    for (char *ptr = path; *ptr; ++ptr)
+    /* Make sure the database is setup and that dictionaries from before
+     * version 5 get their own files */
+    if ((prepare_code = prepare_db(db_loc)) ||
+        (prepare_code = move_dicts_to_files(db_loc, db_file)))
     {
-        if (*ptr == '\\')
-        {
-            *ptr = '/';
-        }
+        ret = prepare_code == DB_NEW_VERSION_ERR ? YOMI_ERR_NEWER_VERSION : YOMI_ERR_DB;
+        goto cleanup;
     }
-#endif
-
-    return path;
-}
 
-#define TITLE_KEY "title"
+    /* Return the create database if not null */
+    if (db)
+    {
+        *db = db_loc;
+        return ret;
+    }
 
-#define REGEX_SKIP_FILE \
-    "^index\\.json$|" \
-    "^tag_bank_[1-9][0-9\\(\\)]*\\.json$|" \
-    "^term_bank_[1-9][0-9\\(\\)]*\\.json$|" \
-    "^term_meta_bank_[1-9][0-9\\(\\)]*\\.json$|" \
-    "^kanji_bank_[1-9][0-9\\(\\)]*\\.json$|" \
-    "^kanji_meta_bank_[1-9][0-9\\(\\)]*\\.json$"
+cleanup:
+    sqlite3_close_v2(db_loc);
+    if (db)
+    {
+        *db = NULL;
+    }
 
-#ifdef _WIN32
-/* This is returned from SHFileOperationW when folders in the path don't exist */
-#define DE_INVALIDFILES 0x7C
-#endif
+    return ret;
+}
 
 /**
- * Extracts resources also in the archive if they exist.
- * @param dict_archive The dictionary archive to extract resources from.
- * @param res_dir      Path to the resource directory.
- * @return Error code.
+ * Gets the public error code for a bank that could not be added.
+ * @param type The type of bank that failed.
+ * @return The YOMI_ERR_* code describing the failure.
  */
-static int extract_resources(zip_t *dict_archive, const char *res_dir)
+static int bank_type_to_error(bank_type type)
 {
-    int          ret        = 0;
-    regex_t      rt;
-    regex_t     *file_regex = NULL;
-    json_object *obj        = NULL;
-    json_object *ret_obj    = NULL;
-    const char  *dict_name  = NULL;
-    char        *base_path  = NULL;
-    const char *file_name   = NULL;
+    switch (type)
+    {
+    case tag_bank:
+        return YOMI_ERR_ADDING_TAGS;
+    case term_bank:
+        return YOMI_ERR_ADDING_TERMS;
+    case term_meta_bank:
+        return YOMI_ERR_ADDING_TERMS_META;
+    case kanji_bank:
+        return YOMI_ERR_ADDING_KANJI;
+    case kanji_meta_bank:
+        return YOMI_ERR_ADDING_KANJI_META;
+    }
+    return YOMI_ERR_DB;
+}
 
-    /* Get the name of the dictionary */
-    if ((ret = get_json_obj(dict_archive, INDEX_FILE, &obj)))
+int yomi_process_dictionary(const char *dict_file, const char *db_file, const char *res_dir)
+{
+    return yomi_process_dictionary_stats(dict_file, db_file, res_dir, NULL);
+}
+
+int yomi_process_dictionary_stats(const char *dict_file, const char *db_file, const char *res_dir,
+                                  yomi_import_stats *stats)
+{
+    int            ret           = 0;
+    int            err           = 0;
+    zip_t         *dict_archive  = NULL;
+    sqlite3       *db            = NULL;
+    sqlite3       *dict_db       = NULL;
+    sqlite3       *bank_db       = NULL;
+    char          *dict_path     = NULL;
+    int            has_pack      = 0;
+    int            use_dict_file = 0;
+    sqlite3_int64  id            = 0;
+    bank_type      failed_type   = tag_bank;
+    import_pragmas pragmas;
+    import_pragmas dict_pragmas;
+    int            pragmas_set   = 0;
+    uint64_t       start         = 0;
+
+    /* Open dictionary archive */
+    dict_archive = zip_open(dict_file, ZIP_RDONLY, &err);
+    if (err)
     {
-        fprintf(stderr, "Failed to open index file\n");
-        goto cleanup;
+        ret = YOMI_ERR_OPENING_DIC;
+        goto error;
     }
-    if ((ret = get_obj_from_obj(obj, TITLE_KEY, json_type_string, &ret_obj)))
+
+    /* Open or create the database */
+    if ((ret = yomi_prepare_db(db_file, &db)))
     {
-        fprintf(stderr, "Failed to get title from index object\n");
-        goto cleanup;
+        goto error;
     }
-    dict_name = json_object_get_string(ret_obj);
 
-    /* Empty the base path if it already exists */
-    base_path = concat_paths(res_dir, dict_name);
-    ret = remove_path(base_path);
-#ifdef _WIN32
-    switch (ret)
+    /* Speed up the import for the lifetime of the transaction */
+    if ((ret = begin_import_pragmas(db, &pragmas)))
     {
-    case DE_INVALIDFILES:
-    case ERROR_FILE_NOT_FOUND:
-        ret = 0;
-        break;
-    default:
-        break;
+        goto error;
     }
-#else
-    ret = ret && ret != ENOENT ? ret : 0;
-#endif
-    if (ret)
+    pragmas_set = 1;
+
+    /* Process the index file */
+    if ((ret = begin_transaction(db)))
     {
-        fprintf(stderr, "Could not remove base path: %s\n", base_path);
-#ifdef _WIN32
-        fprintf(stderr, "Error Code: %x\n", ret);
-#else
-        fprintf(stderr, "%s\n", strerror(ret));
-#endif
-        goto cleanup;
+        goto error;
     }
-    if ((ret = make_path(base_path)))
+    start = now_nsecs();
+    if ((ret = add_index(dict_archive, db, &id)))
     {
-        fprintf(stderr, "Could not create path: %s\n%s\n", base_path, strerror(ret));
-        goto cleanup;
+        ret = ret == DICT_INSTALLED_ERR ?
+            YOMI_ERR_ALREADY_INSTALLED : YOMI_ERR_ADDING_INDEX;
+        goto error;
     }
+    add_phase_stats(stats, YOMI_PHASE_INDEX_FILE, start, 1, 0, 0);
 
-    /* Initialize the file regex filter */
-    if ((ret = regcomp(&rt, REGEX_SKIP_FILE, REG_EXTENDED)))
+    /* Store the dictionary in its own file if there is room to attach it */
+    bank_db = db;
+    if (can_use_dict_file(db, &use_dict_file))
     {
-        fprintf(stderr, "Could not compile regex\nError: %d\n", ret);
-        goto cleanup;
+        ret = YOMI_ERR_DB;
+        goto error;
     }
-    file_regex = &rt; // if regcomp fails, regfree is UB if passed non-NULL
-
-    /* Iterate over files */
-    for (zip_int64_t i = 0; i < zip_get_num_entries(dict_archive, 0); ++i)
+    if (use_dict_file)
     {
-        file_name = zip_get_name(dict_archive, i, 0);
-        /* Skip unwanted files */
-        switch (regexec(file_regex, file_name, 0, NULL, 0))
+        if (create_dict_file(db, db_file, id, &dict_path, &dict_db) ||
+            begin_import_pragmas(dict_db, &dict_pragmas) ||
+            begin_transaction(dict_db))
         {
-        case REG_NOMATCH:
-            break;
-        case 0:
-            continue;
-        default:
-            fprintf(stderr, "Error occurring in matching file regex\n");
-            goto cleanup;
+            ret = YOMI_ERR_CREATING_DICT_FILE;
+            goto error;
         }
+        bank_db = dict_db;
+    }
 
-        /* Check if the file is a directory */
-        size_t file_name_len = strlen(file_name);
-        if (file_name[file_name_len - 1] == '/')
-        {
-            char *path = concat_paths(base_path, file_name);
-            make_path(path);
-            free(path);
-            continue;
-        }
+    /* Process every bank in the archive */
+    if (add_dic_files(dict_archive, dict_file, bank_db, id, 1, &failed_type, stats))
+    {
+        ret = bank_type_to_error(failed_type);
+        goto error;
+    }
 
-        /* Open file that are actual files */
-        zip_file_t *zip_file = zip_fopen_index(dict_archive, i, 0);
-        if (zip_file == NULL)
-        {
-            fprintf(stderr, "Could not open resource file in archive\n");
-            goto cleanup;
-        }
+    /* Pack any resources that also exist in the archive */
+    if (pack_resources(dict_archive, db, id, res_dir, stats, &has_pack))
+    {
+        ret = YOMI_ERR_EXTRACTING_RESOURCES;
+        goto error;
+    }
 
-        /* Create the file path */
-        char *file_path = concat_paths(base_path, file_name);
-        char *last_slash = file_path;
-        for (char *ptr = file_path; *ptr; ++ptr)
-        {
-            if (*ptr == '/')
-            {
-                last_slash = ptr;
-            }
-        }
-        *last_slash = '\0';
-        if ((ret = make_path(file_path)))
-        {
-            fprintf(stderr, "Could not create path: %s\n%s\n", file_path, strerror(ret));
-            free(file_path);
-            file_path = NULL;
-            goto cleanup;
-        }
-        *last_slash = '/';
+    /* Commit the dictionary file first so the directory never references an
+     * incomplete file */
+    start = now_nsecs();
+    if (dict_db && (ret = commit_transaction(dict_db)))
+    {
+        goto error;
+    }
+    if ((ret = commit_transaction(db)))
+    {
+        goto error;
+    }
+    if (swap_resource_pack(res_dir, id, has_pack))
+    {
+        ret = YOMI_ERR_EXTRACTING_RESOURCES;
+    }
+    add_phase_stats(stats, YOMI_PHASE_COMMIT, start, 0, 0, 0);
+    end_import_pragmas(db, &pragmas);
 
-        /* Open the file */
-#ifdef _WIN32
-        LPWSTR wFilePath = utf8_to_lpwstr(file_path);
-        FILE *file = _wfopen(wFilePath, L"wb+");
-        free(wFilePath);
-        wFilePath = NULL;
-#else
-        FILE *file = fopen(file_path, "wb+");
-#endif
-        if (file == NULL)
-        {
-            fprintf(stderr, "Could not open file for writing\n%s\n", file_path);
-            free(file_path);
-            if (zip_file)
-            {
-                zip_fclose(zip_file);
-            }
-            goto cleanup;
-        }
-        free(file_path);
-        file_path = NULL;
+    zip_close(dict_archive);
+    sqlite3_close_v2(dict_db);
+    sqlite3_close_v2(db);
+    free(dict_path);
 
-        /* Buffer and write the file */
-        char buf[BUFSIZ];
-        zip_int64_t bytes_read = 0;
-        while ((bytes_read = zip_fread(zip_file, buf, sizeof(buf))))
-        {
-            fwrite(buf, sizeof(char), bytes_read, file);
-        }
-        fclose(file);
-        if (zip_file)
-        {
-            zip_fclose(zip_file);
-        }
+    return ret;
+
+error:
+    if (dict_db)
+    {
+        rollback_transaction(dict_db);
+        sqlite3_close_v2(dict_db);
     }
-
-cleanup:
-    if (file_regex)
+    if (dict_path)
     {
-        regfree(file_regex);
+        remove_dict_file(dict_path);
+        free(dict_path);
     }
-    json_object_put(obj);
-    free(base_path);
+    if (id)
+    {
+        discard_resource_pack(res_dir, id);
+    }
+    rollback_transaction(db);
+    if (pragmas_set)
+    {
+        end_import_pragmas(db, &pragmas);
+    }
+    zip_close(dict_archive);
+    sqlite3_close_v2(db);
 
     return ret;
 }
 
-#undef TITLE_KEY
+/* Begin yomi_update_dictionary defines */
 
-#undef REGEX_SKIP_FILE
+#define FNV_OFFSET_BASIS    14695981039346656037ULL
+#define FNV_PRIME           1099511628211ULL
 
 /**
- * Modifies the dict_disabled table with a given query.
- * @param dic_id  The ID to bind to the query.
- * @param db_file The path to the database file.
- * @param query   The query to execute. Must contain an ID bind.
- * @return Error code
+ * A bank table and the columns that make up the contents of a row.
  */
-static int modify_dict_disabled(int64_t dic_id, const char *db_file, const char *query)
+typedef struct bank_columns
 {
-    int           ret  = 0;
-    sqlite3      *db   = NULL;
-    sqlite3_stmt *stmt = NULL;
-    int           step = 0;
-    char         *path = NULL;
+    const char *table;
+    const char *columns;
+} bank_columns;
+
+static const bank_columns BANK_COLUMNS[] = {
+    { "tag_bank",        "name, category, ord, notes, score" },
+    { "term_bank",       "expression, reading, def_tags, rules, score, "
+                         "glossary, sequence, term_tags" },
+    { "term_meta_bank",  "expression, mode, type, data, reading, value, "
+                         "display, pitches" },
+    { "kanji_bank",      "char, onyomi, kunyomi, tags, meanings, stats" },
+    { "kanji_meta_bank", "expression, mode, type, data, reading, value, "
+                         "display, pitches" },
+};
+
+#define BANK_COLUMNS_COUNT \
+    (sizeof(BANK_COLUMNS) / sizeof(BANK_COLUMNS[0]))
 
-    /* Open or create the database */
-    if ((ret = yomi_prepare_db(db_file, &db)))
+/**
+ * Adds bytes to a 64-bit FNV-1a hash.
+ * @param hash The current hash. FNV_OFFSET_BASIS to start a new hash.
+ * @param data The bytes to add.
+ * @param len  The number of bytes.
+ * @return The updated hash.
+ */
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t len)
+{
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < len; ++i)
     {
-        goto cleanup;
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
     }
+    return hash;
+}
 
-    /* Remove the dictionary from the  */
-    if (sqlite3_prepare_v2(db, query, -1, &stmt, NULL) != SQLITE_OK)
+/**
+ * Adds a SQLite value to a hash. The type is part of the hash so values of
+ * different types never hash the same.
+ * @param hash  The current hash.
+ * @param value The value to add.
+ * @return The updated hash.
+ */
+static uint64_t hash_value(uint64_t hash, sqlite3_value *value)
+{
+    unsigned char type = sqlite3_value_type(value);
+    hash = hash_bytes(hash, &type, sizeof(type));
+
+    switch (type)
     {
-        fprintf(stderr, "Could not prepare sqlite statement\n");
-        fprintf(stderr, "Query: %s\n", query);
-        ret = STATEMENT_PREPARE_ERR;
-        goto cleanup;
+    case SQLITE_INTEGER:
+    {
+        sqlite3_int64 val = sqlite3_value_int64(value);
+        return hash_bytes(hash, &val, sizeof(val));
     }
-    if (sqlite3_bind_int(stmt, 1, dic_id) != SQLITE_OK)
+    case SQLITE_FLOAT:
     {
-        fprintf(stderr, "Could not bind values to sqlite statement\n");
-        ret = STATEMENT_BIND_ERR;
-        goto cleanup;
+        double val = sqlite3_value_double(value);
+        return hash_bytes(hash, &val, sizeof(val));
     }
-    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    case SQLITE_TEXT:
     {
-        fprintf(stderr, "Could not commit to database, sqlite3 error code %d\n", step);
-        ret = STATEMENT_STEP_ERR;
-        goto cleanup;
+        const unsigned char *text = sqlite3_value_text(value);
+        int len = sqlite3_value_bytes(value);
+        hash = hash_bytes(hash, &len, sizeof(len));
+        return hash_bytes(hash, text, len);
+    }
+    case SQLITE_BLOB:
+    {
+        const void *blob = sqlite3_value_blob(value);
+        int len = sqlite3_value_bytes(value);
+        hash = hash_bytes(hash, &len, sizeof(len));
+        return hash_bytes(hash, blob, len);
+    }
+    default:
+        return hash;
     }
-
-cleanup:
-    sqlite3_finalize(stmt);
-    sqlite3_close_v2(db);
-    free(path);
-
-    return ret;
 }
 
-int yomi_prepare_db(const char *db_file, sqlite3 **db)
+/**
+ * SQL function yomi_row_hash(...) that hashes all of its arguments.
+ * @param ctx  The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The arguments.
+ */
+static void row_hash_func(sqlite3_context *ctx, int argc, sqlite3_value **argv)
 {
-    int      ret          = 0;
-    sqlite3 *db_loc       = NULL;
-    int      prepare_code = 0;
-
-    /* Open or create the database */
-    if (sqlite3_open_v2(db_file, &db_loc, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK)
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (int i = 0; i < argc; ++i)
     {
-        ret = YOMI_ERR_DB;
-        goto cleanup;
+        hash = hash_value(hash, argv[i]);
     }
+    sqlite3_result_int64(ctx, (sqlite3_int64)hash);
+}
 
-    /* Make sure the database is setup */
-    if ((prepare_code = prepare_db(db_loc)))
-    {
-        ret = prepare_code == DB_NEW_VERSION_ERR ? YOMI_ERR_NEWER_VERSION : YOMI_ERR_DB;
-        goto cleanup;
-    }
+/**
+ * Creates empty temporary tables that shadow the bank tables. Rows inserted
+ * without a schema name will go into these tables.
+ * @param db The database.
+ * @return Error code
+ */
+static int create_staging_tables(sqlite3 *db)
+{
+    char *query  = NULL;
+    char *errmsg = NULL;
 
-    /* Return the create database if not null */
-    if (db)
+    for (size_t i = 0; i < BANK_COLUMNS_COUNT; ++i)
     {
-        *db = db_loc;
-        return ret;
+        query = sqlite3_mprintf(
+            "CREATE TEMP TABLE %s AS SELECT * FROM main.%s WHERE 0;",
+            BANK_COLUMNS[i].table, BANK_COLUMNS[i].table
+        );
+        if (query == NULL)
+        {
+            fprintf(stderr, "Could not allocate memory for query\n");
+            return MALLOC_FAILURE_ERR;
+        }
+        sqlite3_exec(db, query, NULL, NULL, &errmsg);
+        sqlite3_free(query);
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not create staging table\nError: %s\n", errmsg);
+            sqlite3_free(errmsg);
+            return DB_CREATE_TABLE_ERR;
+        }
     }
 
-cleanup:
-    sqlite3_close_v2(db_loc);
-    if (db)
+    return 0;
+}
+
+/**
+ * Applies the difference between the staged rows and the rows of a dictionary
+ * to the bank tables. Rows are matched by the hash of their contents, so
+ * only rows that were added, changed or removed are written. Drops the
+ * staging tables.
+ * @param db The database.
+ * @param id The id of the dictionary being updated.
+ * @return Error code
+ */
+static int apply_staged_rows(sqlite3 *db, const sqlite3_int64 id)
+{
+    char *query  = NULL;
+    char *errmsg = NULL;
+
+    for (size_t i = 0; i < BANK_COLUMNS_COUNT; ++i)
     {
-        *db = NULL;
+        const char *table   = BANK_COLUMNS[i].table;
+        const char *columns = BANK_COLUMNS[i].columns;
+
+        /* Number identical rows so duplicates are matched one to one */
+        query = sqlite3_mprintf(
+            "CREATE TEMP TABLE update_old AS "
+                "SELECT rid, hash, row_number() OVER (PARTITION BY hash) AS n "
+                "FROM ("
+                    "SELECT rowid AS rid, yomi_row_hash(%s) AS hash "
+                    "FROM main.%s WHERE dic_id = %lld"
+                ");"
+            "CREATE TEMP TABLE update_new AS "
+                "SELECT rid, hash, row_number() OVER (PARTITION BY hash) AS n "
+                "FROM ("
+                    "SELECT rowid AS rid, yomi_row_hash(%s) AS hash "
+                    "FROM temp.%s"
+                ");"
+            "CREATE INDEX temp.idx_update_old ON update_old(hash, n);"
+            "CREATE INDEX temp.idx_update_new ON update_new(hash, n);"
+
+            "DELETE FROM main.%s WHERE rowid IN ("
+                "SELECT rid FROM update_old AS o WHERE NOT EXISTS ("
+                    "SELECT 1 FROM update_new AS nw "
+                    "WHERE nw.hash = o.hash AND nw.n = o.n"
+                ")"
+            ");"
+            "INSERT INTO main.%s SELECT * FROM temp.%s WHERE rowid IN ("
+                "SELECT rid FROM update_new AS nw WHERE NOT EXISTS ("
+                    "SELECT 1 FROM update_old AS o "
+                    "WHERE o.hash = nw.hash AND o.n = nw.n"
+                ")"
+            ");"
+
+            "DROP TABLE temp.update_old;"
+            "DROP TABLE temp.update_new;"
+            "DROP TABLE temp.%s;",
+            columns, table, (long long)id,
+            columns, table,
+            table,
+            table, table,
+            table
+        );
+        if (query == NULL)
+        {
+            fprintf(stderr, "Could not allocate memory for query\n");
+            return MALLOC_FAILURE_ERR;
+        }
+        sqlite3_exec(db, query, NULL, NULL, &errmsg);
+        sqlite3_free(query);
+        if (errmsg)
+        {
+            fprintf(stderr, "Could not update %s\nError: %s\n", table, errmsg);
+            sqlite3_free(errmsg);
+            return STATEMENT_STEP_ERR;
+        }
     }
 
-    return ret;
+    return 0;
 }
 
-int yomi_process_dictionary(const char *dict_file, const char *db_file, const char *res_dir)
+#define QUERY_FIND      "SELECT dic_id, revision, file FROM directory WHERE title = ?;"
+#define QUERY_UPDATE    "UPDATE directory SET format = ?, revision = ?, sequenced = ? WHERE dic_id = ?;"
+
+int yomi_update_dictionary(const char *dict_file, const char *db_file, const char *res_dir)
 {
     int            ret          = 0;
     int            err          = 0;
     zip_t         *dict_archive = NULL;
     sqlite3       *db           = NULL;
+    sqlite3       *dict_db      = NULL;
+    sqlite3       *bank_db      = NULL;
+    sqlite3_stmt  *stmt         = NULL;
+    char          *dict_path    = NULL;
+    index_info     info;
     sqlite3_int64  id           = 0;
+    int            up_to_date   = 0;
+    int            has_pack     = 0;
+    bank_type      failed_type  = tag_bank;
+
+    memset(&info, 0, sizeof(info));
 
     /* Open dictionary archive */
     dict_archive = zip_open(dict_file, ZIP_RDONLY, &err);
     if (err)
     {
         ret = YOMI_ERR_OPENING_DIC;
-        goto error;
+        goto cleanup;
+    }
+    if (read_index(dict_archive, &info))
+    {
+        ret = YOMI_ERR_ADDING_INDEX;
+        goto cleanup;
     }
 
     /* Open or create the database */
     if ((ret = yomi_prepare_db(db_file, &db)))
     {
-        goto error;
+        goto cleanup;
     }
 
-    /* Process the index file */
-    if ((ret = begin_transaction(db)))
+    /* Find the installed dictionary with the same title */
+    if (sqlite3_prepare_v2(db, QUERY_FIND, -1, &stmt, NULL) != SQLITE_OK ||
+        sqlite3_bind_text(stmt, 1, info.title, -1, NULL) != SQLITE_OK)
     {
-        goto error;
+        ret = YOMI_ERR_DB;
+        goto cleanup;
     }
-    if (add_index(dict_archive, db, &id))
+    switch (sqlite3_step(stmt))
     {
-        ret = YOMI_ERR_ADDING_INDEX;
-        goto error;
+    case SQLITE_ROW:
+        break;
+    case SQLITE_DONE:
+        ret = YOMI_ERR_NOT_INSTALLED;
+        goto cleanup;
+    default:
+        ret = YOMI_ERR_DB;
+        goto cleanup;
+    }
+    id = sqlite3_column_int64(stmt, 0);
+    up_to_date = strcmp((const char *)sqlite3_column_text(stmt, 1), info.revision) == 0;
+    if (sqlite3_column_type(stmt, 2) != SQLITE_NULL)
+    {
+        dict_path = get_dict_file_path(db_file, (const char *)sqlite3_column_text(stmt, 2));
+        if (dict_path == NULL)
+        {
+            ret = YOMI_ERR_DB;
+            goto cleanup;
+        }
+    }
+    sqlite3_finalize(stmt);
+    stmt = NULL;
+    if (up_to_date)
+    {
+        goto cleanup;
     }
 
-    /* Process the tag banks */
-    if (add_dic_files(dict_archive, db, id, tag_bank))
+    /* Open the database that holds the banks of the dictionary */
+    bank_db = db;
+    if (dict_path)
     {
-        ret = YOMI_ERR_ADDING_TAGS;
-        goto error;
+        if (sqlite3_open_v2(dict_path, &dict_db, SQLITE_OPEN_READWRITE, NULL) != SQLITE_OK ||
+            sqlite3_exec(dict_db, JOURNAL_MODE_PRAGMA, NULL, NULL, NULL) != SQLITE_OK)
+        {
+            ret = YOMI_ERR_DB;
+            goto cleanup;
+        }
+        bank_db = dict_db;
+    }
+    if (sqlite3_create_function(
+            bank_db, "yomi_row_hash", -1,
+            SQLITE_UTF8 | SQLITE_DETERMINISTIC, NULL,
+            row_hash_func, NULL, NULL) != SQLITE_OK)
+    {
+        ret = YOMI_ERR_DB;
+        goto cleanup;
     }
 
-    /* Process term banks */
-    if (add_dic_files(dict_archive, db, id, term_bank))
+    if ((ret = begin_transaction(db)))
+    {
+        goto cleanup;
+    }
+    if (dict_db && (ret = begin_transaction(dict_db)))
     {
-        ret = YOMI_ERR_ADDING_TERMS;
         goto error;
     }
 
-    /* Process term bank metadata */
-    if (add_dic_files(dict_archive, db, id, term_meta_bank))
+    /* Stage the new revision and apply the differences */
+    if (create_staging_tables(bank_db))
     {
-        ret = YOMI_ERR_ADDING_TERMS_META;
+        ret = YOMI_ERR_UPDATING_DICTIONARY;
         goto error;
     }
-
-    /* Process kanji banks */
-    if (add_dic_files(dict_archive, db, id, kanji_bank))
+    if (add_dic_files(dict_archive, dict_file, bank_db, id, 0, &failed_type, NULL))
+    {
+        ret = bank_type_to_error(failed_type);
+        goto error;
+    }
+    if (apply_staged_rows(bank_db, id))
     {
-        ret = YOMI_ERR_ADDING_KANJI;
+        ret = YOMI_ERR_UPDATING_DICTIONARY;
         goto error;
     }
 
-    /* Process kanji bank metadata */
-    if (add_dic_files(dict_archive, db, id, kanji_meta_bank))
+    /* Update the directory, keeping the ID the same */
+    if (sqlite3_prepare_v2(db, QUERY_UPDATE, -1, &stmt, NULL) != SQLITE_OK ||
+        sqlite3_bind_int  (stmt, 1, info.format)                  != SQLITE_OK ||
+        sqlite3_bind_text (stmt, 2, info.revision, -1, NULL)      != SQLITE_OK ||
+        sqlite3_bind_int  (stmt, 3, info.sequenced)               != SQLITE_OK ||
+        sqlite3_bind_int64(stmt, 4, id)                           != SQLITE_OK ||
+        sqlite3_step(stmt) != SQLITE_DONE)
     {
-        ret = YOMI_ERR_ADDING_KANJI_META;
+        ret = YOMI_ERR_ADDING_INDEX;
         goto error;
     }
 
-    /* Extract any resources that also exist in the archive */
-    if (extract_resources(dict_archive, res_dir))
+    /* Pack any resources that also exist in the archive */
+    if (pack_resources(dict_archive, db, id, res_dir, NULL, &has_pack))
     {
         ret = YOMI_ERR_EXTRACTING_RESOURCES;
         goto error;
     }
 
-    /* Commit the transaction */
+    /* Commit the transactions, then swap in the pack the new index describes */
+    if (dict_db && (ret = commit_transaction(dict_db)))
+    {
+        goto error;
+    }
     if ((ret = commit_transaction(db)))
     {
         goto error;
     }
+    if (swap_resource_pack(res_dir, id, has_pack))
+    {
+        ret = YOMI_ERR_EXTRACTING_RESOURCES;
+    }
 
-    zip_close(dict_archive);
-    sqlite3_close_v2(db);
-
-    return ret;
+    goto cleanup;
 
 error:
+    if (dict_db)
+    {
+        rollback_transaction(dict_db);
+    }
     rollback_transaction(db);
-    zip_close(dict_archive);
+    if (id)
+    {
+        discard_resource_pack(res_dir, id);
+    }
+
+cleanup:
+    sqlite3_finalize(stmt);
+    sqlite3_close_v2(dict_db);
     sqlite3_close_v2(db);
+    zip_close(dict_archive);
+    json_object_put(info.obj);
+    free(dict_path);
 
     return ret;
 }
 
-#define QUERY "DELETE FROM directory WHERE (dic_id = ?) RETURNING title;"
+#undef FNV_OFFSET_BASIS
+#undef FNV_PRIME
 
-int yomi_delete_dictionary(int64_t dic_id, const char *db_file, const char *res_dir)
+#undef BANK_COLUMNS_COUNT
+
+#undef QUERY_FIND
+#undef QUERY_UPDATE
+
+/* End yomi_update_dictionary defines */
+
+#define QUERY "DELETE FROM directory WHERE (dic_id = ?) RETURNING title, file;"
+
+/* Term indices are written next to the database by the application. The
+ * second file only exists while an index is being replaced. */
+#define TERM_INDEX_FORMAT "dict_%lld.keys"
+
+static const char *TERM_INDEX_SUFFIXES[] = {"", ".new"};
+
+#define TERM_INDEX_SUFFIX_COUNT \
+    (sizeof(TERM_INDEX_SUFFIXES) / sizeof(TERM_INDEX_SUFFIXES[0]))
+
+int yomi_remove_dictionary(int64_t dic_id, const char *db_file, yomi_removed_dictionary *removed)
 {
     int           ret       = 0;
     sqlite3      *db        = NULL;
     sqlite3_stmt *stmt      = NULL;
-    int           step      = 0;
-    char         *path      = NULL;
+    char         *file      = NULL;
+
+    memset(removed, 0, sizeof(*removed));
+    removed->id = dic_id;
 
     /* Open or create the database */
     if ((ret = yomi_prepare_db(db_file, &db)))
@@ -2237,43 +6068,128 @@ int yomi_delete_dictionary(int64_t dic_id, const char *db_file, const char *res_
         ret = YOMI_ERR_DELETE;
         goto cleanup;
     }
-    if (sqlite3_bind_int(stmt, 1, dic_id) != SQLITE_OK)
+    if (sqlite3_bind_int64(stmt, 1, dic_id) != SQLITE_OK)
     {
         ret = YOMI_ERR_DELETE;
         goto cleanup;
     }
-    if ((step = sqlite3_step(stmt)) != SQLITE_ROW)
+    if (sqlite3_step(stmt) != SQLITE_ROW)
     {
         ret = YOMI_ERR_DELETE;
         goto cleanup;
     }
-
-    /* Remove any resources */
-    path = concat_paths(res_dir, (const char *)sqlite3_column_text(stmt, 0));
-    ret = remove_path(path);
-    ret = ret && ret != ENOENT ? ret : 0;
-    if (ret)
+    removed->title = strdup((const char *)sqlite3_column_text(stmt, 0));
+    if (sqlite3_column_type(stmt, 1) != SQLITE_NULL)
     {
-        ret = YOMI_ERR_REMOVING_RESOURCES;
+        removed->path = get_dict_file_path(db_file, (const char *)sqlite3_column_text(stmt, 1));
+        if (removed->path == NULL)
+        {
+            ret = YOMI_ERR_DELETE;
+            goto cleanup;
+        }
+    }
+    file = sqlite3_mprintf(TERM_INDEX_FORMAT, (long long)dic_id);
+    removed->index_path = file ? get_dict_file_path(db_file, file) : NULL;
+    if (removed->title == NULL || removed->index_path == NULL)
+    {
+        ret = YOMI_ERR_DELETE;
         goto cleanup;
     }
 
-    if ((step = sqlite3_step(stmt)) != SQLITE_DONE)
+    /* Files are only removed once the dictionary is gone from the directory,
+     * so a failed delete never leaves a row pointing at a missing file */
+    if (sqlite3_step(stmt) != SQLITE_DONE)
     {
         ret = YOMI_ERR_DELETE;
         goto cleanup;
     }
 
 cleanup:
+    if (ret)
+    {
+        yomi_free_removed_dictionary(removed);
+    }
     sqlite3_finalize(stmt);
     sqlite3_close_v2(db);
+    sqlite3_free(file);
+
+    return ret;
+}
+
+int yomi_delete_dictionary_files(const yomi_removed_dictionary *removed, const char *res_dir)
+{
+    int   ret  = 0;
+    int   err  = 0;
+    char *path = NULL;
+
+    /* Remove the dictionary file if it has one */
+    if (removed->path && remove_dict_file(removed->path))
+    {
+        ret = YOMI_ERR_DELETE;
+        goto cleanup;
+    }
+
+    /* Remove the term index, which is rebuilt if left behind */
+    for (size_t i = 0; i < TERM_INDEX_SUFFIX_COUNT; ++i)
+    {
+        path = sqlite3_mprintf(
+            "%s%s", removed->index_path, TERM_INDEX_SUFFIXES[i]
+        );
+        err = path ? remove_file(path) : ENOMEM;
+        sqlite3_free(path);
+        path = NULL;
+        if (err && err != ENOENT)
+        {
+            ret = YOMI_ERR_DELETE;
+            goto cleanup;
+        }
+    }
+
+    /* Remove any resources */
+    path = get_pack_path(res_dir, removed->id, "");
+    err = path ? remove_file(path) : ENOMEM;
+    if ((err && err != ENOENT) || remove_resource_dir(res_dir, removed->title))
+    {
+        ret = YOMI_ERR_REMOVING_RESOURCES;
+        goto cleanup;
+    }
+
+cleanup:
     free(path);
 
     return ret;
 }
 
+void yomi_free_removed_dictionary(yomi_removed_dictionary *removed)
+{
+    free(removed->title);
+    free(removed->path);
+    free(removed->index_path);
+    removed->title = NULL;
+    removed->path = NULL;
+    removed->index_path = NULL;
+}
+
+int yomi_delete_dictionary(int64_t dic_id, const char *db_file, const char *res_dir)
+{
+    int                     ret = 0;
+    yomi_removed_dictionary removed;
+
+    if ((ret = yomi_remove_dictionary(dic_id, db_file, &removed)))
+    {
+        return ret;
+    }
+    ret = yomi_delete_dictionary_files(&removed, res_dir);
+    yomi_free_removed_dictionary(&removed);
+
+    return ret;
+}
+
 #undef QUERY
 
+#undef TERM_INDEX_FORMAT
+#undef TERM_INDEX_SUFFIX_COUNT
+
 int yomi_disable_dictionary(int64_t dic_id, const char *db_file)
 {
     return modify_dict_disabled(
@@ -28,9 +28,12 @@
 extern "C" {
 #endif
 
-#define YOMI_DB_VERSION                 4
+#define YOMI_DB_VERSION                 8
 #define YOMI_DB_FORMAT_VERSION          3
 
+/* Name of the file in the resource directory holding a dictionary's media */
+#define YOMI_RESOURCE_PACK_FORMAT       "dict_%lld.pack"
+
 #define YOMI_ERR_OPENING_DIC            1
 #define YOMI_ERR_DB                     2
 #define YOMI_ERR_NEWER_VERSION          3
@@ -43,6 +46,11 @@ extern "C" {
 #define YOMI_ERR_DELETE                 10
 #define YOMI_ERR_EXTRACTING_RESOURCES   11
 #define YOMI_ERR_REMOVING_RESOURCES     12
+#define YOMI_ERR_CREATING_DICT_FILE     13
+#define YOMI_ERR_ATTACHING_DICTIONARIES 14
+#define YOMI_ERR_ALREADY_INSTALLED      15
+#define YOMI_ERR_NOT_INSTALLED          16
+#define YOMI_ERR_UPDATING_DICTIONARY    17
 
 typedef enum yomi_blob_t
 {
@@ -55,6 +63,49 @@ typedef enum yomi_blob_t
     YOMI_BLOB_TYPE_BOOLEAN  = 6,
 } yomi_blob_t;
 
+/**
+ * The phases of an import measured by yomi_import_stats.
+ */
+typedef enum yomi_import_phase
+{
+    YOMI_PHASE_INDEX_FILE       = 0,
+    YOMI_PHASE_TAG_BANK         = 1,
+    YOMI_PHASE_TERM_BANK        = 2,
+    YOMI_PHASE_TERM_META_BANK   = 3,
+    YOMI_PHASE_KANJI_BANK       = 4,
+    YOMI_PHASE_KANJI_META_BANK  = 5,
+    YOMI_PHASE_BUILD_INDEXES    = 6,
+    YOMI_PHASE_RESOURCES        = 7,
+    YOMI_PHASE_COMMIT           = 8,
+    YOMI_PHASE_COUNT            = 9,
+} yomi_import_phase;
+
+/**
+ * Measurements of a single phase of an import.
+ */
+typedef struct yomi_phase_stats
+{
+    /* Wall time spent in the phase */
+    uint64_t nsecs;
+
+    /* Number of rows or resources written */
+    uint64_t rows;
+
+    /* Number of uncompressed bytes read from the archive */
+    uint64_t bytes;
+
+    /* Number of compressed bytes read from the archive */
+    uint64_t compressed_bytes;
+} yomi_phase_stats;
+
+/**
+ * Measurements of every phase of an import, indexed by yomi_import_phase.
+ */
+typedef struct yomi_import_stats
+{
+    yomi_phase_stats phases[YOMI_PHASE_COUNT];
+} yomi_import_stats;
+
 /**
  * Prepare a dictionary database if one doesn't already exist
  * @param      db_file The location of the database file
@@ -69,13 +120,46 @@ int yomi_prepare_db(const char *db_file, sqlite3 **db);
  * @param db_file   Path to the sqlite database
  * @param res_dir   The directory additional dictionary resources should be
  *                  stored in. Must already exist, will not be created.
- * @return Error code
+ *                  Resources are packed into a single file named after
+ *                  YOMI_RESOURCE_PACK_FORMAT and indexed by the resource
+ *                  table.
+ * @return Error code. YOMI_ERR_ALREADY_INSTALLED if a dictionary with the same
+ *         title is installed.
  */
 int yomi_process_dictionary(
     const char *dict_file, const char *db_file, const char *res_dir);
 
 /**
- * Remove a dictionary from a database if it exists
+ * Same as yomi_process_dictionary(), measuring every phase of the import.
+ * @param      dict_file The zip archive containing the yomichan dictionary
+ * @param      db_file   Path to the sqlite database
+ * @param      res_dir   The directory additional dictionary resources should
+ *                       be stored in. Must already exist, will not be created.
+ * @param[out] stats     Measurements are added to the values already in stats.
+ *                       Safe if NULL.
+ * @return Error code
+ */
+int yomi_process_dictionary_stats(
+    const char *dict_file, const char *db_file, const char *res_dir,
+    yomi_import_stats *stats);
+
+/**
+ * Update an installed dictionary to the revision in dict_file. Only rows that
+ * were added, changed or removed since the installed revision are written, and
+ * the dictionary keeps its ID. Does nothing if the revisions match.
+ * @param dict_file The zip archive containing the yomichan dictionary
+ * @param db_file   Path to the sqlite database
+ * @param res_dir   The directory additional dictionary resources should be
+ *                  stored in. Must already exist, will not be created.
+ * @return Error code. YOMI_ERR_NOT_INSTALLED if no dictionary with the same
+ *         title is installed.
+ */
+int yomi_update_dictionary(
+    const char *dict_file, const char *db_file, const char *res_dir);
+
+/**
+ * Remove a dictionary from a database if it exists. Same as
+ * yomi_remove_dictionary() followed by yomi_delete_dictionary_files().
  * @param dic_id  ID of the dictionary to remove.
  * @param db_file The location of the database file
  * @param res_dir The directory additional dictionary resources are stored in.
@@ -85,6 +169,72 @@ int yomi_process_dictionary(
 int yomi_delete_dictionary(
     int64_t dic_id, const char *db_file, const char *res_dir);
 
+/**
+ * A dictionary removed from the directory whose files still exist.
+ */
+typedef struct yomi_removed_dictionary
+{
+    /* The ID the dictionary had */
+    int64_t id;
+
+    /* The title of the dictionary */
+    char *title;
+
+    /* Path to the dictionary file. NULL if stored in the main database. */
+    char *path;
+
+    /* Path to the term index of the dictionary */
+    char *index_path;
+} yomi_removed_dictionary;
+
+/**
+ * Remove a dictionary from the directory of a database. Connections opened
+ * afterwards no longer attach its dictionary file, but the file is left in
+ * place so connections that still have it attached keep working. Rows stored
+ * in the main database are deleted.
+ * @param      dic_id  ID of the dictionary to remove.
+ * @param      db_file The location of the database file
+ * @param[out] removed The files left to delete. Must be freed with
+ *                     yomi_free_removed_dictionary() on success.
+ * @return Error code
+ */
+int yomi_remove_dictionary(
+    int64_t dic_id, const char *db_file, yomi_removed_dictionary *removed);
+
+/**
+ * Delete the files of a dictionary removed by yomi_remove_dictionary(). No
+ * connection may have the dictionary file attached or the term index mapped.
+ * @param removed The removed dictionary.
+ * @param res_dir The directory additional dictionary resources are stored in.
+ * @return Error code
+ */
+int yomi_delete_dictionary_files(
+    const yomi_removed_dictionary *removed, const char *res_dir);
+
+/**
+ * Free the strings of a removed dictionary.
+ * @param removed The removed dictionary. Safe if already freed.
+ */
+void yomi_free_removed_dictionary(yomi_removed_dictionary *removed);
+
+/**
+ * Attaches every dictionary stored in its own file to a connection and shadows
+ * the bank tables with temporary views over the main and attached databases.
+ * Any previously attached dictionaries are detached first.
+ * @param db      The connection to attach dictionaries to.
+ * @param db_file The location of the database file db is connected to.
+ * @return Error code
+ */
+int yomi_attach_dictionaries(sqlite3 *db, const char *db_file);
+
+/**
+ * Detaches every dictionary attached by yomi_attach_dictionaries(). Must be
+ * called before a dictionary file can be deleted on some platforms.
+ * @param db The connection to detach dictionaries from.
+ * @return Error code
+ */
+int yomi_detach_dictionaries(sqlite3 *db);
+
 /**
  * Disables a dictionary
  * @param dic_id  The ID of the dictionary to remove
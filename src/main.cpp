@@ -19,6 +19,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <clocale>
+#include <cstring>
 #include <iostream>
 
 #ifdef MEMENTO_QAPPLICATION
@@ -58,13 +59,16 @@
 #include "player/mpvthumbnail.h"
 #include "quick/clipboard.h"
 #include "quick/coloredsvgprovider.h"
+#include "quick/dictionaryresourceprovider.h"
 #include "quick/features.h"
 #include "quick/keytracker.h"
 #include "quick/paths.h"
+#include "quick/performancestats.h"
 #include "setting/settings.h"
 #include "state/context.h"
 #include "subtitle/subtitlelistmodel.h"
 #include "subtitle/subtitlelists.h"
+#include "util/tracing.h"
 #include "util/utils.h"
 
 static constexpr const char *MEMENTO_URI{"Ripose.Memento"};
@@ -91,6 +95,32 @@ static inline bool showHelpMessage(int argc, char **argv)
     return false;
 }
 
+/**
+ * @brief Start writing a trace of the hot paths if one was requested with the
+ * --memento-trace=<path> command line arg or the MEMENTO_TRACE environment
+ * variable.
+ *
+ * @param argc The number of command line arguments
+ * @param argv The values of the command line arguments
+ */
+static void startTracing(int argc, char **argv)
+{
+    constexpr const char *TRACE_ARG = "--memento-trace=";
+
+    QString path = qEnvironmentVariable("MEMENTO_TRACE");
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], TRACE_ARG, std::strlen(TRACE_ARG)) == 0)
+        {
+            path = QString::fromLocal8Bit(argv[i] + std::strlen(TRACE_ARG));
+        }
+    }
+    if (!path.isEmpty())
+    {
+        Tracing::start(path);
+    }
+}
+
 /**
  * @brief Create the Memento config directory if it doesn't already exist.
  *
@@ -251,6 +281,10 @@ static void registerQmlTypes(Context &context)
     qmlRegisterSingletonInstance<Paths>(
         MEMENTO_URI, 1, 0, "MementoPaths", new Paths(&context)
     );
+    qmlRegisterSingletonInstance<PerformanceStats>(
+        MEMENTO_URI, 1, 0, "PerformanceStats",
+        new PerformanceStats(&context, &context)
+    );
 
     /* Subtitle Types */
 
@@ -271,6 +305,9 @@ static void registerQmlTypes(Context &context)
 static void registerImageProviders(QQmlApplicationEngine &engine)
 {
     engine.addImageProvider("svgicon", new ColoredSvgProvider);
+    engine.addImageProvider(
+        DictionaryResources::PROVIDER_ID, new DictionaryResourceProvider
+    );
 }
 
 /**
@@ -458,6 +495,10 @@ int main(int argc, char *argv[])
     if (showHelpMessage(argc, argv))
     {
         std::cout << "Usage: memento [options] [url|path]\n"
+            << "\n"
+            << "  --memento-trace=<path>  Write a Chrome trace of lookups and "
+               "card creation to path.\n"
+            << "                          Also set by MEMENTO_TRACE.\n"
             << "\n"
             << "For more information about commandline arguments, see "
                "https://mpv.io/manual/\n";
@@ -488,6 +529,8 @@ int main(int argc, char *argv[])
         qFatal("Could not make config directory");
     }
 
+    startTracing(argc, argv);
+
     std::setlocale(LC_NUMERIC, "C");
 
 #if defined(Q_OS_WIN)
@@ -516,5 +559,7 @@ int main(int argc, char *argv[])
     DictionarySearchController::destroyInstance();
     Dictionary::destroyDatabaseInstance();
 
+    Tracing::stop();
+
     return ret;
 }
@@ -30,6 +30,12 @@
 
 #include "player/mpvplayer.h"
 #include "util/directoryutils.h"
+#include "util/tracing.h"
+
+/* Latencies reported by MpvController::stats() */
+static LatencyHistogram screenshotLatency;
+static LatencyHistogram audioClipLatency;
+static LatencyHistogram videoClipLatency;
 
 MpvController::MpvController(MpvPlayer *parent) : QObject(parent)
 {
@@ -592,6 +598,9 @@ void MpvController::sendWheel(double x, double y, QPoint angleDelta)
 
 QString MpvController::tempScreenshot(bool subtitles, const QString &ext)
 {
+    MEMENTO_TRACE_SCOPE("MpvController::tempScreenshot");
+    const LatencyHistogram::Timer latency{screenshotLatency};
+
     /* Create a valid temporary file name */
     QTemporaryFile file;
     if (!file.open())
@@ -618,6 +627,9 @@ QString MpvController::tempScreenshot(bool subtitles, const QString &ext)
 
 QImage MpvController::screenshotRaw(bool subtitles)
 {
+    MEMENTO_TRACE_SCOPE("MpvController::screenshotRaw");
+    const LatencyHistogram::Timer latency{screenshotLatency};
+
     const char *args[] = {
         "screenshot-raw",
         subtitles ? "subtitles" : "video",
@@ -696,11 +708,14 @@ QImage MpvController::screenshotRaw(bool subtitles)
 
 QString MpvController::tempAudioClip(const MpvAudioClipArgs &args)
 {
+    MEMENTO_TRACE_SCOPE("MpvController::tempAudioClip");
+
     int64_t aid = player()->state()->aid();
     if (aid == -1)
     {
         return {};
     }
+    const LatencyHistogram::Timer latency{audioClipLatency};
 
     QByteArray argString = QString("start=%1,end=%2,aid=%3")
         .arg(args.start, 0, 'f', 3)
@@ -727,6 +742,9 @@ QString MpvController::tempAudioClip(const MpvAudioClipArgs &args)
 
 QString MpvController::tempVideoClip(const MpvVideoClipArgs &args)
 {
+    MEMENTO_TRACE_SCOPE("MpvController::tempVideoClip");
+    const LatencyHistogram::Timer latency{videoClipLatency};
+
     constexpr const char *FILE_EXTENSION = ".mp4";
 
     QByteArray input = player()->state()->path().toUtf8();
@@ -770,6 +788,22 @@ QString MpvController::tempVideoClip(const MpvVideoClipArgs &args)
     return encodeFile(argString, options, FILE_EXTENSION);
 }
 
+MpvController::Stats MpvController::stats() noexcept
+{
+    return Stats{
+        .screenshots = screenshotLatency.snapshot(),
+        .audioClips = audioClipLatency.snapshot(),
+        .videoClips = videoClipLatency.snapshot(),
+    };
+}
+
+void MpvController::resetStats() noexcept
+{
+    screenshotLatency.reset();
+    audioClipLatency.reset();
+    videoClipLatency.reset();
+}
+
 /* End Public Functions */
 /* Begin Private Functions */
 
@@ -909,6 +943,8 @@ QString MpvController::encodeFile(
     const QList<QPair<QByteArray, QByteArray>> &options,
     const QString &fileExtension)
 {
+    MEMENTO_TRACE_SCOPE("MpvController::encodeFile");
+
     /* Create a valid temporary file name */
     QTemporaryFile file;
     if (!file.open())
@@ -30,6 +30,8 @@
 
 #include <mpv/client.h>
 
+#include "util/latencyhistogram.h"
+
 class MpvPlayer;
 
 /**
@@ -359,6 +361,35 @@ public:
     [[nodiscard]]
     Q_INVOKABLE QString tempVideoClip(const MpvVideoClipArgs &args);
 
+    /**
+     * @brief How long taking screenshots and encoding clips takes.
+     */
+    struct Stats
+    {
+        /* Screenshots saved to a file or copied into memory */
+        LatencyHistogram::Snapshot screenshots;
+
+        /* Audio clips encoded */
+        LatencyHistogram::Snapshot audioClips;
+
+        /* Video clips encoded */
+        LatencyHistogram::Snapshot videoClips;
+    };
+
+    /**
+     * @brief Get how long screenshots and clips have taken since the
+     * application started or resetStats() was called.
+     *
+     * @return Latencies shared by every MpvController.
+     */
+    [[nodiscard]]
+    static Stats stats() noexcept;
+
+    /**
+     * @brief Clears the screenshot and clip latencies.
+     */
+    static void resetStats() noexcept;
+
 signals:
     /**
      * @brief Emitted when the player being controlled changes.
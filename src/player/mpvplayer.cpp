@@ -502,8 +502,8 @@ void MpvPlayer::initOptions()
     QStringList args = QCoreApplication::arguments();
     for (qsizetype i = 0; i < args.size(); ++i)
     {
-        /* Skip non-options */
-        if (!args[i].startsWith("--"))
+        /* Skip non-options and options meant for Memento */
+        if (!args[i].startsWith("--") || args[i].startsWith("--memento-"))
         {
             continue;
         }
@@ -718,6 +718,17 @@ MpvPlayer {
         }
     }
 
+    PlayerStatsOverlay {
+        id: statsOverlay
+        anchors {
+            top: parent.top
+            right: parent.right
+            margins: 30
+        }
+        active: menu.showPerformanceStats
+        onCloseRequested: menu.showPerformanceStats = false
+    }
+
     PlayerOcrOverlay {
         id: ocrOverlay
         player: root
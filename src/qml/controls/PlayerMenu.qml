@@ -13,6 +13,9 @@ MenuBar {
     /* true if subtitles should be shown, false if they should be hidden */
     property alias showSubtitles: actionShowSubtitles.checked
 
+    /* true if performance statistics should be shown, false otherwise */
+    property alias showPerformanceStats: actionShowPerformanceStats.checked
+
     /* true if any children are under the cursor, false otherwise */
     readonly property bool anyHovered: {
         if (hovered)
@@ -437,6 +440,13 @@ MenuBar {
             onTriggered: MementoSettings.windowSubtitleList = checked
         }
 
+        Action {
+            id: actionShowPerformanceStats
+            text: qsTr("Show &Performance Stats")
+            checkable: true
+            checked: false
+        }
+
         Instantiator {
             /* Hide the action if OCR is disabled */
             model: Features.ocr && MementoSettings.ocrEnabled ? 1 : 0
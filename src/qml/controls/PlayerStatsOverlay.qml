@@ -0,0 +1,193 @@
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+import Ripose.Memento
+
+Pane {
+    id: root
+
+    /* true if the statistics should be shown and sampled, false otherwise */
+    property bool active: false
+
+    signal closeRequested()
+
+    /**
+     * Formats a duration for display.
+     * @param ms The duration in milliseconds.
+     * @return The duration rounded to a readable precision.
+     */
+    function formatMs(ms) {
+        return ms < 10 ? ms.toFixed(2) : ms.toFixed(0);
+    }
+
+    /**
+     * Formats a number of bytes for display.
+     * @param bytes The number of bytes.
+     * @return The size in the largest unit that keeps it above 1.
+     */
+    function formatBytes(bytes) {
+        const units = ["B", "KiB", "MiB", "GiB"];
+        let i = 0;
+        while (bytes >= 1024 && i < units.length - 1)
+        {
+            bytes /= 1024;
+            ++i;
+        }
+        return `${i === 0 ? bytes : bytes.toFixed(1)} ${units[i]}`;
+    }
+
+    visible: root.active
+    z: 50
+    opacity: 0.9
+    padding: 8
+
+    Binding {
+        target: PerformanceStats
+        property: "active"
+        value: root.active
+    }
+
+    background: Rectangle {
+        color: MementoPalette.window
+        border.color: MementoPalette.border
+        radius: 4
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: 8
+
+        RowLayout {
+            Layout.fillWidth: true
+
+            Label {
+                Layout.fillWidth: true
+                text: qsTr("Performance")
+                font.bold: true
+            }
+
+            Button {
+                text: qsTr("Reset")
+                onClicked: PerformanceStats.reset()
+            }
+
+            Button {
+                text: qsTr("Close")
+                onClicked: root.closeRequested()
+            }
+        }
+
+        GridLayout {
+            Layout.fillWidth: true
+            columns: 6
+            columnSpacing: 12
+            rowSpacing: 2
+
+            Label { text: qsTr("Operation"); font.bold: true }
+            Label { text: qsTr("Count"); font.bold: true }
+            Label { text: qsTr("Last (ms)"); font.bold: true }
+            Label { text: qsTr("Mean (ms)"); font.bold: true }
+            Label { text: qsTr("p99 (ms)"); font.bold: true }
+            Label { text: qsTr("Max (ms)"); font.bold: true }
+
+            Repeater {
+                model: PerformanceStats.latencies.length * 6
+                delegate: Label {
+                    required property int index
+
+                    readonly property var latency: PerformanceStats.latencies[Math.floor(index / 6)]
+
+                    Layout.alignment: index % 6 === 0 ? Qt.AlignLeft : Qt.AlignRight
+                    text: {
+                        switch (index % 6)
+                        {
+                        case 0:
+                            return latency.name;
+                        case 1:
+                            return latency.count;
+                        case 2:
+                            return root.formatMs(latency.last);
+                        case 3:
+                            return root.formatMs(latency.mean);
+                        case 4:
+                            return root.formatMs(latency.p99);
+                        default:
+                            return root.formatMs(latency.max);
+                        }
+                    }
+                }
+            }
+        }
+
+        GridLayout {
+            Layout.fillWidth: true
+            columns: 2
+            columnSpacing: 12
+            rowSpacing: 2
+
+            Repeater {
+                model: PerformanceStats.counters.length * 2
+                delegate: Label {
+                    required property int index
+
+                    readonly property var counter: PerformanceStats.counters[Math.floor(index / 2)]
+
+                    Layout.alignment: index % 2 === 0 ? Qt.AlignLeft : Qt.AlignRight
+                    text: {
+                        if (index % 2 === 0)
+                        {
+                            return counter.name;
+                        }
+                        return Number.isInteger(counter.value) ?
+                            counter.value :
+                            root.formatMs(counter.value);
+                    }
+                }
+            }
+        }
+
+        GridLayout {
+            Layout.fillWidth: true
+            columns: 6
+            columnSpacing: 12
+            rowSpacing: 2
+            visible: PerformanceStats.dictionaries.length > 0
+
+            Label { text: qsTr("Dictionary"); font.bold: true }
+            Label { text: qsTr("Definitions"); font.bold: true }
+            Label { text: qsTr("Glossaries"); font.bold: true }
+            Label { text: qsTr("Frequencies"); font.bold: true }
+            Label { text: qsTr("Pitches"); font.bold: true }
+            Label { text: qsTr("Kanji"); font.bold: true }
+
+            Repeater {
+                model: PerformanceStats.dictionaries.length * 6
+                delegate: Label {
+                    required property int index
+
+                    readonly property var dictionary: PerformanceStats.dictionaries[Math.floor(index / 6)]
+
+                    Layout.alignment: index % 6 === 0 ? Qt.AlignLeft : Qt.AlignRight
+                    opacity: dictionary.enabled ? 1.0 : 0.5
+                    text: {
+                        switch (index % 6)
+                        {
+                        case 0:
+                            return dictionary.name;
+                        case 1:
+                            return dictionary.definitions;
+                        case 2:
+                            return root.formatBytes(dictionary.glossaryBytes);
+                        case 3:
+                            return dictionary.frequencies;
+                        case 4:
+                            return dictionary.pitches;
+                        default:
+                            return dictionary.kanji;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -161,6 +161,9 @@ ListView {
 
         required property int index
 
+        onIndexChanged: root.dictionarySearch.loadTerms(termLayout.index)
+        Component.onCompleted: root.dictionarySearch.loadTerms(termLayout.index)
+
         /**
          * Add this term to Anki.
          */
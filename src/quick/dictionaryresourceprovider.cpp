@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "quick/dictionaryresourceprovider.h"
+
+#include <QImage>
+#include <QUrl>
+
+#include "dict/dictionary.h"
+
+DictionaryResourceProvider::DictionaryResourceProvider() :
+    QQuickImageProvider(QQuickImageProvider::Image)
+{
+
+}
+
+QImage DictionaryResourceProvider::requestImage(
+    const QString &id, QSize *size, const QSize &requestedSize)
+{
+    qsizetype separator = id.indexOf('/');
+    if (separator == -1)
+    {
+        return QImage();
+    }
+
+    bool ok = false;
+    int64_t dictionaryId = id.left(separator).toLongLong(&ok);
+    if (!ok)
+    {
+        return QImage();
+    }
+
+    std::shared_ptr<const DictionaryResources> resources =
+        Dictionary::resources(dictionaryId);
+    if (resources == nullptr)
+    {
+        return QImage();
+    }
+
+    QString path = QUrl::fromPercentEncoding(id.mid(separator + 1).toUtf8());
+    QImage image = QImage::fromData(resources->read(path));
+    if (image.isNull())
+    {
+        return QImage();
+    }
+
+    if (requestedSize.isValid())
+    {
+        image = image.scaled(
+            requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation
+        );
+    }
+    if (size)
+    {
+        *size = image.size();
+    }
+
+    return image;
+}
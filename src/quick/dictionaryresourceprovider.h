@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QQuickImageProvider>
+
+/**
+ * @brief Serves images stored in dictionary resource packs.
+ */
+class DictionaryResourceProvider : public QQuickImageProvider
+{
+public:
+    DictionaryResourceProvider();
+    virtual ~DictionaryResourceProvider() = default;
+
+    /**
+     * @brief Request an image belonging to a dictionary.
+     *
+     * @param id The ID of the requested image. Follows the format of
+     * dictionary/path where dictionary is the ID of the dictionary and path is
+     * the percent encoded path of the image in the dictionary archive.
+     * @param size The size of the requested image.
+     * @param requestedSize The requested size of the image.
+     * @return The requested image. Empty image if failure.
+     */
+    [[nodiscard]]
+    QImage requestImage(
+        const QString &id, QSize *size, const QSize &requestedSize) override;
+};
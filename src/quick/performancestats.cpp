@@ -0,0 +1,337 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "quick/performancestats.h"
+
+#include <QPointer>
+#include <QVariantMap>
+
+#include <algorithm>
+
+#include "anki/ankiclient.h"
+#include "dict/dictionarysearchcontroller.h"
+#ifdef MEMENTO_MECAB_SUPPORT
+#include "dict/mecabquerygenerator.h"
+#endif // MEMENTO_MECAB_SUPPORT
+#include "player/mpvcontroller.h"
+#include "state/context.h"
+
+/* How often statistics are sampled while active */
+static constexpr int REFRESH_INTERVAL_MS = 1000;
+
+/**
+ * @brief Turns a histogram snapshot into an object for QML.
+ *
+ * @param name The display name of the histogram.
+ * @param snapshot The snapshot of the histogram.
+ * @return An object with the properties name, count, last, mean, p99 and max.
+ * Times are in milliseconds.
+ */
+[[nodiscard]]
+static QVariantMap latencyToMap(
+    const QString &name, const LatencyHistogram::Snapshot &snapshot)
+{
+    constexpr double NSECS_PER_MSEC = 1000000.0;
+
+    QVariantMap map;
+    map["name"] = name;
+    map["count"] = static_cast<qulonglong>(snapshot.count);
+    map["last"] = snapshot.lastNsecs / NSECS_PER_MSEC;
+    map["mean"] = snapshot.meanNsecs / NSECS_PER_MSEC;
+    map["p99"] = snapshot.p99Nsecs / NSECS_PER_MSEC;
+    map["max"] = snapshot.maxNsecs / NSECS_PER_MSEC;
+    return map;
+}
+
+/**
+ * @brief Turns a counter into an object for QML.
+ *
+ * @param name The display name of the counter.
+ * @param value The value of the counter.
+ * @return An object with the properties name and value.
+ */
+[[nodiscard]]
+static QVariantMap counterToMap(const QString &name, const QVariant &value)
+{
+    QVariantMap map;
+    map["name"] = name;
+    map["value"] = value;
+    return map;
+}
+
+/* Begin Constructor/Destructor */
+
+PerformanceStats::PerformanceStats(Context *context, QObject *parent) :
+    QObject(parent),
+    m_context(context)
+{
+    m_timer.setInterval(REFRESH_INTERVAL_MS);
+    connect(
+        &m_timer, &QTimer::timeout,
+        this, &PerformanceStats::refresh
+    );
+}
+
+PerformanceStats::~PerformanceStats()
+{
+
+}
+
+/* End Constructor/Destructor */
+/* Begin Properties */
+
+bool PerformanceStats::active() const noexcept
+{
+    return m_timer.isActive();
+}
+
+void PerformanceStats::setActive(bool value)
+{
+    if (value == active())
+    {
+        return;
+    }
+
+    if (value)
+    {
+        refresh();
+        m_timer.start();
+    }
+    else
+    {
+        m_timer.stop();
+    }
+    emit activeChanged();
+}
+
+QVariantList PerformanceStats::latencies() const
+{
+    return m_latencies;
+}
+
+QVariantList PerformanceStats::counters() const
+{
+    return m_counters;
+}
+
+QVariantList PerformanceStats::dictionaries() const
+{
+    return m_dictionaries;
+}
+
+/* End Properties */
+/* Begin Sampling */
+
+void PerformanceStats::reset()
+{
+    if (DictionarySearchController *search =
+            DictionarySearchController::instance())
+    {
+        search->resetStats();
+    }
+    m_context->ankiClient()->resetStats();
+    MpvController::resetStats();
+    m_baseline = readCounters();
+
+    refresh();
+}
+
+PerformanceStats::CounterValues PerformanceStats::readCounters() noexcept
+{
+    CounterValues values;
+
+    if (const DictionarySearchController *search =
+            DictionarySearchController::instance())
+    {
+        const DictionarySearchController::SearchCacheStats searchCache =
+            search->searchCacheStats();
+        values.searchCacheHits = searchCache.hits;
+        values.searchCacheMisses = searchCache.misses;
+        values.cancelledSearches = search->cancelledSearches();
+
+        const DatabaseManager::StatementCacheStats statements =
+            search->statementCacheStats();
+        values.statementHits = statements.hits;
+        values.statementMisses = statements.misses;
+    }
+
+#ifdef MEMENTO_MECAB_SUPPORT
+    const MeCabQueryGenerator::Stats mecab = MeCabQueryGenerator::stats();
+    values.mecabParses = mecab.parses;
+    values.mecabParseNsecs = mecab.parseNsecs;
+    values.mecabParseCacheHits = mecab.parseCacheHits;
+#endif // MEMENTO_MECAB_SUPPORT
+
+    return values;
+}
+
+void PerformanceStats::refresh()
+{
+    const DictionarySearchController *search =
+        DictionarySearchController::instance();
+
+    /* Latencies */
+    m_latencies.clear();
+    if (search)
+    {
+        const DictionarySearchController::SearchStats searches =
+            search->searchStats();
+        m_latencies.emplaceBack(
+            latencyToMap(tr("Term searches"), searches.terms)
+        );
+        m_latencies.emplaceBack(
+            latencyToMap(tr("Kanji searches"), searches.kanji)
+        );
+
+        const DatabaseManager::QueryStats queries = search->queryStats();
+        m_latencies.emplaceBack(
+            latencyToMap(tr("Term queries"), queries.terms)
+        );
+        m_latencies.emplaceBack(
+            latencyToMap(tr("Frequency and pitch queries"), queries.termMeta)
+        );
+        m_latencies.emplaceBack(
+            latencyToMap(tr("Kanji queries"), queries.kanji)
+        );
+    }
+
+    const AnkiClient::Stats anki = m_context->ankiClient()->stats();
+    m_latencies.emplaceBack(latencyToMap(tr("Note builds"), anki.noteBuilds));
+    m_latencies.emplaceBack(
+        latencyToMap(tr("AnkiConnect requests"), anki.requests)
+    );
+
+    const MpvController::Stats player = MpvController::stats();
+    m_latencies.emplaceBack(
+        latencyToMap(tr("Screenshots"), player.screenshots)
+    );
+    m_latencies.emplaceBack(
+        latencyToMap(tr("Audio clip encodes"), player.audioClips)
+    );
+    m_latencies.emplaceBack(
+        latencyToMap(tr("Video clip encodes"), player.videoClips)
+    );
+
+    /* Counters */
+    const CounterValues current = readCounters();
+    const uint64_t searchCacheHits =
+        current.searchCacheHits - m_baseline.searchCacheHits;
+    const uint64_t searchCacheMisses =
+        current.searchCacheMisses - m_baseline.searchCacheMisses;
+    const uint64_t statementHits =
+        current.statementHits - m_baseline.statementHits;
+    const uint64_t statementMisses =
+        current.statementMisses - m_baseline.statementMisses;
+
+    m_counters.clear();
+    m_counters.emplaceBack(counterToMap(
+        tr("Search cache hits"), static_cast<qulonglong>(searchCacheHits)
+    ));
+    m_counters.emplaceBack(counterToMap(
+        tr("Search cache misses"), static_cast<qulonglong>(searchCacheMisses)
+    ));
+    m_counters.emplaceBack(counterToMap(
+        tr("Cancelled searches"),
+        static_cast<qulonglong>(
+            current.cancelledSearches - m_baseline.cancelledSearches
+        )
+    ));
+    m_counters.emplaceBack(counterToMap(
+        tr("SQL statements"),
+        static_cast<qulonglong>(statementHits + statementMisses)
+    ));
+    m_counters.emplaceBack(counterToMap(
+        tr("Statements prepared"), static_cast<qulonglong>(statementMisses)
+    ));
+#ifdef MEMENTO_MECAB_SUPPORT
+    const uint64_t mecabParses = current.mecabParses - m_baseline.mecabParses;
+    const uint64_t mecabParseNsecs =
+        current.mecabParseNsecs - m_baseline.mecabParseNsecs;
+    m_counters.emplaceBack(counterToMap(
+        tr("MeCab parses"), static_cast<qulonglong>(mecabParses)
+    ));
+    m_counters.emplaceBack(counterToMap(
+        tr("MeCab parse cache hits"),
+        static_cast<qulonglong>(
+            current.mecabParseCacheHits - m_baseline.mecabParseCacheHits
+        )
+    ));
+    m_counters.emplaceBack(counterToMap(
+        tr("MeCab mean parse (ms)"),
+        mecabParses == 0 ? 0.0 : mecabParseNsecs / 1000000.0 / mecabParses
+    ));
+#endif // MEMENTO_MECAB_SUPPORT
+
+    emit updated();
+
+    if (!m_refreshingDictionaries)
+    {
+        refreshDictionaries();
+    }
+}
+
+QCoro::Task<void> PerformanceStats::refreshDictionaries()
+{
+    DictionarySearchController *search =
+        DictionarySearchController::instance();
+    if (search == nullptr)
+    {
+        m_dictionaries.clear();
+        co_return;
+    }
+
+    QPointer<PerformanceStats> performanceStats{this};
+    m_refreshingDictionaries = true;
+    QList<DatabaseManager::DictionaryCost> costs =
+        co_await search->dictionaryCostsAsync();
+    if (performanceStats == nullptr)
+    {
+        co_return;
+    }
+    m_refreshingDictionaries = false;
+
+    /* Dictionary costs, most expensive first */
+    m_dictionaries.clear();
+    std::sort(
+        costs.begin(), costs.end(),
+        [] (const auto &lhs, const auto &rhs) -> bool
+        {
+            return lhs.glossaryBytes > rhs.glossaryBytes ||
+                (lhs.glossaryBytes == rhs.glossaryBytes &&
+                 lhs.name < rhs.name);
+        }
+    );
+    for (const DatabaseManager::DictionaryCost &cost : costs)
+    {
+        QVariantMap map;
+        map["name"] = cost.name;
+        map["enabled"] = cost.enabled;
+        map["definitions"] = static_cast<qulonglong>(cost.definitions);
+        map["glossaryBytes"] = static_cast<qulonglong>(cost.glossaryBytes);
+        map["frequencies"] = static_cast<qulonglong>(cost.frequencies);
+        map["pitches"] = static_cast<qulonglong>(cost.pitches);
+        map["kanji"] = static_cast<qulonglong>(cost.kanji);
+        m_dictionaries.emplaceBack(std::move(map));
+    }
+
+    emit updated();
+}
+
+/* End Sampling */
@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QObject>
+
+#include <QTimer>
+#include <QVariantList>
+
+#ifdef MEMENTO_SYSTEM_QCORO
+#include <QCoroTask>
+#else
+#include <qcoro/qcorotask.h>
+#endif // MEMENTO_SYSTEM_QCORO
+
+#include <cstdint>
+
+class Context;
+
+/**
+ * @brief QML singleton that periodically samples the latency histograms and
+ * counters of the search pipeline, Anki client and player.
+ */
+class PerformanceStats : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(
+        bool active
+        READ active
+        WRITE setActive
+        NOTIFY activeChanged
+    )
+
+    Q_PROPERTY(
+        QVariantList latencies
+        READ latencies
+        NOTIFY updated
+    )
+
+    Q_PROPERTY(
+        QVariantList counters
+        READ counters
+        NOTIFY updated
+    )
+
+    Q_PROPERTY(
+        QVariantList dictionaries
+        READ dictionaries
+        NOTIFY updated
+    )
+
+public:
+    /**
+     * @brief Creates an inactive sampler.
+     *
+     * @param context The application context.
+     * @param parent The parent of this object.
+     */
+    explicit PerformanceStats(Context *context, QObject *parent = nullptr);
+    virtual ~PerformanceStats();
+
+    /**
+     * @brief Get if the statistics are being sampled.
+     *
+     * @return true if the statistics are sampled every second, false
+     * otherwise.
+     */
+    [[nodiscard]]
+    bool active() const noexcept;
+
+    /**
+     * @brief Start or stop sampling the statistics. Counters keep counting
+     * while inactive.
+     *
+     * @param value true to sample the statistics every second, false to stop.
+     */
+    void setActive(bool value);
+
+    /**
+     * @brief Get the last sampled latencies.
+     *
+     * @return A list of objects with the properties name, count, last, mean,
+     * p99 and max. Times are in milliseconds.
+     */
+    [[nodiscard]]
+    QVariantList latencies() const;
+
+    /**
+     * @brief Get the last sampled counters.
+     *
+     * @return A list of objects with the properties name and value.
+     */
+    [[nodiscard]]
+    QVariantList counters() const;
+
+    /**
+     * @brief Get the last sampled costs of the installed dictionaries.
+     *
+     * @return A list of objects with the properties name, enabled,
+     * definitions, glossaryBytes, frequencies, pitches and kanji.
+     */
+    [[nodiscard]]
+    QVariantList dictionaries() const;
+
+    /**
+     * @brief Starts counting every statistic from zero.
+     */
+    Q_INVOKABLE void reset();
+
+signals:
+    /**
+     * @brief Emitted when sampling starts or stops.
+     */
+    void activeChanged();
+
+    /**
+     * @brief Emitted after the statistics are sampled.
+     */
+    void updated();
+
+private slots:
+    /**
+     * @brief Samples every statistic. Dictionary costs are sampled in the
+     * background and emit updated() again once they arrive.
+     */
+    void refresh();
+
+private:
+    /**
+     * @brief Samples the dictionary costs unless they are already being
+     * sampled.
+     *
+     * @return An awaitable task.
+     */
+    QCoro::Task<void> refreshDictionaries();
+
+    /**
+     * @brief Monotonic counters that are reset by subtracting a baseline.
+     */
+    struct CounterValues
+    {
+        uint64_t searchCacheHits{0};
+        uint64_t searchCacheMisses{0};
+        uint64_t cancelledSearches{0};
+        uint64_t statementHits{0};
+        uint64_t statementMisses{0};
+        uint64_t mecabParses{0};
+        uint64_t mecabParseNsecs{0};
+        uint64_t mecabParseCacheHits{0};
+    };
+
+    /**
+     * @brief Reads the current value of every counter.
+     *
+     * @return The counter values.
+     */
+    [[nodiscard]]
+    static CounterValues readCounters() noexcept;
+
+    /* The application context */
+    Context *m_context;
+
+    /* Fires every time the statistics should be sampled */
+    QTimer m_timer;
+
+    /* Counter values when reset() was last called */
+    CounterValues m_baseline;
+
+    /* The last sampled latencies */
+    QVariantList m_latencies;
+
+    /* The last sampled counters */
+    QVariantList m_counters;
+
+    /* The last sampled dictionary costs */
+    QVariantList m_dictionaries;
+
+    /* true while dictionary costs are being sampled, false otherwise */
+    bool m_refreshingDictionaries{false};
+};
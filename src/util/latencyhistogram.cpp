@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "util/latencyhistogram.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "util/tracing.h"
+
+/* Begin Timer */
+
+LatencyHistogram::Timer::Timer(LatencyHistogram &histogram) noexcept :
+    m_histogram(histogram),
+    m_start(Tracing::now())
+{
+}
+
+LatencyHistogram::Timer::~Timer()
+{
+    m_histogram.recordSince(m_start);
+}
+
+/* End Timer */
+/* Begin Recording */
+
+void LatencyHistogram::record(int64_t nsecs) noexcept
+{
+    nsecs = std::max<int64_t>(nsecs, 0);
+
+    m_buckets[bucketIndex(nsecs)].fetch_add(1, std::memory_order_relaxed);
+    m_totalNsecs.fetch_add(nsecs, std::memory_order_relaxed);
+    m_lastNsecs.store(nsecs, std::memory_order_relaxed);
+    int64_t max = m_maxNsecs.load(std::memory_order_relaxed);
+    while (nsecs > max &&
+        !m_maxNsecs.compare_exchange_weak(
+            max, nsecs, std::memory_order_relaxed))
+    {
+    }
+}
+
+void LatencyHistogram::recordSince(int64_t start) noexcept
+{
+    record(Tracing::now() - start);
+}
+
+/* End Recording */
+/* Begin Summarizing */
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const noexcept
+{
+    std::array<uint64_t, BUCKET_COUNT> buckets;
+    uint64_t count = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        count += buckets[i];
+    }
+
+    Snapshot result{
+        .count = count,
+        .lastNsecs = m_lastNsecs.load(std::memory_order_relaxed),
+        .meanNsecs = 0,
+        .p99Nsecs = 0,
+        .maxNsecs = m_maxNsecs.load(std::memory_order_relaxed),
+    };
+    if (count == 0)
+    {
+        return result;
+    }
+    result.meanNsecs = static_cast<int64_t>(
+        m_totalNsecs.load(std::memory_order_relaxed) / count
+    );
+
+    /* The bucket holding the 99th percentile is found by rank */
+    const uint64_t rank = count - count / 100;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            result.p99Nsecs = std::min<int64_t>(
+                static_cast<int64_t>(bucketUpperBound(i)), result.maxNsecs
+            );
+            break;
+        }
+    }
+
+    return result;
+}
+
+void LatencyHistogram::reset() noexcept
+{
+    for (std::atomic_uint64_t &bucket : m_buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_totalNsecs.store(0, std::memory_order_relaxed);
+    m_lastNsecs.store(0, std::memory_order_relaxed);
+    m_maxNsecs.store(0, std::memory_order_relaxed);
+}
+
+/* End Summarizing */
+/* Begin Buckets */
+
+size_t LatencyHistogram::bucketIndex(uint64_t nsecs) noexcept
+{
+    if (nsecs < SUB_BUCKETS)
+    {
+        return nsecs;
+    }
+
+    /* The exponent picks a row of buckets, the bits after the leading one
+     * pick the bucket within the row */
+    const int exponent = std::bit_width(nsecs) - 1;
+    const size_t sub = (nsecs >> (exponent - SUB_BUCKET_BITS)) &
+        (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) noexcept
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+
+    const int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    const uint64_t sub = index % SUB_BUCKETS;
+    const uint64_t width = uint64_t{1} << (exponent - SUB_BUCKET_BITS);
+    return (SUB_BUCKETS + sub) * width + (width - 1);
+}
+
+/* End Buckets */
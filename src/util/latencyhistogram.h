@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief A histogram of durations that can be recorded to from any thread
+ * without locking. Buckets grow exponentially with four buckets per power of
+ * two, so percentiles are accurate to within 25%.
+ */
+class LatencyHistogram
+{
+public:
+    /**
+     * @brief A summary of the recorded durations.
+     */
+    struct Snapshot
+    {
+        /* Number of durations recorded */
+        uint64_t count;
+
+        /* The most recently recorded duration in nanoseconds */
+        int64_t lastNsecs;
+
+        /* The mean duration in nanoseconds */
+        int64_t meanNsecs;
+
+        /* The 99th percentile duration in nanoseconds */
+        int64_t p99Nsecs;
+
+        /* The longest duration in nanoseconds */
+        int64_t maxNsecs;
+    };
+
+    /**
+     * @brief Records the lifetime of an object to a histogram.
+     */
+    class Timer
+    {
+    public:
+        /**
+         * @brief Starts timing.
+         *
+         * @param histogram The histogram the duration is recorded to.
+         */
+        explicit Timer(LatencyHistogram &histogram) noexcept;
+
+        Timer(const Timer &) = delete;
+        Timer &operator=(const Timer &) = delete;
+
+        ~Timer();
+
+    private:
+        /* The histogram the duration is recorded to */
+        LatencyHistogram &m_histogram;
+
+        /* The Tracing::now() timestamp timing started at */
+        int64_t m_start;
+    };
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    /**
+     * @brief Records a duration.
+     *
+     * @param nsecs The duration in nanoseconds. Negative values count as 0.
+     */
+    void record(int64_t nsecs) noexcept;
+
+    /**
+     * @brief Records the time elapsed since a timestamp.
+     *
+     * @param start A Tracing::now() timestamp.
+     */
+    void recordSince(int64_t start) noexcept;
+
+    /**
+     * @brief Summarizes the recorded durations. Durations recorded while the
+     * snapshot is taken may be partially included.
+     *
+     * @return A summary of the recorded durations.
+     */
+    [[nodiscard]]
+    Snapshot snapshot() const noexcept;
+
+    /**
+     * @brief Forgets every recorded duration.
+     */
+    void reset() noexcept;
+
+private:
+    /* log2 of the number of buckets per power of two */
+    static constexpr int SUB_BUCKET_BITS = 2;
+
+    /* Number of buckets per power of two */
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+
+    /* Enough buckets to hold every 64-bit duration */
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) *
+        SUB_BUCKETS;
+
+    /**
+     * @brief Get the bucket a duration is counted in.
+     *
+     * @param nsecs The duration in nanoseconds.
+     * @return The index of the bucket.
+     */
+    [[nodiscard]]
+    static size_t bucketIndex(uint64_t nsecs) noexcept;
+
+    /**
+     * @brief Get the longest duration counted in a bucket.
+     *
+     * @param index The index of the bucket.
+     * @return The upper bound of the bucket in nanoseconds.
+     */
+    [[nodiscard]]
+    static uint64_t bucketUpperBound(size_t index) noexcept;
+
+    /* Number of durations in each bucket */
+    std::array<std::atomic_uint64_t, BUCKET_COUNT> m_buckets{};
+
+    /* Sum of every duration recorded */
+    std::atomic_uint64_t m_totalNsecs{0};
+
+    /* The most recently recorded duration */
+    std::atomic_int64_t m_lastNsecs{0};
+
+    /* The longest duration recorded */
+    std::atomic_int64_t m_maxNsecs{0};
+};
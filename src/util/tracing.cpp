@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "util/tracing.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+
+#include <cstdio>
+
+/* Guards everything below */
+static QMutex traceMutex;
+
+/* The trace file. Only open while tracing. */
+static QFile traceFile;
+
+/* Timestamps are written relative to the time tracing started */
+static int64_t traceOrigin{0};
+
+/* The ID of the current process */
+static qint64 tracePid{0};
+
+/* True until the first event of the file is written */
+static bool firstEvent{true};
+
+/* Incremented every time tracing starts so threads get named in every file */
+static uint64_t traceSession{0};
+
+/* Source of thread IDs that are small enough to read in the trace viewer */
+static std::atomic_int nextThreadId{1};
+
+/**
+ * @brief Writes an event to the trace file. traceMutex must be held.
+ *
+ * @param event The JSON object of the event.
+ * @param size The length of event.
+ */
+static void writeEvent(const char *event, qsizetype size)
+{
+    if (!firstEvent)
+    {
+        traceFile.write(",\n");
+    }
+    firstEvent = false;
+    traceFile.write(event, size);
+}
+
+/**
+ * @brief Names the current thread in the trace file. traceMutex must be held.
+ *
+ * @param tid The ID of the current thread in the trace.
+ */
+static void writeThreadName(int tid)
+{
+    QString name = QThread::currentThread()->objectName();
+    if (name.isEmpty())
+    {
+        name = QThread::isMainThread() ?
+            QStringLiteral("Main Thread") :
+            QStringLiteral("Thread %1").arg(tid);
+    }
+    name.replace('\\', "\\\\").replace('"', "\\\"");
+
+    char event[512];
+    const int size = std::snprintf(
+        event, sizeof(event),
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%lld,\"tid\":%d,"
+        "\"args\":{\"name\":\"%s\"}}",
+        static_cast<long long>(tracePid), tid, qUtf8Printable(name)
+    );
+    if (size > 0 && size < static_cast<int>(sizeof(event)))
+    {
+        writeEvent(event, size);
+    }
+}
+
+bool Tracing::start(const QString &path)
+{
+    QMutexLocker lock{&traceMutex};
+    if (enabledFlag)
+    {
+        return true;
+    }
+
+    traceFile.setFileName(path);
+    if (!traceFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning(
+            "Could not open trace file %s: %s",
+            qUtf8Printable(path), qUtf8Printable(traceFile.errorString())
+        );
+        return false;
+    }
+    /* The array format stays readable if Memento exits without stopping */
+    traceFile.write("[\n");
+
+    traceOrigin = now();
+    tracePid = QCoreApplication::applicationPid();
+    firstEvent = true;
+    ++traceSession;
+    enabledFlag = true;
+
+    return true;
+}
+
+void Tracing::stop()
+{
+    QMutexLocker lock{&traceMutex};
+    if (!enabledFlag)
+    {
+        return;
+    }
+    enabledFlag = false;
+
+    traceFile.write("\n]\n");
+    traceFile.close();
+}
+
+void Tracing::record(const char *name, int64_t start, int64_t end)
+{
+    thread_local const int tid = nextThreadId++;
+    thread_local uint64_t namedSession = 0;
+
+    QMutexLocker lock{&traceMutex};
+
+    /* Tracing may have stopped while the span was open */
+    if (!enabledFlag)
+    {
+        return;
+    }
+    if (namedSession != traceSession)
+    {
+        writeThreadName(tid);
+        namedSession = traceSession;
+    }
+
+    char event[256];
+    const int size = std::snprintf(
+        event, sizeof(event),
+        "{\"name\":\"%s\",\"cat\":\"memento\",\"ph\":\"X\","
+        "\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lld,\"tid\":%d}",
+        name,
+        (start - traceOrigin) / 1000.0,
+        (end - start) / 1000.0,
+        static_cast<long long>(tracePid),
+        tid
+    );
+    if (size > 0 && size < static_cast<int>(sizeof(event)))
+    {
+        writeEvent(event, size);
+    }
+}
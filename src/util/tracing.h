@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright (c) 2026 Ripose
+//
+// This file is part of Memento.
+//
+// Memento is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License.
+//
+// Memento is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Memento.  If not, see <https://www.gnu.org/licenses/>.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Scoped trace spans that can be streamed to a Chrome trace file. The
+ * file can be opened with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Spans cost a single relaxed atomic load when tracing is disabled.
+ */
+namespace Tracing
+{
+
+/**
+ * @brief Starts writing trace events to a file. Does nothing if tracing is
+ * already started.
+ *
+ * @param path The path of the trace file. Overwritten if it exists.
+ * @return true if tracing started, false if the file could not be opened.
+ */
+bool start(const QString &path);
+
+/**
+ * @brief Finishes the trace file and stops tracing. Spans that are still open
+ * are dropped.
+ */
+void stop();
+
+/* True while trace events are being written. Use enabled() instead. */
+inline std::atomic_bool enabledFlag{false};
+
+/**
+ * @brief Get if trace events are being written.
+ *
+ * @return true if tracing is enabled, false otherwise.
+ */
+[[nodiscard]]
+inline bool enabled() noexcept
+{
+    return enabledFlag.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Get the timestamp spans are measured with.
+ *
+ * @return The time in nanoseconds since an arbitrary point.
+ */
+[[nodiscard]]
+inline int64_t now() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ * @brief Writes a complete event to the trace file.
+ *
+ * @param name The name of the event. Must be a string literal.
+ * @param start The now() timestamp the event started at.
+ * @param end The now() timestamp the event ended at.
+ */
+void record(const char *name, int64_t start, int64_t end);
+
+/**
+ * @brief Records the lifetime of an object as an event. Nothing is measured
+ * if tracing was disabled when the span was created.
+ */
+class Span
+{
+public:
+    /**
+     * @brief Starts a span.
+     *
+     * @param name The name of the span. Must be a string literal.
+     */
+    explicit Span(const char *name) noexcept :
+        m_name(enabled() ? name : nullptr),
+        m_start(m_name ? now() : 0)
+    {
+    }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+    ~Span()
+    {
+        if (m_name)
+        {
+            record(m_name, m_start, now());
+        }
+    }
+
+private:
+    /* The name of the span. nullptr if tracing is disabled. */
+    const char *m_name;
+
+    /* The time the span started at */
+    int64_t m_start;
+};
+
+}
+
+#define MEMENTO_TRACE_CONCAT_IMPL(a, b) a##b
+#define MEMENTO_TRACE_CONCAT(a, b) MEMENTO_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Traces the rest of the enclosing scope.
+ *
+ * @param name The name of the span. Must be a string literal.
+ */
+#define MEMENTO_TRACE_SCOPE(name) \
+    const Tracing::Span MEMENTO_TRACE_CONCAT(traceSpan, __LINE__){name}
@@ -23,3 +23,4 @@
 #include "util/directoryutils.h"
 #include "util/fileutils.h"
 #include "util/imageutils.h"
+#include "util/tracing.h"